@@ -0,0 +1,146 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/shell/decoration/renderer.h"
+#include "src/server/shell/decoration/window.h"
+
+#include "mir/test/doubles/stub_buffer_allocator.h"
+#include "mir/test/doubles/stub_surface.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace msd = mir::shell::decoration;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+/// Matches the geometry used by BasicDecoration
+auto const static_geometry = std::make_shared<msd::StaticGeometry const>(msd::StaticGeometry{
+    geom::Height{24},   // titlebar_height
+    geom::Width{6},     // side_border_width
+    geom::Height{6},    // bottom_border_height
+    geom::Size{16, 16}, // resize_corner_input_size
+    geom::Width{24},    // button_width
+    geom::Width{6},     // padding_between_buttons
+    geom::Height{14},   // title_font_height
+    geom::Point{8, 2},  // title_font_top_left
+    geom::Displacement{5, 5}, // icon_padding
+    geom::Width{1},     // icon_line_width
+});
+
+struct TitledSurface : mtd::StubSurface
+{
+    std::string name() const override { return title; }
+    geom::Size window_size() const override { return {640, 480}; }
+    MirWindowFocusState focus_state() const override { return focus; }
+    MirWindowState state() const override { return mir_window_state_restored; }
+
+    std::string title;
+    MirWindowFocusState focus{mir_window_focus_state_focused};
+};
+
+/// Redraws the titlebar of \a surface after \a change has been applied, \a redraws times
+template<typename Change>
+auto time_redraws(msd::Renderer& renderer, TitledSurface& surface, int redraws, Change change)
+    -> std::chrono::nanoseconds
+{
+    auto const surface_ptr = std::shared_ptr<TitledSurface>{std::shared_ptr<TitledSurface>{}, &surface};
+    msd::InputState const input_state{{}, {}};
+    int rendered{0};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != redraws; ++i)
+    {
+        change(i);
+        renderer.update_state(msd::WindowState{static_geometry, surface_ptr}, input_state);
+        if (renderer.render_titlebar())
+            ++rendered;
+    }
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    // Make use of the result, so the compiler can't discard the work
+    if (rendered < 0)
+        std::cout << rendered;
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+
+void report(std::string const& scenario, std::chrono::nanoseconds duration, int redraws)
+{
+    std::cout << std::setw(32) << std::left << scenario
+              << std::setw(8) << std::right << duration.count() / redraws / 1000.0
+              << "us per titlebar redraw" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <redraws per scenario>"<<std::endl;
+        exit(1);
+    }
+
+    int const redraws = std::atoi(argv[1]);
+    auto const allocator = std::make_shared<mtd::StubBufferAllocator>();
+    std::string const title{"mir@localhost: ~/src/mir/build - make -j8 all"};
+
+    {
+        // A terminal title being typed into: each redraw adds or removes a character
+        msd::Renderer renderer{allocator, static_geometry};
+        TitledSurface surface;
+        auto const duration = time_redraws(renderer, surface, redraws, [&](int i)
+            {
+                surface.title = title.substr(0, 1 + i % title.size());
+            });
+        report("title typed one key at a time", duration, redraws);
+    }
+
+    {
+        // Focus moving between windows: the title does not change
+        msd::Renderer renderer{allocator, static_geometry};
+        TitledSurface surface;
+        surface.title = title;
+        auto const duration = time_redraws(renderer, surface, redraws, [&](int i)
+            {
+                surface.focus = i % 2 ? mir_window_focus_state_focused : mir_window_focus_state_unfocused;
+            });
+        report("focus toggled, same title", duration, redraws);
+    }
+
+    {
+        // Many windows, each with a distinct title sharing the same glyphs
+        std::vector<std::string> titles;
+        for (int i = 0; i != 256; ++i)
+            titles.push_back("Document " + std::to_string(i) + " - Editor");
+
+        msd::Renderer renderer{allocator, static_geometry};
+        TitledSurface surface;
+        auto const duration = time_redraws(renderer, surface, redraws, [&](int i)
+            {
+                surface.title = titles[i % titles.size()];
+            });
+        report("256 distinct window titles", duration, redraws);
+    }
+
+    exit(0);
+}
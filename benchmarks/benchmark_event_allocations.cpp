@@ -0,0 +1,142 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/events/event_builders.h"
+#include "mir/geometry/displacement.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace mev = mir::events;
+namespace geom = mir::geometry;
+
+namespace
+{
+std::atomic<long> allocations{0};
+}
+
+// Count every heap allocation in the process, including those in the Mir libraries
+void* operator new(std::size_t size)
+{
+    ++allocations;
+    if (auto const p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace
+{
+std::vector<uint8_t> const no_cookie;
+
+/// Builds a relative pointer motion event as the libinput platform does
+auto motion_event(int i) -> mir::EventUPtr
+{
+    return mev::make_event(
+        MirInputDeviceId{1},
+        std::chrono::nanoseconds{i},
+        no_cookie,
+        mir_input_event_modifier_none,
+        mir_pointer_action_motion,
+        0,
+        0.0f, 0.0f,
+        0.0f, 0.0f,
+        1.0f, 1.0f);
+}
+
+struct Result
+{
+    double allocations_per_event;
+    long ns_per_event;
+};
+
+template<typename Path>
+auto measure(int events, Path path) -> Result
+{
+    // Let any pooling settle before counting
+    for (int i = 0; i != 1000; ++i)
+        path(i);
+
+    auto const allocations_before = allocations.load();
+    auto const start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i != events; ++i)
+        path(i);
+
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    return {
+        static_cast<double>(allocations.load() - allocations_before) / events,
+        static_cast<long>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / events)};
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <pointer motion events>"<<std::endl;
+        exit(1);
+    }
+
+    int const events = std::atoi(argv[1]);
+
+    struct
+    {
+        char const* name;
+        std::function<void(int)> path;
+    } const paths[] = {
+        {"build", [](int i) { motion_event(i); }},
+        {"build, deliver to surface", [](int i)
+            {
+                // SurfaceInputDispatcher clones each event into the surface's coordinates
+                auto const event = motion_event(i);
+                auto const delivered = mev::clone_event(*event);
+                mev::transform_positions(*delivered, geom::Displacement{10, 10});
+            }},
+        {"build, share with seat, deliver to surface", [](int i)
+            {
+                // InputSink::handle_input() takes a shared_ptr
+                std::shared_ptr<MirEvent> const event = motion_event(i);
+                auto const delivered = mev::clone_event(*event);
+                mev::transform_positions(*delivered, geom::Displacement{10, 10});
+            }},
+    };
+
+    for (auto const& path : paths)
+    {
+        auto const result = measure(events, path.path);
+        std::cout << path.name << ": " << result.allocations_per_event << " allocations and "
+                  << result.ns_per_event << "ns per event" << std::endl;
+    }
+
+    exit(0);
+}
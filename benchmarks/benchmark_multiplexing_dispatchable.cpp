@@ -18,7 +18,9 @@
 
 #include "mir/dispatch/multiplexing_dispatchable.h"
 
+#include <cstring>
 #include <iostream>
+#include <string>
 #include <vector>
 #include <memory>
 #include <chrono>
@@ -72,6 +74,48 @@ private:
 
 thread_local uint64_t TestDispatchable::dispatch_count = 0;
 
+/// A source that stays readable, counting how often it is dispatched
+class ReadySource : public md::Dispatchable
+{
+public:
+    ReadySource(uint64_t& dispatch_count)
+        : dispatch_count{dispatch_count}
+    {
+        int pipefds[2];
+        if (pipe(pipefds) < 0)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create pipe"};
+        }
+
+        read_fd = mir::Fd{pipefds[0]};
+        write_fd = mir::Fd{pipefds[1]};
+
+        char dummy{0};
+        if (::write(write_fd, &dummy, sizeof(dummy)) != sizeof(dummy))
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to mark dispatchable"};
+        }
+    }
+
+    mir::Fd watch_fd() const override
+    {
+        return read_fd;
+    }
+    bool dispatch(md::FdEvents) override
+    {
+        ++dispatch_count;
+        return true;
+    }
+    md::FdEvents relevant_events() const override
+    {
+        return md::FdEvent::readable;
+    }
+
+private:
+    uint64_t& dispatch_count;
+    mir::Fd read_fd, write_fd;
+};
+
 bool fd_is_readable(int fd)
 {
     struct pollfd poller {
@@ -82,11 +126,55 @@ bool fd_is_readable(int fd)
     return poll(&poller, 1, 0);
 }
 
+/// Events/sec dispatching from a number of simultaneously-ready sources on one thread
+double ready_source_throughput(int source_count, int events_per_dispatch, uint64_t event_count)
+{
+    uint64_t dispatched{0};
+
+    md::MultiplexingDispatchable dispatcher;
+    dispatcher.set_max_events_per_dispatch(events_per_dispatch);
+
+    for (int i = 0; i != source_count; ++i)
+    {
+        dispatcher.add_watch(std::make_shared<ReadySource>(dispatched));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (dispatched < event_count)
+    {
+        dispatcher.dispatch(md::FdEvent::readable);
+    }
+
+    std::chrono::duration<double> const duration = std::chrono::steady_clock::now() - start;
+    return dispatched / duration.count();
+}
+
+void ready_sources(uint64_t event_count)
+{
+    std::cout<<"ready sources\tevents/sec (1 per dispatch)\tevents/sec ("
+             <<md::MultiplexingDispatchable::max_batch_size<<" per dispatch)"<<std::endl;
+
+    for (int sources = 1; sources <= 64; sources *= 2)
+    {
+        auto const unbatched = ready_source_throughput(sources, 1, event_count);
+        auto const batched = ready_source_throughput(sources, md::MultiplexingDispatchable::max_batch_size, event_count);
+        std::cout<<sources<<"\t"<<static_cast<uint64_t>(unbatched)<<"\t"<<static_cast<uint64_t>(batched)<<std::endl;
+    }
+}
+
 int main(int argc, char** argv)
 {
+    if (argc == 3 && strcmp(argv[1], "--ready-sources") == 0)
+    {
+        ready_sources(std::atoll(argv[2]));
+        exit(0);
+    }
+
     if (argc != 3)
     {
         std::cout<<"Usage: "<<argv[0]<<" <number of threads> <dispatch count>"<<std::endl;
+        std::cout<<"       "<<argv[0]<<" --ready-sources <dispatch count>"<<std::endl;
         exit(1);
     }
 
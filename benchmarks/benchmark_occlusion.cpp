@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/occlusion.h"
+
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+class OpaqueRenderable : public mg::Renderable
+{
+public:
+    OpaqueRenderable(geom::Rectangle const& position)
+        : position{position}
+    {
+    }
+
+    ID id() const override { return this; }
+    std::shared_ptr<mg::Buffer> buffer() const override { return {}; }
+    geom::Rectangle screen_position() const override { return position; }
+    geom::Rectangle src_bounds() const override { return {{}, position.size}; }
+    std::experimental::optional<geom::Rectangle> clip_area() const override { return {}; }
+    geom::Rectangles damage() const override { return {}; }
+    float alpha() const override { return 1.0f; }
+    glm::mat4 transformation() const override { return glm::mat4(1); }
+    bool shaped() const override { return false; }
+    geom::Rectangles opaque_region() const override { return {}; }
+    unsigned int swap_interval() const override { return 1; }
+
+private:
+    geom::Rectangle const position;
+};
+
+class Element : public mc::SceneElement
+{
+public:
+    Element(geom::Rectangle const& position)
+        : renderable_{std::make_shared<OpaqueRenderable>(position)}
+    {
+    }
+
+    std::shared_ptr<mg::Renderable> renderable() const override { return renderable_; }
+    void rendered() override {}
+    void occluded() override {}
+
+private:
+    std::shared_ptr<mg::Renderable> const renderable_;
+};
+
+geom::Rectangle const output{{0, 0}, {1920, 1080}};
+
+/// A scene of \a surfaces randomly placed windows, about a quarter of the output each
+mc::SceneElementSequence random_scene(int surfaces, std::mt19937& random)
+{
+    std::uniform_int_distribution<int> x{-200, 1720};
+    std::uniform_int_distribution<int> y{-200, 880};
+    std::uniform_int_distribution<int> width{100, 960};
+    std::uniform_int_distribution<int> height{100, 540};
+
+    mc::SceneElementSequence scene;
+    for (int i = 0; i != surfaces; ++i)
+    {
+        scene.push_back(std::make_shared<Element>(
+            geom::Rectangle{{x(random), y(random)}, {width(random), height(random)}}));
+    }
+    return scene;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <iterations per scene size>"<<std::endl;
+        exit(1);
+    }
+
+    int const iterations = std::atoi(argv[1]);
+    std::mt19937 random{1234};
+
+    for (auto const surfaces : {10, 100, 1000})
+    {
+        auto const scene = random_scene(surfaces, random);
+        std::chrono::steady_clock::duration duration{0};
+        size_t visible{0};
+
+        for (int i = 0; i != iterations; ++i)
+        {
+            auto elements = scene;
+
+            auto const start = std::chrono::steady_clock::now();
+            mc::filter_occlusions_from(elements, output);
+            duration += std::chrono::steady_clock::now() - start;
+
+            visible = elements.size();
+        }
+
+        auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        std::cout << std::setw(5) << surfaces << " surfaces (" << std::setw(3) << visible << " visible): "
+                  << iterations << " passes took " << ns << "ns ("
+                  << ns / iterations << "ns per pass)" << std::endl;
+    }
+
+    exit(0);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/renderer/sw/pixel_kernels.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace mrs = mir::renderer::software;
+
+namespace
+{
+// A 4K screen, and a HiDPI titlebar spanning it
+size_t const frame_pixels = 3840 * 2160;
+size_t const titlebar_pixels = 3840 * 48;
+
+template<typename Operation>
+auto time_runs(int runs, Operation operation) -> std::chrono::nanoseconds
+{
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != runs; ++i)
+        operation();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+}
+
+void report(mrs::PixelKernels const& kernels, char const* operation, std::chrono::nanoseconds duration, int runs)
+{
+    std::cout << std::setw(8) << std::left << kernels.name
+              << std::setw(16) << operation
+              << std::setw(10) << std::right << std::fixed << std::setprecision(1)
+              << duration.count() / runs / 1000.0 << "us" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <runs per kernel>"<<std::endl;
+        exit(1);
+    }
+
+    int const runs = std::atoi(argv[1]);
+    std::mt19937 random{1234};
+    std::uniform_int_distribution<uint32_t> pixel;
+    std::uniform_int_distribution<int> coverage{-400, 255};
+
+    std::vector<uint32_t> source(frame_pixels);
+    for (auto& p : source)
+        p = pixel(random);
+
+    // Text is mostly uncovered, with some partially covered edges and some solid strokes
+    std::vector<uint8_t> mask(titlebar_pixels);
+    for (auto& m : mask)
+        m = std::max(coverage(random), 0);
+
+    std::vector<uint32_t> dest(frame_pixels);
+
+    std::cout << "Pixels per operation: fill, premultiply, swap " << frame_pixels
+              << "; blend " << titlebar_pixels << std::endl;
+
+    for (auto const kernels : mrs::available_pixel_kernels())
+    {
+        report(*kernels, "fill", time_runs(runs, [&]
+            {
+                kernels->fill(dest.data(), 0xff303030, frame_pixels);
+            }), runs);
+
+        report(*kernels, "blend_a8", time_runs(runs, [&]
+            {
+                kernels->blend_a8(dest.data(), mask.data(), 0xffe0e0e0, titlebar_pixels);
+            }), runs);
+
+        report(*kernels, "premultiply", time_runs(runs, [&]
+            {
+                kernels->premultiply(dest.data(), source.data(), frame_pixels);
+            }), runs);
+
+        report(*kernels, "swap_red_blue", time_runs(runs, [&]
+            {
+                kernels->swap_red_blue(dest.data(), source.data(), frame_pixels);
+            }), runs);
+    }
+
+    std::cout << "Selected: " << mrs::pixel_kernels().name << std::endl;
+
+    exit(0);
+}
@@ -0,0 +1,344 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "src/renderers/sw/renderer.h"
+#include "src/renderers/gl/renderer.h"
+#include "mir/renderer/gl/buffer_age_source.h"
+#include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/gl/texture_source.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/graphics/buffer_basic.h"
+
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/test/doubles/stub_sw_display_buffer.h"
+
+#include MIR_SERVER_GL_H
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mg = mir::graphics;
+namespace mr = mir::renderer;
+namespace mrs = mir::renderer::software;
+namespace mrg = mir::renderer::gl;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+geom::Rectangle const screen{{0, 0}, {1920, 1080}};
+
+/// A client's shared memory buffer, which either renderer can composite
+class ClientBuffer :
+    public mg::BufferBasic,
+    public mg::NativeBufferBase,
+    public mrs::PixelSource,
+    public mrg::TextureSource
+{
+public:
+    ClientBuffer(geom::Size size, MirPixelFormat format, uint32_t color)
+        : size_{size},
+          format{format},
+          pixels(size.width.as_int() * size.height.as_int(), color)
+    {
+    }
+
+    geom::Size size() const override { return size_; }
+    MirPixelFormat pixel_format() const override { return format; }
+    std::shared_ptr<mg::NativeBuffer> native_buffer_handle() const override { return {}; }
+    NativeBufferBase* native_buffer_base() override { return this; }
+
+    void write(unsigned char const* data, size_t size) override
+    {
+        memcpy(pixels.data(), data, std::min(size, pixels.size() * sizeof pixels[0]));
+    }
+    void read(std::function<void(unsigned char const*)> const& do_with_pixels) override
+    {
+        do_with_pixels(reinterpret_cast<unsigned char const*>(pixels.data()));
+    }
+    geom::Stride stride() const override { return geom::Stride{size_.width.as_int() * 4}; }
+
+    void gl_bind_to_texture() override
+    {
+        bind();
+        secure_for_render();
+    }
+    void bind() override
+    {
+        // The channel order doesn't matter for timing, so upload the same way for every format
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, GL_RGBA,
+            size_.width.as_int(), size_.height.as_int(), 0,
+            GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    }
+    void secure_for_render() override {}
+
+private:
+    geom::Size const size_;
+    MirPixelFormat const format;
+    std::vector<uint32_t> pixels;
+};
+
+/// A client redrawing every frame: alternates between two buffers, as the GL renderer
+/// only uploads buffers it hasn't seen before
+class Window
+{
+public:
+    Window(geom::Rectangle position, MirPixelFormat format, uint32_t color)
+        : buffers{
+              std::make_shared<ClientBuffer>(position.size, format, color),
+              std::make_shared<ClientBuffer>(position.size, format, color ^ 0x00ffffff)},
+          renderable{std::make_shared<mtd::FakeRenderable>(
+              position, 1.0f, format == mir_pixel_format_xrgb_8888)}
+    {
+        renderable->set_buffer(buffers[0]);
+    }
+
+    void next_frame()
+    {
+        current = !current;
+        renderable->set_buffer(buffers[current]);
+    }
+
+    std::shared_ptr<ClientBuffer> const buffers[2];
+    std::shared_ptr<mtd::FakeRenderable> const renderable;
+
+private:
+    bool current{false};
+};
+
+struct Scene
+{
+    std::string name;
+    mg::RenderableList renderables;
+    /// Updates the scene for the next frame, returning its damage (or nothing to repaint everything)
+    std::function<std::experimental::optional<geom::Rectangles>(int frame)> next_frame;
+};
+
+/// A headless llvmpipe context drawing into a pbuffer the size of the screen
+class PbufferDisplayBuffer :
+    public mtd::StubDisplayBuffer,
+    public mrg::RenderTarget,
+    public mrg::BufferAgeSource
+{
+public:
+    PbufferDisplayBuffer(geom::Rectangle const& view_area)
+        : StubDisplayBuffer{view_area}
+    {
+        auto const get_platform_display = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+            eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        display = get_platform_display ?
+            get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr) :
+            eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+            return;
+
+        EGLint const config_attribs[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, MIR_SERVER_EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+            EGL_NONE};
+        EGLConfig config;
+        EGLint configs{0};
+        if (!eglChooseConfig(display, config_attribs, &config, 1, &configs) || configs != 1)
+            return;
+
+        EGLint const surface_attribs[] = {
+            EGL_WIDTH, view_area.size.width.as_int(),
+            EGL_HEIGHT, view_area.size.height.as_int(),
+            EGL_NONE};
+        EGLint const context_attribs[] = {
+#if MIR_SERVER_EGL_OPENGL_BIT == EGL_OPENGL_ES2_BIT
+            EGL_CONTEXT_CLIENT_VERSION, 2,
+#endif
+            EGL_NONE};
+        eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
+        surface = eglCreatePbufferSurface(display, config, surface_attribs);
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attribs);
+    }
+
+    ~PbufferDisplayBuffer()
+    {
+        if (display != EGL_NO_DISPLAY)
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (context != EGL_NO_CONTEXT)
+                eglDestroyContext(display, context);
+            if (surface != EGL_NO_SURFACE)
+                eglDestroySurface(display, surface);
+            eglTerminate(display);
+        }
+    }
+
+    bool usable() const { return surface != EGL_NO_SURFACE && context != EGL_NO_CONTEXT; }
+
+    auto renderer_name() const -> std::string
+    {
+        auto const name = reinterpret_cast<char const*>(glGetString(GL_RENDERER));
+        return name ? name : "unknown";
+    }
+
+    void make_current() override { eglMakeCurrent(display, surface, surface, context); }
+    void release_current() override { eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT); }
+    void bind() override { glBindFramebuffer(GL_FRAMEBUFFER, 0); }
+
+    // A pbuffer is never swapped, so waiting for it to finish drawing is the closest equivalent
+    void swap_buffers() override
+    {
+        glFinish();
+        drawn = true;
+    }
+
+    // ...and it always holds the previous frame, so partial repaints are possible
+    unsigned int buffer_age() const override { return drawn ? 1 : 0; }
+
+private:
+    EGLDisplay display{EGL_NO_DISPLAY};
+    EGLSurface surface{EGL_NO_SURFACE};
+    EGLContext context{EGL_NO_CONTEXT};
+    bool drawn{false};
+};
+
+auto time_frames(mr::Renderer& renderer, Scene const& scene, int frames) -> std::chrono::nanoseconds
+{
+    renderer.set_viewport(screen);
+    renderer.render(scene.renderables);   // Warm up caches and fill the buffers
+
+    auto const start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame != frames; ++frame)
+    {
+        if (auto const damage = scene.next_frame(frame))
+            renderer.set_frame_damage(*damage);
+        renderer.render(scene.renderables);
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+}
+
+void report(std::string const& renderer, std::string const& scene, std::chrono::nanoseconds duration, int frames)
+{
+    std::cout << std::setw(24) << std::left << scene
+              << std::setw(12) << renderer
+              << std::setw(10) << std::right << std::fixed << std::setprecision(2)
+              << duration.count() / frames / 1e6 << "ms per frame" << std::endl;
+}
+
+auto make_scenes() -> std::vector<Scene>
+{
+    std::vector<Scene> scenes;
+
+    {
+        // A fullscreen video or game
+        auto const window = std::make_shared<Window>(screen, mir_pixel_format_xrgb_8888, 0xff3060a0);
+        scenes.push_back({
+            "fullscreen client",
+            {window->renderable},
+            [window](int) -> std::experimental::optional<geom::Rectangles>
+            {
+                window->next_frame();
+                return geom::Rectangles{screen};
+            }});
+    }
+
+    // A wallpaper, overlapping translucent windows and a cursor
+    auto const wallpaper = std::make_shared<Window>(screen, mir_pixel_format_xrgb_8888, 0xff204060);
+    std::vector<std::shared_ptr<Window>> windows;
+    for (int i = 0; i != 6; ++i)
+    {
+        geom::Rectangle const position{{100 + 180 * i, 80 + 90 * i}, {640, 480}};
+        windows.push_back(std::make_shared<Window>(position, mir_pixel_format_argb_8888, 0xe0a0a0a0));
+    }
+    auto const cursor = std::make_shared<Window>(
+        geom::Rectangle{{960, 540}, {24, 24}}, mir_pixel_format_argb_8888, 0xff000000);
+
+    mg::RenderableList desktop{wallpaper->renderable};
+    for (auto const& window : windows)
+        desktop.push_back(window->renderable);
+    desktop.push_back(cursor->renderable);
+
+    scenes.push_back({
+        "desktop, one redrawing",
+        desktop,
+        [window = windows.back()](int) -> std::experimental::optional<geom::Rectangles>
+        {
+            window->next_frame();
+            return geom::Rectangles{window->renderable->screen_position()};
+        }});
+
+    scenes.push_back({
+        "desktop, cursor moving",
+        desktop,
+        [cursor](int frame) -> std::experimental::optional<geom::Rectangles>
+        {
+            auto const before = cursor->renderable->screen_position();
+            auto after = before;
+            after.top_left = {100 + (frame * 7) % 1600, 100 + (frame * 3) % 800};
+            cursor->renderable->set_screen_position(after);
+            return geom::Rectangles{before, after};
+        }});
+
+    scenes.push_back({
+        "desktop, full repaint",
+        desktop,
+        [](int) -> std::experimental::optional<geom::Rectangles> { return {}; }});
+
+    return scenes;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <frames per scene>"<<std::endl;
+        exit(1);
+    }
+
+    int const frames = std::atoi(argv[1]);
+    auto const scenes = make_scenes();
+
+    {
+        mtd::StubSWDisplayBuffer display_buffer{screen};
+        mrs::Renderer renderer{display_buffer};
+        for (auto const& scene : scenes)
+            report("software", scene.name, time_frames(renderer, scene, frames), frames);
+    }
+
+    PbufferDisplayBuffer display_buffer{screen};
+    if (!display_buffer.usable())
+    {
+        std::cout << "No EGL pbuffer available; skipping the GL renderer" << std::endl;
+        exit(0);
+    }
+
+    display_buffer.make_current();
+    std::cout << "GL renderer: " << display_buffer.renderer_name() << std::endl;
+    {
+        mrg::Renderer renderer{display_buffer};
+        for (auto const& scene : scenes)
+            report("gl", scene.name, time_frames(renderer, scene, frames), frames);
+    }
+    display_buffer.release_current();
+
+    exit(0);
+}
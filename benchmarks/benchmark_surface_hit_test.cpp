@@ -0,0 +1,125 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+
+namespace ms = mir::scene;
+namespace mi = mir::input;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+geom::Rectangle const wall{{0, 0}, {7680, 4320}};
+
+/// Adds \a surfaces randomly placed windows to the stack
+void populate(ms::SurfaceStack& stack, int surfaces, std::mt19937& random)
+{
+    std::uniform_int_distribution<int> x{0, wall.size.width.as_int() - 1};
+    std::uniform_int_distribution<int> y{0, wall.size.height.as_int() - 1};
+    std::uniform_int_distribution<int> width{100, 1920};
+    std::uniform_int_distribution<int> height{100, 1080};
+
+    for (int i = 0; i != surfaces; ++i)
+    {
+        auto const surface = std::make_shared<ms::BasicSurface>(
+            nullptr,
+            "benchmark",
+            geom::Rectangle{{x(random), y(random)}, {width(random), height(random)}},
+            mir_pointer_unconfined,
+            std::list<ms::StreamInfo>{{std::make_shared<mtd::StubBufferStream>(), {}, {}}},
+            nullptr,
+            mir::report::null_scene_report());
+
+        stack.add_surface(surface, mi::InputReceptionMode::normal);
+    }
+}
+
+/// Finds the topmost surface the way input dispatch used to: by visiting every surface
+auto surface_at_by_walking(ms::SurfaceStack& stack, geom::Point point) -> std::shared_ptr<mi::Surface>
+{
+    std::shared_ptr<mi::Surface> top;
+    stack.for_each([&](std::shared_ptr<mi::Surface> const& surface)
+        {
+            if (surface->input_area_contains(point))
+                top = surface;
+        });
+    return top;
+}
+
+template<typename HitTest>
+auto time_hit_tests(std::vector<geom::Point> const& points, HitTest hit_test) -> std::chrono::nanoseconds
+{
+    int hits{0};
+
+    auto const start = std::chrono::steady_clock::now();
+    for (auto const& point : points)
+    {
+        if (hit_test(point))
+            ++hits;
+    }
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    // Make use of the result, so the compiler can't discard the work
+    if (hits < 0)
+        std::cout << hits;
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <hit-tests per scene size>"<<std::endl;
+        exit(1);
+    }
+
+    int const hit_tests = std::atoi(argv[1]);
+    std::mt19937 random{1234};
+
+    std::uniform_int_distribution<int> x{0, wall.size.width.as_int() - 1};
+    std::uniform_int_distribution<int> y{0, wall.size.height.as_int() - 1};
+    std::vector<geom::Point> points;
+    for (int i = 0; i != hit_tests; ++i)
+        points.push_back({x(random), y(random)});
+
+    for (auto const surfaces : {10, 100, 1000})
+    {
+        ms::SurfaceStack stack{mir::report::null_scene_report()};
+        populate(stack, surfaces, random);
+
+        auto const indexed = time_hit_tests(points, [&](geom::Point point) { return stack.surface_at(point); });
+        auto const walked = time_hit_tests(points, [&](geom::Point point) { return surface_at_by_walking(stack, point); });
+
+        std::cout << std::setw(5) << surfaces << " surfaces: "
+                  << indexed.count() / hit_tests << "ns per indexed hit-test, "
+                  << walked.count() / hit_tests << "ns per hit-test visiting every surface" << std::endl;
+    }
+
+    exit(0);
+}
@@ -0,0 +1,234 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wlshmbuffer.h"
+
+#include "mir/anonymous_shm_file.h"
+#include "mir/executor.h"
+
+#include <wayland-server-core.h>
+#include <wayland-client.h>
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <system_error>
+#include <poll.h>
+#include <sys/socket.h>
+
+namespace mf = mir::frontend;
+
+namespace
+{
+/// Runs work immediately; everything in this benchmark happens on one thread
+class InlineExecutor : public mir::Executor
+{
+public:
+    void spawn(std::function<void()>&& work) override
+    {
+        work();
+    }
+};
+
+/// A Wayland server and a client of it, connected by a socketpair and pumped by hand
+class Connection
+{
+public:
+    Connection()
+        : server{wl_display_create()}
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+        {
+            throw std::system_error{errno, std::system_category(), "Failed to create socketpair"};
+        }
+
+        wl_display_init_shm(server);
+        server_client = wl_client_create(server, fds[0]);
+        client = wl_display_connect_to_fd(fds[1]);
+
+        auto const registry = wl_display_get_registry(client);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        roundtrip();
+        wl_registry_destroy(registry);
+
+        if (!shm)
+        {
+            throw std::runtime_error{"Server did not advertise wl_shm"};
+        }
+    }
+
+    ~Connection()
+    {
+        wl_shm_destroy(shm);
+        wl_display_disconnect(client);
+        wl_display_destroy(server);
+    }
+
+    /// Creates a client buffer backed by its own pool, returning the server's resource for it
+    wl_resource* create_buffer(mir::AnonymousShmFile& file, int width, int height)
+    {
+        auto const stride = width * 4;
+        auto const pool = wl_shm_create_pool(shm, file.fd(), stride * height);
+        auto const buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_ARGB8888);
+        wl_shm_pool_destroy(pool);
+        roundtrip();
+
+        return wl_client_get_object(server_client, wl_proxy_get_id(reinterpret_cast<wl_proxy*>(buffer)));
+    }
+
+    /// Delivers queued server events (such as wl_buffer.release) so the socket never fills
+    void pump()
+    {
+        wl_display_flush(client);
+        wl_event_loop_dispatch(wl_display_get_event_loop(server), 0);
+        wl_display_flush_clients(server);
+
+        while (wl_display_prepare_read(client) != 0)
+        {
+            wl_display_dispatch_pending(client);
+        }
+
+        pollfd readable{wl_display_get_fd(client), POLLIN, 0};
+        if (poll(&readable, 1, 0) > 0)
+        {
+            wl_display_read_events(client);
+        }
+        else
+        {
+            wl_display_cancel_read(client);
+        }
+        wl_display_dispatch_pending(client);
+    }
+
+private:
+    void roundtrip()
+    {
+        bool done{false};
+        auto const callback = wl_display_sync(client);
+        wl_callback_add_listener(callback, &sync_listener, &done);
+
+        while (!done)
+        {
+            pump();
+        }
+        wl_callback_destroy(callback);
+    }
+
+    static void global(void* data, wl_registry* registry, uint32_t name, char const* interface, uint32_t)
+    {
+        auto const self = static_cast<Connection*>(data);
+        if (strcmp(interface, wl_shm_interface.name) == 0)
+        {
+            self->shm = static_cast<wl_shm*>(wl_registry_bind(registry, name, &wl_shm_interface, 1));
+        }
+    }
+
+    static void global_remove(void*, wl_registry*, uint32_t)
+    {
+    }
+
+    static void sync_done(void* data, wl_callback*, uint32_t)
+    {
+        *static_cast<bool*>(data) = true;
+    }
+
+    static constexpr wl_registry_listener registry_listener{&global, &global_remove};
+    static constexpr wl_callback_listener sync_listener{&sync_done};
+
+    wl_display* const server;
+    wl_client* server_client;
+    wl_display* client;
+    wl_shm* shm{nullptr};
+};
+
+constexpr wl_registry_listener Connection::registry_listener;
+constexpr wl_callback_listener Connection::sync_listener;
+
+/// Commits the same client buffer \a commits times, sampling it once per commit as the compositor would
+std::chrono::nanoseconds time_commits(
+    Connection& connection,
+    wl_resource* buffer,
+    mf::WlShmBuffer::Access access,
+    int commits)
+{
+    auto const executor = std::make_shared<InlineExecutor>();
+    volatile unsigned char sample;
+
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != commits; ++i)
+    {
+        auto mir_buffer = mf::WlShmBuffer::mir_buffer_from_wl_buffer(buffer, executor, []{}, access);
+
+        auto const pixels = dynamic_cast<mir::renderer::software::PixelSource*>(mir_buffer->native_buffer_base());
+        pixels->read([&sample](unsigned char const* data) { sample = data[0]; });
+
+        mir_buffer.reset();     // Releases the buffer back to the client
+        connection.pump();
+    }
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <commits per configuration>"<<std::endl;
+        exit(1);
+    }
+
+    int const commits = std::atoi(argv[1]);
+
+    struct
+    {
+        char const* name;
+        int width;
+        int height;
+    } const resolutions[] = {{"1080p", 1920, 1080}, {"4K", 3840, 2160}};
+
+    struct
+    {
+        char const* name;
+        mf::WlShmBuffer::Access access;
+    } const modes[] = {{"copy", mf::WlShmBuffer::Access::copy}, {"zero-copy", mf::WlShmBuffer::Access::zero_copy}};
+
+    Connection connection;
+
+    for (auto const& resolution : resolutions)
+    {
+        mir::AnonymousShmFile file{static_cast<size_t>(resolution.width * resolution.height * 4)};
+        memset(file.base_ptr(), 0x55, resolution.width * resolution.height * 4);
+        auto const buffer = connection.create_buffer(file, resolution.width, resolution.height);
+
+        for (auto const& mode : modes)
+        {
+            auto const duration = time_commits(connection, buffer, mode.access, commits);
+            auto const per_commit = duration.count() / commits;
+
+            std::cout << std::setw(6) << resolution.name << std::setw(10) << mode.name << ": "
+                      << commits << " commits took " << duration.count() << "ns ("
+                      << per_commit << "ns per commit, "
+                      << (per_commit ? 1000000000 / per_commit : 0) << " commits/s)" << std::endl;
+        }
+    }
+
+    exit(0);
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/thread/work_queue.h"
+
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mth = mir::thread;
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+/// How WaylandExecutor queued work before: a locked deque, notifying on every spawn
+class LockedQueue
+{
+public:
+    bool push(std::function<void()>&& work)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        queue.push_back(std::move(work));
+        return true;
+    }
+
+    void start_draining()
+    {
+    }
+
+    std::function<void()> pop()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (queue.empty())
+            return {};
+        auto work = std::move(queue.front());
+        queue.pop_front();
+        return work;
+    }
+
+private:
+    std::mutex mutex;
+    std::deque<std::function<void()>> queue;
+};
+
+/// Runs work on a thread woken through an eventfd, as the Wayland event loop does
+template<typename Queue>
+class Executor
+{
+public:
+    Executor()
+        : notify_fd{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)},
+          consumer{[this] { run(); }}
+    {
+    }
+
+    ~Executor()
+    {
+        stopping = true;
+        eventfd_write(notify_fd, 1);
+        consumer.join();
+        close(notify_fd);
+    }
+
+    void spawn(std::function<void()>&& work)
+    {
+        if (queue.push(std::move(work)))
+        {
+            eventfd_write(notify_fd, 1);
+            ++notifications;
+        }
+    }
+
+    std::atomic<long> notifications{0};
+
+private:
+    void run()
+    {
+        pollfd fd{notify_fd, POLLIN, 0};
+        while (!stopping)
+        {
+            poll(&fd, 1, -1);
+
+            eventfd_t unused;
+            eventfd_read(notify_fd, &unused);
+
+            queue.start_draining();
+            while (auto work = queue.pop())
+                work();
+        }
+    }
+
+    Queue queue;
+    int const notify_fd;
+    std::atomic<bool> stopping{false};
+    std::thread consumer;
+};
+
+template<typename Queue>
+void benchmark(char const* name, char const* scenario, int producers, int tasks_per_producer, bool paced)
+{
+    int const total = producers * tasks_per_producer;
+    std::vector<Clock::duration> latencies(total);
+
+    Executor<Queue> executor;
+
+    auto const start = Clock::now();
+    {
+        std::vector<std::thread> threads;
+        for (int p = 0; p != producers; ++p)
+        {
+            threads.emplace_back([&, p]
+                {
+                    std::atomic<int> ran{0};
+                    for (int i = 0; i != tasks_per_producer; ++i)
+                    {
+                        auto const slot = p * tasks_per_producer + i;
+                        auto const spawned = Clock::now();
+                        executor.spawn([&latencies, &ran, slot, spawned]
+                            {
+                                latencies[slot] = Clock::now() - spawned;
+                                ran.fetch_add(1, std::memory_order_release);
+                            });
+
+                        // Wait for each task to run before spawning the next
+                        while (paced && ran.load(std::memory_order_acquire) != i + 1)
+                            std::this_thread::yield();
+                    }
+                    while (ran.load(std::memory_order_acquire) != tasks_per_producer)
+                        std::this_thread::yield();
+                });
+        }
+        for (auto& thread : threads)
+            thread.join();
+    }
+    auto const elapsed = Clock::now() - start;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto const us = [](Clock::duration d)
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() / 1000.0;
+        };
+
+    std::cout << std::setw(10) << std::left << name
+              << std::setw(8) << scenario
+              << std::setw(3) << std::right << producers << " producers"
+              << std::fixed << std::setprecision(2)
+              << std::setw(10) << us(elapsed) / total << "us/task"
+              << std::setw(10) << us(latencies[total / 2]) << "us p50"
+              << std::setw(10) << us(latencies[total * 99 / 100]) << "us p99"
+              << std::setw(10) << executor.notifications.load() << " wakeups" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cout<<"Usage: "<<argv[0]<<" <tasks per producer>"<<std::endl;
+        exit(1);
+    }
+
+    int const tasks = std::atoi(argv[1]);
+
+    for (auto producers : {1, 4, 16})
+    {
+        // Spawn as fast as possible: the cost of spawning and of waking the consumer
+        benchmark<LockedQueue>("locked", "flood", producers, tasks, false);
+        benchmark<mth::WorkQueue>("lock-free", "flood", producers, tasks, false);
+
+        // Spawn one task at a time from each producer: the latency from spawn to execution
+        benchmark<LockedQueue>("locked", "paced", producers, tasks, true);
+        benchmark<mth::WorkQueue>("lock-free", "paced", producers, tasks, true);
+    }
+
+    exit(0);
+}
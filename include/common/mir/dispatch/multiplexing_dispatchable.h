@@ -22,6 +22,8 @@
 #include "mir/dispatch/dispatchable.h"
 #include "mir/posix_rw_mutex.h"
 
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <initializer_list>
 #include <list>
@@ -29,6 +31,8 @@
 
 #include <pthread.h>
 
+struct epoll_event;
+
 namespace mir
 {
 namespace dispatch
@@ -94,9 +98,30 @@ public:
      * \param [in] fd   File descriptor of watch to remove.
      */
     void remove_watch(Fd const& fd);
+
+    /**
+     * \brief Set how many ready dispatchees a single dispatch() may handle
+     *
+     * By default each call to dispatch() handles a single ready dispatchee. Raising
+     * this lets a busy adaptor drain several with one wakeup; dispatchees are still
+     * run one after another on the dispatching thread and sequential dispatchees are
+     * still never dispatched concurrently.
+     *
+     * \param [in] count   Maximum dispatchees per dispatch(), clamped to [1, max_batch_size]
+     */
+    void set_max_events_per_dispatch(int count);
+
+    static int const max_batch_size = 64;
 private:
+    using Holder = std::list<std::pair<std::shared_ptr<Dispatchable>, bool>>;
+
+    bool is_watched(std::shared_ptr<Dispatchable> const& dispatchee);
+    void rearm(std::shared_ptr<Dispatchable> const& dispatchee, epoll_event& event);
+
     PosixRWMutex lifetime_mutex;
-    std::list<std::pair<std::shared_ptr<Dispatchable>, bool>> dispatchee_holder;
+    Holder dispatchee_holder;
+    std::atomic<int> max_events{1};
+    std::atomic<uint64_t> removal_generation{0};
 
     Fd epoll_fd;
 };
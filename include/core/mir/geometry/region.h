@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GEOMETRY_REGION_H_
+#define MIR_GEOMETRY_REGION_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <vector>
+#include <initializer_list>
+#include <iosfwd>
+
+namespace mir
+{
+namespace geometry
+{
+
+/**
+ * A set of points, supporting union, intersection and subtraction.
+ *
+ * The region is stored as non-overlapping rectangles in "y-x banded" form
+ * (as in pixman and X11): rectangles are sorted top-to-bottom then
+ * left-to-right, rectangles sharing any rows share the same top and bottom,
+ * and vertically adjacent bands with identical spans are merged. So the
+ * representation of a given set of points is unique, and equal regions
+ * compare equal.
+ */
+class Region
+{
+public:
+    Region() = default;
+    Region(Rectangle const& rect);
+    /// The union of the rectangles, which may overlap
+    Region(std::initializer_list<Rectangle> const& rects);
+
+    bool is_empty() const;
+    Rectangle bounding_rectangle() const;
+
+    /// True if every point of rect is in the region (trivially true for an empty rect)
+    bool contains(Rectangle const& rect) const;
+    bool overlaps(Rectangle const& rect) const;
+
+    void add(Region const& other);
+    void subtract(Region const& other);
+    void intersect(Region const& other);
+
+    Region intersection_with(Rectangle const& rect) const;
+
+    typedef std::vector<Rectangle>::const_iterator const_iterator;
+    typedef std::vector<Rectangle>::size_type size_type;
+    const_iterator begin() const;
+    const_iterator end() const;
+    size_type size() const;
+
+    bool operator==(Region const& other) const;
+    bool operator!=(Region const& other) const;
+
+private:
+    std::vector<Rectangle> rectangles;
+};
+
+std::ostream& operator<<(std::ostream& out, Region const& value);
+}
+}
+
+#endif /* MIR_GEOMETRY_REGION_H_ */
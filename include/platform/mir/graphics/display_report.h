@@ -43,6 +43,9 @@ public:
     virtual void report_drm_master_failure(int error) = 0;
     virtual void report_vt_switch_away_failure() = 0;
     virtual void report_vt_switch_back_failure() = 0;
+    /* A framebuffer for a scanout buffer was (or wasn't) already registered with KMS */
+    virtual void report_framebuffer_cache_hit(unsigned int output_id) = 0;
+    virtual void report_framebuffer_cache_miss(unsigned int output_id) = 0;
 
 protected:
     DisplayReport() = default;
@@ -21,6 +21,7 @@
 
 #include <experimental/optional>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
 #include <glm/glm.hpp>
 #include <memory>
 #include <vector>
@@ -50,8 +51,26 @@ public:
     virtual std::shared_ptr<Buffer> buffer() const = 0;
 
     virtual geometry::Rectangle screen_position() const = 0;
+
+    /**
+     * The region of buffer() (in buffer coordinates) that is scaled to fill
+     * screen_position(). Without cropping or scaling this is the top-left
+     * of the buffer at the size of screen_position().
+     */
+    virtual geometry::Rectangle src_bounds() const = 0;
+
     virtual std::experimental::optional<geometry::Rectangle> clip_area() const = 0;
 
+    /**
+     * The region (in screen coordinates) whose content has changed since
+     * this renderable was last composited by the same compositor.
+     *
+     * Changes to the position, stacking or other properties of the
+     * renderable are not included; only changes to the buffer content.
+     * Calling this may acquire the buffer in the same way as buffer().
+     */
+    virtual geometry::Rectangles damage() const = 0;
+
     // These are from the old CompositingCriteria. There is a little bit
     // of function overlap with the above functions still.
     virtual float alpha() const = 0;
@@ -72,6 +91,15 @@ public:
 
     virtual bool shaped() const = 0;  // meaning the pixel format has alpha
 
+    /**
+     * The region (in screen coordinates) that the client has declared to be
+     * opaque, even though the pixel format has alpha (see shaped()).
+     *
+     * The alpha channel of the buffer may be ignored within this region.
+     * Plane alpha (see alpha()) still applies.
+     */
+    virtual geometry::Rectangles opaque_region() const = 0;
+
     virtual unsigned int swap_interval() const = 0;
 protected:
     Renderable() = default;
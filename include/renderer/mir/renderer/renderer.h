@@ -20,6 +20,7 @@
 #define MIR_RENDERER_RENDERER_H_
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/graphics/renderable.h"
 #include "mir_toolkit/common.h"
 #include <glm/glm.hpp>
@@ -36,6 +37,14 @@ public:
 
     virtual void set_viewport(geometry::Rectangle const& rect) = 0;
     virtual void set_output_transform(glm::mat2 const&) = 0;
+
+    /**
+     * Limit the next render() to the region (in screen coordinates) that has
+     * changed since the previous frame. The renderer remains responsible for
+     * repairing any other part of its target that is out of date.
+     * If this is not called before render() everything is redrawn.
+     */
+    virtual void set_frame_damage(geometry::Rectangles const& damage) = 0;
     virtual void render(graphics::RenderableList const&) const = 0;
     virtual void suspend() = 0; // called when render() is skipped
 
@@ -0,0 +1,53 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_BUFFER_AGE_SOURCE_H_
+#define MIR_RENDERER_GL_BUFFER_AGE_SOURCE_H_
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+
+/**
+ * Optionally implemented by a RenderTarget that knows how old the contents
+ * of its back buffer are without asking EGL (e.g. a single FBO).
+ */
+class BufferAgeSource
+{
+public:
+    virtual ~BufferAgeSource() = default;
+
+    /**
+     * The number of swaps since the current back buffer was last drawn to,
+     * with the semantics of EGL_EXT_buffer_age: 0 means the contents are
+     * undefined, 1 means they are those of the previous frame.
+     */
+    virtual unsigned int buffer_age() const = 0;
+
+protected:
+    BufferAgeSource() = default;
+    BufferAgeSource(BufferAgeSource const&) = delete;
+    BufferAgeSource& operator=(BufferAgeSource const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_GL_BUFFER_AGE_SOURCE_H_ */
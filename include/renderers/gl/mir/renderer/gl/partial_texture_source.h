@@ -0,0 +1,55 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_GL_PARTIAL_TEXTURE_SOURCE_H_
+#define MIR_RENDERER_GL_PARTIAL_TEXTURE_SOURCE_H_
+
+#include "mir/geometry/rectangles.h"
+
+namespace mir
+{
+namespace renderer
+{
+namespace gl
+{
+
+/**
+ * Optionally implemented by a TextureSource whose pixels are uploaded by
+ * copying (e.g. SHM buffers), allowing a texture that already holds an
+ * earlier buffer of the same size and format to be updated in place.
+ */
+class PartialTextureSource
+{
+public:
+    virtual ~PartialTextureSource() = default;
+
+    /**
+     * Uploads only the \a damage (in buffer coordinates) into the currently
+     * bound texture; everything else is assumed to be up to date.
+     */
+    virtual void bind_damaged(geometry::Rectangles const& damage) = 0;
+
+protected:
+    PartialTextureSource() = default;
+    PartialTextureSource(PartialTextureSource const&) = delete;
+    PartialTextureSource& operator=(PartialTextureSource const&) = delete;
+};
+
+}
+}
+}
+
+#endif /* MIR_RENDERER_GL_PARTIAL_TEXTURE_SOURCE_H_ */
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_RENDERER_SW_PIXEL_KERNELS_H_
+#define MIR_RENDERER_SW_PIXEL_KERNELS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+/// Inner loops for drawing into 32 bit per pixel software buffers
+///
+/// Pixels are native-endian 32 bit words with alpha in the top byte. Every implementation produces
+/// exactly the same output as the scalar reference, so which one is picked can never be observed
+/// in the rendered result. Destination and source may be unaligned.
+struct PixelKernels
+{
+    char const* name;
+
+    /// Sets \a count pixels to \a color
+    void (*fill)(uint32_t* dest, uint32_t color, size_t count);
+
+    /// Blends \a color over \a count pixels using the 8 bit coverage values in \a mask
+    ///
+    /// Coverage is scaled by the alpha of \a color, then the three color channels are blended with
+    /// truncating integer arithmetic. The alpha channel of \a dest is left untouched.
+    void (*blend_a8)(uint32_t* dest, uint8_t const* mask, uint32_t color, size_t count);
+
+    /// Converts \a count straight alpha pixels from \a src to premultiplied alpha in \a dest
+    ///
+    /// Channels are rounded to the nearest value. \a dest may be the same as \a src.
+    void (*premultiply)(uint32_t* dest, uint32_t const* src, size_t count);
+
+    /// Exchanges the red and blue channels, converting between ARGB and ABGR
+    ///
+    /// \a dest may be the same as \a src.
+    void (*swap_red_blue)(uint32_t* dest, uint32_t const* src, size_t count);
+
+    /// Composites \a count premultiplied alpha pixels from \a src over \a dest
+    ///
+    /// Every channel of \a src, including alpha, is first scaled by \a alpha. Channels are rounded to
+    /// the nearest value and the sum saturates, so invalid premultiplied pixels can't wrap around.
+    void (*over)(uint32_t* dest, uint32_t const* src, uint8_t alpha, size_t count);
+
+    /// Resamples a row with nearest neighbour sampling: dest[i] = src[(x + i * step) >> 16]
+    ///
+    /// \a x and \a step are 16.16 fixed point, and the position wraps around like any uint32_t.
+    void (*scale_nearest)(uint32_t* dest, uint32_t const* src, uint32_t x, uint32_t step, size_t count);
+};
+
+/// The fastest kernels the CPU we're running on supports
+auto pixel_kernels() -> PixelKernels const&;
+
+/// All kernels the CPU we're running on supports, starting with the scalar reference
+auto available_pixel_kernels() -> std::vector<PixelKernels const*>;
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_PIXEL_KERNELS_H_
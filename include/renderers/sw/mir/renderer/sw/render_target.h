@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MIR_RENDERER_SW_RENDER_TARGET_H_
+#define MIR_RENDERER_SW_RENDER_TARGET_H_
+
+#include "mir/geometry/size.h"
+#include "mir/geometry/dimensions.h"
+
+#include <stdint.h>
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+
+/// A CPU mapped output, such as a KMS dumb buffer or an offscreen buffer, for software rendering
+///
+/// DisplayBuffers that can be drawn to this way return one from native_display_buffer().
+class RenderTarget
+{
+public:
+    virtual ~RenderTarget() = default;
+
+    struct Pixels
+    {
+        /// Native-endian 32 bit words with the (ignored) alpha in the top byte
+        uint32_t* data;
+        /// Distance between the starts of consecutive rows in bytes
+        geometry::Stride stride;
+    };
+
+    /** Size of the buffers in pixels */
+    virtual auto size() const -> geometry::Size = 0;
+    /** The buffer to draw the next frame into, valid until swap_buffers() */
+    virtual auto back_buffer() -> Pixels = 0;
+    /**
+     * The number of frames since the back buffer was last presented, as per
+     * EGL_EXT_buffer_age; 0 if it is new or its contents are undefined.
+     */
+    virtual auto buffer_age() const -> unsigned int = 0;
+    /** Presents the back buffer */
+    virtual void swap_buffers() = 0;
+
+protected:
+    RenderTarget() = default;
+    RenderTarget(RenderTarget const&) = delete;
+    RenderTarget& operator=(RenderTarget const&) = delete;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_RENDER_TARGET_H_
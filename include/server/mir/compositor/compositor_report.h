@@ -20,6 +20,7 @@
 #define MIR_COMPOSITOR_COMPOSITOR_REPORT_H_
 
 #include "mir/graphics/renderable.h"
+#include "mir/geometry/rectangles.h"
 
 namespace mir
 {
@@ -33,6 +34,7 @@ public:
     virtual void added_display(int width, int height, int x, int y, SubCompositorId id) = 0;
     virtual void began_frame(SubCompositorId id) = 0;
     virtual void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) = 0;
+    virtual void damage_in_frame(SubCompositorId id, geometry::Rectangles const& damage) = 0;
     virtual void rendered_frame(SubCompositorId id) = 0;
     virtual void finished_frame(SubCompositorId id) = 0;
     virtual void started() = 0;
@@ -0,0 +1,74 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_FRAME_STATISTICS_H_
+#define MIR_COMPOSITOR_FRAME_STATISTICS_H_
+
+#include "mir/compositor/compositor_report.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/// Summary of a distribution of frame timings
+struct FrameTimePercentiles
+{
+    std::chrono::nanoseconds p50{0};
+    std::chrono::nanoseconds p90{0};
+    std::chrono::nanoseconds p99{0};
+    std::chrono::nanoseconds max{0};
+    uint64_t samples{0};
+};
+
+struct DisplayFrameStatistics
+{
+    CompositorReport::SubCompositorId id;
+
+    /// From the start of a frame until it has been rendered (bypassed frames are not counted)
+    FrameTimePercentiles render_time;
+    /// From the scene snapshot until the frame is handed over to be posted
+    FrameTimePercentiles snapshot_to_post;
+    /// Between successive frames
+    FrameTimePercentiles frame_interval;
+};
+
+/**
+ * Frame timing distributions gathered by the compositor report.
+ *
+ * Querying doesn't interrupt compositing, so may be done from any thread at any time.
+ */
+class FrameStatistics
+{
+public:
+    /// Distributions for each display since it was added (including those composited before a restart)
+    virtual auto per_display() const -> std::vector<DisplayFrameStatistics> = 0;
+
+protected:
+    FrameStatistics() = default;
+    virtual ~FrameStatistics() = default;
+    FrameStatistics(FrameStatistics const&) = delete;
+    FrameStatistics& operator=(FrameStatistics const&) = delete;
+};
+
+}
+}
+
+#endif // MIR_COMPOSITOR_FRAME_STATISTICS_H_
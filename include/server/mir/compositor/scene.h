@@ -59,6 +59,15 @@ public:
      */
     virtual SceneElementSequence scene_elements_for(CompositorID id) = 0;
 
+    /**
+     * As scene_elements_for(), but replacing the contents of elements so that a
+     * caller compositing frame after frame can reuse its storage.
+     */
+    virtual void fill_scene_elements(CompositorID id, SceneElementSequence& elements)
+    {
+        elements = scene_elements_for(id);
+    }
+
     /**
      * Return the number of additional frames that you need to render to get
      * fully up to date with the latest data in the scene. For a generic
@@ -41,6 +41,10 @@ struct StreamInfo
     std::shared_ptr<compositor::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    /// Relative to the stream's top-left; only meaningful for formats with alpha
+    std::vector<geometry::Rectangle> opaque_region;
+    /// The part of the stream's buffers scaled to size; if unset they are not cropped or scaled
+    optional_value<geometry::Rectangle> src_bounds;
 };
 
 class SurfaceObserver;
@@ -65,6 +69,8 @@ public:
     virtual geometry::Size window_size() const = 0;
 
     virtual graphics::RenderableList generate_renderables(compositor::CompositorID id) const = 0; 
+    /// Appends what generate_renderables() would return to list, reusing its storage
+    virtual void append_renderables(compositor::CompositorID id, graphics::RenderableList& list) const = 0;
     virtual int buffers_ready_for_compositor(void const* compositor_id) const = 0;
 
     virtual MirWindowType type() const = 0;
@@ -79,7 +85,8 @@ public:
      * Sets the input region for this surface.
      *
      * The input region is expressed in coordinates relative to the surface (i.e.,
-     * use (0,0) for the top left point of the surface).
+     * use (0,0) for the top left point of the surface), and is clipped to the
+     * surface.
      *
      * By default the input region is the whole surface. To unset a custom input region
      * and revert to the default set an empty input region, i.e., set_input_region({}).
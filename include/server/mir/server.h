@@ -34,7 +34,7 @@ namespace mir
 template<class Observer>
 class ObserverRegistrar;
 
-namespace compositor { class Compositor; class DisplayBufferCompositorFactory; class CompositorReport; }
+namespace compositor { class Compositor; class DisplayBufferCompositorFactory; class CompositorReport; class FrameStatistics; }
 namespace graphics { class Cursor; class Platform; class Display; class GLConfig; class DisplayConfigurationPolicy; class DisplayConfigurationObserver; }
 namespace input { class CompositeEventFilter; class InputDispatcher; class CursorListener; class CursorImages; class TouchVisualizer; class InputDeviceHub;}
 namespace logging { class Logger; }
@@ -351,6 +351,10 @@ public:
     /// \return the compositor report.
     auto the_compositor_report() const -> std::shared_ptr<compositor::CompositorReport>;
 
+    /// \return frame timing statistics per display.
+    /// These are gathered by the logging compositor report (--compositor-report=log).
+    auto the_frame_statistics() const -> std::shared_ptr<compositor::FrameStatistics>;
+
     /// \return the composite event filter.
     auto the_composite_event_filter() const -> std::shared_ptr<input::CompositeEventFilter>;
 
@@ -50,6 +50,10 @@ struct StreamSpecification
     std::weak_ptr<frontend::BufferStream> stream;
     geometry::Displacement displacement;
     optional_value<geometry::Size> size;
+    /// Relative to the stream's top-left; only meaningful for formats with alpha
+    std::vector<geometry::Rectangle> opaque_region;
+    /// The part of the stream's buffers scaled to size; if unset they are not cropped or scaled
+    optional_value<geometry::Rectangle> src_bounds;
 };
 auto operator==(StreamSpecification const& lhs, StreamSpecification const& rhs) -> bool;
 
@@ -50,6 +50,7 @@ struct StubSurface : scene::Surface
     void set_transformation(glm::mat4 const&) override {}
     bool visible() const override { return false; }
     graphics::RenderableList generate_renderables(compositor::CompositorID) const override { return {}; }
+    void append_renderables(compositor::CompositorID, graphics::RenderableList&) const override {}
     int buffers_ready_for_compositor(void const*) const override { return 0; }
     MirWindowType type() const override { return mir_window_type_normal; }
     MirWindowState state() const override { return mir_window_state_fullscreen; }
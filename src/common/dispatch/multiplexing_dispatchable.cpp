@@ -31,6 +31,7 @@
 #include <string.h>
 #include <system_error>
 #include <algorithm>
+#include <array>
 
 namespace md = mir::dispatch;
 
@@ -108,48 +109,104 @@ bool md::MultiplexingDispatchable::dispatch(md::FdEvents events)
         return false;
     }
 
-    std::shared_ptr<md::Dispatchable> source;
-    bool rearm_source{false};
-    epoll_event event;
+    std::array<std::shared_ptr<md::Dispatchable>, max_batch_size> sources;
+    std::array<bool, max_batch_size> rearm_source;
+    std::array<epoll_event, max_batch_size> ready;
+    int ready_count{0};
+    uint64_t generation;
 
     {
         std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
 
-        auto result = epoll_wait(epoll_fd, &event, 1, 0);
+        generation = removal_generation.load();
+        ready_count = epoll_wait(epoll_fd, ready.data(), max_events.load(), 0);
 
-        if (result < 0)
+        if (ready_count < 0)
         {
             BOOST_THROW_EXCEPTION((std::system_error{errno,
                                                      std::system_category(),
                                                      "Failed to wait on fds"}));
         }
 
-        if (result == 0)
+        if (ready_count == 0)
         {
             // Some other thread must have stolen the event we were woken for;
             // that's ok, just return.
             return true;
         }
 
-        auto event_source = reinterpret_cast<decltype(dispatchee_holder)::pointer>(event.data.ptr);
+        for (int i = 0; i != ready_count; ++i)
+        {
+            auto event_source = reinterpret_cast<Holder::pointer>(ready[i].data.ptr);
 
-        source = event_source->first;
-        rearm_source = event_source->second;
+            sources[i] = event_source->first;
+            rearm_source[i] = event_source->second;
+        }
     }
 
-    if (!source->dispatch(epoll_to_fd_event(event)))
+    int next{0};
+    try
     {
-        remove_watch(source);
+        for (; next != ready_count; ++next)
+        {
+            auto const& source = sources[next];
+
+            // An earlier dispatchee in this batch (or another thread) may have removed this one
+            // since we read the events. Once removed it must not be dispatched or rearmed.
+            auto const current_generation = removal_generation.load();
+            if (current_generation != generation)
+            {
+                generation = current_generation;
+                if (!is_watched(source))
+                    continue;
+            }
+
+            if (!source->dispatch(epoll_to_fd_event(ready[next])))
+            {
+                remove_watch(source);
+            }
+            else if (rearm_source[next])
+            {
+                rearm(source, ready[next]);
+            }
+        }
     }
-    else if (rearm_source)
+    catch (...)
     {
-        event.events = fd_event_to_epoll(source->relevant_events()) | EPOLLONESHOT;
-        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, source->watch_fd(), &event);
+        // Sequential dispatchees we read but haven't yet dispatched are disabled until
+        // rearmed; they're still ready, so rearming leaves them for the next dispatch().
+        while (++next < ready_count)
+        {
+            if (rearm_source[next] && is_watched(sources[next]))
+                rearm(sources[next], ready[next]);
+        }
+        throw;
     }
 
     return true;
 }
 
+void md::MultiplexingDispatchable::set_max_events_per_dispatch(int count)
+{
+    max_events = std::max(1, std::min(count, static_cast<int>(max_batch_size)));
+}
+
+bool md::MultiplexingDispatchable::is_watched(std::shared_ptr<Dispatchable> const& dispatchee)
+{
+    std::shared_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+    return std::any_of(dispatchee_holder.begin(), dispatchee_holder.end(),
+                       [&dispatchee](Holder::value_type const& candidate)
+                       {
+                           return candidate.first == dispatchee;
+                       });
+}
+
+void md::MultiplexingDispatchable::rearm(std::shared_ptr<Dispatchable> const& dispatchee, epoll_event& event)
+{
+    event.events = fd_event_to_epoll(dispatchee->relevant_events()) | EPOLLONESHOT;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, dispatchee->watch_fd(), &event);
+}
+
 md::FdEvents md::MultiplexingDispatchable::relevant_events() const
 {
     return md::FdEvent::readable;
@@ -223,6 +280,7 @@ void md::MultiplexingDispatchable::remove_watch(Fd const& fd)
     }
 
     std::unique_lock<decltype(lifetime_mutex)> lock{lifetime_mutex};
+    ++removal_generation;
     dispatchee_holder.remove_if([&fd](std::pair<std::shared_ptr<Dispatchable>,bool> const& candidate)
     {
         return candidate.first->watch_fd() == fd;
@@ -36,9 +36,142 @@
 
 #include <capnp/serialize.h>
 
+#include <algorithm>
+#include <mutex>
 
 namespace ml = mir::logging;
 
+namespace
+{
+/**
+ * Recycles the storage of destroyed events.
+ *
+ * Each thread keeps a short list of free blocks so the common case needs no locking.
+ * As events are often created on one thread (input) and destroyed on another, lists
+ * that grow too long are handed in batches to a shared list, from which threads that
+ * run dry take their blocks.
+ */
+std::size_t const block_size = sizeof(MirEvent);
+std::size_t const thread_cache_limit = 64;
+std::size_t const batch_size = thread_cache_limit / 2;
+std::size_t const shared_limit = 1024;
+
+struct FreeBlock
+{
+    FreeBlock* next;
+};
+
+struct FreeList
+{
+    FreeBlock* head{nullptr};
+    std::size_t count{0};
+
+    void push(FreeBlock* block)
+    {
+        block->next = head;
+        head = block;
+        ++count;
+    }
+
+    auto pop() -> FreeBlock*
+    {
+        auto const block = head;
+        head = block->next;
+        --count;
+        return block;
+    }
+
+    /// Moves up to n blocks onto to
+    void move_to(FreeList& to, std::size_t n)
+    {
+        while (head && n--)
+            to.push(pop());
+    }
+};
+
+struct SharedFreeList
+{
+    std::mutex mutex;
+    FreeList blocks;
+};
+
+// Deliberately leaked: thread caches may be returned to it during static destruction
+auto shared_blocks() -> SharedFreeList&
+{
+    static auto const shared = new SharedFreeList;
+    return *shared;
+}
+
+void release(FreeList& blocks, std::size_t n)
+{
+    n = std::min(n, blocks.count);
+
+    auto& shared = shared_blocks();
+    {
+        std::lock_guard<std::mutex> lock{shared.mutex};
+        auto const room = shared_limit - std::min(shared_limit, shared.blocks.count);
+        auto const shared_count = std::min(n, room);
+        blocks.move_to(shared.blocks, shared_count);
+        n -= shared_count;
+    }
+
+    while (n--)
+        ::operator delete(blocks.pop());
+}
+
+// Events can outlive the cache of the thread destroying them (in other thread_local
+// objects, say), so the cache marks its passing for them to use the heap directly.
+thread_local bool cache_destroyed{false};
+
+struct ThreadCache
+{
+    ~ThreadCache()
+    {
+        release(blocks, blocks.count);
+        cache_destroyed = true;
+    }
+
+    FreeList blocks;
+};
+
+thread_local ThreadCache cache;
+}
+
+void* MirEvent::operator new(std::size_t size)
+{
+    if (size > block_size || cache_destroyed)
+        return ::operator new(size);
+
+    if (!cache.blocks.head)
+    {
+        auto& shared = shared_blocks();
+        std::lock_guard<std::mutex> lock{shared.mutex};
+        shared.blocks.move_to(cache.blocks, batch_size);
+    }
+
+    if (cache.blocks.head)
+        return cache.blocks.pop();
+
+    return ::operator new(block_size);
+}
+
+void MirEvent::operator delete(void* event, std::size_t size)
+{
+    if (!event)
+        return;
+
+    if (size > block_size || cache_destroyed)
+    {
+        ::operator delete(event);
+        return;
+    }
+
+    cache.blocks.push(static_cast<FreeBlock*>(event));
+
+    if (cache.blocks.count > thread_cache_limit)
+        release(cache.blocks, batch_size);
+}
+
 MirEvent::MirEvent(MirEvent const& e)
 {
     auto reader = e.event.asReader();
@@ -0,0 +1,325 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/geometry/region.h"
+
+#include <algorithm>
+#include <limits>
+#include <ostream>
+
+namespace geom = mir::geometry;
+
+namespace
+{
+enum class Op
+{
+    unite,
+    subtract,
+    intersect
+};
+
+bool inside(Op op, bool in_a, bool in_b)
+{
+    switch (op)
+    {
+    case Op::unite:     return in_a || in_b;
+    case Op::subtract:  return in_a && !in_b;
+    case Op::intersect: return in_a && in_b;
+    }
+    return false;
+}
+
+struct Span
+{
+    int left;
+    int right;
+};
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width.as_int() <= 0 || rect.size.height.as_int() <= 0;
+}
+
+/// Collects the spans of the band of rects covering row y, advancing band past any bands above it
+void spans_at(std::vector<geom::Rectangle> const& rects, size_t& band, int y, std::vector<Span>& spans)
+{
+    spans.clear();
+
+    while (band != rects.size() && rects[band].bottom().as_int() <= y)
+    {
+        auto const top = rects[band].top();
+        while (band != rects.size() && rects[band].top() == top)
+            ++band;
+    }
+
+    if (band == rects.size() || rects[band].top().as_int() > y)
+        return;
+
+    auto const top = rects[band].top();
+    for (auto i = band; i != rects.size() && rects[i].top() == top; ++i)
+        spans.push_back({rects[i].left().as_int(), rects[i].right().as_int()});
+}
+
+/// Sweeps across the span boundaries of both bands, emitting the spans where op holds
+void combine_spans(Op op, std::vector<Span> const& a, std::vector<Span> const& b, std::vector<Span>& result)
+{
+    result.clear();
+
+    auto const a_end = 2 * a.size();
+    auto const b_end = 2 * b.size();
+    auto const boundary = [](std::vector<Span> const& spans, size_t i)
+        { return i % 2 ? spans[i / 2].right : spans[i / 2].left; };
+
+    size_t i = 0, j = 0;
+    bool in_a = false, in_b = false, was_inside = false;
+    int start = 0;
+
+    while (i != a_end || j != b_end)
+    {
+        auto const x = std::min(
+            i != a_end ? boundary(a, i) : std::numeric_limits<int>::max(),
+            j != b_end ? boundary(b, j) : std::numeric_limits<int>::max());
+
+        while (i != a_end && boundary(a, i) == x) { in_a = !in_a; ++i; }
+        while (j != b_end && boundary(b, j) == x) { in_b = !in_b; ++j; }
+
+        auto const is_inside = inside(op, in_a, in_b);
+        if (is_inside && !was_inside)
+            start = x;
+        else if (!is_inside && was_inside)
+            result.push_back({start, x});
+        was_inside = is_inside;
+    }
+}
+
+std::vector<geom::Rectangle> combine(
+    Op op,
+    std::vector<geom::Rectangle> const& a,
+    std::vector<geom::Rectangle> const& b)
+{
+    std::vector<int> rows;
+    rows.reserve(2 * (a.size() + b.size()));
+    for (auto const* rects : {&a, &b})
+    {
+        for (auto const& rect : *rects)
+        {
+            rows.push_back(rect.top().as_int());
+            rows.push_back(rect.bottom().as_int());
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    std::vector<geom::Rectangle> result;
+    std::vector<Span> a_spans, b_spans, spans;
+    size_t a_band = 0, b_band = 0;
+
+    // The band most recently emitted, for merging with an identical band below it
+    size_t previous_begin = 0;
+    int previous_bottom = std::numeric_limits<int>::min();
+
+    for (size_t row = 0; row + 1 < rows.size(); ++row)
+    {
+        auto const top = rows[row];
+        auto const bottom = rows[row + 1];
+
+        spans_at(a, a_band, top, a_spans);
+        spans_at(b, b_band, top, b_spans);
+        combine_spans(op, a_spans, b_spans, spans);
+
+        if (spans.empty())
+            continue;
+
+        auto const previous_count = result.size() - previous_begin;
+        bool const continues_previous =
+            previous_bottom == top &&
+            previous_count == spans.size() &&
+            std::equal(spans.begin(), spans.end(), result.begin() + previous_begin,
+                [](Span const& span, geom::Rectangle const& rect)
+                {
+                    return span.left == rect.left().as_int() && span.right == rect.right().as_int();
+                });
+
+        if (continues_previous)
+        {
+            for (auto i = previous_begin; i != result.size(); ++i)
+                result[i].size.height = geom::Height{bottom - result[i].top().as_int()};
+        }
+        else
+        {
+            previous_begin = result.size();
+            for (auto const& span : spans)
+                result.push_back({{span.left, top}, {span.right - span.left, bottom - top}});
+        }
+        previous_bottom = bottom;
+    }
+
+    return result;
+}
+}
+
+geom::Region::Region(Rectangle const& rect)
+{
+    if (!::is_empty(rect))
+        rectangles.push_back(rect);
+}
+
+geom::Region::Region(std::initializer_list<Rectangle> const& rects)
+{
+    for (auto const& rect : rects)
+        add(rect);
+}
+
+bool geom::Region::is_empty() const
+{
+    return rectangles.empty();
+}
+
+geom::Rectangle geom::Region::bounding_rectangle() const
+{
+    if (rectangles.empty())
+        return {};
+
+    auto left = rectangles.front().left();
+    auto right = rectangles.front().right();
+    for (auto const& rect : rectangles)
+    {
+        left = std::min(left, rect.left());
+        right = std::max(right, rect.right());
+    }
+
+    auto const top = rectangles.front().top();
+    auto const bottom = rectangles.back().bottom();
+    return {{left, top}, {right.as_int() - left.as_int(), bottom.as_int() - top.as_int()}};
+}
+
+bool geom::Region::contains(Rectangle const& rect) const
+{
+    if (::is_empty(rect))
+        return true;
+
+    // Walk down the bands, requiring each to cover the rect's columns without a gap between them
+    auto y = rect.top();
+    for (auto const& band_rect : rectangles)
+    {
+        if (band_rect.bottom() <= y)
+            continue;
+        if (band_rect.top() > y)
+            return false;
+
+        if (band_rect.left() <= rect.left() && rect.right() <= band_rect.right())
+        {
+            y = band_rect.bottom();
+            if (y >= rect.bottom())
+                return true;
+        }
+        else if (band_rect.left() > rect.left())
+        {
+            return false;   // Spans are sorted, so nothing later in the band can cover the rect
+        }
+    }
+    return false;
+}
+
+bool geom::Region::overlaps(Rectangle const& rect) const
+{
+    for (auto const& r : rectangles)
+    {
+        if (r.top() >= rect.bottom())
+            break;
+        if (r.overlaps(rect))
+            return true;
+    }
+    return false;
+}
+
+void geom::Region::add(Region const& other)
+{
+    if (other.rectangles.empty())
+        return;
+
+    if (rectangles.empty())
+    {
+        rectangles = other.rectangles;
+        return;
+    }
+
+    rectangles = combine(Op::unite, rectangles, other.rectangles);
+}
+
+void geom::Region::subtract(Region const& other)
+{
+    if (rectangles.empty() || other.rectangles.empty())
+        return;
+
+    if (!bounding_rectangle().overlaps(other.bounding_rectangle()))
+        return;
+
+    rectangles = combine(Op::subtract, rectangles, other.rectangles);
+}
+
+void geom::Region::intersect(Region const& other)
+{
+    if (rectangles.empty() || other.rectangles.empty() ||
+        !bounding_rectangle().overlaps(other.bounding_rectangle()))
+    {
+        rectangles.clear();
+        return;
+    }
+
+    rectangles = combine(Op::intersect, rectangles, other.rectangles);
+}
+
+geom::Region geom::Region::intersection_with(Rectangle const& rect) const
+{
+    Region result{*this};
+    result.intersect(rect);
+    return result;
+}
+
+geom::Region::const_iterator geom::Region::begin() const
+{
+    return rectangles.begin();
+}
+
+geom::Region::const_iterator geom::Region::end() const
+{
+    return rectangles.end();
+}
+
+geom::Region::size_type geom::Region::size() const
+{
+    return rectangles.size();
+}
+
+bool geom::Region::operator==(Region const& other) const
+{
+    return rectangles == other.rectangles;
+}
+
+bool geom::Region::operator!=(Region const& other) const
+{
+    return rectangles != other.rectangles;
+}
+
+std::ostream& geom::operator<<(std::ostream& out, Region const& value)
+{
+    out << '[';
+    for (auto const& rect : value)
+        out << rect << ", ";
+    out << ']';
+    return out;
+}
@@ -20,6 +20,8 @@
 #include "recently_used_cache.h"
 #include "mir/graphics/buffer.h"
 #include "mir/renderer/gl/texture_source.h"
+#include "mir/renderer/gl/partial_texture_source.h"
+#include "mir/geometry/displacement.h"
 
 #include <stdexcept>
 #include <boost/throw_exception.hpp>
@@ -29,6 +31,20 @@ namespace mgl = mir::gl;
 namespace geom = mir::geometry;
 namespace mrgl = mir::renderer::gl;
 
+namespace
+{
+auto damage_in_buffer_coordinates(mg::Renderable const& renderable) -> geom::Rectangles
+{
+    auto const offset = geom::as_displacement(renderable.screen_position().top_left);
+
+    geom::Rectangles damage;
+    for (auto const& rect : renderable.damage())
+        damage.add(geom::Rectangle{rect.top_left - offset, rect.size});
+
+    return damage;
+}
+}
+
 std::shared_ptr<mgl::Texture> mgl::RecentlyUsedCache::load(mg::Renderable const& renderable)
 {
     auto const& buffer = renderable.buffer();
@@ -42,9 +58,28 @@ std::shared_ptr<mgl::Texture> mgl::RecentlyUsedCache::load(mg::Renderable const&
 
     if ((texture.last_bound_buffer != buffer_id) || (!texture.valid_binding))
     {
-        texture_source->bind();
+        auto const partial_source = dynamic_cast<mrgl::PartialTextureSource*>(texture_source);
+
+        // The renderable's damage is relative to the buffer we last uploaded (as we
+        // load every buffer the compositor consumes) but it's only meaningful to us
+        // if the texture still matches and the whole buffer is drawn unscaled.
+        if (partial_source &&
+            texture.valid_binding &&
+            texture.last_bound_size == buffer->size() &&
+            texture.last_bound_format == buffer->pixel_format() &&
+            renderable.screen_position().size == buffer->size() &&
+            renderable.src_bounds() == geom::Rectangle{{}, buffer->size()})
+        {
+            partial_source->bind_damaged(damage_in_buffer_coordinates(renderable));
+        }
+        else
+        {
+            texture_source->bind();
+        }
         texture.resource = buffer;
         texture.last_bound_buffer = buffer_id;
+        texture.last_bound_size = buffer->size();
+        texture.last_bound_format = buffer->pixel_format();
     }
     texture_source->secure_for_render();
 
@@ -24,6 +24,8 @@
 #include "mir/gl/texture.h"
 #include "mir/graphics/buffer_id.h"
 #include "mir/graphics/renderable.h"
+#include "mir/geometry/size.h"
+#include "mir_toolkit/common.h"
 #include <unordered_map>
 
 namespace mir
@@ -46,6 +48,8 @@ private:
         {}
         std::shared_ptr<Texture> texture;
         graphics::BufferID last_bound_buffer;
+        geometry::Size last_bound_size;
+        MirPixelFormat last_bound_format{mir_pixel_format_invalid};
         bool used{true};
         bool valid_binding{false};
         std::shared_ptr<graphics::Buffer> resource;
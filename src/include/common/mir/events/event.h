@@ -25,6 +25,7 @@
 
 #include <capnp/message.h>
 
+#include <cstddef>
 #include <cstring>
 
 struct MirEvent
@@ -73,10 +74,18 @@ struct MirEvent
     static mir::EventUPtr deserialize(std::string const& bytes);
     static std::string serialize(MirEvent const* event);
 
+    /// Events are recycled through a pool rather than going to the heap each time
+    static void* operator new(std::size_t size);
+    static void operator delete(void* event, std::size_t size);
+
 protected:
     MirEvent() = default;
 
-    ::capnp::MallocMessageBuilder message;
+    /// Enough for any input event, so that building one doesn't allocate message segments
+    static std::size_t const first_segment_words = 128;
+
+    ::capnp::word first_segment[first_segment_words]{};
+    ::capnp::MallocMessageBuilder message{kj::arrayPtr(first_segment, first_segment_words)};
     mir::capnp::Event::Builder event{message.initRoot<mir::capnp::Event>()};
 };
 
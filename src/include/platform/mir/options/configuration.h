@@ -50,6 +50,7 @@ extern char const* const cursor_opt;
 extern char const* const fatal_except_opt;
 extern char const* const debug_opt;
 extern char const* const composite_delay_opt;
+extern char const* const frame_timeline_opt;
 extern char const* const enable_key_repeat_opt;
 extern char const* const x11_display_opt;
 extern char const* const wayland_extensions_opt;
@@ -57,6 +58,7 @@ extern char const* const enable_mirclient_opt;
 
 extern char const* const name_opt;
 extern char const* const offscreen_opt;
+extern char const* const offscreen_software_opt;
 
 extern char const* const enable_key_repeat_opt;
 
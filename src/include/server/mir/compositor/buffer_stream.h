@@ -21,6 +21,7 @@
 #define MIR_COMPOSITOR_BUFFER_STREAM_H_
 
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
 #include "mir/frontend/buffer_stream.h"
 #include "mir_toolkit/common.h"
 #include "mir/graphics/buffer_id.h"
@@ -42,12 +43,30 @@ class BufferStream : public frontend::BufferStream
 public:
     virtual ~BufferStream() = default;
 
+    using frontend::BufferStream::submit_buffer;
+
+    /**
+     * Submit a buffer along with the region of it (in buffer coordinates)
+     * that differs from the previously submitted buffer.
+     */
+    virtual void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) = 0;
+
     virtual auto lock_compositor_buffer(void const* user_id) -> std::shared_ptr<graphics::Buffer> = 0;
     virtual auto stream_size() -> geometry::Size = 0;
     virtual auto buffers_ready_for_compositor(void const* user_id) const -> int = 0;
     virtual void drop_old_buffers() = 0;
     virtual auto has_submitted_buffer() const -> bool = 0;
     virtual auto framedropping() const -> bool = 0;
+
+    /**
+     * The region (in buffer coordinates) of the buffer most recently locked
+     * by user_id that differs from the buffer user_id locked before that.
+     *
+     * If there is no usable history for user_id the whole buffer is damaged.
+     */
+    virtual auto damage_for(void const* user_id) const -> geometry::Rectangles = 0;
 };
 
 }
@@ -24,6 +24,16 @@
 #include <mir/fd.h>
 #include <vector>
 
+#include <stddef.h>
+
+namespace google
+{
+namespace protobuf
+{
+class MessageLite;
+}
+}
+
 namespace mir
 {
 namespace protobuf
@@ -43,11 +53,22 @@ public:
     Invocation(mir::protobuf::wire::Invocation const& invocation) :
         invocation(invocation) {}
 
+    /// For an \a invocation parsed without its parameters, which are still in the receive buffer
+    Invocation(
+        mir::protobuf::wire::Invocation const& invocation,
+        unsigned char const* parameters,
+        size_t parameters_size) :
+        invocation(invocation),
+        unparsed_parameters{parameters},
+        unparsed_parameters_size{parameters_size} {}
+
     const ::std::string& method_name() const;
-    const ::std::string& parameters() const;
+    bool parse_parameters(google::protobuf::MessageLite& parameters) const;
     google::protobuf::uint32 id() const;
 private:
     mir::protobuf::wire::Invocation const& invocation;
+    unsigned char const* const unparsed_parameters{nullptr};
+    size_t const unparsed_parameters_size{0};
 };
 
 class MessageProcessor
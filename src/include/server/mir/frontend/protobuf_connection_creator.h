@@ -27,6 +27,7 @@
 namespace mir
 {
 namespace graphics { class PlatformIpcOperations; }
+namespace cookie { class Authority; }
 namespace frontend
 {
 class MessageProcessorReport;
@@ -48,6 +49,7 @@ public:
         std::shared_ptr<ProtobufIpcFactory> const& ipc_factory,
         std::shared_ptr<SessionAuthorizer> const& session_authorizer,
         std::shared_ptr<graphics::PlatformIpcOperations> const& operations,
+        std::shared_ptr<cookie::Authority> const& cookie_authority,
         std::shared_ptr<MessageProcessorReport> const& report);
     ~ProtobufConnectionCreator() noexcept;
 
@@ -66,6 +68,7 @@ private:
     std::shared_ptr<ProtobufIpcFactory> const ipc_factory;
     std::shared_ptr<SessionAuthorizer> const session_authorizer;
     std::shared_ptr<graphics::PlatformIpcOperations> const operations;
+    std::shared_ptr<cookie::Authority> const cookie_authority;
     std::shared_ptr<MessageProcessorReport> const report;
     std::atomic<int> next_session_id;
     std::shared_ptr<detail::Connections<detail::SocketConnection>> const connections;
@@ -58,7 +58,7 @@ void invoke(
         Invocation const& invocation)
 {
     ParameterMessage parameter_message;
-    if (!parameter_message.ParseFromString(invocation.parameters()))
+    if (!invocation.parse_parameters(parameter_message))
         BOOST_THROW_EXCEPTION(std::runtime_error("Failed to parse message parameters!"));
     ResultMessage result_message;
 
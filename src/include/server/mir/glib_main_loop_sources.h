@@ -80,6 +80,23 @@ GSourceHandle add_timer_gsource(
     std::function<void()> const& exception_handler,
     time::Timestamp target_time);
 
+/**
+ * Runs work spawned from any thread on the main loop, in order.
+ *
+ * Spawning work doesn't take a lock, and only wakes the main context if
+ * all the work spawned before it has started running.
+ */
+class WorkSource
+{
+public:
+    WorkSource(GMainContext* main_context, std::function<void()> const& exception_handler);
+
+    void spawn(std::function<void()>&& work);
+
+private:
+    GSourceHandle const gsource;
+};
+
 class FdSources
 {
 public:
@@ -0,0 +1,46 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_INPUT_COOKIE_TOKEN_H_
+#define MIR_INPUT_COOKIE_TOKEN_H_
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct MirEvent;
+
+namespace mir
+{
+namespace cookie { class Authority; }
+namespace input
+{
+/**
+ * A compact stand-in for the cookie of an input event while it is inside the server.
+ *
+ * A cookie only authenticates its timestamp, so that's all the token holds. Calculating
+ * the MAC is left to seal_cookie(), which is only needed for events that are sent to
+ * clients that can hand the cookie back.
+ */
+auto cookie_token(std::chrono::nanoseconds timestamp) -> std::vector<uint8_t>;
+
+/// Replaces the cookie token of an input event with a full cookie from authority. Events
+/// without a token (including those that already have a full cookie) are left alone.
+void seal_cookie(MirEvent& event, cookie::Authority& authority);
+}
+}
+
+#endif // MIR_INPUT_COOKIE_TOKEN_H_
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_TIMELINE_H_
+#define MIR_REPORT_TIMELINE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
+
+namespace mir
+{
+namespace report
+{
+/**
+ * A record of what Mir's threads were doing, and when, kept cheaply enough to leave
+ * running on production machines.
+ *
+ * Each thread records spans into its own preallocated ring buffer (allocated on the
+ * first span it records), so recording takes no locks and, once enabled, costs a clock
+ * read and a few stores; while disabled it costs a single relaxed load. When a buffer
+ * is full the oldest spans are overwritten.
+ *
+ * The recording can be written at any time as Chrome trace event JSON, which can be
+ * viewed with chrome://tracing or https://ui.perfetto.dev.
+ */
+class Timeline
+{
+public:
+    /// Starts recording, keeping (at least) the latest events_per_thread span boundaries of each thread
+    static void enable(size_t events_per_thread);
+    static void disable();
+
+    static bool enabled()
+    {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    /// \param name must outlive the timeline, so typically a string literal
+    static void begin(char const* name);
+    static void end(char const* name);
+
+    /// Writes the recorded spans of every thread as Chrome trace event JSON
+    static void write_chrome_trace(std::ostream& out);
+
+    /// Records a span for the lifetime of the object
+    class Span
+    {
+    public:
+        explicit Span(char const* name)
+            : name{enabled() ? name : nullptr}
+        {
+            if (this->name)
+                begin(this->name);
+        }
+
+        ~Span()
+        {
+            if (name)
+                end(name);
+        }
+
+        Span(Span const&) = delete;
+        Span& operator=(Span const&) = delete;
+
+    private:
+        char const* const name;
+    };
+
+private:
+    static std::atomic<bool> active;
+};
+}
+}
+
+#endif /* MIR_REPORT_TIMELINE_H_ */
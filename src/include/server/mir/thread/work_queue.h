@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_THREAD_WORK_QUEUE_H_
+#define MIR_THREAD_WORK_QUEUE_H_
+
+#include <atomic>
+#include <functional>
+
+namespace mir
+{
+namespace thread
+{
+/**
+ * A queue of work that any thread may add to, for a single thread to run.
+ *
+ * Adding work never takes a lock. The consumer is only woken when work is added
+ * to a queue it has already drained: push() returns true when the caller should
+ * wake it, and the consumer calls start_draining() before popping work.
+ */
+class WorkQueue
+{
+public:
+    WorkQueue();
+    ~WorkQueue();
+
+    /// Adds work to the queue, returning true if the consumer needs waking.
+    bool push(std::function<void()>&& work);
+
+    /// Marks the consumer as awake. Work pushed after this wakes it again.
+    void start_draining();
+
+    /**
+     * Takes the oldest work from the queue, or an empty function if there's none.
+     *
+     * This may miss work still being pushed, but that push will wake the consumer.
+     * Only the consumer may call this.
+     */
+    std::function<void()> pop();
+
+    /// Whether there's any work left. Only the consumer may call this.
+    bool empty() const;
+
+private:
+    WorkQueue(WorkQueue const&) = delete;
+    WorkQueue& operator=(WorkQueue const&) = delete;
+
+    struct Node
+    {
+        std::atomic<Node*> next{nullptr};
+        std::function<void()> work;
+    };
+
+    void push_node(Node* node);
+
+    Node stub;
+    std::atomic<Node*> head;
+    Node* tail;
+    std::atomic<bool> wakeup_pending{false};
+};
+}
+}
+
+#endif // MIR_THREAD_WORK_QUEUE_H_
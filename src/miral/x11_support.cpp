@@ -41,6 +41,15 @@ void miral::X11Support::operator()(mir::Server& server) const
     server.add_configuration_option(
         "xwayland-path",
         "Path to Xwayland executable", "/usr/bin/Xwayland");
+
+    server.add_configuration_option(
+        "xwayland-eager-start",
+        "Start Xwayland with the server, rather than when the first X11 client connects", mir::OptionType::null);
+
+    server.add_configuration_option(
+        "xwayland-idle-timeout",
+        "Seconds Xwayland may go without X11 clients before it is stopped "
+        "(default: 0, stop it when the last X11 client disconnects)", 0);
 }
 
 miral::X11Support::~X11Support() = default;
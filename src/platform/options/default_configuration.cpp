@@ -46,11 +46,13 @@ char const* const mo::host_socket_opt             = "host-socket";
 char const* const mo::nested_passthrough_opt      = "nested-passthrough";
 char const* const mo::name_opt                    = "name";
 char const* const mo::offscreen_opt               = "offscreen";
+char const* const mo::offscreen_software_opt      = "offscreen-software";
 char const* const mo::touchspots_opt              = "enable-touchspots";
 char const* const mo::cursor_opt                  = "cursor";
 char const* const mo::fatal_except_opt            = "on-fatal-error-except";
 char const* const mo::debug_opt                   = "debug";
 char const* const mo::composite_delay_opt         = "composite-delay";
+char const* const mo::frame_timeline_opt          = "frame-timeline";
 char const* const mo::enable_key_repeat_opt       = "enable-key-repeat";
 char const* const mo::x11_display_opt             = "x11-display-experimental";
 char const* const mo::wayland_extensions_opt      = "wayland-extensions";
@@ -191,6 +193,9 @@ mo::DefaultConfiguration::DefaultConfiguration(
             "frames from clients before compositing). Higher values result in "
             "lower latency but risk causing frame skipping. "
             "Default: A negative value means decide automatically.")
+        (frame_timeline_opt, po::value<std::string>(),
+            "Record what the compositing threads do each frame, and write it to this file as "
+            "Chrome trace JSON (for chrome://tracing or Perfetto) on SIGUSR2 and on exit.")
         (name_opt, po::value<std::string>(),
             "When nested, the name Mir uses when registering with the host.")
         (nested_passthrough_opt, po::value<bool>()->default_value(true),
@@ -198,6 +203,8 @@ mo::DefaultConfiguration::DefaultConfiguration(
             " to avoid a composition pass")
         (offscreen_opt,
             "Render to offscreen buffers instead of the real outputs.")
+        (offscreen_software_opt,
+            "With --offscreen, composite in software into CPU memory instead of with GL.")
         (touchspots_opt,
             "Display visualization of touchspots (e.g. for screencasting).")
         (cursor_opt,
@@ -164,7 +164,9 @@ void mgc::MemoryBackedShmBuffer::write(unsigned char const* data, size_t data_si
 {
     if (data_size != stride_.as_uint32_t()*size().height.as_uint32_t())
         BOOST_THROW_EXCEPTION(std::logic_error("Size is not equal to number of pixels in buffer"));
+    std::lock_guard<std::mutex> lock{texture_mutex};
     memcpy(pixels.get(), data, data_size);
+    texture_is_stale = true;
 }
 
 void mgc::MemoryBackedShmBuffer::read(std::function<void(unsigned char const*)> const& do_with_pixels)
@@ -198,7 +200,14 @@ void mgc::ShmBuffer::bind()
 void mgc::MemoryBackedShmBuffer::bind()
 {
     mgc::ShmBuffer::bind();
-    upload_to_texture(pixels.get());
+
+    // The texture persists with the buffer, so only reupload when the pixels change
+    std::lock_guard<std::mutex> lock{texture_mutex};
+    if (texture_is_stale)
+    {
+        upload_to_texture(pixels.get());
+        texture_is_stale = false;
+    }
 }
 
 auto mgc::MemoryBackedShmBuffer::native_buffer_handle() const -> std::shared_ptr<mg::NativeBuffer>
@@ -31,6 +31,8 @@
 
 #include MIR_SERVER_GL_H
 
+#include <mutex>
+
 namespace mir
 {
 class ShmFile;
@@ -97,6 +99,9 @@ public:
 private:
     geometry::Stride const stride_;
     std::unique_ptr<unsigned char[]> const pixels;
+
+    std::mutex texture_mutex;
+    bool texture_is_stale{true};
 };
 
 }
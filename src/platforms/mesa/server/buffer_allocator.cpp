@@ -19,6 +19,7 @@
 
 #include "buffer_allocator.h"
 #include "gbm_buffer.h"
+#include "wayland_scanout_buffer.h"
 #include "buffer_texture_binder.h"
 #include "mir/anonymous_shm_file.h"
 #include "shm_buffer.h"
@@ -45,6 +46,7 @@
 #include MIR_SERVER_GLEXT_H
 
 #include <algorithm>
+#include <atomic>
 #include <stdexcept>
 #include <system_error>
 #include <gbm.h>
@@ -381,11 +383,48 @@ std::shared_ptr<mg::Buffer> mgm::BufferAllocator::buffer_from_resource(
         [this]() { ctx->make_current(); },
         [this]() { ctx->release_current(); });
 
-    return mg::wayland::buffer_from_resource(
-        buffer,
-        std::move(on_consumed),
-        std::move(on_release),
-        ctx,
-        *egl_extensions,
-        wayland_executor);
+    std::shared_ptr<gbm_bo> scanout_bo;
+    if (bypass_option == mgm::BypassOption::allowed)
+        scanout_bo = import_for_scanout(device, buffer);
+
+    if (!scanout_bo)
+    {
+        return mg::wayland::buffer_from_resource(
+            buffer,
+            std::move(on_consumed),
+            std::move(on_release),
+            ctx,
+            *egl_extensions,
+            wayland_executor);
+    }
+
+    // Whichever of compositing or scanout uses the buffer first consumes it
+    struct ConsumeOnce
+    {
+        ConsumeOnce(std::function<void()>&& on_consumed)
+            : on_consumed{std::move(on_consumed)}
+        {
+        }
+
+        void operator()()
+        {
+            if (!consumed.exchange(true))
+                on_consumed();
+        }
+
+        std::function<void()> const on_consumed;
+        std::atomic<bool> consumed{false};
+    };
+    auto const consume = std::make_shared<ConsumeOnce>(std::move(on_consumed));
+
+    return std::make_shared<WaylandScanoutBuffer>(
+        mg::wayland::buffer_from_resource(
+            buffer,
+            [consume]() { (*consume)(); },
+            std::move(on_release),
+            ctx,
+            *egl_extensions,
+            wayland_executor),
+        scanout_bo,
+        [consume]() { (*consume)(); });
 }
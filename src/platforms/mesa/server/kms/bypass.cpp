@@ -23,6 +23,20 @@
 using namespace mir;
 namespace mgm = mir::graphics::mesa;
 
+namespace
+{
+bool opaque_everywhere(graphics::Renderable const& renderable)
+{
+    auto const position = renderable.screen_position();
+    for (auto const& opaque : renderable.opaque_region())
+    {
+        if (opaque.contains(position))
+            return true;
+    }
+    return false;
+}
+}
+
 mgm::BypassMatch::BypassMatch(geometry::Rectangle const& rect)
     : view_area(rect),
       bypass_is_feasible(true),
@@ -40,8 +54,10 @@ bool mgm::BypassMatch::operator()(std::shared_ptr<graphics::Renderable> const& r
     if (!view_area.overlaps(renderable->screen_position()))
         return false;
 
-    auto const is_opaque = !((renderable->alpha() != 1.0f) || renderable->shaped());
-    auto const fits = (renderable->screen_position() == view_area);
+    // The whole buffer must be scanned out as it is: a cropped or scaled buffer needs compositing
+    auto const fits = (renderable->screen_position() == view_area) &&
+                      (renderable->src_bounds() == geometry::Rectangle{{0, 0}, view_area.size});
+    auto const is_opaque = (renderable->alpha() == 1.0f) && (!renderable->shaped() || opaque_everywhere(*renderable));
     auto const is_orthogonal = (renderable->transformation() == identity);
     bypass_is_feasible = (is_opaque && fits && is_orthogonal);
     return bypass_is_feasible;
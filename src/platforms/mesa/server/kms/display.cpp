@@ -190,7 +190,8 @@ mgm::Display::Display(std::vector<std::shared_ptr<helpers::DRMHelper>> const& dr
                       flipper = std::make_shared<KMSPageFlipper>(drm_fd, listener);
                   }
                   return flipper;
-              })},
+              },
+              listener)},
       current_display_configuration{output_container},
       dirty_configuration{false},
       bypass_option(bypass_option),
@@ -409,8 +410,13 @@ bool mgm::Display::apply_if_configuration_preserves_display_buffers(
 
 mg::Frame mgm::Display::last_frame_on(unsigned output_id) const
 {
-    auto output = current_display_configuration.get_output_for(
-        DisplayConfigurationOutputId{static_cast<int>(output_id)});
+    std::shared_ptr<KMSOutput> output;
+    {
+        // Called from the frontend, so may race with hotplug and configure()
+        std::lock_guard<decltype(configuration_mutex)> lock{configuration_mutex};
+        output = current_display_configuration.get_output_for(
+            DisplayConfigurationOutputId{static_cast<int>(output_id)});
+    }
     return output->last_frame();
 }
 
@@ -22,6 +22,7 @@
 #include "mir/graphics/transformation.h"
 #include "bypass.h"
 #include "gbm_buffer.h"
+#include "wayland_scanout_buffer.h"
 #include "mir/fatal.h"
 #include "mir/log.h"
 #include "native_buffer.h"
@@ -599,6 +600,10 @@ bool mgm::DisplayBuffer::overlay(RenderableList const& renderable_list)
             {
                 if (auto bufobj = outputs.front()->fb_for(native->bo))
                 {
+                    // A Wayland client's buffer is consumed by scanning it out, rather than by binding it
+                    if (auto const wayland_buffer = std::dynamic_pointer_cast<mgm::WaylandScanoutBuffer>(bypass_buffer))
+                        wayland_buffer->scanned_out();
+
                     bypass_buf = bypass_buffer;
                     bypass_bufobj = bufobj;
                     return true;
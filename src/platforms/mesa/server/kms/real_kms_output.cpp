@@ -18,6 +18,7 @@
 
 #include "real_kms_output.h"
 #include "mir/graphics/display_configuration.h"
+#include "mir/graphics/display_report.h"
 #include "page_flipper.h"
 #include "kms-utils/kms_connector.h"
 #include "mir/fatal.h"
@@ -74,9 +75,11 @@ void bo_user_data_destroy(gbm_bo* /*bo*/, void *data)
 mgm::RealKMSOutput::RealKMSOutput(
     int drm_fd,
     kms::DRMModeConnectorUPtr&& connector,
-    std::shared_ptr<PageFlipper> const& page_flipper)
+    std::shared_ptr<PageFlipper> const& page_flipper,
+    std::shared_ptr<DisplayReport> const& report)
     : drm_fd_{drm_fd},
       page_flipper{page_flipper},
+      report{report},
       connector{std::move(connector)},
       mode_index{0},
       current_crtc(),
@@ -633,10 +636,19 @@ mgm::FBHandle* mgm::RealKMSOutput::fb_for(gbm_bo* bo) const
     /*
      * Check if we have already set up this gbm_bo (the gbm implementation is
      * free to reuse gbm_bos). If so, return the associated FBHandle.
+     *
+     * The FBHandle lives exactly as long as the gbm_bo: bo_user_data_destroy
+     * removes the framebuffer when the buffer is destroyed. Framebuffers don't
+     * depend on the mode, so they stay valid across reconfiguration.
      */
     auto bufobj = static_cast<FBHandle*>(gbm_bo_get_user_data(bo));
     if (bufobj)
+    {
+        report->report_framebuffer_cache_hit(id());
         return bufobj;
+    }
+
+    report->report_framebuffer_cache_miss(id());
 
     uint32_t fb_id{0};
     uint32_t handles[4] = {gbm_bo_get_handle(bo).u32, 0, 0, 0};
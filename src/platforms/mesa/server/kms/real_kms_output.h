@@ -30,6 +30,8 @@ namespace mir
 {
 namespace graphics
 {
+class DisplayReport;
+
 namespace mesa
 {
 
@@ -41,7 +43,8 @@ public:
     RealKMSOutput(
         int drm_fd,
         kms::DRMModeConnectorUPtr&& connector,
-        std::shared_ptr<PageFlipper> const& page_flipper);
+        std::shared_ptr<PageFlipper> const& page_flipper,
+        std::shared_ptr<DisplayReport> const& report);
     ~RealKMSOutput();
 
     uint32_t id() const override;
@@ -79,6 +82,7 @@ private:
 
     int const drm_fd_;
     std::shared_ptr<PageFlipper> const page_flipper;
+    std::shared_ptr<DisplayReport> const report;
 
     kms::DRMModeConnectorUPtr connector;
     size_t mode_index;
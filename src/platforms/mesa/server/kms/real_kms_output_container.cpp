@@ -25,9 +25,11 @@ namespace mgm = mir::graphics::mesa;
 
 mgm::RealKMSOutputContainer::RealKMSOutputContainer(
     std::vector<int> const& drm_fds,
-    std::function<std::shared_ptr<PageFlipper>(int)> const& construct_page_flipper)
+    std::function<std::shared_ptr<PageFlipper>(int)> const& construct_page_flipper,
+    std::shared_ptr<DisplayReport> const& report)
     : drm_fds{drm_fds},
-      construct_page_flipper{construct_page_flipper}
+      construct_page_flipper{construct_page_flipper},
+      report{report}
 {
 }
 
@@ -74,7 +76,8 @@ void mgm::RealKMSOutputContainer::update_from_hardware_state()
                 new_outputs.push_back(std::make_shared<RealKMSOutput>(
                     drm_fd,
                     std::move(connector),
-                    construct_page_flipper(drm_fd)));
+                    construct_page_flipper(drm_fd),
+                    report));
             }
         }
 
@@ -26,6 +26,8 @@ namespace mir
 {
 namespace graphics
 {
+class DisplayReport;
+
 namespace mesa
 {
 
@@ -36,7 +38,8 @@ class RealKMSOutputContainer : public KMSOutputContainer
 public:
     RealKMSOutputContainer(
         std::vector<int> const& drm_fds,
-        std::function<std::shared_ptr<PageFlipper>(int drm_fd)> const& construct_page_flipper);
+        std::function<std::shared_ptr<PageFlipper>(int drm_fd)> const& construct_page_flipper,
+        std::shared_ptr<DisplayReport> const& report);
 
     void for_each_output(std::function<void(std::shared_ptr<KMSOutput> const&)> functor) const override;
 
@@ -45,6 +48,7 @@ private:
     std::vector<int> const drm_fds;
     std::vector<std::shared_ptr<KMSOutput>> outputs;
     std::function<std::shared_ptr<PageFlipper>(int drm_fd)> const construct_page_flipper;
+    std::shared_ptr<DisplayReport> const report;
 };
 
 }
@@ -0,0 +1,140 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wayland_scanout_buffer.h"
+#include "native_buffer.h"
+
+#include <wayland-server-core.h>
+
+#include <type_traits>
+
+namespace mg = mir::graphics;
+namespace mgm = mir::graphics::mesa;
+namespace geom = mir::geometry;
+
+namespace
+{
+class ImportedBo
+{
+public:
+    static std::shared_ptr<gbm_bo> bo_for_resource(gbm_device* device, wl_resource* buffer)
+    {
+        ImportedBo* imported;
+
+        if (auto notifier = wl_resource_get_destroy_listener(buffer, &on_destroyed))
+        {
+            // We've already imported this buffer (or failed to)
+            imported = wl_container_of(notifier, imported, destruction_listener);
+        }
+        else
+        {
+            imported = new ImportedBo{device, buffer};
+        }
+        return imported->bo;
+    }
+
+private:
+    ImportedBo(gbm_device* device, wl_resource* buffer)
+        : bo{import(device, buffer)}
+    {
+        destruction_listener.notify = &on_destroyed;
+        wl_resource_add_destroy_listener(buffer, &destruction_listener);
+    }
+
+    static std::shared_ptr<gbm_bo> import(gbm_device* device, wl_resource* buffer)
+    {
+        if (auto const bo = gbm_bo_import(device, GBM_BO_IMPORT_WL_BUFFER, buffer, GBM_BO_USE_SCANOUT))
+        {
+            return {bo, &gbm_bo_destroy};
+        }
+        return nullptr;
+    }
+
+    static void on_destroyed(wl_listener* listener, void*)
+    {
+        ImportedBo* imported;
+
+        imported = wl_container_of(listener, imported, destruction_listener);
+        delete imported;
+    }
+
+    std::shared_ptr<gbm_bo> const bo;
+    wl_listener destruction_listener;
+};
+static_assert(
+    std::is_standard_layout<ImportedBo>::value,
+    "ImportedBo must be Standard Layout for wl_container_of to be defined behaviour");
+}
+
+auto mgm::import_for_scanout(gbm_device* device, wl_resource* buffer) -> std::shared_ptr<gbm_bo>
+{
+    return ImportedBo::bo_for_resource(device, buffer);
+}
+
+mgm::WaylandScanoutBuffer::WaylandScanoutBuffer(
+    std::unique_ptr<Buffer> composited,
+    std::shared_ptr<gbm_bo> const& bo,
+    std::function<void()> const& on_scanout)
+    : composited{std::move(composited)},
+      bo{bo},
+      on_scanout{on_scanout}
+{
+}
+
+std::shared_ptr<mg::NativeBuffer> mgm::WaylandScanoutBuffer::native_buffer_handle() const
+{
+    auto temp = std::make_shared<NativeBuffer>();
+
+    temp->fd_items = 0;
+    temp->stride = gbm_bo_get_stride(bo.get());
+    temp->flags = mir_buffer_flag_can_scanout;
+    temp->bo = bo.get();
+    temp->is_gbm_buffer = true;
+    temp->native_format = gbm_bo_get_format(bo.get());
+    temp->native_flags = GBM_BO_USE_SCANOUT;
+
+    auto const& dim = size();
+    temp->width = dim.width.as_int();
+    temp->height = dim.height.as_int();
+
+    return temp;
+}
+
+mg::BufferID mgm::WaylandScanoutBuffer::id() const
+{
+    return composited->id();
+}
+
+geom::Size mgm::WaylandScanoutBuffer::size() const
+{
+    return composited->size();
+}
+
+MirPixelFormat mgm::WaylandScanoutBuffer::pixel_format() const
+{
+    return composited->pixel_format();
+}
+
+mg::NativeBufferBase* mgm::WaylandScanoutBuffer::native_buffer_base()
+{
+    // The renderer finds the texture to composite with here
+    return composited->native_buffer_base();
+}
+
+void mgm::WaylandScanoutBuffer::scanned_out()
+{
+    on_scanout();
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_MESA_WAYLAND_SCANOUT_BUFFER_H_
+#define MIR_GRAPHICS_MESA_WAYLAND_SCANOUT_BUFFER_H_
+
+#include "mir/graphics/buffer.h"
+
+#include <gbm.h>
+
+#include <functional>
+#include <memory>
+
+struct wl_resource;
+
+namespace mir
+{
+namespace graphics
+{
+namespace mesa
+{
+/**
+ * Imports a client's wl_buffer into GBM so that it can be scanned out.
+ *
+ * Each import creates a new gbm_bo, and KMSOutput::fb_for() adds a framebuffer
+ * per gbm_bo. Clients cycle through the same few wl_buffers, so the gbm_bo is
+ * kept until the client destroys the wl_buffer and later imports reuse it.
+ *
+ * \return  The imported gbm_bo, or nullptr if the buffer can't be scanned out.
+ * \note    Must be called on the Wayland thread.
+ */
+auto import_for_scanout(gbm_device* device, wl_resource* buffer) -> std::shared_ptr<gbm_bo>;
+
+/**
+ * A client's Wayland buffer, which the display may scan out directly.
+ *
+ * Compositing draws the wrapped buffer as usual. When the display scans this
+ * out instead, it calls scanned_out() in place of binding the texture.
+ */
+class WaylandScanoutBuffer : public Buffer
+{
+public:
+    WaylandScanoutBuffer(
+        std::unique_ptr<Buffer> composited,
+        std::shared_ptr<gbm_bo> const& bo,
+        std::function<void()> const& on_scanout);
+
+    std::shared_ptr<graphics::NativeBuffer> native_buffer_handle() const override;
+    BufferID id() const override;
+    geometry::Size size() const override;
+    MirPixelFormat pixel_format() const override;
+    NativeBufferBase* native_buffer_base() override;
+
+    void scanned_out();
+
+private:
+    std::unique_ptr<Buffer> const composited;
+    std::shared_ptr<gbm_bo> const bo;
+    std::function<void()> const on_scanout;
+};
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_MESA_WAYLAND_SCANOUT_BUFFER_H_ */
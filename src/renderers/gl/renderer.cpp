@@ -19,6 +19,7 @@
 #define MIR_LOG_COMPONENT "GLRenderer"
 
 #include "renderer.h"
+#include "mir/renderer/gl/buffer_age_source.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/gl/default_program_factory.h"
 #include "mir/graphics/renderable.h"
@@ -29,6 +30,7 @@
 #include "mir/gl/texture.h"
 #include "mir/log.h"
 #include "mir/report_exception.h"
+#include "mir/report/timeline.h"
 #include "mir/graphics/egl_error.h"
 #include "mir/graphics/texture.h"
 #include "mir/graphics/program_factory.h"
@@ -38,20 +40,65 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <EGL/egl.h>
+#include <EGL/eglext.h>
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
 #include <cmath>
 #include <sstream>
+#include <cstring>
 
 namespace mg = mir::graphics;
 namespace mgl = mir::gl;
 namespace mrg = mir::renderer::gl;
+namespace mr = mir::report;
 namespace geom = mir::geometry;
 
+namespace
+{
+// Beyond this we may as well repaint everything
+unsigned int const max_buffer_age = 4;
+
+bool egl_extension_supported(char const* extension)
+{
+    auto const display = eglGetCurrentDisplay();
+    if (display == EGL_NO_DISPLAY)
+        return false;
+
+    auto const extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (!extensions)
+        return false;
+
+    auto const length = strlen(extension);
+    for (auto found = strstr(extensions, extension); found; found = strstr(found + length, extension))
+    {
+        if ((found == extensions || found[-1] == ' ') && (found[length] == ' ' || found[length] == '\0'))
+            return true;
+    }
+    return false;
+}
+
+/// True if the renderable's pixels need blending with what's beneath them
+bool needs_pixel_blending(mg::Renderable const& renderable)
+{
+    if (!renderable.shaped())
+        return false;
+
+    // The client may have told us the alpha channel doesn't matter
+    auto const position = renderable.screen_position();
+    for (auto const& opaque : renderable.opaque_region())
+    {
+        if (opaque.contains(position))
+            return false;
+    }
+    return true;
+}
+}
+
 mrg::CurrentRenderTarget::CurrentRenderTarget(mg::DisplayBuffer* display_buffer)
     : render_target{
-        dynamic_cast<renderer::gl::RenderTarget*>(display_buffer->native_display_buffer())}
+        dynamic_cast<renderer::gl::RenderTarget*>(display_buffer->native_display_buffer())},
+      egl_buffer_age_supported{egl_extension_supported("EGL_EXT_buffer_age")}
 {
     if (!render_target)
         BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support GL rendering"));
@@ -80,6 +127,24 @@ void mrg::CurrentRenderTarget::swap_buffers()
     render_target->swap_buffers();
 }
 
+unsigned int mrg::CurrentRenderTarget::buffer_age() const
+{
+    if (auto const age_source = dynamic_cast<BufferAgeSource const*>(render_target))
+        return age_source->buffer_age();
+
+    if (!egl_buffer_age_supported)
+        return 0;
+
+    EGLint age = 0;
+    if (!eglQuerySurface(eglGetCurrentDisplay(), eglGetCurrentSurface(EGL_DRAW), EGL_BUFFER_AGE_EXT, &age) ||
+        age < 0)
+    {
+        return 0;
+    }
+
+    return age;
+}
+
 const GLchar* const mrg::Renderer::vshader =
 {
     "attribute vec3 position;\n"
@@ -407,21 +472,114 @@ void mrg::Renderer::tessellate(std::vector<mgl::Primitive>& primitives,
     primitives[0] = mgl::tessellate_renderable_into_rectangle(renderable, geom::Displacement{0,0});
 }
 
+void mrg::Renderer::set_frame_damage(geom::Rectangles const& damage)
+{
+    frame_damage = damage;
+}
+
+auto mrg::Renderer::repair_areas() const -> std::experimental::optional<geom::Rectangles>
+{
+    // Partial repaints are only attempted when screen pixels map directly onto buffer pixels
+    if (!frame_damage || !gl_viewport_is_one_to_one || display_transform != glm::mat4(1))
+        return {};
+
+    auto const age = render_target.buffer_age();
+    if (age == 0 || age > damage_history.size() + 1)
+        return {};
+
+    std::vector<geom::Rectangle> stale;
+    auto const add_stale = [&](geom::Rectangle const& area)
+        {
+            auto const visible = area.intersection_with(viewport);
+            if (visible.size.width.as_int() > 0 && visible.size.height.as_int() > 0)
+                stale.push_back(visible);
+        };
+
+    for (auto const& area : *frame_damage)
+        add_stale(area);
+    for (auto frame = damage_history.begin(); frame != damage_history.begin() + (age - 1); ++frame)
+    {
+        for (auto const& area : *frame)
+            add_stale(area);
+    }
+
+    // Don't scissor and clear the same pixels twice
+    geom::Rectangles result;
+    for (auto i = 0u; i != stale.size(); ++i)
+    {
+        bool covered = false;
+        for (auto j = 0u; j != stale.size() && !covered; ++j)
+            covered = (i != j) && stale[j].contains(stale[i]) && (stale[j] != stale[i] || j < i);
+
+        if (!covered)
+            result.add(stale[i]);
+    }
+
+    return result;
+}
+
 void mrg::Renderer::render(mg::RenderableList const& renderables) const
 {
+    mr::Timeline::Span const span{"render"};
     render_target.bind();
 
     glClearColor(clear_color[0], clear_color[1], clear_color[2], clear_color[3]);
     glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-    glClear(GL_COLOR_BUFFER_BIT);
 
     ++frameno;
-    for (auto const& r : renderables)
+    if (auto const areas = repair_areas())
+    {
+        glEnable(GL_SCISSOR_TEST);
+        for (auto const& area : *areas)
+        {
+            repair_area = area;
+            scissor_to(area);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            for (auto const& r : renderables)
+            {
+                if (r->screen_position().overlaps(area) || r->transformation() != glm::mat4(1))
+                    draw(*r);
+            }
+        }
+        repair_area = std::experimental::nullopt;
+        glDisable(GL_SCISSOR_TEST);
+
+        // Textures of renderables that were not redrawn are still on screen, so
+        // keep them from being dropped (which would force a reupload later)
+        for (auto const& r : renderables)
+        {
+            if (!std::dynamic_pointer_cast<mg::gl::Texture>(r->buffer()))
+            {
+                try
+                {
+                    texture_cache->load(*r);
+                }
+                catch (std::exception const&)
+                {
+                    report_exception();
+                }
+            }
+        }
+    }
+    else
     {
-        draw(*r);
+        glClear(GL_COLOR_BUFFER_BIT);
+        for (auto const& r : renderables)
+        {
+            draw(*r);
+        }
     }
 
-    render_target.swap_buffers();
+    {
+        mr::Timeline::Span const span{"swap buffers"};
+        render_target.swap_buffers();
+    }
+
+    damage_history.push_front(frame_damage ? *frame_damage : geom::Rectangles{viewport});
+    if (damage_history.size() > max_buffer_age)
+        damage_history.pop_back();
+    frame_damage = std::experimental::nullopt;
 
     // Deleting unused textures only requires the GL context. This clean-up
     // does not affect screen contents so can happen after swap_buffers...
@@ -433,20 +591,12 @@ void mrg::Renderer::render(mg::RenderableList const& renderables) const
 
 void mrg::Renderer::draw(mg::Renderable const& renderable) const
 {
+    mr::Timeline::Span const span{"draw"};
     auto const clip_area = renderable.clip_area();
     if (clip_area)
     {
         glEnable(GL_SCISSOR_TEST);
-        glScissor(
-            clip_area.value().top_left.x.as_int() -
-                viewport.top_left.x.as_int(),
-            viewport.top_left.y.as_int() +
-                viewport.size.height.as_int() -
-                clip_area.value().top_left.y.as_int() -
-                clip_area.value().size.height.as_int(),
-            clip_area.value().size.width.as_int(), 
-            clip_area.value().size.height.as_int()
-        );
+        scissor_to(repair_area ? clip_area.value().intersection_with(*repair_area) : clip_area.value());
     }
 
     auto const texture = std::dynamic_pointer_cast<mg::gl::Texture>(renderable.buffer());
@@ -457,6 +607,7 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
             {
                 try
                 {
+                    mr::Timeline::Span const span{"texture upload"};
                     return texture_cache->load(renderable);
                 }
                 catch (std::exception const&)
@@ -561,7 +712,7 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
         BlendSeparate client_blend;
 
         // These renderable method names could be better (see LP: #1236224)
-        if (renderable.shaped())  // Client is RGBA:
+        if (needs_pixel_blending(renderable))  // Client is RGBA:
         {
             client_blend = {GL_ONE, GL_ONE_MINUS_SRC_ALPHA,
                             GL_ONE, GL_ONE_MINUS_SRC_ALPHA};
@@ -630,10 +781,28 @@ void mrg::Renderer::draw(mg::Renderable const& renderable) const
     glDisableVertexAttribArray(prog.position_attr);
     if (renderable.clip_area())
     {
-        glDisable(GL_SCISSOR_TEST);
+        if (repair_area)
+            scissor_to(*repair_area);
+        else
+            glDisable(GL_SCISSOR_TEST);
     }
 }
 
+void mrg::Renderer::scissor_to(geom::Rectangle const& area) const
+{
+    // GL window coordinates have their origin at the bottom left
+    glScissor(
+        area.top_left.x.as_int() -
+            viewport.top_left.x.as_int(),
+        viewport.top_left.y.as_int() +
+            viewport.size.height.as_int() -
+            area.top_left.y.as_int() -
+            area.size.height.as_int(),
+        area.size.width.as_int(),
+        area.size.height.as_int()
+    );
+}
+
 void mrg::Renderer::set_viewport(geometry::Rectangle const& rect)
 {
     if (rect == viewport)
@@ -686,6 +855,10 @@ void mrg::Renderer::update_gl_viewport()
      */
     render_target.ensure_current();
 
+    // Whatever is in the back buffers no longer lines up with what we draw
+    damage_history.clear();
+    gl_viewport_is_one_to_one = false;
+
     auto transformed_viewport = display_transform *
                                 glm::vec4(viewport.size.width.as_int(),
                                           viewport.size.height.as_int(), 0, 1);
@@ -710,6 +883,11 @@ void mrg::Renderer::update_gl_viewport()
         GLint offset_y = (buf_height - reduced_height) / 2;
 
         glViewport(offset_x, offset_y, reduced_width, reduced_height);
+
+        gl_viewport_is_one_to_one =
+            offset_x == 0 && offset_y == 0 &&
+            reduced_width == viewport.size.width.as_int() &&
+            reduced_height == viewport.size.height.as_int();
     }
 }
 
@@ -726,5 +904,6 @@ void mrg::Renderer::set_output_transform(glm::mat2 const& t)
 void mrg::Renderer::suspend()
 {
     texture_cache->invalidate();
+    damage_history.clear();
 }
 
@@ -23,12 +23,15 @@
 
 #include <mir/renderer/renderer.h>
 #include <mir/geometry/rectangle.h>
+#include <mir/geometry/rectangles.h>
 #include <mir/graphics/buffer_id.h>
 #include <mir/graphics/renderable.h>
 #include <mir/gl/primitive.h>
 #include "mir/renderer/gl/render_target.h"
 
 #include MIR_SERVER_GL_H
+#include <deque>
+#include <experimental/optional>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -52,8 +55,12 @@ public:
     void bind();
     void swap_buffers();
 
+    /// Age of the current back buffer as per EGL_EXT_buffer_age (0 if unknown)
+    unsigned int buffer_age() const;
+
 private:
     renderer::gl::RenderTarget* const render_target;
+    bool const egl_buffer_age_supported;
 };
 
 class Renderer : public renderer::Renderer
@@ -65,6 +72,7 @@ public:
     // These are called with a valid GL context:
     void set_viewport(geometry::Rectangle const& rect) override;
     void set_output_transform(glm::mat2 const&) override;
+    void set_frame_damage(geometry::Rectangles const& damage) override;
     void render(graphics::RenderableList const&) const override;
 
     // This is called _without_ a GL context:
@@ -127,6 +135,11 @@ protected:
 
 private:
     void update_gl_viewport();
+    void scissor_to(geometry::Rectangle const& area) const;
+
+    /// The areas that need repainting to bring the back buffer up to date,
+    /// or nothing if the whole viewport needs repainting.
+    auto repair_areas() const -> std::experimental::optional<geometry::Rectangles>;
 
     class ProgramFactory;
     std::unique_ptr<ProgramFactory> const program_factory;
@@ -135,6 +148,12 @@ private:
     glm::mat4 screen_to_gl_coords;
     glm::mat4 display_transform;
     std::vector<mir::gl::Primitive> mutable primitives;
+
+    bool gl_viewport_is_one_to_one = false;
+    std::experimental::optional<geometry::Rectangles> mutable frame_damage;
+    std::experimental::optional<geometry::Rectangle> mutable repair_area;
+    /// Damage of previous frames, most recent first
+    std::deque<geometry::Rectangles> mutable damage_history;
 };
 
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_RENDERER_SW_KERNEL_IMPLEMENTATIONS_H_
+#define MIR_RENDERER_SW_KERNEL_IMPLEMENTATIONS_H_
+
+#include "mir/renderer/sw/pixel_kernels.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#define MIR_PIXEL_KERNELS_X86 1
+#endif
+
+// The NEON kernels work on deinterleaved bytes, so they rely on the alpha byte coming last
+#if defined(__ARM_NEON) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define MIR_PIXEL_KERNELS_NEON 1
+#endif
+
+namespace mir
+{
+namespace renderer
+{
+namespace software
+{
+namespace detail
+{
+/// Per-pixel operations of the scalar reference, also used for the tails of the vector kernels
+inline auto blend_a8_pixel(uint32_t dest, uint8_t mask, uint32_t color) -> uint32_t
+{
+    uint32_t const coverage = mask * (color >> 24) / 255;
+    uint32_t result = dest & 0xff000000u;
+    for (int shift = 0; shift != 24; shift += 8)
+    {
+        uint32_t const d = (dest >> shift) & 0xff;
+        uint32_t const c = (color >> shift) & 0xff;
+        result |= (d * (255 - coverage) / 255 + c * coverage / 255) << shift;
+    }
+    return result;
+}
+
+inline auto premultiply_pixel(uint32_t pixel) -> uint32_t
+{
+    uint32_t const alpha = pixel >> 24;
+    uint32_t result = pixel & 0xff000000u;
+    for (int shift = 0; shift != 24; shift += 8)
+        result |= ((((pixel >> shift) & 0xff) * alpha + 127) / 255) << shift;
+    return result;
+}
+
+inline auto swap_red_blue_pixel(uint32_t pixel) -> uint32_t
+{
+    return (pixel & 0xff00ff00u) | ((pixel >> 16) & 0xffu) | ((pixel & 0xffu) << 16);
+}
+
+inline auto over_pixel(uint32_t dest, uint32_t src, uint8_t alpha) -> uint32_t
+{
+    uint32_t const src_alpha = ((src >> 24) * alpha + 127) / 255;
+    uint32_t result = 0;
+    for (int shift = 0; shift != 32; shift += 8)
+    {
+        uint32_t const s = (((src >> shift) & 0xff) * alpha + 127) / 255;
+        uint32_t const d = (((dest >> shift) & 0xff) * (255 - src_alpha) + 127) / 255;
+        result |= (s + d < 255 ? s + d : 255) << shift;
+    }
+    return result;
+}
+
+void scalar_scale_nearest(uint32_t* dest, uint32_t const* src, uint32_t x, uint32_t step, size_t count);
+
+extern PixelKernels const scalar_kernels;
+#ifdef MIR_PIXEL_KERNELS_X86
+extern PixelKernels const sse2_kernels;
+extern PixelKernels const avx2_kernels;
+#endif
+#ifdef MIR_PIXEL_KERNELS_NEON
+extern PixelKernels const neon_kernels;
+#endif
+}
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_KERNEL_IMPLEMENTATIONS_H_
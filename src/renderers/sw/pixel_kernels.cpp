@@ -0,0 +1,100 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "kernel_implementations.h"
+
+namespace mrs = mir::renderer::software;
+namespace mrsd = mir::renderer::software::detail;
+
+namespace
+{
+void scalar_fill(uint32_t* dest, uint32_t color, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+        dest[i] = color;
+}
+
+void scalar_blend_a8(uint32_t* dest, uint8_t const* mask, uint32_t color, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+        dest[i] = mrsd::blend_a8_pixel(dest[i], mask[i], color);
+}
+
+void scalar_premultiply(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+        dest[i] = mrsd::premultiply_pixel(src[i]);
+}
+
+void scalar_swap_red_blue(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+        dest[i] = mrsd::swap_red_blue_pixel(src[i]);
+}
+
+void scalar_over(uint32_t* dest, uint32_t const* src, uint8_t alpha, size_t count)
+{
+    for (size_t i = 0; i != count; ++i)
+        dest[i] = mrsd::over_pixel(dest[i], src[i], alpha);
+}
+
+auto detect_kernels() -> std::vector<mrs::PixelKernels const*>
+{
+    std::vector<mrs::PixelKernels const*> kernels{&mrsd::scalar_kernels};
+
+#ifdef MIR_PIXEL_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        kernels.push_back(&mrsd::sse2_kernels);
+    if (__builtin_cpu_supports("avx2"))
+        kernels.push_back(&mrsd::avx2_kernels);
+#endif
+#ifdef MIR_PIXEL_KERNELS_NEON
+    kernels.push_back(&mrsd::neon_kernels);
+#endif
+
+    return kernels;
+}
+}
+
+// Only AVX2 has a gather; the other kernels share this
+void mrsd::scalar_scale_nearest(uint32_t* dest, uint32_t const* src, uint32_t x, uint32_t step, size_t count)
+{
+    for (size_t i = 0; i != count; ++i, x += step)
+        dest[i] = src[x >> 16];
+}
+
+mrs::PixelKernels const mrsd::scalar_kernels{
+    "scalar",
+    &scalar_fill,
+    &scalar_blend_a8,
+    &scalar_premultiply,
+    &scalar_swap_red_blue,
+    &scalar_over,
+    &scalar_scale_nearest};
+
+auto mrs::available_pixel_kernels() -> std::vector<PixelKernels const*>
+{
+    static auto const kernels = detect_kernels();
+    return kernels;
+}
+
+auto mrs::pixel_kernels() -> PixelKernels const&
+{
+    static auto const& best = *available_pixel_kernels().back();
+    return best;
+}
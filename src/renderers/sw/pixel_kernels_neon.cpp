@@ -0,0 +1,150 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "kernel_implementations.h"
+
+#ifdef MIR_PIXEL_KERNELS_NEON
+
+#include <arm_neon.h>
+
+namespace mrs = mir::renderer::software;
+namespace mrsd = mir::renderer::software::detail;
+
+namespace
+{
+/// x / 255 for each unsigned 16 bit lane where x < 65280, without a division
+inline auto div255(uint16x8_t x) -> uint16x8_t
+{
+    return vshrq_n_u16(vaddq_u16(vaddq_u16(x, vdupq_n_u16(1)), vshrq_n_u16(x, 8)), 8);
+}
+
+/// \a dest * (255 - \a coverage) / 255 + \a color * \a coverage / 255 for one channel of eight pixels
+inline auto blend(uint8x8_t dest, uint8x8_t color, uint8x8_t coverage) -> uint8x8_t
+{
+    return vmovn_u16(vaddq_u16(
+        div255(vmull_u8(dest, vsub_u8(vdup_n_u8(255), coverage))),
+        div255(vmull_u8(color, coverage))));
+}
+
+void neon_fill(uint32_t* dest, uint32_t color, size_t count)
+{
+    uint32x4_t const colors = vdupq_n_u32(color);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_u32(dest + i, colors);
+    for (; i != count; ++i)
+        dest[i] = color;
+}
+
+void neon_blend_a8(uint32_t* dest, uint8_t const* mask, uint32_t color, size_t count)
+{
+    uint8x8_t const blue = vdup_n_u8(color & 0xff);
+    uint8x8_t const green = vdup_n_u8((color >> 8) & 0xff);
+    uint8x8_t const red = vdup_n_u8((color >> 16) & 0xff);
+    uint8x8_t const color_alpha = vdup_n_u8(color >> 24);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8_t const mask8 = vld1_u8(mask + i);
+        if (!vget_lane_u64(vreinterpret_u64_u8(mask8), 0))
+            continue;   // Nothing covered, so nothing changes
+
+        uint8x8_t const coverage = vmovn_u16(div255(vmull_u8(mask8, color_alpha)));
+        uint8_t* const target = reinterpret_cast<uint8_t*>(dest + i);
+        uint8x8x4_t pixels = vld4_u8(target);
+        pixels.val[0] = blend(pixels.val[0], blue, coverage);
+        pixels.val[1] = blend(pixels.val[1], green, coverage);
+        pixels.val[2] = blend(pixels.val[2], red, coverage);
+        vst4_u8(target, pixels);
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::blend_a8_pixel(dest[i], mask[i], color);
+}
+
+void neon_premultiply(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    uint16x8_t const rounding = vdupq_n_u16(127);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        for (int channel = 0; channel != 3; ++channel)
+        {
+            pixels.val[channel] = vmovn_u16(div255(vaddq_u16(
+                vmull_u8(pixels.val[channel], pixels.val[3]),
+                rounding)));
+        }
+        vst4_u8(reinterpret_cast<uint8_t*>(dest + i), pixels);
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::premultiply_pixel(src[i]);
+}
+
+void neon_swap_red_blue(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        uint8x8_t const blue = pixels.val[0];
+        pixels.val[0] = pixels.val[2];
+        pixels.val[2] = blue;
+        vst4_u8(reinterpret_cast<uint8_t*>(dest + i), pixels);
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::swap_red_blue_pixel(src[i]);
+}
+
+void neon_over(uint32_t* dest, uint32_t const* src, uint8_t alpha, size_t count)
+{
+    uint8x8_t const alphas = vdup_n_u8(alpha);
+    uint16x8_t const rounding = vdupq_n_u16(127);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        uint8x8x4_t pixels = vld4_u8(reinterpret_cast<uint8_t const*>(src + i));
+        uint8_t* const target = reinterpret_cast<uint8_t*>(dest + i);
+        uint8x8x4_t under = vld4_u8(target);
+
+        for (int channel = 0; channel != 4; ++channel)
+            pixels.val[channel] = vmovn_u16(div255(vaddq_u16(vmull_u8(pixels.val[channel], alphas), rounding)));
+
+        uint8x8_t const remaining = vsub_u8(vdup_n_u8(255), pixels.val[3]);
+        for (int channel = 0; channel != 4; ++channel)
+        {
+            under.val[channel] = vqadd_u8(
+                pixels.val[channel],
+                vmovn_u16(div255(vaddq_u16(vmull_u8(under.val[channel], remaining), rounding))));
+        }
+        vst4_u8(target, under);
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::over_pixel(dest[i], src[i], alpha);
+}
+}
+
+mrs::PixelKernels const mrsd::neon_kernels{
+    "neon",
+    &neon_fill,
+    &neon_blend_a8,
+    &neon_premultiply,
+    &neon_swap_red_blue,
+    &neon_over,
+    &mrsd::scalar_scale_nearest};
+
+#endif
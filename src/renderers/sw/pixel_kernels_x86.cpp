@@ -0,0 +1,357 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "kernel_implementations.h"
+
+#ifdef MIR_PIXEL_KERNELS_X86
+
+#include <immintrin.h>
+
+namespace mrs = mir::renderer::software;
+namespace mrsd = mir::renderer::software::detail;
+
+// These are built without -msse2/-mavx2 so the rest of Mir keeps running on any CPU;
+// each function is compiled for its instruction set and only called once the CPU is
+// known to support it.
+#define MIR_SSE2 __attribute__((target("sse2")))
+#define MIR_AVX2 __attribute__((target("avx2")))
+
+namespace
+{
+/// x / 255 for each unsigned 16 bit lane, without a division
+MIR_SSE2 inline auto div255_sse2(__m128i x) -> __m128i
+{
+    return _mm_srli_epi16(_mm_mulhi_epu16(x, _mm_set1_epi16(static_cast<short>(0x8081))), 7);
+}
+
+MIR_AVX2 inline auto div255_avx2(__m256i x) -> __m256i
+{
+    return _mm256_srli_epi16(_mm256_mulhi_epu16(x, _mm256_set1_epi16(static_cast<short>(0x8081))), 7);
+}
+
+/// Blends two pixels widened to 16 bit channels; the alpha lanes of \a coverage must be zero
+MIR_SSE2 inline auto blend_sse2(__m128i dest, __m128i color, __m128i coverage) -> __m128i
+{
+    __m128i const inverse = _mm_sub_epi16(_mm_set1_epi16(255), coverage);
+    return _mm_add_epi16(
+        div255_sse2(_mm_mullo_epi16(dest, inverse)),
+        div255_sse2(_mm_mullo_epi16(color, coverage)));
+}
+
+MIR_SSE2 void sse2_fill(uint32_t* dest, uint32_t color, size_t count)
+{
+    __m128i const colors = _mm_set1_epi32(static_cast<int>(color));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), colors);
+    for (; i != count; ++i)
+        dest[i] = color;
+}
+
+MIR_SSE2 void sse2_blend_a8(uint32_t* dest, uint8_t const* mask, uint32_t color, size_t count)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const color_channels = _mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(color)), zero);
+    __m128i const color_alpha = _mm_set1_epi16(static_cast<short>(color >> 24));
+    __m128i const not_alpha = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t mask4;
+        __builtin_memcpy(&mask4, mask + i, sizeof mask4);
+        if (!mask4)
+            continue;   // Nothing covered, so nothing changes
+
+        // Coverage of the four pixels, scaled by the color's alpha
+        __m128i const coverage = div255_sse2(_mm_mullo_epi16(
+            _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(mask4)), zero),
+            color_alpha));
+        // ...repeated across each pixel's color channels
+        __m128i const pairs = _mm_unpacklo_epi16(coverage, coverage);
+        __m128i const coverage_lo = _mm_and_si128(_mm_unpacklo_epi32(pairs, pairs), not_alpha);
+        __m128i const coverage_hi = _mm_and_si128(_mm_unpackhi_epi32(pairs, pairs), not_alpha);
+
+        __m128i* const target = reinterpret_cast<__m128i*>(dest + i);
+        __m128i const pixels = _mm_loadu_si128(target);
+        __m128i const lo = blend_sse2(_mm_unpacklo_epi8(pixels, zero), color_channels, coverage_lo);
+        __m128i const hi = blend_sse2(_mm_unpackhi_epi8(pixels, zero), color_channels, coverage_hi);
+        _mm_storeu_si128(target, _mm_packus_epi16(lo, hi));
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::blend_a8_pixel(dest[i], mask[i], color);
+}
+
+/// Premultiplies two pixels widened to 16 bit channels
+MIR_SSE2 inline auto premultiply_sse2(__m128i pixels) -> __m128i
+{
+    // Multiply every channel by its pixel's alpha, except alpha itself which is multiplied by 255
+    __m128i const alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    __m128i const alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i const factor = _mm_or_si128(
+        _mm_andnot_si128(alpha_lanes, alpha),
+        _mm_and_si128(alpha_lanes, _mm_set1_epi16(255)));
+    return div255_sse2(_mm_add_epi16(_mm_mullo_epi16(pixels, factor), _mm_set1_epi16(127)));
+}
+
+MIR_SSE2 void sse2_premultiply(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    __m128i const zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        __m128i const lo = premultiply_sse2(_mm_unpacklo_epi8(pixels, zero));
+        __m128i const hi = premultiply_sse2(_mm_unpackhi_epi8(pixels, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), _mm_packus_epi16(lo, hi));
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::premultiply_pixel(src[i]);
+}
+
+MIR_SSE2 void sse2_swap_red_blue(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    __m128i const alpha_green = _mm_set1_epi32(static_cast<int>(0xff00ff00u));
+    __m128i const low_byte = _mm_set1_epi32(0xff);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        __m128i const swapped = _mm_or_si128(
+            _mm_and_si128(pixels, alpha_green),
+            _mm_or_si128(
+                _mm_and_si128(_mm_srli_epi32(pixels, 16), low_byte),
+                _mm_slli_epi32(_mm_and_si128(pixels, low_byte), 16)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), swapped);
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::swap_red_blue_pixel(src[i]);
+}
+
+/// Composites two premultiplied pixels widened to 16 bit channels over two others
+MIR_SSE2 inline auto over_sse2(__m128i dest, __m128i src, __m128i alpha) -> __m128i
+{
+    __m128i const rounding = _mm_set1_epi16(127);
+    __m128i const scaled = div255_sse2(_mm_add_epi16(_mm_mullo_epi16(src, alpha), rounding));
+    __m128i const src_alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(scaled, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m128i const remaining = div255_sse2(_mm_add_epi16(
+        _mm_mullo_epi16(dest, _mm_sub_epi16(_mm_set1_epi16(255), src_alpha)),
+        rounding));
+    return _mm_add_epi16(scaled, remaining);
+}
+
+MIR_SSE2 void sse2_over(uint32_t* dest, uint32_t const* src, uint8_t alpha, size_t count)
+{
+    __m128i const zero = _mm_setzero_si128();
+    __m128i const alpha_byte = _mm_set1_epi32(static_cast<int>(0xff000000u));
+    __m128i const alphas = _mm_set1_epi16(alpha);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        __m128i* const target = reinterpret_cast<__m128i*>(dest + i);
+
+        // Fully transparent pixels leave the destination as it is, and opaque ones replace it
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(pixels, zero)) == 0xffff)
+            continue;
+        if (alpha == 255 &&
+            _mm_movemask_epi8(_mm_cmpeq_epi32(_mm_and_si128(pixels, alpha_byte), alpha_byte)) == 0xffff)
+        {
+            _mm_storeu_si128(target, pixels);
+            continue;
+        }
+
+        __m128i const under = _mm_loadu_si128(target);
+        __m128i const lo = over_sse2(_mm_unpacklo_epi8(under, zero), _mm_unpacklo_epi8(pixels, zero), alphas);
+        __m128i const hi = over_sse2(_mm_unpackhi_epi8(under, zero), _mm_unpackhi_epi8(pixels, zero), alphas);
+        _mm_storeu_si128(target, _mm_packus_epi16(lo, hi));
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::over_pixel(dest[i], src[i], alpha);
+}
+
+MIR_AVX2 void avx2_fill(uint32_t* dest, uint32_t color, size_t count)
+{
+    __m256i const colors = _mm256_set1_epi32(static_cast<int>(color));
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), colors);
+    for (; i != count; ++i)
+        dest[i] = color;
+}
+
+/// Narrows four pixels of 16 bit channels back to bytes
+MIR_AVX2 inline auto pack_avx2(__m256i channels) -> __m128i
+{
+    // packus works within 128 bit lanes, leaving the pixels in qwords 0 and 2
+    return _mm256_castsi256_si128(_mm256_permute4x64_epi64(_mm256_packus_epi16(channels, channels), 0x08));
+}
+
+MIR_AVX2 void avx2_blend_a8(uint32_t* dest, uint8_t const* mask, uint32_t color, size_t count)
+{
+    __m256i const color_channels = _mm256_cvtepu8_epi16(_mm_set1_epi32(static_cast<int>(color)));
+    __m256i const color_alpha = _mm256_set1_epi16(static_cast<short>(color >> 24));
+    // Repeats each pixel's coverage across its color channels, and zeros it for alpha
+    __m128i const spread = _mm_set_epi8(-1, 3, 3, 3, -1, 2, 2, 2, -1, 1, 1, 1, -1, 0, 0, 0);
+    __m256i const full = _mm256_set1_epi16(255);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        uint32_t mask4;
+        __builtin_memcpy(&mask4, mask + i, sizeof mask4);
+        if (!mask4)
+            continue;   // Nothing covered, so nothing changes
+
+        __m256i const coverage = div255_avx2(_mm256_mullo_epi16(
+            _mm256_cvtepu8_epi16(_mm_shuffle_epi8(_mm_cvtsi32_si128(static_cast<int>(mask4)), spread)),
+            color_alpha));
+
+        __m128i* const target = reinterpret_cast<__m128i*>(dest + i);
+        __m256i const pixels = _mm256_cvtepu8_epi16(_mm_loadu_si128(target));
+        __m256i const blended = _mm256_add_epi16(
+            div255_avx2(_mm256_mullo_epi16(pixels, _mm256_sub_epi16(full, coverage))),
+            div255_avx2(_mm256_mullo_epi16(color_channels, coverage)));
+        _mm_storeu_si128(target, pack_avx2(blended));
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::blend_a8_pixel(dest[i], mask[i], color);
+}
+
+MIR_AVX2 void avx2_premultiply(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    // Multiply every channel by its pixel's alpha, except alpha itself which is multiplied by 255
+    __m128i const spread_alpha = _mm_set_epi8(-1, 15, 15, 15, -1, 11, 11, 11, -1, 7, 7, 7, -1, 3, 3, 3);
+    __m256i const opaque_alpha = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    __m256i const rounding = _mm256_set1_epi16(127);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i const pixels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(src + i));
+        __m256i const factor = _mm256_or_si256(
+            _mm256_cvtepu8_epi16(_mm_shuffle_epi8(pixels, spread_alpha)),
+            opaque_alpha);
+        __m256i const premultiplied = div255_avx2(_mm256_add_epi16(
+            _mm256_mullo_epi16(_mm256_cvtepu8_epi16(pixels), factor),
+            rounding));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), pack_avx2(premultiplied));
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::premultiply_pixel(src[i]);
+}
+
+MIR_AVX2 void avx2_swap_red_blue(uint32_t* dest, uint32_t const* src, size_t count)
+{
+    __m256i const swap = _mm256_set_epi8(
+        15, 12, 13, 14, 11, 8, 9, 10, 7, 4, 5, 6, 3, 0, 1, 2,
+        15, 12, 13, 14, 11, 8, 9, 10, 7, 4, 5, 6, 3, 0, 1, 2);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), _mm256_shuffle_epi8(pixels, swap));
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::swap_red_blue_pixel(src[i]);
+}
+
+/// Composites four premultiplied pixels widened to 16 bit channels over four others
+MIR_AVX2 inline auto over_avx2(__m256i dest, __m256i src, __m256i alpha) -> __m256i
+{
+    __m256i const rounding = _mm256_set1_epi16(127);
+    __m256i const scaled = div255_avx2(_mm256_add_epi16(_mm256_mullo_epi16(src, alpha), rounding));
+    __m256i const src_alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(scaled, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+    __m256i const remaining = div255_avx2(_mm256_add_epi16(
+        _mm256_mullo_epi16(dest, _mm256_sub_epi16(_mm256_set1_epi16(255), src_alpha)),
+        rounding));
+    return _mm256_add_epi16(scaled, remaining);
+}
+
+MIR_AVX2 void avx2_over(uint32_t* dest, uint32_t const* src, uint8_t alpha, size_t count)
+{
+    __m256i const zero = _mm256_setzero_si256();
+    __m256i const alpha_byte = _mm256_set1_epi32(static_cast<int>(0xff000000u));
+    __m256i const alphas = _mm256_set1_epi16(alpha);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i const pixels = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(src + i));
+        __m256i* const target = reinterpret_cast<__m256i*>(dest + i);
+
+        // Fully transparent pixels leave the destination as it is, and opaque ones replace it
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(pixels, zero)) == -1)
+            continue;
+        if (alpha == 255 &&
+            _mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_and_si256(pixels, alpha_byte), alpha_byte)) == -1)
+        {
+            _mm256_storeu_si256(target, pixels);
+            continue;
+        }
+
+        // Unpacking and packing both work within 128 bit lanes, so the pixels end up in order
+        __m256i const under = _mm256_loadu_si256(target);
+        __m256i const lo = over_avx2(_mm256_unpacklo_epi8(under, zero), _mm256_unpacklo_epi8(pixels, zero), alphas);
+        __m256i const hi = over_avx2(_mm256_unpackhi_epi8(under, zero), _mm256_unpackhi_epi8(pixels, zero), alphas);
+        _mm256_storeu_si256(target, _mm256_packus_epi16(lo, hi));
+    }
+    for (; i != count; ++i)
+        dest[i] = mrsd::over_pixel(dest[i], src[i], alpha);
+}
+
+MIR_AVX2 void avx2_scale_nearest(uint32_t* dest, uint32_t const* src, uint32_t x, uint32_t step, size_t count)
+{
+    __m256i const steps = _mm256_set1_epi32(static_cast<int>(step * 8));
+    __m256i positions = _mm256_add_epi32(
+        _mm256_set1_epi32(static_cast<int>(x)),
+        _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(step)), _mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0)));
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8, x += step * 8)
+    {
+        __m256i const pixels = _mm256_i32gather_epi32(
+            reinterpret_cast<int const*>(src),
+            _mm256_srli_epi32(positions, 16),
+            4);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i), pixels);
+        positions = _mm256_add_epi32(positions, steps);
+    }
+    mrsd::scalar_scale_nearest(dest + i, src, x, step, count - i);
+}
+}
+
+mrs::PixelKernels const mrsd::sse2_kernels{
+    "sse2",
+    &sse2_fill,
+    &sse2_blend_a8,
+    &sse2_premultiply,
+    &sse2_swap_red_blue,
+    &sse2_over,
+    &mrsd::scalar_scale_nearest};
+
+mrs::PixelKernels const mrsd::avx2_kernels{
+    "avx2",
+    &avx2_fill,
+    &avx2_blend_a8,
+    &avx2_premultiply,
+    &avx2_swap_red_blue,
+    &avx2_over,
+    &avx2_scale_nearest};
+
+#endif
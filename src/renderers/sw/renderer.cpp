@@ -0,0 +1,534 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#define MIR_LOG_COMPONENT "SoftwareRenderer"
+
+#include "renderer.h"
+#include "mir/renderer/sw/pixel_kernels.h"
+#include "mir/renderer/sw/pixel_source.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/graphics/buffer.h"
+#include "mir/graphics/display_buffer.h"
+#include "mir/log.h"
+#include "mir/report/timeline.h"
+
+#include <boost/throw_exception.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mrs = mir::renderer::software;
+namespace mr = mir::report;
+namespace geom = mir::geometry;
+
+namespace
+{
+// Beyond this we may as well repaint everything
+unsigned int const max_buffer_age = 4;
+
+auto target_of(mg::DisplayBuffer& display_buffer) -> mrs::RenderTarget&
+{
+    auto const target = dynamic_cast<mrs::RenderTarget*>(display_buffer.native_display_buffer());
+    if (!target)
+        BOOST_THROW_EXCEPTION(std::logic_error("DisplayBuffer does not support software rendering"));
+    return *target;
+}
+
+bool is_empty(geom::Rectangle const& area)
+{
+    return area.size.width.as_int() <= 0 || area.size.height.as_int() <= 0;
+}
+
+/// The 32 bit formats we can composite; anything else has to be converted by the client
+bool is_supported(MirPixelFormat format)
+{
+    switch (format)
+    {
+    case mir_pixel_format_argb_8888:
+    case mir_pixel_format_xrgb_8888:
+    case mir_pixel_format_abgr_8888:
+    case mir_pixel_format_xbgr_8888:
+        return true;
+    default:
+        return false;
+    }
+}
+
+auto pixel_source_of(mg::Buffer& buffer) -> mrs::PixelSource*
+{
+    if (!is_supported(buffer.pixel_format()))
+        return nullptr;
+    return dynamic_cast<mrs::PixelSource*>(buffer.native_buffer_base());
+}
+
+bool covered_by(geom::Rectangles const& region, geom::Rectangle const& area)
+{
+    for (auto const& rect : region)
+    {
+        if (rect.contains(area))
+            return true;
+    }
+    return false;
+}
+
+// Well beyond any screen, but leaving room to take one coordinate from another
+double const max_coordinate = 1 << 29;
+
+/// Where the pixels of a renderable with a transformation() come from. As in the GL renderer,
+/// the transformation is applied about the centre of the renderable's screen_position().
+class TransformedPosition
+{
+public:
+    TransformedPosition(glm::mat4 const& transformation, geom::Rectangle const& position)
+        : half_width{position.size.width.as_int() / 2.0},
+          half_height{position.size.height.as_int() / 2.0}
+    {
+        auto const centre_x = position.top_left.x.as_int() + half_width;
+        auto const centre_y = position.top_left.y.as_int() + half_height;
+
+        // Renderables are flat, so this is the projective map of their plane onto the screen
+        auto const& t = transformation;
+        double const m[3][3]{
+            {t[0][0], t[1][0], t[3][0] + centre_x},
+            {t[0][1], t[1][1], t[3][1] + centre_y},
+            {t[0][3], t[1][3], t[3][3]}};
+
+        for (int i = 0; i != 3; ++i)
+        {
+            for (int j = 0; j != 3; ++j)
+                forward[i][j] = m[i][j];
+        }
+
+        // The adjugate is as good as the inverse, as only the ratios of the results matter
+        for (int i = 0; i != 3; ++i)
+        {
+            for (int j = 0; j != 3; ++j)
+            {
+                inverse[j][i] =
+                    m[(i + 1) % 3][(j + 1) % 3] * m[(i + 2) % 3][(j + 2) % 3] -
+                    m[(i + 1) % 3][(j + 2) % 3] * m[(i + 2) % 3][(j + 1) % 3];
+            }
+        }
+
+        invertible = m[0][0] * inverse[0][0] + m[0][1] * inverse[1][0] + m[0][2] * inverse[2][0] != 0;
+    }
+
+    /// The screen area the renderable is drawn in. This is empty if the renderable is
+    /// squashed flat or any of it is behind the viewer, neither of which we try to draw.
+    auto bounds() const -> geom::Rectangle
+    {
+        if (!invertible)
+            return {};
+
+        double min_x{max_coordinate}, min_y{max_coordinate};
+        double max_x{-max_coordinate}, max_y{-max_coordinate};
+        for (auto const corner_x : {-half_width, half_width})
+        {
+            for (auto const corner_y : {-half_height, half_height})
+            {
+                auto const w = project(forward[2], corner_x, corner_y);
+                if (w <= 0)
+                    return {};
+
+                auto const x = project(forward[0], corner_x, corner_y) / w;
+                auto const y = project(forward[1], corner_x, corner_y) / w;
+                min_x = std::min(min_x, x);
+                min_y = std::min(min_y, y);
+                max_x = std::max(max_x, x);
+                max_y = std::max(max_y, y);
+            }
+        }
+
+        auto const clamp = [](double coordinate)
+            {
+                return static_cast<int>(std::min(std::max(coordinate, -max_coordinate), max_coordinate));
+            };
+        auto const left = clamp(std::floor(min_x));
+        auto const top = clamp(std::floor(min_y));
+        return {{left, top}, {clamp(std::ceil(max_x)) - left, clamp(std::ceil(max_y)) - top}};
+    }
+
+    /// Maps the centre of the screen pixel at (\a x, \a y) back onto the untransformed renderable,
+    /// relative to its top left. Returns false if the renderable isn't drawn there.
+    bool source_of(int x, int y, double& from_x, double& from_y) const
+    {
+        auto const h_x = project(inverse[0], x + 0.5, y + 0.5);
+        auto const h_y = project(inverse[1], x + 0.5, y + 0.5);
+        auto const h_w = project(inverse[2], x + 0.5, y + 0.5);
+        if (h_w == 0)
+            return false;
+
+        auto const offset_x = h_x / h_w;
+        auto const offset_y = h_y / h_w;
+        if (project(forward[2], offset_x, offset_y) <= 0)
+            return false;   // The point behind the viewer that projects to the same place
+
+        from_x = offset_x + half_width;
+        from_y = offset_y + half_height;
+        return 0 <= from_x && from_x < 2 * half_width && 0 <= from_y && from_y < 2 * half_height;
+    }
+
+private:
+    static auto project(double const (&row)[3], double x, double y) -> double
+    {
+        return row[0] * x + row[1] * y + row[2];
+    }
+
+    double const half_width;
+    double const half_height;
+    double forward[3][3];
+    double inverse[3][3];
+    bool invertible;
+};
+
+bool is_transformed(mg::Renderable const& renderable)
+{
+    return renderable.transformation() != glm::mat4(1);
+}
+
+/// The area of the screen the renderable is drawn in
+auto screen_bounds(mg::Renderable const& renderable) -> geom::Rectangle
+{
+    if (!is_transformed(renderable))
+        return renderable.screen_position();
+    return TransformedPosition{renderable.transformation(), renderable.screen_position()}.bounds();
+}
+
+/// True if nothing beneath the renderable shows through anywhere in \a area
+bool opaquely_covers(mg::Renderable const& renderable, geom::Rectangle const& area)
+{
+    if (renderable.alpha() < 1.0f || !renderable.screen_position().contains(area))
+        return false;
+
+    // A transformed renderable needn't cover its screen_position()
+    if (is_transformed(renderable))
+        return false;
+
+    auto const clip_area = renderable.clip_area();
+    if (clip_area && !clip_area.value().contains(area))
+        return false;
+
+    if (!pixel_source_of(*renderable.buffer()))
+        return false;   // We'll fail to draw it, so can't rely on it
+
+    return !renderable.shaped() || covered_by(renderable.opaque_region(), area);
+}
+}
+
+struct mrs::Renderer::Canvas
+{
+    RenderTarget::Pixels pixels;
+    /// The part of the screen the target shows
+    geom::Rectangle area;
+
+    auto row(int screen_y) const -> uint32_t*
+    {
+        auto const y = screen_y - area.top_left.y.as_int();
+        return reinterpret_cast<uint32_t*>(reinterpret_cast<unsigned char*>(pixels.data) + y * pixels.stride.as_int());
+    }
+
+    auto at(geom::Point screen_position) const -> uint32_t*
+    {
+        return row(screen_position.y.as_int()) + (screen_position.x.as_int() - area.top_left.x.as_int());
+    }
+};
+
+mrs::Renderer::Renderer(mg::DisplayBuffer& display_buffer)
+    : render_target(target_of(display_buffer)),
+      kernels(pixel_kernels())
+{
+    mir::log_info("Using %s pixel kernels", kernels.name);
+
+    set_viewport(display_buffer.view_area());
+}
+
+void mrs::Renderer::set_viewport(geom::Rectangle const& rect)
+{
+    if (rect == viewport)
+        return;
+
+    viewport = rect;
+
+    // Whatever is in the back buffers no longer lines up with what we draw
+    damage_history.clear();
+}
+
+void mrs::Renderer::set_output_transform(glm::mat2 const& transform)
+{
+    if (transform != glm::mat2(1) && !output_transform_warned)
+    {
+        mir::log_warning("Output transformations are not supported; the output will not be rotated");
+        output_transform_warned = true;
+    }
+}
+
+void mrs::Renderer::set_frame_damage(geom::Rectangles const& damage)
+{
+    frame_damage = damage;
+}
+
+auto mrs::Renderer::repair_areas() const -> std::experimental::optional<geom::Rectangles>
+{
+    if (!frame_damage)
+        return {};
+
+    auto const age = render_target.buffer_age();
+    if (age == 0 || age > damage_history.size() + 1)
+        return {};
+
+    std::vector<geom::Rectangle> stale;
+    auto const add_stale = [&](geom::Rectangle const& area)
+        {
+            auto const visible = area.intersection_with(viewport);
+            if (!is_empty(visible))
+                stale.push_back(visible);
+        };
+
+    for (auto const& area : *frame_damage)
+        add_stale(area);
+    for (auto frame = damage_history.begin(); frame != damage_history.begin() + (age - 1); ++frame)
+    {
+        for (auto const& area : *frame)
+            add_stale(area);
+    }
+
+    // Don't repaint the same pixels twice
+    geom::Rectangles result;
+    for (auto i = 0u; i != stale.size(); ++i)
+    {
+        bool covered = false;
+        for (auto j = 0u; j != stale.size() && !covered; ++j)
+            covered = (i != j) && stale[j].contains(stale[i]) && (stale[j] != stale[i] || j < i);
+
+        if (!covered)
+            result.add(stale[i]);
+    }
+
+    return result;
+}
+
+void mrs::Renderer::render(mg::RenderableList const& renderables) const
+{
+    mr::Timeline::Span const span{"render"};
+
+    auto const target_size = render_target.size();
+    Canvas const canvas{
+        render_target.back_buffer(),
+        geom::Rectangle{
+            viewport.top_left,
+            geom::Size{
+                std::min(viewport.size.width, target_size.width),
+                std::min(viewport.size.height, target_size.height)}}};
+
+    auto const fill = [&](geom::Rectangle const& area)
+        {
+            auto const width = area.size.width.as_int();
+            for (int y = area.top_left.y.as_int(); y != area.bottom_right().y.as_int(); ++y)
+                kernels.fill(canvas.at({area.top_left.x, y}), clear_color, width);
+        };
+
+    auto repair = repair_areas();
+    if (!repair)
+    {
+        repair = geom::Rectangles{canvas.area};
+
+        // Anything the viewport doesn't reach is a border
+        if (target_size != canvas.area.size)
+            fill(geom::Rectangle{canvas.area.top_left, target_size});
+    }
+
+    for (auto const& damaged : *repair)
+    {
+        auto const area = damaged.intersection_with(canvas.area);
+        if (is_empty(area))
+            continue;
+
+        // Nothing beneath the topmost renderable that opaquely covers the area shows through
+        auto first = renderables.begin();
+        bool covered = false;
+        for (auto r = renderables.rbegin(); r != renderables.rend() && !covered; ++r)
+        {
+            if (opaquely_covers(**r, area))
+            {
+                first = std::prev(r.base());
+                covered = true;
+            }
+        }
+
+        if (!covered)
+            fill(area);
+
+        for (auto r = first; r != renderables.end(); ++r)
+        {
+            if (screen_bounds(**r).overlaps(area))
+                draw(**r, area, canvas);
+        }
+    }
+
+    {
+        mr::Timeline::Span const span{"swap buffers"};
+        render_target.swap_buffers();
+    }
+
+    damage_history.push_front(frame_damage ? *frame_damage : geom::Rectangles{viewport});
+    if (damage_history.size() > max_buffer_age)
+        damage_history.pop_back();
+    frame_damage = std::experimental::nullopt;
+}
+
+void mrs::Renderer::draw(mg::Renderable const& renderable, geom::Rectangle const& area, Canvas const& canvas) const
+{
+    mr::Timeline::Span const span{"draw"};
+
+    auto const buffer = renderable.buffer();
+    auto const pixel_source = pixel_source_of(*buffer);
+    if (!pixel_source)
+    {
+        mir::log_error("Buffer does not support software rendering!");
+        return;
+    }
+
+    auto const position = renderable.screen_position();
+    auto const transformed = is_transformed(renderable);
+    TransformedPosition const transformed_position{renderable.transformation(), position};
+    auto visible = (transformed ? transformed_position.bounds() : position).intersection_with(area);
+    if (auto const clip_area = renderable.clip_area())
+        visible = visible.intersection_with(clip_area.value());
+    if (is_empty(visible))
+        return;
+
+    auto const format = buffer->pixel_format();
+    auto const buffer_size = buffer->size();
+    auto const src_bounds = renderable.src_bounds().intersection_with({{}, buffer_size});
+    if (is_empty(src_bounds))
+        return;
+
+    auto const width = visible.size.width.as_int();
+    auto const height = visible.size.height.as_int();
+    auto const offset_x = visible.top_left.x.as_int() - position.top_left.x.as_int();
+    auto const offset_y = visible.top_left.y.as_int() - position.top_left.y.as_int();
+    auto const stride = pixel_source->stride().as_int() ?
+        pixel_source->stride().as_int() :
+        buffer_size.width.as_int() * MIR_BYTES_PER_PIXEL(format);
+
+    // Nearest neighbour sampling at pixel centres, in 16.16 fixed point
+    bool const scaled = src_bounds.size != position.size;
+    uint32_t const step_x = (uint64_t(src_bounds.size.width.as_int()) << 16) / position.size.width.as_int();
+    uint32_t const step_y = (uint64_t(src_bounds.size.height.as_int()) << 16) / position.size.height.as_int();
+    auto const src_left = src_bounds.top_left.x.as_int();
+    auto const src_top = src_bounds.top_left.y.as_int();
+    uint32_t const first_x = offset_x * step_x + step_x / 2;
+
+    bool const swap_red_blue = format == mir_pixel_format_abgr_8888 || format == mir_pixel_format_xbgr_8888;
+    bool const opaque =
+        !renderable.shaped() ||
+        format == mir_pixel_format_xrgb_8888 || format == mir_pixel_format_xbgr_8888 ||
+        (!transformed && covered_by(renderable.opaque_region(), visible));
+    auto const alpha = static_cast<uint8_t>(std::lround(std::min(std::max(renderable.alpha(), 0.0f), 1.0f) * 255));
+
+    // Composites a row of the renderable's pixels, which may be in (and may be overwritten in) row
+    auto const blend = [&](uint32_t* dest, uint32_t const* src, int count)
+        {
+            if (swap_red_blue)
+            {
+                kernels.swap_red_blue(row.data(), src, count);
+                src = row.data();
+            }
+
+            if (opaque && alpha == 255)
+            {
+                memcpy(dest, src, count * sizeof *dest);
+            }
+            else
+            {
+                if (opaque)
+                {
+                    // The alpha channel may be uninitialized, so must not be used
+                    for (int x = 0; x != count; ++x)
+                        row[x] = src[x] | 0xff000000u;
+                    src = row.data();
+                }
+                kernels.over(dest, src, alpha, count);
+            }
+        };
+
+    row.resize(width);
+    if (transformed)
+    {
+        auto const position_width = position.size.width.as_int();
+        auto const position_height = position.size.height.as_int();
+        auto const src_width = src_bounds.size.width.as_int();
+        auto const src_height = src_bounds.size.height.as_int();
+        auto const left = visible.top_left.x.as_int();
+
+        pixel_source->read([&](unsigned char const* pixels)
+            {
+                // Gather each run of pixels the renderable is drawn in, then composite it
+                for (int y = visible.top_left.y.as_int(); y != visible.bottom_right().y.as_int(); ++y)
+                {
+                    int run{0};
+                    for (int x = left; x != left + width + 1; ++x)
+                    {
+                        double from_x, from_y;
+                        if (x != left + width && transformed_position.source_of(x, y, from_x, from_y))
+                        {
+                            auto const buffer_x = src_left +
+                                std::min(static_cast<int>(from_x * src_width / position_width), src_width - 1);
+                            auto const buffer_y = src_top +
+                                std::min(static_cast<int>(from_y * src_height / position_height), src_height - 1);
+                            row[run++] = reinterpret_cast<uint32_t const*>(pixels + buffer_y * stride)[buffer_x];
+                        }
+                        else if (run)
+                        {
+                            blend(canvas.at({x - run, y}), row.data(), run);
+                            run = 0;
+                        }
+                    }
+                }
+            });
+        return;
+    }
+
+    pixel_source->read([&](unsigned char const* pixels)
+        {
+            for (int y = 0; y != height; ++y)
+            {
+                auto const buffer_y = src_top + (scaled ?
+                    ((offset_y + y) * step_y + step_y / 2) >> 16 :
+                    uint32_t(offset_y + y));
+                auto src = reinterpret_cast<uint32_t const*>(pixels + buffer_y * stride) + src_left;
+                auto const dest = canvas.at({visible.top_left.x, visible.top_left.y.as_int() + y});
+
+                if (scaled)
+                {
+                    kernels.scale_nearest(row.data(), src, first_x, step_x, width);
+                    src = row.data();
+                }
+                else
+                {
+                    src += offset_x;
+                }
+
+                blend(dest, src, width);
+            }
+        });
+}
+
+void mrs::Renderer::suspend()
+{
+    damage_history.clear();
+}
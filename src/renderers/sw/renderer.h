@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MIR_RENDERER_SW_RENDERER_H_
+#define MIR_RENDERER_SW_RENDERER_H_
+
+#include "mir/renderer/renderer.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+#include "mir/graphics/renderable.h"
+
+#include <deque>
+#include <experimental/optional>
+#include <vector>
+
+namespace mir
+{
+namespace graphics { class DisplayBuffer; }
+namespace renderer
+{
+namespace software
+{
+class RenderTarget;
+struct PixelKernels;
+
+/// Composites buffers that expose their pixels (see PixelSource) on the CPU
+///
+/// Renderables use nearest neighbour sampling, whether scaled or transformed (see
+/// Renderable::transformation()). The output transform is ignored.
+class Renderer : public renderer::Renderer
+{
+public:
+    Renderer(graphics::DisplayBuffer& display_buffer);
+
+    void set_viewport(geometry::Rectangle const& rect) override;
+    void set_output_transform(glm::mat2 const&) override;
+    void set_frame_damage(geometry::Rectangles const& damage) override;
+    void render(graphics::RenderableList const&) const override;
+    void suspend() override;
+
+private:
+    struct Canvas;
+
+    void draw(graphics::Renderable const& renderable, geometry::Rectangle const& area, Canvas const& canvas) const;
+
+    /// The areas that need repainting to bring the back buffer up to date,
+    /// or nothing if the whole viewport needs repainting.
+    auto repair_areas() const -> std::experimental::optional<geometry::Rectangles>;
+
+    RenderTarget& render_target;
+    PixelKernels const& kernels;
+    uint32_t const clear_color{0xff000000};
+
+    geometry::Rectangle viewport;
+    bool output_transform_warned{false};
+    std::experimental::optional<geometry::Rectangles> mutable frame_damage;
+    /// Damage of previous frames, most recent first
+    std::deque<geometry::Rectangles> mutable damage_history;
+    /// Scratch space for converting a row of a renderable
+    std::vector<uint32_t> mutable row;
+};
+
+}
+}
+}
+
+#endif // MIR_RENDERER_SW_RENDERER_H_
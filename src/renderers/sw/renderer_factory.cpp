@@ -0,0 +1,38 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "renderer_factory.h"
+#include "renderer.h"
+#include "mir/renderer/sw/render_target.h"
+#include "mir/renderer/gl/render_target.h"
+#include "mir/graphics/display_buffer.h"
+
+namespace mrs = mir::renderer::software;
+
+mrs::RendererFactory::RendererFactory(std::shared_ptr<renderer::RendererFactory> const& fallback)
+    : fallback{fallback}
+{
+}
+
+std::unique_ptr<mir::renderer::Renderer>
+mrs::RendererFactory::create_renderer_for(
+    graphics::DisplayBuffer& display_buffer)
+{
+    auto const native = display_buffer.native_display_buffer();
+    if (dynamic_cast<RenderTarget*>(native) && !dynamic_cast<gl::RenderTarget*>(native))
+        return std::make_unique<Renderer>(display_buffer);
+
+    return fallback->create_renderer_for(display_buffer);
+}
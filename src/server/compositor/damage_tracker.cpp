@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "damage_tracker.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace geom = mir::geometry;
+
+namespace
+{
+glm::mat4 const identity(1);
+
+auto visible_area_of(mg::Renderable const& renderable) -> geom::Rectangle
+{
+    auto area = renderable.screen_position();
+    if (auto const clip = renderable.clip_area())
+        area = area.intersection_with(clip.value());
+    return area;
+}
+}
+
+mc::DamageTracker::DamageTracker() :
+    last_transformation(1)
+{
+}
+
+auto mc::DamageTracker::damage_for(
+    mg::RenderableList const& renderables,
+    geom::Rectangle const& view_area,
+    glm::mat2 const& transformation) -> geom::Rectangles
+{
+    std::vector<RenderedState> this_frame;
+    this_frame.reserve(renderables.size());
+    for (auto const& renderable : renderables)
+    {
+        this_frame.push_back(RenderedState{
+            renderable->id(),
+            visible_area_of(*renderable),
+            renderable->alpha(),
+            renderable->transformation(),
+            renderable->shaped()});
+    }
+
+    bool everything =
+        !last_view_area ||
+        last_view_area.value() != view_area ||
+        last_transformation != transformation;
+
+    geom::Rectangles damage;
+
+    if (!everything)
+    {
+        std::unordered_map<mg::Renderable::ID, RenderedState const*> previous;
+        for (auto const& state : last_frame)
+            previous[state.id] = &state;
+
+        std::vector<mg::Renderable::ID> surviving;
+        for (auto i = 0u; i != this_frame.size() && !everything; ++i)
+        {
+            auto const& now = this_frame[i];
+
+            // We can't easily bound the effect of an arbitrary transformation
+            if (now.transformation != identity)
+            {
+                everything = true;
+                break;
+            }
+
+            auto const before = previous.find(now.id);
+            if (before == previous.end())
+            {
+                damage.add(now.area);
+                continue;
+            }
+
+            auto const& then = *before->second;
+            surviving.push_back(now.id);
+
+            if (then.area != now.area || then.alpha != now.alpha || then.shaped != now.shaped)
+            {
+                damage.add(then.area);
+                damage.add(now.area);
+            }
+            else
+            {
+                for (auto const& rect : renderables[i]->damage())
+                    damage.add(rect.intersection_with(now.area));
+            }
+        }
+
+        std::vector<mg::Renderable::ID> surviving_before;
+        for (auto const& then : last_frame)
+        {
+            if (then.transformation != identity)
+            {
+                everything = true;
+            }
+            else if (std::none_of(this_frame.begin(), this_frame.end(),
+                                  [&then](RenderedState const& now) { return now.id == then.id; }))
+            {
+                damage.add(then.area);
+            }
+            else
+            {
+                surviving_before.push_back(then.id);
+            }
+        }
+
+        // Anything restacked from the first point of difference may now look different
+        if (!everything && surviving != surviving_before)
+        {
+            auto const first_difference = std::mismatch(
+                surviving.begin(), surviving.end(), surviving_before.begin()).first;
+
+            for (auto i = first_difference; i != surviving.end(); ++i)
+                damage.add(previous[*i]->area);
+        }
+    }
+
+    last_frame = std::move(this_frame);
+    last_view_area = view_area;
+    last_transformation = transformation;
+
+    if (everything)
+        return {view_area};
+
+    geom::Rectangles clipped;
+    for (auto const& rect : damage)
+    {
+        auto const on_screen = rect.intersection_with(view_area);
+        if (on_screen.size.width.as_int() > 0 && on_screen.size.height.as_int() > 0)
+            clipped.add(on_screen);
+    }
+    return clipped;
+}
+
+void mc::DamageTracker::invalidate()
+{
+    last_frame.clear();
+    last_view_area = std::experimental::nullopt;
+}
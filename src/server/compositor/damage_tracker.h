@@ -0,0 +1,69 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+#define MIR_COMPOSITOR_DAMAGE_TRACKER_H_
+
+#include "mir/graphics/renderable.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/geometry/rectangles.h"
+
+#include <glm/glm.hpp>
+#include <experimental/optional>
+#include <vector>
+
+namespace mir
+{
+namespace compositor
+{
+
+/**
+ * Works out which parts of a display buffer need repainting by comparing
+ * each frame's renderables with those of the previous frame.
+ */
+class DamageTracker
+{
+public:
+    DamageTracker();
+
+    /// The region (in screen coordinates) that differs from the last frame
+    auto damage_for(
+        graphics::RenderableList const& renderables,
+        geometry::Rectangle const& view_area,
+        glm::mat2 const& transformation) -> geometry::Rectangles;
+
+    /// Forget the last frame (e.g. because it was not rendered by us)
+    void invalidate();
+
+private:
+    struct RenderedState
+    {
+        graphics::Renderable::ID id;
+        geometry::Rectangle area;
+        float alpha;
+        glm::mat4 transformation;
+        bool shaped;
+    };
+
+    std::vector<RenderedState> last_frame;
+    std::experimental::optional<geometry::Rectangle> last_view_area;
+    glm::mat2 last_transformation;
+};
+
+}
+}
+
+#endif /* MIR_COMPOSITOR_DAMAGE_TRACKER_H_ */
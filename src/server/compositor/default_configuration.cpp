@@ -23,6 +23,7 @@
 #include "default_display_buffer_compositor_factory.h"
 #include "multi_threaded_compositor.h"
 #include "gl/renderer_factory.h"
+#include "sw/renderer_factory.h"
 #include "compositing_screencast.h"
 #include "mir/main_loop.h"
 
@@ -88,7 +89,9 @@ std::shared_ptr<mir::renderer::RendererFactory> mir::DefaultServerConfiguration:
     return renderer_factory(
         []()
         {
-            return std::make_shared<mir::renderer::gl::RendererFactory>();
+            // Display buffers that can't do GL are composited in software
+            return std::make_shared<mir::renderer::software::RendererFactory>(
+                std::make_shared<mir::renderer::gl::RendererFactory>());
         });
 }
 
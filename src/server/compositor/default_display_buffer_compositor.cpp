@@ -26,6 +26,7 @@
 #include "mir/graphics/buffer.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/renderer/renderer.h"
+#include "mir/report/timeline.h"
 #include "occlusion.h"
 #include <mutex>
 #include <cstdlib>
@@ -33,6 +34,7 @@
 
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
+namespace mr = mir::report;
 
 mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
     mg::DisplayBuffer& display_buffer,
@@ -46,13 +48,17 @@ mc::DefaultDisplayBufferCompositor::DefaultDisplayBufferCompositor(
 
 void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& scene_elements)
 {
+    mr::Timeline::Span const span{"composite"};
     report->began_frame(this);
 
     auto const& view_area = display_buffer.view_area();
-    auto const& occlusions = mc::filter_occlusions_from(scene_elements, view_area);
+    {
+        mr::Timeline::Span const span{"occlusion"};
+        auto const& occlusions = mc::filter_occlusions_from(scene_elements, view_area);
 
-    for (auto const& element : occlusions)
-        element->occluded();
+        for (auto const& element : occlusions)
+            element->occluded();
+    }
 
     mg::RenderableList renderable_list;
     renderable_list.reserve(scene_elements.size());
@@ -72,17 +78,29 @@ void mc::DefaultDisplayBufferCompositor::composite(mc::SceneElementSequence&& sc
      */
     scene_elements.clear();  // Those in use are still in renderable_list
 
-    if (display_buffer.overlay(renderable_list))
+    auto const overlaid = [&]
+        {
+            mr::Timeline::Span const span{"overlay"};
+            return display_buffer.overlay(renderable_list);
+        }();
+
+    if (overlaid)
     {
         report->renderables_in_frame(this, renderable_list);
         renderer->suspend();
+        damage_tracker.invalidate();
     }
     else
     {
-        renderer->set_output_transform(display_buffer.transformation());
+        auto const transformation = display_buffer.transformation();
+        auto const damage = damage_tracker.damage_for(renderable_list, view_area, transformation);
+
+        renderer->set_output_transform(transformation);
         renderer->set_viewport(view_area);
+        renderer->set_frame_damage(damage);
         renderer->render(renderable_list);
 
+        report->damage_in_frame(this, damage);
         report->renderables_in_frame(this, renderable_list);
         report->rendered_frame(this);
 
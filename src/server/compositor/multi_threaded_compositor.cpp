@@ -31,6 +31,7 @@
 #include "mir/raii.h"
 #include "mir/unwind_helpers.h"
 #include "mir/thread_name.h"
+#include "mir/report/timeline.h"
 
 #include <thread>
 #include <chrono>
@@ -42,6 +43,7 @@ using namespace std::literals::chrono_literals;
 namespace mc = mir::compositor;
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
+namespace mr = mir::report;
 
 namespace mir
 {
@@ -75,12 +77,16 @@ public:
     {
         mir::set_thread_name("Mir/Comp");
 
-        std::vector<std::tuple<mg::DisplayBuffer*, std::unique_ptr<mc::DisplayBufferCompositor>>> compositors;
+        /* The scene element sequence of each display is reused frame after frame */
+        std::vector<std::tuple<
+            mg::DisplayBuffer*,
+            std::unique_ptr<mc::DisplayBufferCompositor>,
+            mc::SceneElementSequence>> compositors;
         group.for_each_display_buffer(
         [this, &compositors](mg::DisplayBuffer& buffer)
         {
             compositors.emplace_back(
-                std::make_tuple(&buffer, compositor_factory->create_compositor_for(buffer)));
+                std::make_tuple(&buffer, compositor_factory->create_compositor_for(buffer), mc::SceneElementSequence{}));
 
             auto const& r = buffer.view_area();
             auto const comp_id = std::get<1>(compositors.back()).get();
@@ -116,7 +122,10 @@ public:
             while (running)
             {
                 /* Wait until compositing has been scheduled or we are stopped */
-                run_cv.wait(lock, [&]{ return (frames_scheduled > 0) || !running; });
+                {
+                    mr::Timeline::Span const span{"wait for frame"};
+                    run_cv.wait(lock, [&]{ return (frames_scheduled > 0) || !running; });
+                }
 
                 /*
                  * Check if we are running before compositing, since we may have
@@ -138,9 +147,19 @@ public:
                     for (auto& tuple : compositors)
                     {
                         auto& compositor = std::get<1>(tuple);
-                        compositor->composite(scene->scene_elements_for(compositor.get()));
+                        auto& scene_elements = std::get<2>(tuple);
+                        {
+                            mr::Timeline::Span const span{"scene snapshot"};
+                            scene->fill_scene_elements(compositor.get(), scene_elements);
+                        }
+                        compositor->composite(std::move(scene_elements));
+                        scene_elements.clear();  // Don't hold buffers until the next frame
+                    }
+
+                    {
+                        mr::Timeline::Span const span{"post"};
+                        group.post();
                     }
-                    group.post();
 
                     /*
                      * "Predictive bypass" optimization: If the last frame was
@@ -151,7 +170,10 @@ public:
                      */
                     auto delay = force_sleep >= std::chrono::milliseconds::zero() ?
                                  force_sleep : group.recommended_sleep();
-                    std::this_thread::sleep_for(delay);
+                    {
+                        mr::Timeline::Span const span{"predictive sleep"};
+                        std::this_thread::sleep_for(delay);
+                    }
 
                     lock.lock();
 
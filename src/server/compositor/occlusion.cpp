@@ -17,11 +17,12 @@
  */
 
 #include "mir/geometry/rectangle.h"
+#include "mir/geometry/region.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "occlusion.h"
 
-#include <vector>
+#include <algorithm>
 
 using namespace mir::geometry;
 using namespace mir::graphics;
@@ -29,37 +30,69 @@ using namespace mir::compositor;
 
 namespace
 {
-bool renderable_is_occluded(
-    Renderable const& renderable, 
-    Rectangle const& area,
-    std::vector<Rectangle>& coverage)
+/// Narrows the clip area of a renderable to the part of it left visible
+class ClippedRenderable : public Renderable
 {
-    static glm::mat4 const identity(1);
-    static Rectangle const empty{};
-
-    if (renderable.transformation() != identity)
-        return false;  // Weirdly transformed. Assume never occluded.
+public:
+    ClippedRenderable(std::shared_ptr<Renderable> const& renderable, Rectangle const& visible)
+        : renderable{renderable},
+          clip{renderable->clip_area() ? renderable->clip_area().value().intersection_with(visible) : visible}
+    {
+    }
 
-    auto const& window = renderable.screen_position();
-    auto const& clipped_window = window.intersection_with(area);
+    ID id() const override { return renderable->id(); }
+    std::shared_ptr<Buffer> buffer() const override { return renderable->buffer(); }
+    Rectangle screen_position() const override { return renderable->screen_position(); }
+    Rectangle src_bounds() const override { return renderable->src_bounds(); }
+    std::experimental::optional<Rectangle> clip_area() const override { return clip; }
+    Rectangles damage() const override { return renderable->damage(); }
+    float alpha() const override { return renderable->alpha(); }
+    glm::mat4 transformation() const override { return renderable->transformation(); }
+    bool shaped() const override { return renderable->shaped(); }
+    Rectangles opaque_region() const override { return renderable->opaque_region(); }
+    unsigned int swap_interval() const override { return renderable->swap_interval(); }
 
-    if (clipped_window == empty)
-        return true;  // Not in the area; definitely occluded.
+private:
+    std::shared_ptr<Renderable> const renderable;
+    Rectangle const clip;
+};
 
-    bool occluded = false;
-    for (auto const& r : coverage)
+class ClippedSceneElement : public SceneElement
+{
+public:
+    ClippedSceneElement(std::shared_ptr<SceneElement> const& element, Rectangle const& visible)
+        : element{element},
+          clipped{std::make_shared<ClippedRenderable>(element->renderable(), visible)}
     {
-        if (r.contains(clipped_window))
-        {
-            occluded = true;
-            break;
-        }
     }
 
-    if (!occluded && renderable.alpha() == 1.0f && !renderable.shaped())
-        coverage.push_back(clipped_window);
+    std::shared_ptr<Renderable> renderable() const override { return clipped; }
+    void rendered() override { element->rendered(); }
+    void occluded() override { element->occluded(); }
 
-    return occluded;
+private:
+    std::shared_ptr<SceneElement> const element;
+    std::shared_ptr<Renderable> const clipped;
+};
+
+void add_opaque_parts(Renderable const& renderable, Rectangle const& window, Rectangle const& area, Region& coverage)
+{
+    if (renderable.alpha() != 1.0f)
+        return;
+
+    // Nothing outside the clip area gets drawn, so it can't cover anything
+    auto const drawn = renderable.clip_area() ? renderable.clip_area().value().intersection_with(area) : area;
+
+    if (!renderable.shaped())
+    {
+        coverage.add(window.intersection_with(drawn));
+    }
+    else
+    {
+        // Translucent formats still cover whatever the client says is opaque
+        for (auto const& opaque : renderable.opaque_region())
+            coverage.add(opaque.intersection_with(drawn));
+    }
 }
 }
 
@@ -67,23 +100,54 @@ SceneElementSequence mir::compositor::filter_occlusions_from(
     SceneElementSequence& elements,
     Rectangle const& area)
 {
+    static glm::mat4 const identity(1);
+
     SceneElementSequence occluded;
-    std::vector<Rectangle> coverage;
+    SceneElementSequence visible;
+    visible.reserve(elements.size());
+    Region coverage;
 
-    auto it = elements.rbegin();
-    while (it != elements.rend())
+    // Walk from the top, subtracting what's already covered from each element
+    for (auto it = elements.rbegin(); it != elements.rend(); ++it)
     {
         auto const renderable = (*it)->renderable();
-        if (renderable_is_occluded(*renderable, area, coverage))
+
+        if (renderable->transformation() != identity)
         {
-            occluded.insert(occluded.begin(), *it);
-            it = SceneElementSequence::reverse_iterator(elements.erase(std::prev(it.base())));
+            // Weirdly transformed. Assume never occluded, and covering nothing.
+            visible.push_back(*it);
+            continue;
         }
-        else
+
+        auto const window = renderable->screen_position().intersection_with(area);
+
+        if (coverage.contains(window))
         {
-            it++;
+            occluded.push_back(*it);
+            continue;
         }
+
+        Region visible_region{window};
+        visible_region.subtract(coverage);
+
+        if (visible_region.is_empty())
+        {
+            occluded.push_back(*it);
+            continue;
+        }
+
+        auto const visible_bounds = visible_region.bounding_rectangle();
+        if (visible_bounds != window)
+            visible.push_back(std::make_shared<ClippedSceneElement>(*it, visible_bounds));
+        else
+            visible.push_back(*it);
+
+        add_opaque_parts(*renderable, window, area, coverage);
     }
 
+    std::reverse(visible.begin(), visible.end());
+    std::reverse(occluded.begin(), occluded.end());
+    elements = std::move(visible);
+
     return occluded;
 }
@@ -27,7 +27,22 @@ namespace mc = mir::compositor;
 namespace geom = mir::geometry;
 namespace mg = mir::graphics;
 namespace ms = mir::scene;
-namespace geom = mir::geometry;
+
+namespace
+{
+// Enough history to cover the buffers a client can have in flight
+auto const max_submission_history = 8u;
+
+auto whole_of(geom::Size const& size) -> geom::Rectangles
+{
+    return {geom::Rectangle{{}, size}};
+}
+
+auto whole_of(mg::Buffer const& buffer) -> geom::Rectangles
+{
+    return whole_of(buffer.size());
+}
+}
 
 enum class mc::Stream::ScheduleMode {
     Queueing,
@@ -42,6 +57,7 @@ mc::Stream::Stream(
     size(size),
     pf(pf),
     first_frame_posted(false),
+    next_serial{1},
     frame_callback{[](auto){}}
 {
 }
@@ -49,12 +65,42 @@ mc::Stream::Stream(
 mc::Stream::~Stream() = default;
 
 void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer)
+{
+    if (!buffer)
+        BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
+
+    submit_buffer(buffer, whole_of(*buffer));
+}
+
+void mc::Stream::submit_buffer(std::shared_ptr<mg::Buffer> const& buffer, geom::Rectangles const& damage)
 {
     if (!buffer)
         BOOST_THROW_EXCEPTION(std::invalid_argument("cannot submit null buffer"));
 
     {
         std::lock_guard<decltype(mutex)> lk(mutex); 
+
+        geom::Rectangles buffer_damage;
+        if (first_frame_posted && buffer->size() == size)
+        {
+            geom::Rectangle const buffer_rect{{}, buffer->size()};
+            for (auto const& rect : damage)
+            {
+                auto const clipped = rect.intersection_with(buffer_rect);
+                if (clipped.size.width.as_int() > 0 && clipped.size.height.as_int() > 0)
+                    buffer_damage.add(clipped);
+            }
+        }
+        else
+        {
+            // A new size invalidates everything
+            buffer_damage = whole_of(*buffer);
+        }
+
+        submissions.push_back({next_serial++, buffer->id(), std::move(buffer_damage)});
+        if (submissions.size() > max_submission_history)
+            submissions.pop_front();
+
         first_frame_posted = true;
         pf = buffer->pixel_format();
         size = buffer->size();
@@ -87,7 +133,72 @@ void mc::Stream::set_frame_posted_callback(
 
 std::shared_ptr<mg::Buffer> mc::Stream::lock_compositor_buffer(void const* id)
 {
-    return arbiter->compositor_acquire(id);
+    auto const buffer = arbiter->compositor_acquire(id);
+
+    std::lock_guard<decltype(mutex)> lk(mutex);
+    update_damage_for(id, *buffer, lk);
+
+    return buffer;
+}
+
+void mc::Stream::update_damage_for(void const* user_id, mg::Buffer const& buffer, std::lock_guard<std::mutex> const&)
+{
+    auto const user = user_damage.find(user_id);
+
+    if (user != user_damage.end())
+    {
+        auto& record = user->second;
+
+        if (record.buffer == buffer.id())
+        {
+            // Same buffer as last time: nothing has changed
+            record.damage.clear();
+            return;
+        }
+
+        // We can only accumulate damage if we still have every submission since the last one user_id saw
+        if (!submissions.empty() && submissions.front().serial <= record.serial + 1)
+        {
+            geom::Rectangles accumulated;
+            for (auto const& submission : submissions)
+            {
+                if (submission.serial <= record.serial)
+                    continue;
+
+                for (auto const& rect : submission.damage)
+                    accumulated.add(rect);
+
+                if (submission.buffer == buffer.id())
+                {
+                    record = UserDamage{submission.serial, submission.buffer, std::move(accumulated)};
+                    return;
+                }
+            }
+        }
+    }
+
+    auto serial = next_serial - 1;
+    for (auto i = submissions.rbegin(); i != submissions.rend(); ++i)
+    {
+        if (i->buffer == buffer.id())
+        {
+            serial = i->serial;
+            break;
+        }
+    }
+
+    user_damage[user_id] = UserDamage{serial, buffer.id(), whole_of(buffer)};
+}
+
+auto mc::Stream::damage_for(void const* user_id) const -> geom::Rectangles
+{
+    std::lock_guard<decltype(mutex)> lk(mutex);
+
+    auto const user = user_damage.find(user_id);
+    if (user == user_damage.end())
+        return whole_of(size);
+
+    return user->second.damage;
 }
 
 geom::Size mc::Stream::stream_size()
@@ -25,10 +25,13 @@
 #include "mir/frontend/buffer_stream_id.h"
 #include "mir/lockable_callback.h"
 #include "mir/geometry/size.h"
+#include "mir/geometry/rectangles.h"
 #include "multi_monitor_arbiter.h"
 #include <mutex>
 #include <memory>
 #include <set>
+#include <deque>
+#include <unordered_map>
 
 namespace mir
 {
@@ -43,6 +46,9 @@ public:
     ~Stream();
 
     void submit_buffer(std::shared_ptr<graphics::Buffer> const& buffer) override;
+    void submit_buffer(
+        std::shared_ptr<graphics::Buffer> const& buffer,
+        geometry::Rectangles const& damage) override;
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& exec) override;
     MirPixelFormat pixel_format() const override;
     void set_frame_posted_callback(
@@ -56,10 +62,26 @@ public:
     void drop_old_buffers() override;
     bool has_submitted_buffer() const override;
     void set_scale(float scale) override;
+    auto damage_for(void const* user_id) const -> geometry::Rectangles override;
 
 private:
     enum class ScheduleMode;
     void transition_schedule(std::shared_ptr<Schedule>&& new_schedule, std::lock_guard<std::mutex> const&);
+    void update_damage_for(void const* user_id, graphics::Buffer const& buffer, std::lock_guard<std::mutex> const&);
+
+    struct Submission
+    {
+        unsigned long long serial;
+        graphics::BufferID buffer;
+        geometry::Rectangles damage;
+    };
+
+    struct UserDamage
+    {
+        unsigned long long serial;
+        graphics::BufferID buffer;
+        geometry::Rectangles damage;
+    };
 
     std::mutex mutable mutex;
     ScheduleMode schedule_mode;
@@ -68,6 +90,9 @@ private:
     geometry::Size size; 
     MirPixelFormat pf;
     bool first_frame_posted;
+    unsigned long long next_serial;
+    std::deque<Submission> submissions;
+    std::unordered_map<void const*, UserDamage> user_damage;
 
     std::mutex callback_mutex;
     std::function<void(geometry::Size const&)> frame_callback;
@@ -72,6 +72,7 @@ mir::DefaultServerConfiguration::the_connection_creator()
                 new_ipc_factory(session_authorizer),
                 session_authorizer,
                 the_graphics_platform()->make_ipc_operations(),
+                the_cookie_authority(),
                 the_message_processor_report());
         });
 }
@@ -156,6 +157,7 @@ mir::DefaultServerConfiguration::the_prompt_connection_creator()
                 new_ipc_factory(session_authorizer),
                 session_authorizer,
                 the_graphics_platform()->make_ipc_operations(),
+                the_cookie_authority(),
                 the_message_processor_report());
         });
 }
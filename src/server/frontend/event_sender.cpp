@@ -18,16 +18,19 @@
 
 #include "event_sender.h"
 #include "mir/events/event.h"
-#include "mir/frontend/client_constants.h"
+#include "mir/events/input_event.h"
+#include "mir/events/pointer_event.h"
+#include "mir/events/resize_event.h"
 #include "mir/graphics/display_configuration.h"
-#include "mir/variable_length_array.h"
 #include "mir/input/device.h"
+#include "mir/input/cookie_token.h"
 #include "mir/input/mir_input_config.h"
 #include "mir/input/mir_input_config_serialization.h"
 #include "mir/input/mir_pointer_config.h"
 #include "mir/input/mir_touchpad_config.h"
 #include "mir/input/mir_keyboard_config.h"
 #include "message_sender.h"
+#include "wire_result.h"
 #include "protobuf_buffer_packer.h"
 
 #include "mir/graphics/buffer.h"
@@ -42,23 +45,76 @@ namespace mev = mir::events;
 namespace mp = mir::protobuf;
 namespace mi = mir::input;
 
+namespace
+{
+// Messages that only carry the latest state of something, so that a newer one
+// makes an older one the client hasn't been sent yet redundant
+enum class Superseding : uint32_t
+{
+    resize = 1,
+    pointer_motion,
+    display_configuration,
+    input_configuration
+};
+
+uint64_t superseding_key(Superseding what, int id = 0)
+{
+    return (static_cast<uint64_t>(what) << 32) | static_cast<uint32_t>(id);
+}
+
+mir::optional_value<uint64_t> superseding_key_for(MirEvent const& event)
+{
+    switch (event.type())
+    {
+    case mir_event_type_resize:
+        return superseding_key(Superseding::resize, event.to_resize()->surface_id());
+
+    case mir_event_type_input:
+    {
+        // Only the position is the latest state: scrolling and relative motion arrive as
+        // motion too, but dropping them would lose the distance moved.
+        auto const input = event.to_input();
+        if (input->input_type() != mir_input_event_type_pointer)
+            return {};
+
+        auto const pointer = input->to_pointer();
+        if (pointer->action() != mir_pointer_action_motion ||
+            pointer->vscroll() != 0 || pointer->hscroll() != 0 ||
+            pointer->dx() != 0 || pointer->dy() != 0)
+            return {};
+
+        return superseding_key(Superseding::pointer_motion, input->window_id());
+    }
+
+    default:
+        return {};
+    }
+}
+}
+
 mfd::EventSender::EventSender(
     std::shared_ptr<MessageSender> const& socket_sender,
-    std::shared_ptr<mg::PlatformIpcOperations> const& buffer_packer) :
+    std::shared_ptr<mg::PlatformIpcOperations> const& buffer_packer,
+    std::shared_ptr<mir::cookie::Authority> const& cookie_authority) :
     sender(socket_sender),
-    buffer_packer(buffer_packer)
+    buffer_packer(buffer_packer),
+    cookie_authority(cookie_authority)
 {
 }
 
 void mfd::EventSender::handle_event(EventUPtr&& event)
 {
+    // Input events only carry a cookie token until they leave the server; this client
+    // might hand the cookie back, so it needs the real thing
+    mi::seal_cookie(*event, *cookie_authority);
+
     // In future we might send multiple events, or insert them into messages
     // containing other responses, but for now we send them individually.
     mp::EventSequence seq;
     mp::Event *ev = seq.add_event();
     ev->set_raw(MirEvent::serialize(event.get()));
 
-    send_event_sequence(seq, {});
+    send_event_sequence(seq, {}, superseding_key_for(*event));
 }
 
 void mfd::EventSender::handle_display_config_change(
@@ -69,7 +125,7 @@ void mfd::EventSender::handle_display_config_change(
     auto protobuf_config = seq.mutable_display_configuration();
     mfd::pack_protobuf_display_configuration(*protobuf_config, display_config);
 
-    send_event_sequence(seq, {});
+    send_event_sequence(seq, {}, superseding_key(Superseding::display_configuration));
 }
 
 void mfd::EventSender::handle_lifecycle_event(
@@ -98,32 +154,23 @@ void mfd::EventSender::handle_input_config_change(MirInputConfig const& config)
     mp::EventSequence seq;
 
     seq.set_input_configuration(mi::serialize_input_config(config));
-    send_event_sequence(seq, {});
+    send_event_sequence(seq, {}, superseding_key(Superseding::input_configuration));
 }
 
-void mfd::EventSender::send_event_sequence(mp::EventSequence& seq, FdSets const& fds)
+void mfd::EventSender::send_event_sequence(
+    mp::EventSequence& seq,
+    FdSets const& fds,
+    mir::optional_value<uint64_t> const& key)
 {
-    mir::VariableLengthArray<frontend::serialization_buffer_size>
-#if GOOGLE_PROTOBUF_VERSION >= 3010000
-        send_buffer{static_cast<size_t>(seq.ByteSizeLong())};
-#else
-        send_buffer{static_cast<size_t>(seq.ByteSize())};
-#endif
-
-    seq.SerializeWithCachedSizesToArray(send_buffer.data());
-
-    mir::protobuf::wire::Result result;
-    result.add_events(send_buffer.data(), send_buffer.size());
-#if GOOGLE_PROTOBUF_VERSION >= 3010000
-    send_buffer.resize(result.ByteSizeLong());
-#else
-    send_buffer.resize(result.ByteSize());
-#endif
-    result.SerializeWithCachedSizesToArray(send_buffer.data());
+    ResultBuffer send_buffer{0};
+    serialize_event_result(seq, send_buffer);
 
     try
     {
-        sender->send(reinterpret_cast<char*>(send_buffer.data()), send_buffer.size(), fds);
+        if (key.is_set())
+            sender->send_superseding(reinterpret_cast<char*>(send_buffer.data()), send_buffer.size(), key.value());
+        else
+            sender->send(reinterpret_cast<char*>(send_buffer.data()), send_buffer.size(), fds);
     }
     catch (std::exception const& error)
     {
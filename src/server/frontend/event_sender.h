@@ -21,11 +21,14 @@
 
 #include "mir/frontend/event_sink.h"
 #include "mir/frontend/fd_sets.h"
+#include "mir/optional_value.h"
+#include <cstdint>
 #include <memory>
 
 namespace mir
 {
 namespace graphics { class PlatformIpcOperations; }
+namespace cookie { class Authority; }
 namespace protobuf
 {
 class EventSequence;
@@ -42,7 +45,8 @@ class EventSender : public  mir::frontend::EventSink
 public:
     explicit EventSender(
         std::shared_ptr<MessageSender> const& socket_sender,
-        std::shared_ptr<graphics::PlatformIpcOperations> const& buffer_packer);
+        std::shared_ptr<graphics::PlatformIpcOperations> const& buffer_packer,
+        std::shared_ptr<cookie::Authority> const& cookie_authority);
     void handle_event(EventUPtr&& event) override;
     void handle_lifecycle_event(MirLifecycleState state) override;
     void handle_display_config_change(graphics::DisplayConfiguration const& config) override;
@@ -55,11 +59,17 @@ public:
     void update_buffer(graphics::Buffer&) override;
 
 private:
-    void send_event_sequence(protobuf::EventSequence&, FdSets const&);
+    /// Messages with a superseding key replace any older one with the same key the
+    /// client hasn't been sent yet; they can't carry fds.
+    void send_event_sequence(
+        protobuf::EventSequence&,
+        FdSets const&,
+        optional_value<uint64_t> const& key = {});
     void send_buffer(protobuf::EventSequence&, graphics::Buffer&, graphics::BufferIpcMsgType);
 
     std::shared_ptr<MessageSender> const sender;
     std::shared_ptr<graphics::PlatformIpcOperations> const buffer_packer;
+    std::shared_ptr<cookie::Authority> const cookie_authority;
 };
 
 }
@@ -21,6 +21,7 @@
 #include "mir/frontend/fd_sets.h"
 
 #include <sys/types.h>
+#include <cstdint>
 
 namespace mir
 {
@@ -31,6 +32,18 @@ class MessageSender
 public:
     virtual void send(char const* data, size_t length, FdSets const& fds) = 0;
 
+    /**
+     * Send a message that makes any earlier message sent with the same key redundant.
+     *
+     * A sender that has to queue messages for a client that isn't keeping up may
+     * drop the earlier messages if they haven't been sent yet.
+     */
+    virtual void send_superseding(char const* data, size_t length, uint64_t key)
+    {
+        (void)key;
+        send(data, length, {});
+    }
+
 protected:
     MessageSender() = default;
     virtual ~MessageSender() = default;
@@ -71,7 +71,7 @@ template<class ParameterMessage>
 ParameterMessage parse_parameter(Invocation const& invocation)
 {
     ParameterMessage request;
-    if (!request.ParseFromString(invocation.parameters()))
+    if (!invocation.parse_parameters(request))
         BOOST_THROW_EXCEPTION(std::runtime_error("Failed to parse message parameters!"));
     return request;
 }
@@ -172,9 +172,12 @@ const std::string& mfd::Invocation::method_name() const
     return invocation.method_name();
 }
 
-const std::string& mfd::Invocation::parameters() const
+bool mfd::Invocation::parse_parameters(google::protobuf::MessageLite& parameters) const
 {
-    return invocation.parameters();
+    if (unparsed_parameters)
+        return parameters.ParseFromArray(unparsed_parameters, static_cast<int>(unparsed_parameters_size));
+    else
+        return parameters.ParseFromString(invocation.parameters());
 }
 
 google::protobuf::uint32 mfd::Invocation::id() const
@@ -19,9 +19,7 @@
 #include "protobuf_responder.h"
 #include "resource_cache.h"
 #include "message_sender.h"
-#include "mir/frontend/client_constants.h"
-#include "mir/variable_length_array.h"
-#include "socket_messenger.h"
+#include "wire_result.h"
 
 namespace mfd = mir::frontend::detail;
 
@@ -38,28 +36,8 @@ void mfd::ProtobufResponder::send_response(
     google::protobuf::MessageLite* response,
     FdSets const& fd_sets)
 {
-    mir::VariableLengthArray<serialization_buffer_size>
-#if GOOGLE_PROTOBUF_VERSION >= 3010000
-        send_response_buffer{static_cast<size_t>(response->ByteSizeLong())};
-#else
-        send_response_buffer{static_cast<size_t>(response->ByteSize())};
-#endif
-
-    response->SerializeWithCachedSizesToArray(send_response_buffer.data());
-
-    {
-        std::lock_guard<decltype(result_guard)> lock{result_guard};
-
-        send_response_result.set_id(id);
-        send_response_result.set_response(send_response_buffer.data(), send_response_buffer.size());
-
-#if GOOGLE_PROTOBUF_VERSION >= 3010000
-        send_response_buffer.resize(send_response_result.ByteSizeLong());
-#else
-        send_response_buffer.resize(send_response_result.ByteSize());
-#endif
-        send_response_result.SerializeWithCachedSizesToArray(send_response_buffer.data());
-    }
+    ResultBuffer send_response_buffer{0};
+    serialize_response_result(id, *response, send_response_buffer);
 
     sender->send(reinterpret_cast<char*>(send_response_buffer.data()), send_response_buffer.size(), fd_sets);
     resource_cache->free_resource(response);
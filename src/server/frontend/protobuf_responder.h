@@ -20,10 +20,8 @@
 #define MIR_FRONTEND_PROTOBUF_RESPONDER_H_
 
 #include "mir/frontend/protobuf_message_sender.h"
-#include "mir_protobuf_wire.pb.h"
 
 #include <memory>
-#include <mutex>
 
 namespace mir
 {
@@ -50,9 +48,6 @@ public:
 private:
     std::shared_ptr<MessageSender> const sender;
     std::shared_ptr<ResourceCache> const resource_cache;
-
-    std::mutex result_guard;
-    mir::protobuf::wire::Result send_response_result;
 };
 }
 }
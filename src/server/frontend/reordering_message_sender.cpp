@@ -35,7 +35,7 @@ void mf::ReorderingMessageSender::send(
         std::lock_guard<decltype(message_lock)> lock{message_lock};
         if (corked)
         {
-            buffered_messages.emplace_back(Message {std::vector<char>(data, data + length), FdSets(fds)});
+            buffered_messages.emplace_back(Message {std::vector<char>(data, data + length), FdSets(fds), false, 0});
             return;
         }
     }
@@ -43,6 +43,23 @@ void mf::ReorderingMessageSender::send(
     sink->send(data, length, fds);
 }
 
+void mf::ReorderingMessageSender::send_superseding(
+    char const* data,
+    size_t length,
+    uint64_t key)
+{
+    {
+        std::lock_guard<decltype(message_lock)> lock{message_lock};
+        if (corked)
+        {
+            buffered_messages.emplace_back(Message {std::vector<char>(data, data + length), FdSets{}, true, key});
+            return;
+        }
+    }
+
+    sink->send_superseding(data, length, key);
+}
+
 void mf::ReorderingMessageSender::uncork()
 {
     {
@@ -52,7 +69,10 @@ void mf::ReorderingMessageSender::uncork()
 
     for (auto const& message : buffered_messages)
     {
-        sink->send(message.data.data(), message.data.size(), message.fds);
+        if (message.superseding)
+            sink->send_superseding(message.data.data(), message.data.size(), message.key);
+        else
+            sink->send(message.data.data(), message.data.size(), message.fds);
     }
     buffered_messages.clear();
 }
@@ -38,6 +38,7 @@ public:
     explicit ReorderingMessageSender(std::shared_ptr<MessageSender> const& sink);
 
     void send(char const* data, size_t length, FdSets const& fds) override;
+    void send_superseding(char const* data, size_t length, uint64_t key) override;
 
     /**
      * Stop diverting messages into the buffer.
@@ -51,6 +52,8 @@ private:
     {
         std::vector<char> data;
         FdSets fds;
+        bool superseding;
+        uint64_t key;
     };
     std::mutex message_lock;
     bool corked;
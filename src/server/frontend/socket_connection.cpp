@@ -26,6 +26,8 @@
 
 #include "mir_protobuf_wire.pb.h"
 
+#include <google/protobuf/io/coded_stream.h>
+
 #include <boost/signals2.hpp>
 #include <boost/throw_exception.hpp>
 
@@ -38,6 +40,86 @@ namespace ba = boost::asio;
 namespace bs = boost::system;
 
 namespace mfd = mir::frontend::detail;
+namespace gp = google::protobuf;
+
+namespace
+{
+constexpr auto tag(int field_number, gp::uint32 wiretype) -> gp::uint32
+{
+    return (static_cast<gp::uint32>(field_number) << 3) | wiretype;
+}
+
+// From the protobuf encoding specification
+gp::uint32 const wiretype_varint = 0;
+gp::uint32 const wiretype_length_delimited = 2;
+
+/// Parses \a invocation from \a body, leaving its parameters where they are
+///
+/// The parameters are the bulk of most messages, and are parsed again once the method is known;
+/// pointing at them in the receive buffer saves copying them into \a invocation first.
+///
+/// \returns The parameters in \a body, or nullptr if they were parsed into \a invocation because
+///          the message had fields this doesn't know about
+auto parse_invocation(std::vector<char> const& body, mir::protobuf::wire::Invocation& invocation)
+    -> std::pair<unsigned char const*, size_t>
+{
+    using Invocation = mir::protobuf::wire::Invocation;
+
+    auto const data = reinterpret_cast<gp::uint8 const*>(body.data());
+    gp::io::CodedInputStream in{data, static_cast<int>(body.size())};
+    std::pair<unsigned char const*, size_t> parameters{nullptr, 0};
+    gp::uint32 value;
+    bool valid{true};
+
+    while (auto const field = in.ReadTag())
+    {
+        switch (field)
+        {
+        case tag(Invocation::kIdFieldNumber, wiretype_varint):
+            valid = in.ReadVarint32(&value);
+            invocation.set_id(value);
+            break;
+
+        case tag(Invocation::kMethodNameFieldNumber, wiretype_length_delimited):
+            valid = in.ReadVarint32(&value) && in.ReadString(invocation.mutable_method_name(), value);
+            break;
+
+        case tag(Invocation::kParametersFieldNumber, wiretype_length_delimited):
+            valid = in.ReadVarint32(&value);
+            parameters = {data + in.CurrentPosition(), value};
+            valid = valid && in.Skip(value);
+            break;
+
+        case tag(Invocation::kProtocolVersionFieldNumber, wiretype_varint):
+            valid = in.ReadVarint32(&value);
+            invocation.set_protocol_version(value);
+            break;
+
+        case tag(Invocation::kSideChannelFdsFieldNumber, wiretype_varint):
+            valid = in.ReadVarint32(&value);
+            invocation.set_side_channel_fds(value);
+            break;
+
+        default:
+            valid = false;
+            break;
+        }
+
+        if (!valid)
+            break;
+    }
+
+    if (!valid || in.CurrentPosition() != static_cast<int>(body.size()))
+    {
+        // Leave anything unexpected to protobuf
+        invocation.Clear();
+        invocation.ParseFromArray(body.data(), body.size());
+        return {nullptr, 0};
+    }
+
+    return parameters;
+}
+}
 
 mfd::SocketConnection::SocketConnection(
     std::shared_ptr<mfd::MessageReceiver> const& message_receiver,
@@ -98,7 +180,7 @@ try
     }
 
     mir::protobuf::wire::Invocation invocation;
-    invocation.ParseFromArray(body.data(), body.size());
+    auto const parameters = parse_invocation(body, invocation);
 
     int const v = invocation.has_protocol_version() ?
                   invocation.protocol_version() :
@@ -120,7 +202,11 @@ try
         processor->client_pid(client_pid);
     }
 
-    if (processor->dispatch(invocation, fds))
+    auto const unpacked = parameters.first ?
+        mfd::Invocation{invocation, parameters.first, parameters.second} :
+        mfd::Invocation{invocation};
+
+    if (processor->dispatch(unpacked, fds))
     {
         read_next_message();
     }
@@ -17,32 +17,136 @@
  */
 
 #include "socket_messenger.h"
-#include "mir/frontend/client_constants.h"
-#include "mir/variable_length_array.h"
 #include "mir/fd_socket_transmission.h"
 #include "mir/raii.h"
+#include "mir/variable_length_array.h"
 
 #include <boost/throw_exception.hpp>
 
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/socket.h>
 
+#include <algorithm>
 #include <stdexcept>
+#include <system_error>
 
 namespace mf = mir::frontend;
 namespace mfd = mf::detail;
 namespace bs = boost::system;
 namespace ba = boost::asio;
 
-mfd::SocketMessenger::SocketMessenger(std::shared_ptr<ba::local::stream_protocol::socket> const& socket)
+namespace
+{
+size_t const max_iovecs_per_write{64};
+
+// Writes as much of the message as the socket will take without blocking
+size_t send_some(mir::Fd const& socket_fd, iovec* iov, size_t iov_count)
+{
+    msghdr header{};
+    size_t total{0};
+
+    while (iov_count)
+    {
+        header.msg_iov = iov;
+        header.msg_iovlen = iov_count;
+
+        auto sent = sendmsg(socket_fd, &header, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                break;
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to send message to client"));
+        }
+
+        total += sent;
+
+        // Skip past whatever was written, which may end part way through an iovec
+        for (; iov_count && static_cast<size_t>(sent) >= iov->iov_len; ++iov, --iov_count)
+            sent -= iov->iov_len;
+        if (iov_count)
+        {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + sent;
+            iov->iov_len -= sent;
+        }
+    }
+
+    return total;
+}
+
+// As mir::send_fds(), but returns false rather than failing if the socket is full
+bool try_send_fds(mir::Fd const& socket_fd, std::vector<mir::Fd> const& fds)
+{
+    if (fds.empty())
+        return true;
+
+    char dummy_iov_data = 'M';
+    iovec iov{&dummy_iov_data, 1};
+
+    static auto const builtin_n_fds = 5;
+    static auto const builtin_cmsg_space = CMSG_SPACE(builtin_n_fds * sizeof(int));
+    auto const fds_bytes = fds.size() * sizeof(int);
+    mir::VariableLengthArray<builtin_cmsg_space> control{CMSG_SPACE(fds_bytes)};
+    memset(control.data(), 0, control.size());
+
+    msghdr header{};
+    header.msg_iov = &iov;
+    header.msg_iovlen = 1;
+    header.msg_control = control.data();
+    header.msg_controllen = control.size();
+
+    auto const message = CMSG_FIRSTHDR(&header);
+    message->cmsg_len = CMSG_LEN(fds_bytes);
+    message->cmsg_level = SOL_SOCKET;
+    message->cmsg_type = SCM_RIGHTS;
+
+    auto data = reinterpret_cast<int*>(CMSG_DATA(message));
+    for (auto const& fd : fds)
+        *data++ = fd;
+
+    while (sendmsg(socket_fd, &header, MSG_NOSIGNAL | MSG_DONTWAIT) < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return false;
+        if (errno != EINTR)
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to send fds to client"));
+    }
+
+    return true;
+}
+
+// The caller only guarantees its fds stay open for the duration of the send() call
+std::vector<mir::Fd> duplicate(std::vector<mir::Fd> const& fds)
+{
+    std::vector<mir::Fd> copies;
+    copies.reserve(fds.size());
+
+    for (auto const& fd : fds)
+    {
+        auto const copy = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (copy < 0)
+            BOOST_THROW_EXCEPTION(std::system_error(errno, std::system_category(), "Failed to duplicate fd for client"));
+        copies.emplace_back(copy);
+    }
+
+    return copies;
+}
+}
+
+mfd::SocketMessenger::SocketMessenger(
+    std::shared_ptr<ba::local::stream_protocol::socket> const& socket,
+    size_t max_queued_bytes)
     : socket(socket),
-      socket_fd{IntOwnedFd{socket->native_handle()}}
+      socket_fd{IntOwnedFd{socket->native_handle()}},
+      max_queued_bytes{max_queued_bytes}
 {
     // Make the socket non-blocking to avoid hanging the server when a client
-    // is unresponsive. Also increase the send buffer size to 64KiB to allow
-    // more leeway for transient client freezes.
+    // is unresponsive. Also increase the send buffer size to 64KiB so that
+    // transient client freezes rarely need the outbound queue.
     // See https://bugs.launchpad.net/mir/+bug/1350207
-    // TODO: Rework the messenger to support asynchronous sends
     socket->non_blocking(true);
     boost::asio::socket_base::send_buffer_size option(64*1024);
     socket->set_option(option);
@@ -71,26 +175,185 @@ mf::SessionCredentials mfd::SocketMessenger::client_creds()
     return creator_creds();
 }
 
-void mfd::SocketMessenger::send(char const* data, size_t length, FdSets const& fd_set)
+void mfd::SocketMessenger::send(char const* data, size_t length, FdSets const& fd_sets)
+{
+    send_or_queue(data, length, fd_sets, false, 0);
+}
+
+void mfd::SocketMessenger::send_superseding(char const* data, size_t length, uint64_t key)
 {
-    static size_t const header_size{2};
-    mir::VariableLengthArray<mf::serialization_buffer_size> whole_message{header_size + length};
+    send_or_queue(data, length, {}, true, key);
+}
+
+void mfd::SocketMessenger::send_or_queue(
+    char const* data,
+    size_t length,
+    FdSets const& fd_sets,
+    bool superseding,
+    uint64_t key)
+{
+    char header[]{
+        static_cast<char>((length >> 8) & 0xff),
+        static_cast<char>((length >> 0) & 0xff)};
+    size_t const message_size{sizeof header + length};
 
-    whole_message.data()[0] = static_cast<unsigned char>((length >> 8) & 0xff);
-    whole_message.data()[1] = static_cast<unsigned char>((length >> 0) & 0xff);
-    std::copy(data, data + length, whole_message.data() + header_size);
+    std::lock_guard<std::mutex> lock{message_lock};
 
-    std::unique_lock<std::mutex> lg(message_lock);
+    size_t sent{0};
+    auto unsent_fds = fd_sets.begin();
+
+    // Messages (and the fds that follow them) must reach the client in the order they
+    // were sent, so only write directly when there is nothing queued ahead
+    if (queued_messages.empty())
+    {
+        iovec message[]{
+            {header, sizeof header},
+            {const_cast<char*>(data), length}};
 
-    // TODO: This should be asynchronous, but we are not making sure
-    // that a potential call to send_fds is executed _after_ this
-    // function has completed (if it would be executed asynchronously.
-    // NOTE: we rely on this synchronous behavior as per the comment in
-    // mf::SessionMediator::create_surface
-    ba::write(*socket, ba::buffer(whole_message.data(), whole_message.size()));
+        sent = send_some(socket_fd, message, sizeof message / sizeof message[0]);
+
+        if (sent == message_size)
+        {
+            // The client expects each set of fds on its own marker byte after the message
+            while (unsent_fds != fd_sets.end() && try_send_fds(socket_fd, *unsent_fds))
+                ++unsent_fds;
+
+            if (unsent_fds == fd_sets.end())
+                return;
+        }
+    }
+    else if (superseding)
+    {
+        // A message that has started going out can't be withdrawn
+        for (auto i = queued_messages.begin(); i != queued_messages.end();)
+        {
+            if (i->superseding && i->key == key && i->sent == 0)
+            {
+                queued_bytes -= i->data.size();
+                i = queued_messages.erase(i);
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+
+    if (queued_bytes + (message_size - sent) > max_queued_bytes)
+    {
+        // The client has stopped reading. Shutting the socket down ends the
+        // connection just as if the client had closed it.
+        queued_messages.clear();
+        queued_bytes = 0;
+        shutdown(socket_fd, SHUT_RDWR);
+        BOOST_THROW_EXCEPTION(std::runtime_error("Client is not reading its messages, disconnecting it"));
+    }
+
+    QueuedMessage queued{{}, 0, {}, superseding && sent == 0, key};
+    queued.data.reserve(message_size - sent);
+    if (sent < sizeof header)
+        queued.data.insert(queued.data.end(), header + sent, header + sizeof header);
+    queued.data.insert(queued.data.end(), data + (sent > sizeof header ? sent - sizeof header : 0), data + length);
+
+    for (; unsent_fds != fd_sets.end(); ++unsent_fds)
+        queued.fds.push_back(duplicate(*unsent_fds));
+
+    queued_bytes += queued.data.size();
+    queued_messages.push_back(std::move(queued));
+
+    wait_for_writable();
+}
+
+void mfd::SocketMessenger::send_queued()
+{
+    while (!queued_messages.empty())
+    {
+        // Write as many messages as possible at once, stopping after the first
+        // that has fds to follow it
+        iovec iov[max_iovecs_per_write];
+        size_t iov_count{0};
+        size_t gathered{0};
+
+        for (auto& message : queued_messages)
+        {
+            if (iov_count == max_iovecs_per_write)
+                break;
+
+            if (message.sent < message.data.size())
+                iov[iov_count++] = {message.data.data() + message.sent, message.data.size() - message.sent};
+            ++gathered;
+
+            if (!message.fds.empty())
+                break;
+        }
+
+        auto written = iov_count ? send_some(socket_fd, iov, iov_count) : 0;
+        queued_bytes -= written;
+
+        for (; gathered; --gathered)
+        {
+            auto& message = queued_messages.front();
+
+            auto const step = std::min(written, message.data.size() - message.sent);
+            message.sent += step;
+            written -= step;
+
+            if (message.sent < message.data.size())
+                return;
+
+            while (!message.fds.empty())
+            {
+                if (!try_send_fds(socket_fd, message.fds.front()))
+                    return;
+                message.fds.erase(message.fds.begin());
+            }
+
+            queued_messages.pop_front();
+        }
+    }
+}
+
+void mfd::SocketMessenger::wait_for_writable()
+{
+    if (waiting_for_writable)
+        return;
+
+    waiting_for_writable = true;
+
+    std::weak_ptr<SocketMessenger> const weak_self{shared_from_this()};
+    socket->async_send(
+        ba::null_buffers(),
+        [weak_self](bs::error_code const& error, size_t)
+        {
+            if (auto const self = weak_self.lock())
+                self->on_writable(error);
+        });
+}
+
+void mfd::SocketMessenger::on_writable(bs::error_code const& error)
+{
+    std::lock_guard<std::mutex> lock{message_lock};
+
+    waiting_for_writable = false;
+
+    if (error)
+        return;
+
+    try
+    {
+        send_queued();
+    }
+    catch (std::exception const&)
+    {
+        // The client has gone. The connection notices that when it next reads
+        // from the socket, so all that's left to do here is drop the messages.
+        queued_messages.clear();
+        queued_bytes = 0;
+        return;
+    }
 
-    for (auto const& fds : fd_set)
-        mir::send_fds(socket_fd, fds);
+    if (!queued_messages.empty())
+        wait_for_writable();
 }
 
 void mfd::SocketMessenger::async_receive_msg(
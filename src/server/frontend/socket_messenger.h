@@ -21,7 +21,13 @@
 #include "message_sender.h"
 #include "message_receiver.h"
 #include "mir/frontend/session_credentials.h"
+
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <vector>
+
+#include <sys/uio.h>
 
 namespace mir
 {
@@ -29,13 +35,26 @@ namespace frontend
 {
 namespace detail
 {
+/**
+ * Sends and receives messages on a client socket.
+ *
+ * Sending never waits for the client: whatever the socket won't take immediately is queued
+ * and written as the socket becomes writable. A client that lets more than max_queued_bytes
+ * build up is disconnected.
+ */
 class SocketMessenger : public MessageSender,
-                        public MessageReceiver
+                        public MessageReceiver,
+                        public std::enable_shared_from_this<SocketMessenger>
 {
 public:
-    SocketMessenger(std::shared_ptr<boost::asio::local::stream_protocol::socket> const& socket);
+    static size_t const default_max_queued_bytes = 4*1024*1024;
+
+    SocketMessenger(
+        std::shared_ptr<boost::asio::local::stream_protocol::socket> const& socket,
+        size_t max_queued_bytes = default_max_queued_bytes);
 
     void send(char const* data, size_t length, FdSets const& fds) override;
+    void send_superseding(char const* data, size_t length, uint64_t key) override;
 
     void async_receive_msg(MirReadHandler const& handler, boost::asio::mutable_buffers_1 const& buffer) override;
     boost::system::error_code receive_msg(boost::asio::mutable_buffers_1 const& buffer) override;
@@ -44,6 +63,19 @@ public:
     void receive_fds(std::vector<Fd>& fds) override;
 
 private:
+    struct QueuedMessage
+    {
+        std::vector<char> data;
+        size_t sent;
+        FdSets fds;
+        bool superseding;
+        uint64_t key;
+    };
+
+    void send_or_queue(char const* data, size_t length, FdSets const& fds, bool superseding, uint64_t key);
+    void send_queued();
+    void wait_for_writable();
+    void on_writable(boost::system::error_code const& error);
     void set_passcred(int opt);
     void update_session_creds();
     SessionCredentials creator_creds() const;
@@ -51,7 +83,12 @@ private:
     std::shared_ptr<boost::asio::local::stream_protocol::socket> socket;
     mir::Fd socket_fd;
 
+    size_t const max_queued_bytes;
+
     std::mutex message_lock;
+    std::deque<QueuedMessage> queued_messages;
+    size_t queued_bytes{0};
+    bool waiting_for_writable{false};
     SessionCredentials session_creds{0, 0, 0};
 };
 }
@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "wire_result.h"
+
+#include "mir_protobuf_wire.pb.h"
+
+#include <google/protobuf/io/coded_stream.h>
+
+namespace mfd = mir::frontend::detail;
+namespace gp = google::protobuf;
+using gp::io::CodedOutputStream;
+
+namespace
+{
+// From the protobuf encoding specification
+gp::uint32 const wiretype_varint = 0;
+gp::uint32 const wiretype_length_delimited = 2;
+
+auto tag(int field_number, gp::uint32 wiretype) -> gp::uint32
+{
+    return (static_cast<gp::uint32>(field_number) << 3) | wiretype;
+}
+
+auto byte_size(gp::MessageLite const& message) -> gp::uint32
+{
+#if GOOGLE_PROTOBUF_VERSION >= 3010000
+    return static_cast<gp::uint32>(message.ByteSizeLong());
+#else
+    return static_cast<gp::uint32>(message.ByteSize());
+#endif
+}
+
+/// Writes \a message as a length-delimited field, relying on the sizes cached by byte_size()
+auto write_message_field(int field_number, gp::MessageLite const& message, gp::uint32 size, gp::uint8* target)
+    -> gp::uint8*
+{
+    target = CodedOutputStream::WriteTagToArray(tag(field_number, wiretype_length_delimited), target);
+    target = CodedOutputStream::WriteVarint32ToArray(size, target);
+    return message.SerializeWithCachedSizesToArray(target);
+}
+
+auto message_field_size(int field_number, gp::uint32 size) -> size_t
+{
+    return CodedOutputStream::VarintSize32(tag(field_number, wiretype_length_delimited)) +
+           CodedOutputStream::VarintSize32(size) +
+           size;
+}
+}
+
+void mfd::serialize_response_result(
+    gp::uint32 id,
+    gp::MessageLite const& response,
+    ResultBuffer& buffer)
+{
+    using Result = mir::protobuf::wire::Result;
+
+    auto const response_size = byte_size(response);
+    auto const id_tag = tag(Result::kIdFieldNumber, wiretype_varint);
+
+    buffer.resize(
+        CodedOutputStream::VarintSize32(id_tag) + CodedOutputStream::VarintSize32(id) +
+        message_field_size(Result::kResponseFieldNumber, response_size));
+
+    // Fields in field number order, as protobuf itself would write them
+    auto target = CodedOutputStream::WriteTagToArray(id_tag, buffer.data());
+    target = CodedOutputStream::WriteVarint32ToArray(id, target);
+    write_message_field(Result::kResponseFieldNumber, response, response_size, target);
+}
+
+void mfd::serialize_event_result(
+    gp::MessageLite const& event_sequence,
+    ResultBuffer& buffer)
+{
+    using Result = mir::protobuf::wire::Result;
+
+    auto const sequence_size = byte_size(event_sequence);
+
+    buffer.resize(message_field_size(Result::kEventsFieldNumber, sequence_size));
+
+    write_message_field(Result::kEventsFieldNumber, event_sequence, sequence_size, buffer.data());
+}
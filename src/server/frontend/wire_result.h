@@ -0,0 +1,59 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_FRONTEND_WIRE_RESULT_H_
+#define MIR_FRONTEND_WIRE_RESULT_H_
+
+#include "mir/frontend/client_constants.h"
+#include "mir/variable_length_array.h"
+
+#include <google/protobuf/stubs/common.h>
+
+namespace google
+{
+namespace protobuf
+{
+class MessageLite;
+}
+}
+
+namespace mir
+{
+namespace frontend
+{
+namespace detail
+{
+using ResultBuffer = VariableLengthArray<serialization_buffer_size>;
+
+/// Serializes a mir::protobuf::wire::Result carrying \a response as the reply to invocation \a id
+///
+/// This produces the same bytes as filling in and serializing a Result, but serializes
+/// \a response directly into \a buffer rather than into a temporary that is then copied.
+void serialize_response_result(
+    google::protobuf::uint32 id,
+    google::protobuf::MessageLite const& response,
+    ResultBuffer& buffer);
+
+/// Serializes a mir::protobuf::wire::Result carrying \a event_sequence as its only event
+void serialize_event_result(
+    google::protobuf::MessageLite const& event_sequence,
+    ResultBuffer& buffer);
+}
+}
+}
+
+#endif /* MIR_FRONTEND_WIRE_RESULT_H_ */
@@ -0,0 +1,122 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "client_motion_coalescer.h"
+
+#include <wayland-server-core.h>
+
+#include <linux/sockios.h>
+#include <sys/ioctl.h>
+
+namespace mf = mir::frontend;
+
+std::chrono::milliseconds const mf::ClientMotionCoalescer::recheck_interval{2};
+
+mf::ClientMotionCoalescer::ClientMotionCoalescer(
+    wl_client* client,
+    std::function<void(Motion const&)> const& send)
+    : client{client},
+      send_motion{send},
+      timer{wl_event_loop_add_timer(
+          wl_display_get_event_loop(wl_client_get_display(client)),
+          &on_timer,
+          this)}
+{
+}
+
+mf::ClientMotionCoalescer::~ClientMotionCoalescer()
+{
+    wl_event_source_remove(timer);
+}
+
+void mf::ClientMotionCoalescer::motion(Motion const& motion)
+{
+    // Motion over another surface can't be merged into what we're holding
+    if (held && held.value().surface != motion.surface)
+        flush();
+
+    if (held)
+    {
+        auto& merged = held.value();
+        merged.time = motion.time;
+        if (motion.position)
+            merged.position = motion.position;
+        merged.scroll = merged.scroll + motion.scroll;
+    }
+    else if (awaiting_read)
+    {
+        held = motion;
+    }
+    else
+    {
+        send(motion);
+    }
+}
+
+void mf::ClientMotionCoalescer::flush()
+{
+    if (held)
+    {
+        // Sending can lead back to us (e.g. leaving a subsurface discards held motion)
+        auto const motion = held.value();
+        held = std::experimental::nullopt;
+        send(motion);
+    }
+}
+
+void mf::ClientMotionCoalescer::discard()
+{
+    held = std::experimental::nullopt;
+}
+
+auto mf::ClientMotionCoalescer::client_has_unread_events() const -> bool
+{
+    // For a Unix socket this is what we've written that the client has yet to read
+    int unread{0};
+    return ioctl(wl_client_get_fd(client), SIOCOUTQ, &unread) == 0 && unread > 0;
+}
+
+void mf::ClientMotionCoalescer::send(Motion const& motion)
+{
+    if (!*motion.surface_destroyed)
+        send_motion(motion);
+
+    if (!awaiting_read)
+    {
+        awaiting_read = true;
+        wl_event_source_timer_update(timer, recheck_interval.count());
+    }
+}
+
+int mf::ClientMotionCoalescer::on_timer(void* data)
+{
+    auto const self = static_cast<ClientMotionCoalescer*>(data);
+
+    // Timers are dispatched after the clients have been flushed, so whatever was last sent
+    // has either been read, or is waiting in the socket
+    self->awaiting_read = false;
+    if (self->client_has_unread_events())
+    {
+        self->awaiting_read = true;
+        wl_event_source_timer_update(self->timer, recheck_interval.count());
+    }
+    else
+    {
+        self->flush();
+    }
+
+    return 0;
+}
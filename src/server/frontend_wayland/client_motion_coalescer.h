@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_CLIENT_MOTION_COALESCER_H_
+#define MIR_FRONTEND_CLIENT_MOTION_COALESCER_H_
+
+#include "mir/geometry/point.h"
+#include "mir/geometry/displacement.h"
+
+#include <experimental/optional>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+struct wl_client;
+struct wl_event_source;
+
+namespace mir
+{
+namespace frontend
+{
+class WlSurface;
+
+/// Holds back pointer motion for a client that hasn't yet read the motion it was last sent,
+/// merging it with any later motion until the client catches up.
+///
+/// InputEventCoalescer stops motion piling up for a busy Wayland thread; this stops it piling
+/// up in the socket of a client that reads slower than the mouse reports, which then gets the
+/// latest position each time it reads. Whether the client has caught up is checked every
+/// recheck_interval, so motion to a client is never sent more often than that.
+///
+/// Only used on the Wayland thread.
+class ClientMotionCoalescer
+{
+public:
+    struct Motion
+    {
+        std::chrono::milliseconds time;
+        WlSurface* surface;
+        /// Motion held for a surface that is destroyed before it is sent is dropped
+        std::shared_ptr<bool> surface_destroyed;
+        std::experimental::optional<geometry::Point> position;
+        geometry::Displacement scroll;
+    };
+
+    static std::chrono::milliseconds const recheck_interval;
+
+    ClientMotionCoalescer(wl_client* client, std::function<void(Motion const&)> const& send);
+    ~ClientMotionCoalescer();
+
+    /// Sends the motion now if the client has read everything it has been sent, otherwise
+    /// holds it until the client has
+    void motion(Motion const& motion);
+
+    /// Sends any motion being held straight away, so that the next event doesn't overtake it
+    void flush();
+
+    /// Drops any motion being held (for example, because the pointer has left the surface)
+    void discard();
+
+    ClientMotionCoalescer(ClientMotionCoalescer const&) = delete;
+    ClientMotionCoalescer& operator=(ClientMotionCoalescer const&) = delete;
+
+private:
+    static int on_timer(void* data);
+    auto client_has_unread_events() const -> bool;
+    void send(Motion const& motion);
+
+    wl_client* const client;
+    std::function<void(Motion const&)> const send_motion;
+    wl_event_source* const timer;
+
+    /// Set from sending motion until the client has been seen to have read it
+    bool awaiting_read{false};
+    std::experimental::optional<Motion> held;
+};
+}
+}
+
+#endif // MIR_FRONTEND_CLIENT_MOTION_COALESCER_H_
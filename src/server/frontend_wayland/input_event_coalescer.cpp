@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "input_event_coalescer.h"
+
+#include "mir/events/event.h"
+#include "mir/events/input_event.h"
+#include "mir/events/pointer_event.h"
+#include "mir/events/event_builders.h"
+
+namespace mf = mir::frontend;
+namespace mev = mir::events;
+
+namespace
+{
+auto as_motion(MirEvent const& event) -> MirPointerEvent const*
+{
+    if (event.type() != mir_event_type_input)
+        return nullptr;
+
+    auto const input = event.to_input();
+    if (input->input_type() != mir_input_event_type_pointer)
+        return nullptr;
+
+    auto const pointer = input->to_pointer();
+    return pointer->action() == mir_pointer_action_motion ? pointer : nullptr;
+}
+
+// Motion can only be merged if handling the result would look the same to the client
+// as handling each event in turn (apart from the intermediate positions)
+auto can_merge(MirPointerEvent const& queued, MirPointerEvent const& latest) -> bool
+{
+    return queued.device_id() == latest.device_id() &&
+           queued.buttons() == latest.buttons() &&
+           queued.modifiers() == latest.modifiers();
+}
+
+void merge(MirPointerEvent& queued, MirPointerEvent const& latest)
+{
+    queued.set_event_time(latest.event_time());
+    queued.set_cookie(latest.cookie());
+    queued.set_x(latest.x());
+    queued.set_y(latest.y());
+    queued.set_dx(queued.dx() + latest.dx());
+    queued.set_dy(queued.dy() + latest.dy());
+    queued.set_hscroll(queued.hscroll() + latest.hscroll());
+    queued.set_vscroll(queued.vscroll() + latest.vscroll());
+}
+}
+
+auto mf::InputEventCoalescer::enqueue(MirEvent const& event) -> std::shared_ptr<MirEvent>
+{
+    auto const motion = as_motion(event);
+
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (motion && queued_motion)
+    {
+        auto const queued = queued_motion->to_input()->to_pointer();
+        if (can_merge(*queued, *motion))
+        {
+            merge(*queued, *motion);
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<MirEvent> owned_event = mev::clone_event(event);
+
+    // Anything else has to be handled after the queued motion, so later motion can't join it
+    queued_motion = motion ? owned_event : nullptr;
+    return owned_event;
+}
+
+void mf::InputEventCoalescer::dequeue(std::shared_ptr<MirEvent> const& event)
+{
+    std::lock_guard<decltype(mutex)> lock{mutex};
+
+    if (queued_motion == event)
+        queued_motion.reset();
+}
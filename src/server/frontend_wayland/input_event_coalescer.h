@@ -0,0 +1,56 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_INPUT_EVENT_COALESCER_H_
+#define MIR_FRONTEND_INPUT_EVENT_COALESCER_H_
+
+#include <mir_toolkit/event.h>
+
+#include <memory>
+#include <mutex>
+
+namespace mir
+{
+namespace frontend
+{
+/// Copies input events for handling on the Wayland thread, merging pointer motion into
+/// motion that the Wayland thread hasn't got round to yet.
+///
+/// A high frequency mouse can generate motion far faster than a busy Wayland thread can
+/// handle it, and a client only needs the latest position. Buttons, enter, leave and
+/// anything else stay in order: motion is never merged across them.
+///
+/// \note This only merges motion waiting for the Wayland thread. Motion waiting for a client
+///       that reads its socket slowly is merged by ClientMotionCoalescer.
+class InputEventCoalescer
+{
+public:
+    /// Returns a copy of event to hand to the Wayland thread, or nullptr if event was merged
+    /// into motion that is already queued
+    auto enqueue(MirEvent const& event) -> std::shared_ptr<MirEvent>;
+
+    /// Called on the Wayland thread before handling an event returned by enqueue(). Nothing
+    /// more is merged into the event after this returns, so it is then safe to read.
+    void dequeue(std::shared_ptr<MirEvent> const& event);
+
+private:
+    std::mutex mutex;
+    std::shared_ptr<MirEvent> queued_motion;
+};
+}
+}
+
+#endif // MIR_FRONTEND_INPUT_EVENT_COALESCER_H_
@@ -24,6 +24,8 @@
 #include "xdg_shell_stable.h"
 #include "xdg_output_v1.h"
 #include "layer_shell_v1.h"
+#include "wp_presentation.h"
+#include "wp_viewporter.h"
 #include "xwayland_wm_shell.h"
 #include "mir_display.h"
 #include "wl_seat.h"
@@ -34,6 +36,7 @@
 #include "mir/scene/session.h"
 
 namespace mf = mir::frontend;
+namespace mg = mir::graphics;
 namespace ms = mir::scene;
 namespace msh = mir::shell;
 namespace mo = mir::options;
@@ -44,7 +47,9 @@ auto mf::get_standard_extensions() -> std::vector<std::string>
     return std::vector<std::string>{
         mw::Shell::interface_name,
         mw::XdgWmBase::interface_name,
-        mw::XdgShellV6::interface_name};
+        mw::XdgShellV6::interface_name,
+        mw::Presentation::interface_name,
+        mw::Viewporter::interface_name};
 }
 
 auto mf::get_supported_extensions() -> std::vector<std::string>
@@ -58,7 +63,9 @@ auto mf::get_supported_extensions() -> std::vector<std::string>
         mw::XdgWmBase::interface_name,
         mw::XdgShellV6::interface_name,
         mw::LayerShellV1::interface_name,
-        mw::XdgOutputManagerV1::interface_name};
+        mw::XdgOutputManagerV1::interface_name,
+        mw::Presentation::interface_name,
+        mw::Viewporter::interface_name};
 }
 
 namespace
@@ -67,7 +74,8 @@ namespace
 auto configure_wayland_extensions(
     std::set<std::string> const& extensions,
     bool x11_enabled,
-    std::vector<mir::WaylandExtensionHook> const& wayland_extension_hooks)
+    std::vector<mir::WaylandExtensionHook> const& wayland_extension_hooks,
+    std::shared_ptr<mg::Display> const& graphics_display)
     -> std::unique_ptr<mf::WaylandExtensions>
 {
     struct WaylandExtensions : mf::WaylandExtensions
@@ -75,8 +83,12 @@ auto configure_wayland_extensions(
         WaylandExtensions(
             std::set<std::string> const& extension,
             bool x11_enabled,
-            std::vector<mir::WaylandExtensionHook> const& wayland_extension_hooks) :
-            extension{extension}, x11_enabled{x11_enabled}, wayland_extension_hooks{wayland_extension_hooks} {}
+            std::vector<mir::WaylandExtensionHook> const& wayland_extension_hooks,
+            std::shared_ptr<mg::Display> const& graphics_display) :
+            extension{extension},
+            x11_enabled{x11_enabled},
+            wayland_extension_hooks{wayland_extension_hooks},
+            graphics_display{graphics_display} {}
 
     protected:
         void custom_extensions(
@@ -110,6 +122,14 @@ auto configure_wayland_extensions(
                     mw::XdgOutputManagerV1::interface_name,
                     create_xdg_output_manager_v1(display, output_manager));
 
+            if (extension.find(mw::Presentation::interface_name) != extension.end())
+                add_extension(
+                    mw::Presentation::interface_name,
+                    create_wp_presentation(display, graphics_display, output_manager));
+
+            if (extension.find(mw::Viewporter::interface_name) != extension.end())
+                add_extension(mw::Viewporter::interface_name, mf::create_wp_viewporter(display));
+
             if (x11_enabled)
                 add_extension("x11-support", std::make_shared<mf::XWaylandWMShell>(shell, *seat, output_manager));
         }
@@ -128,9 +148,10 @@ auto configure_wayland_extensions(
         std::set<std::string> const extension;
         const bool x11_enabled;
         std::vector<mir::WaylandExtensionHook> const wayland_extension_hooks;
+        std::shared_ptr<mg::Display> const graphics_display;
     };
 
-    return std::make_unique<WaylandExtensions>(extensions, x11_enabled, wayland_extension_hooks);
+    return std::make_unique<WaylandExtensions>(extensions, x11_enabled, wayland_extension_hooks, graphics_display);
 }
 }
 
@@ -159,7 +180,11 @@ std::shared_ptr<mf::Connector>
                 the_buffer_allocator(),
                 the_session_authorizer(),
                 arw_socket,
-                configure_wayland_extensions(wayland_extensions, options->is_set(mo::x11_display_opt), wayland_extension_hooks),
+                configure_wayland_extensions(
+                    wayland_extensions,
+                    options->is_set(mo::x11_display_opt),
+                    wayland_extension_hooks,
+                    the_display()),
                 wayland_extension_filter);
         });
 }
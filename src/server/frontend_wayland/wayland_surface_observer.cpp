@@ -28,7 +28,6 @@
 
 #include <mir_toolkit/events/window_placement.h>
 #include <mir_toolkit/events/event.h>
-#include <mir/events/event_builders.h>
 #include <mir/input/xkb_mapper.h>
 #include <mir/input/keymap.h>
 #include <mir/log.h>
@@ -39,7 +38,6 @@
 namespace mf = mir::frontend;
 namespace ms = mir::scene;
 namespace geom = mir::geometry;
-namespace mev = mir::events;
 namespace mi = mir::input;
 
 mf::WaylandSurfaceObserver::WaylandSurfaceObserver(
@@ -146,11 +144,15 @@ void mf::WaylandSurfaceObserver::placed_relative(ms::Surface const*, geometry::R
 
 void mf::WaylandSurfaceObserver::input_consumed(ms::Surface const*, MirEvent const* event)
 {
-    std::shared_ptr<MirEvent> owned_event = mev::clone_event(*event);
+    auto const owned_event = input_events.enqueue(*event);
+
+    if (!owned_event)
+        return; // Merged into motion the Wayland thread hasn't handled yet
 
     run_on_wayland_thread_unless_destroyed(
         [this, owned_event]()
         {
+            input_events.dequeue(owned_event);
             if (mir_event_get_type(owned_event.get()) != mir_event_type_input)
             {
                 log_warning(
@@ -316,15 +318,15 @@ void mf::WaylandSurfaceObserver::handle_pointer_motion_event(
 
     if (send_motion || send_axis)
     {
+        std::experimental::optional<geom::Point> motion;
+        if (send_motion)
+            motion = position;
+
         seat->for_each_listener(
             client,
-            [&ms, surface = surface, &send_motion, &position, &send_axis, &axis_motion](WlPointer* pointer)
+            [&ms, surface = surface, &motion, &axis_motion](WlPointer* pointer)
             {
-                if (send_motion)
-                    pointer->motion(ms, surface, position);
-                if (send_axis)
-                    pointer->axis(ms, axis_motion);
-                pointer->frame();
+                pointer->coalesced_motion(ms, surface, motion, axis_motion);
             });
     }
 }
@@ -20,6 +20,8 @@
 #ifndef MIR_FRONTEND_WAYLAND_SURFACE_OBSERVER_H_
 #define MIR_FRONTEND_WAYLAND_SURFACE_OBSERVER_H_
 
+#include "input_event_coalescer.h"
+
 #include "mir/scene/null_surface_observer.h"
 
 #include <memory>
@@ -93,6 +95,7 @@ private:
     MirWindowState current_state{mir_window_state_unknown};
     MirPointerButtons last_pointer_buttons{0};
     std::experimental::optional<mir::geometry::Point> last_pointer_position;
+    InputEventCoalescer input_events;
     std::shared_ptr<bool> const destroyed;
 
     void run_on_wayland_thread_unless_destroyed(std::function<void()>&& work);
@@ -316,12 +316,12 @@ auto mf::WindowWlSurfaceRole::pending_size() const -> geom::Size
 auto mf::WindowWlSurfaceRole::current_size() const -> geom::Size
 {
     auto size = committed_size.value_or(geom::Size{640, 480});
-    if (surface->buffer_size())
+    if (auto const surface_size = surface->size())
     {
         if (!committed_width_set_explicitly)
-            size.width = surface->buffer_size().value().width;
+            size.width = surface_size.value().width;
         if (!committed_height_set_explicitly)
-            size.height = surface->buffer_size().value().height;
+            size.height = surface_size.value().height;
     }
     return size;
 }
@@ -122,7 +122,14 @@ mf::WlPointer::WlPointer(
     : Pointer(new_resource, Version<6>()),
       display{wl_client_get_display(client)},
       on_destroy{on_destroy},
-      cursor{std::make_unique<NullCursor>()}
+      cursor{std::make_unique<NullCursor>()},
+      held_motion{client, [this](ClientMotionCoalescer::Motion const& motion)
+          {
+              if (motion.position)
+                  this->motion(motion.time, motion.surface, motion.position.value());
+              axis(motion.time, motion.scroll);
+              frame();
+          }}
 {
 }
 
@@ -135,6 +142,8 @@ mf::WlPointer::~WlPointer()
 
 void mf::WlPointer::enter(WlSurface* parent_surface, geom::Point const& position_on_parent)
 {
+    held_motion.flush();
+
     auto const serial = wl_display_next_serial(display);
     auto const final = parent_surface->transform_point(position_on_parent);
 
@@ -156,6 +165,9 @@ void mf::WlPointer::enter(WlSurface* parent_surface, geom::Point const& position
 
 void mf::WlPointer::leave()
 {
+    // The client has no use for where the pointer was on a surface it has left
+    held_motion.discard();
+
     if (!surface_under_cursor)
         return;
     surface_under_cursor.value()->remove_destroy_listener(this);
@@ -169,6 +181,9 @@ void mf::WlPointer::leave()
 
 void mf::WlPointer::button(std::chrono::milliseconds const& ms, uint32_t button, bool pressed)
 {
+    // The client needs to know where the pointer is before the button
+    held_motion.flush();
+
     auto const serial = wl_display_next_serial(display);
     auto const state = pressed ? ButtonState::pressed : ButtonState::released;
 
@@ -219,6 +234,15 @@ void mf::WlPointer::axis(std::chrono::milliseconds const& ms, geometry::Displace
     }
 }
 
+void mf::WlPointer::coalesced_motion(
+    std::chrono::milliseconds const& ms,
+    WlSurface* parent_surface,
+    std::experimental::optional<geometry::Point> const& position_on_parent,
+    geometry::Displacement const& scroll)
+{
+    held_motion.motion({ms, parent_surface, parent_surface->destroyed_flag(), position_on_parent, scroll});
+}
+
 void mf::WlPointer::frame()
 {
     if (can_send_frame && version_supports_frame())
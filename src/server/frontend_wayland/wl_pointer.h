@@ -21,6 +21,7 @@
 
 
 #include "wayland_wrapper.h"
+#include "client_motion_coalescer.h"
 
 #include "mir/geometry/point.h"
 #include "mir/geometry/displacement.h"
@@ -66,6 +67,14 @@ public:
     void axis(std::chrono::milliseconds const& ms, geometry::Displacement const& scroll);
     void frame();
 
+    /// Sends motion and/or scroll followed by a frame, unless the client has yet to read the
+    /// last motion it was sent. Then it is held back, and merged with any later motion.
+    void coalesced_motion(
+        std::chrono::milliseconds const& ms,
+        WlSurface* parent_surface,
+        std::experimental::optional<geometry::Point> const& position_on_parent,
+        geometry::Displacement const& scroll);
+
     struct Cursor;
 
 private:
@@ -86,6 +95,7 @@ private:
     ///@}
 
     std::unique_ptr<Cursor> cursor;
+    ClientMotionCoalescer held_motion;
 };
 
 }
@@ -24,8 +24,10 @@
 #include "wl_region.h"
 #include "wlshmbuffer.h"
 #include "deleted_for_resource.h"
+#include "wp_presentation.h"
 
 #include "wayland_wrapper.h"
+#include "viewporter_wrapper.h"
 
 #include "wayland_frontend.tp.h"
 
@@ -39,6 +41,9 @@
 #include "mir/log.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
 #include <boost/throw_exception.hpp>
 
 namespace mf = mir::frontend;
@@ -46,6 +51,54 @@ namespace geom = mir::geometry;
 namespace mw = mir::wayland;
 namespace msh = mir::shell;
 
+namespace
+{
+// Clients frequently damage (0, 0, INT32_MAX, INT32_MAX) to mean "everything", so
+// keep the coordinates small enough that clipping the rectangle later cannot overflow
+auto clamped_rectangle(int32_t x, int32_t y, int32_t width, int32_t height) -> geom::Rectangle
+{
+    auto const limit = std::numeric_limits<int32_t>::max() / 2;
+    auto const clamp = [](int32_t value, int32_t min, int32_t max) { return std::min(std::max(value, min), max); };
+
+    return {
+        {clamp(x, -limit, limit), clamp(y, -limit, limit)},
+        {clamp(width, 0, limit), clamp(height, 0, limit)}};
+}
+}
+
+auto mf::surface_to_buffer(
+    geom::Rectangle const& rect,
+    geom::Rectangle const& source,
+    geom::Size const& surface_size) -> geom::Rectangle
+{
+    if (surface_size.width <= geom::Width{} || surface_size.height <= geom::Height{})
+        return {};
+
+    // Round outwards (in exact integer arithmetic) so that every buffer pixel the rectangle touches is included
+    auto const floor_to_buffer = [](int surface, int surface_extent, int buffer_extent)
+        {
+            auto const clamped = std::min(std::max(surface, 0), surface_extent);
+            return static_cast<int>(int64_t{clamped} * buffer_extent / surface_extent);
+        };
+    auto const ceil_to_buffer = [](int surface, int surface_extent, int buffer_extent)
+        {
+            auto const clamped = std::min(std::max(surface, 0), surface_extent);
+            return static_cast<int>((int64_t{clamped} * buffer_extent + surface_extent - 1) / surface_extent);
+        };
+
+    auto const surface_width = surface_size.width.as_int();
+    auto const surface_height = surface_size.height.as_int();
+    auto const buffer_width = source.size.width.as_int();
+    auto const buffer_height = source.size.height.as_int();
+
+    auto const left = source.left().as_int() + floor_to_buffer(rect.left().as_int(), surface_width, buffer_width);
+    auto const top = source.top().as_int() + floor_to_buffer(rect.top().as_int(), surface_height, buffer_height);
+    auto const right = source.left().as_int() + ceil_to_buffer(rect.right().as_int(), surface_width, buffer_width);
+    auto const bottom = source.top().as_int() + ceil_to_buffer(rect.bottom().as_int(), surface_height, buffer_height);
+
+    return {{left, top}, {right - left, bottom - top}};
+}
+
 mf::WlSurfaceState::Callback::Callback(wl_resource* new_resource)
     : mw::Callback{new_resource, Version<1>()},
       destroyed{deleted_flag_for_resource(resource)}
@@ -63,10 +116,26 @@ void mf::WlSurfaceState::update_from(WlSurfaceState const& source)
     if (source.input_shape)
         input_shape = source.input_shape;
 
+    if (source.opaque_region)
+        opaque_region = source.opaque_region;
+
+    if (source.viewport)
+        viewport = source.viewport;
+
     frame_callbacks.insert(end(frame_callbacks),
                            begin(source.frame_callbacks),
                            end(source.frame_callbacks));
 
+    presentation_feedbacks.insert(end(presentation_feedbacks),
+                                  begin(source.presentation_feedbacks),
+                                  end(source.presentation_feedbacks));
+
+    for (auto const& rect : source.damage)
+        damage.add(rect);
+
+    for (auto const& rect : source.surface_damage)
+        surface_damage.add(rect);
+
     if (source.surface_data_invalidated)
         surface_data_invalidated = true;
 }
@@ -75,6 +144,8 @@ bool mf::WlSurfaceState::surface_data_needs_refresh() const
 {
     return offset ||
            input_shape ||
+           opaque_region ||
+           viewport ||
            surface_data_invalidated;
 }
 
@@ -126,8 +197,8 @@ mf::WlSurface::Position mf::WlSurface::transform_point(geom::Point point)
         if (result.is_in_input_region)
             return result;
     }
-    geom::Rectangle surface_rect = {geom::Point{}, buffer_size_.value_or(geom::Size{})};
-    for (auto& rect : input_shape.value_or(std::vector<geom::Rectangle>{{{}, buffer_size_.value_or(geom::Size{})}}))
+    geom::Rectangle surface_rect = {geom::Point{}, size().value_or(geom::Size{})};
+    for (auto& rect : input_shape.value_or(std::vector<geom::Rectangle>{surface_rect}))
     {
         if (rect.intersection_with(surface_rect).contains(point))
             return {point, this, true};
@@ -140,6 +211,24 @@ auto mf::WlSurface::scene_surface() const -> std::experimental::optional<std::sh
     return role->scene_surface();
 }
 
+auto mf::WlSurface::size() const -> std::experimental::optional<geom::Size>
+{
+    // A surface without a buffer has no content and so no size, whatever the viewport says
+    if (!buffer_size_)
+        return std::experimental::nullopt;
+
+    if (viewport_.destination)
+        return viewport_.destination;
+
+    // Without a destination, check_viewport() ensures the source has an integer size
+    if (viewport_.source)
+        return geom::Size{
+            static_cast<int>(viewport_.source.value().width),
+            static_cast<int>(viewport_.source.value().height)};
+
+    return buffer_size_;
+}
+
 void mf::WlSurface::set_role(WlSurfaceRole* role_)
 {
     if (role != &null_role)
@@ -186,8 +275,24 @@ void mf::WlSurface::populate_surface_data(std::vector<shell::StreamSpecification
 {
     geometry::Displacement offset = parent_offset + offset_;
 
-    buffer_streams.push_back(msh::StreamSpecification{stream, offset, {}});
-    geom::Rectangle surface_rect = {geom::Point{} + offset, buffer_size_.value_or(geom::Size{})};
+    geom::Rectangle surface_rect = {geom::Point{} + offset, size().value_or(geom::Size{})};
+
+    std::vector<geom::Rectangle> opaque_rects;
+    for (auto const& rect : opaque_region)
+    {
+        auto const clipped = rect.intersection_with({{}, surface_rect.size}); // clip to surface
+        if (clipped.size.width > geom::Width{} && clipped.size.height > geom::Height{})
+            opaque_rects.push_back(clipped);
+    }
+    msh::StreamSpecification spec{stream, offset, {}, std::move(opaque_rects)};
+    if (buffer_size_ && (viewport_.source || viewport_.destination))
+    {
+        // The renderer crops and scales the buffer to the surface size
+        spec.size = surface_rect.size;
+        spec.src_bounds = viewport_.source ?
+            viewport_.source.value().covering() : geom::Rectangle{{}, buffer_size_.value()};
+    }
+    buffer_streams.push_back(std::move(spec));
     if (input_shape)
     {
         for (auto rect : input_shape.value())
@@ -258,20 +363,13 @@ void mf::WlSurface::attach(std::experimental::optional<wl_resource*> const& buff
 
 void mf::WlSurface::damage(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    // The viewport to map this into the buffer is only known on commit
+    pending.surface_damage.add(clamped_rectangle(x, y, width, height));
 }
 
 void mf::WlSurface::damage_buffer(int32_t x, int32_t y, int32_t width, int32_t height)
 {
-    (void)x;
-    (void)y;
-    (void)width;
-    (void)height;
-    // This isn't essential, but could enable optimizations
+    pending.damage.add(clamped_rectangle(x, y, width, height));
 }
 
 void mf::WlSurface::frame(wl_resource* new_callback)
@@ -279,10 +377,32 @@ void mf::WlSurface::frame(wl_resource* new_callback)
     pending.frame_callbacks.push_back(std::make_shared<WlSurfaceState::Callback>(new_callback));
 }
 
+void mf::WlSurface::add_presentation_feedback(std::shared_ptr<PresentationListener> const& feedback)
+{
+    pending.presentation_feedbacks.push_back(feedback);
+}
+
+void mf::WlSurface::set_pending_viewport_source(
+    std::experimental::optional<WlSurfaceState::Viewport::Source> const& source)
+{
+    if (!pending.viewport)
+        pending.viewport = viewport_;
+    pending.viewport.value().source = source;
+}
+
+void mf::WlSurface::set_pending_viewport_destination(std::experimental::optional<geom::Size> const& destination)
+{
+    if (!pending.viewport)
+        pending.viewport = viewport_;
+    pending.viewport.value().destination = destination;
+}
+
 void mf::WlSurface::set_opaque_region(std::experimental::optional<wl_resource*> const& region)
 {
-    (void)region;
-    // This isn't essential, but could enable optimizations
+    if (region)
+        pending.opaque_region = WlRegion::from(region.value())->rectangle_vector();
+    else
+        pending.opaque_region = std::vector<geom::Rectangle>{};
 }
 
 void mf::WlSurface::set_input_region(std::experimental::optional<wl_resource*> const& region)
@@ -313,6 +433,12 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     if (state.input_shape)
         input_shape = state.input_shape.value();
 
+    if (state.opaque_region)
+        opaque_region = state.opaque_region.value();
+
+    if (state.viewport)
+        viewport_ = state.viewport.value();
+
     if (state.buffer)
     {
         wl_resource * buffer = *state.buffer;
@@ -322,11 +448,21 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
             // TODO: unmap surface, and unmap all subsurfaces
             buffer_size_ = std::experimental::nullopt;
             send_frame_callbacks();
+
+            // The update removes the content, so there is nothing to present
+            PresentationFeedbacks{executor, state.presentation_feedbacks};
         }
         else
         {
-            auto const executor_send_frame_callbacks = [this, executor = executor, destroyed = destroyed]()
+            std::shared_ptr<PresentationFeedbacks> presentation;
+            if (!state.presentation_feedbacks.empty())
+                presentation = std::make_shared<PresentationFeedbacks>(executor, state.presentation_feedbacks);
+
+            auto const executor_send_frame_callbacks = [this, executor = executor, destroyed = destroyed, presentation]()
                 {
+                    if (presentation)
+                        presentation->consumed();
+
                     executor->spawn(run_unless(
                         destroyed,
                         [this]()
@@ -342,7 +478,8 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                 mir_buffer = WlShmBuffer::mir_buffer_from_wl_buffer(
                     buffer,
                     executor,
-                    std::move(executor_send_frame_callbacks));
+                    std::move(executor_send_frame_callbacks),
+                    WlShmBuffer::Access::zero_copy);
                 tracepoint(
                     mir_server_wayland,
                     sw_buffer_committed,
@@ -371,17 +508,43 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
                     mir_buffer->id().as_value());
             }
 
-            if (!input_shape && (!buffer_size_ || mir_buffer->size() != buffer_size_.value()))
+            if ((!input_shape || !opaque_region.empty() || viewport_.destination) &&
+                (!buffer_size_ || mir_buffer->size() != buffer_size_.value()))
             {
-                state.invalidate_surface_data(); // input shape needs to be recalculated for the new size
+                // input shape and opaque region need to be clipped to the new size, and a scaled buffer resized
+                state.invalidate_surface_data();
             }
             buffer_size_ = mir_buffer->size();
-            stream->submit_buffer(mir_buffer);
+
+            if (!check_viewport())
+                return;
+
+            // The stream tracks damage in buffer coordinates
+            auto damage = state.damage;
+            auto const source = viewport_.source ?
+                viewport_.source.value().covering() : geom::Rectangle{{}, buffer_size_.value()};
+            for (auto const& rect : state.surface_damage)
+                damage.add(surface_to_buffer(rect, source, size().value()));
+
+            // Strictly, a new buffer without damage has not changed. Rather than freeze
+            // the surface of clients that don't bother with damage, assume it all changed.
+            if (damage.size() > 0)
+                stream->submit_buffer(mir_buffer, damage);
+            else
+                stream->submit_buffer(mir_buffer);
         }
     }
     else
     {
+        if (state.viewport && !check_viewport())
+            return;
+
         send_frame_callbacks();
+
+        // Nothing new to composite, so the update is shown by the next flip
+        auto const now = graphics::Frame::Timestamp::now(CLOCK_MONOTONIC);
+        for (auto const& feedback : state.presentation_feedbacks)
+            feedback->consumed(now);
     }
 
     for (WlSubsurface* child: children)
@@ -390,6 +553,47 @@ void mf::WlSurface::commit(WlSurfaceState const& state)
     }
 }
 
+auto mf::WlSurface::check_viewport() const -> bool
+{
+    if (!viewport_object || !viewport_.source)
+        return true;
+
+    auto const& source = viewport_.source.value();
+
+    if (!viewport_.destination &&
+        (source.width != std::trunc(source.width) || source.height != std::trunc(source.height)))
+    {
+        wl_resource_post_error(
+            viewport_object->resource,
+            mw::Viewport::Error::bad_size,
+            "Viewport source size %f×%f is not integer and there is no destination size",
+            source.width, source.height);
+        return false;
+    }
+
+    // A surface without a buffer has nothing to crop, so any source is allowed
+    if (!buffer_size_ ||
+        (source.x + source.width <= buffer_size_.value().width.as_int() &&
+         source.y + source.height <= buffer_size_.value().height.as_int()))
+        return true;
+
+    wl_resource_post_error(
+        viewport_object->resource,
+        mw::Viewport::Error::out_of_buffer,
+        "Viewport source rectangle extends outside of the buffer");
+    return false;
+}
+
+auto mf::WlSurfaceState::Viewport::Source::covering() const -> geom::Rectangle
+{
+    auto const left = static_cast<int>(std::floor(x));
+    auto const top = static_cast<int>(std::floor(y));
+    auto const right = static_cast<int>(std::ceil(x + width));
+    auto const bottom = static_cast<int>(std::ceil(y + height));
+
+    return {{left, top}, {right - left, bottom - top}};
+}
+
 void mf::WlSurface::commit()
 {
     if (pending.offset && *pending.offset == offset_)
@@ -401,6 +605,12 @@ void mf::WlSurface::commit()
     if (pending.input_shape && *pending.input_shape == input_shape)
         pending.input_shape = std::experimental::nullopt;
 
+    if (pending.opaque_region && *pending.opaque_region == opaque_region)
+        pending.opaque_region = std::experimental::nullopt;
+
+    if (pending.viewport && *pending.viewport == viewport_)
+        pending.viewport = std::experimental::nullopt;
+
     // order is important
     auto const state = std::move(pending);
     pending = WlSurfaceState();
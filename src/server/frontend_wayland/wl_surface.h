@@ -26,6 +26,7 @@
 #include "mir/geometry/displacement.h"
 #include "mir/geometry/size.h"
 #include "mir/geometry/point.h"
+#include "mir/geometry/rectangles.h"
 
 #include <vector>
 #include <map>
@@ -54,10 +55,28 @@ namespace compositor
 {
 class BufferStream;
 }
+namespace wayland
+{
+class Viewport;
+}
 namespace frontend
 {
 class WlSurface;
 class WlSubsurface;
+class PresentationListener;
+
+/**
+ * Maps a rectangle in surface coordinates into the buffer
+ *
+ * \param [in] rect          the rectangle on the surface
+ * \param [in] source        the part of the buffer shown on the surface (the whole buffer without a viewport)
+ * \param [in] surface_size  the size \a source is scaled to
+ * \return                   the buffer pixels \a rect touches, clipped to \a source
+ */
+auto surface_to_buffer(
+    geometry::Rectangle const& rect,
+    geometry::Rectangle const& source,
+    geometry::Size const& surface_size) -> geometry::Rectangle;
 
 struct WlSurfaceState
 {
@@ -68,6 +87,28 @@ struct WlSurfaceState
         std::shared_ptr<bool> destroyed;
     };
 
+    /// wp_viewport crop and scale: each part is independently optional
+    struct Viewport
+    {
+        /// The source as the client set it, which may be fractional
+        struct Source
+        {
+            double x, y, width, height;
+
+            /// The buffer pixels the source touches (rounded outwards)
+            auto covering() const -> geometry::Rectangle;
+
+            bool operator==(Source const& other) const
+            { return x == other.x && y == other.y && width == other.width && height == other.height; }
+        };
+
+        std::experimental::optional<Source> source;
+        std::experimental::optional<geometry::Size> destination;
+
+        bool operator==(Viewport const& other) const
+        { return source == other.source && destination == other.destination; }
+    };
+
     // if you add variables, don't forget to update this
     void update_from(WlSurfaceState const& source);
 
@@ -82,7 +123,16 @@ struct WlSurfaceState
 
     std::experimental::optional<geometry::Displacement> offset;
     std::experimental::optional<std::experimental::optional<std::vector<geometry::Rectangle>>> input_shape;
+    // A null region (nothing opaque) is represented by an empty vector
+    std::experimental::optional<std::vector<geometry::Rectangle>> opaque_region;
     std::vector<std::shared_ptr<Callback>> frame_callbacks;
+    std::vector<std::shared_ptr<PresentationListener>> presentation_feedbacks;
+    std::experimental::optional<Viewport> viewport;
+
+    // The region of the buffer changed since the last commit (empty if the client did not say)
+    geometry::Rectangles damage;
+    // As damage, but in surface coordinates (mapped into the buffer through the viewport on commit)
+    geometry::Rectangles surface_damage;
 
 private:
     // only set to true if invalidate_surface_data() is called
@@ -126,6 +176,8 @@ public:
     geometry::Displacement offset() const { return offset_; }
     geometry::Displacement total_offset() const { return offset_ + role->total_offset(); }
     std::experimental::optional<geometry::Size> buffer_size() const { return buffer_size_; }
+    /// The buffer size after the viewport crops and scales it (nullopt without a buffer)
+    std::experimental::optional<geometry::Size> size() const;
     bool synchronized() const;
     Position transform_point(geometry::Point point);
     wl_resource* raw_resource() const { return resource; }
@@ -137,6 +189,12 @@ public:
     std::unique_ptr<WlSurface, std::function<void(WlSurface*)>> add_child(WlSubsurface* child);
     void refresh_surface_data_now();
     void pending_invalidate_surface_data() { pending.invalidate_surface_data(); }
+    void add_presentation_feedback(std::shared_ptr<PresentationListener> const& feedback);
+    void set_pending_viewport_source(std::experimental::optional<WlSurfaceState::Viewport::Source> const& source);
+    void set_pending_viewport_destination(std::experimental::optional<geometry::Size> const& destination);
+    /// The wp_viewport of this surface (a surface has at most one), or nullptr
+    wayland::Viewport* viewport() const { return viewport_object; }
+    void set_viewport(wayland::Viewport* viewport) { viewport_object = viewport; }
     void populate_surface_data(std::vector<shell::StreamSpecification>& buffer_streams,
                                std::vector<mir::geometry::Rectangle>& input_shape_accumulator,
                                geometry::Displacement const& parent_offset) const;
@@ -160,13 +218,19 @@ private:
     WlSurfaceState pending;
     geometry::Displacement offset_;
     std::experimental::optional<geometry::Size> buffer_size_;
+    WlSurfaceState::Viewport viewport_;
+    wayland::Viewport* viewport_object{nullptr};
     std::vector<std::shared_ptr<WlSurfaceState::Callback>> frame_callbacks;
     std::experimental::optional<std::vector<mir::geometry::Rectangle>> input_shape;
+    std::vector<mir::geometry::Rectangle> opaque_region;
     std::map<void const*, std::function<void()>> destroy_listeners;
     std::shared_ptr<bool> const destroyed;
 
     void send_frame_callbacks();
 
+    /// Posts bad_size or out_of_buffer (returning false) if the viewport can't apply to the current buffer
+    auto check_viewport() const -> bool;
+
     void destroy() override;
     void attach(std::experimental::optional<wl_resource*> const& buffer, int32_t x, int32_t y) override;
     void damage(int32_t x, int32_t y, int32_t width, int32_t height) override;
@@ -30,7 +30,12 @@
 
 #include <boost/throw_exception.hpp>
 
+#include <atomic>
+#include <csignal>
+#include <cstdio>
 #include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace
 {
@@ -45,6 +50,127 @@ wl_shm_buffer* shm_buffer_from_resource_checked(wl_resource* resource)
     return buffer;
 }
 
+// The access in progress. Only one thread accesses a pool at a time, and the handler only
+// touches lock-free atomics, so this is safe to use from signal context.
+std::atomic<char*> accessed_start{nullptr};
+std::atomic<size_t> accessed_size{0};
+std::atomic<bool> accessed_range_truncated{false};
+static_assert(ATOMIC_POINTER_LOCK_FREE == 2 && ATOMIC_BOOL_LOCK_FREE == 2, "SIGBUS handler needs lock-free atomics");
+
+struct sigaction previous_sigbus_action;
+long const page_size{sysconf(_SC_PAGESIZE)};
+
+void forward_to_previous_handler(int sig, siginfo_t* info, void* context)
+{
+    if (previous_sigbus_action.sa_flags & SA_SIGINFO)
+    {
+        previous_sigbus_action.sa_sigaction(sig, info, context);
+    }
+    else if (previous_sigbus_action.sa_handler == SIG_DFL || previous_sigbus_action.sa_handler == SIG_IGN)
+    {
+        // A fault will recur without us in the way; a signal that was sent won't
+        sigaction(sig, &previous_sigbus_action, nullptr);
+        if (info->si_code <= 0)
+            raise(sig);
+    }
+    else
+    {
+        previous_sigbus_action.sa_handler(sig);
+    }
+}
+
+extern "C" void handle_sigbus(int sig, siginfo_t* info, void* context)
+{
+    auto const address = static_cast<char*>(info->si_addr);
+    auto const start = accessed_start.load();
+    auto const size = accessed_size.load();
+
+    if (start && start <= address && address < start + size)
+    {
+        // Replace the missing part of the client's mapping with zeros, so that the access completes
+        auto const first_page = reinterpret_cast<char*>(reinterpret_cast<uintptr_t>(start) & ~(page_size - 1));
+        auto const length = start + size - first_page;
+
+        if (mmap(first_page, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED | MAP_ANONYMOUS, -1, 0) !=
+            MAP_FAILED)
+        {
+            accessed_range_truncated = true;
+            return;
+        }
+    }
+
+    forward_to_previous_handler(sig, info, context);
+}
+
+/// Guards an access to a client's shm pool, which the client may truncate at any time
+///
+/// This does the job of wl_shm_buffer_begin_access()/end_access() on any thread. Those can only be
+/// used on the Wayland thread as end_access() posts the protocol error. Our SIGBUS handler is only
+/// installed for the duration of the access, so it doesn't matter what else installs handlers (and
+/// when), and faults that aren't in the accessed range go to whatever handler it replaced.
+class PoolAccess
+{
+public:
+    PoolAccess(wl_shm_buffer* buffer)
+        : data{static_cast<char*>(wl_shm_buffer_get_data(buffer))},
+          lock{access_mutex}
+    {
+        accessed_size = size_t(wl_shm_buffer_get_height(buffer)) * wl_shm_buffer_get_stride(buffer);
+        accessed_range_truncated = false;
+        accessed_start = data;
+
+        struct sigaction action;
+        action.sa_sigaction = &handle_sigbus;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigaction(SIGBUS, &action, &previous_sigbus_action);
+    }
+
+    ~PoolAccess()
+    {
+        sigaction(SIGBUS, &previous_sigbus_action, nullptr);
+        accessed_start = nullptr;
+    }
+
+    char* const data;
+
+    /// Whether the client truncated the pool during the access (and we saw zeros instead)
+    auto truncated() const -> bool
+    {
+        return accessed_range_truncated;
+    }
+
+private:
+    PoolAccess(PoolAccess const&) = delete;
+    PoolAccess& operator=(PoolAccess const&) = delete;
+
+    /// Serialises accesses, as there's one handler (and accessed range) for the process
+    static std::mutex access_mutex;
+    std::lock_guard<std::mutex> const lock;
+};
+
+std::mutex PoolAccess::access_mutex;
+
+void post_truncated_pool_error(wl_resource* buffer)
+{
+    wl_resource_post_error(buffer, WL_SHM_ERROR_INVALID_FD, "error accessing SHM buffer");
+}
+
+/// \note This must be called on the Wayland thread
+/// \param report_to   if not null, the buffer to post a protocol error on if the client truncated its pool
+std::unique_ptr<uint8_t[]> copy_pixels(wl_shm_buffer* buffer, wl_resource* report_to)
+{
+    auto const size = wl_shm_buffer_get_height(buffer) * wl_shm_buffer_get_stride(buffer);
+    auto copy = std::make_unique<uint8_t[]>(size);
+
+    PoolAccess const access{buffer};
+    std::memcpy(copy.get(), access.data, size);
+    if (access.truncated() && report_to)
+        post_truncated_pool_error(report_to);
+
+    return copy;
+}
+
 MirPixelFormat wl_format_to_mir_format(uint32_t format)
 {
     switch (format)
@@ -121,6 +247,69 @@ GLenum const abgr = GL_INVALID_ENUM;
 
     return gl_format != GL_INVALID_ENUM && gl_type != GL_INVALID_ENUM;
 }
+
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH GL_UNPACK_ROW_LENGTH_EXT
+#endif
+
+/// \note This must be called with a current GL context
+bool unpack_row_length_supported()
+{
+    static bool const supported =
+        []()
+        {
+            auto const version = reinterpret_cast<char const*>(glGetString(GL_VERSION));
+            auto const extensions = reinterpret_cast<char const*>(glGetString(GL_EXTENSIONS));
+
+            int major = 0;
+            bool const is_gles = version && strstr(version, "OpenGL ES");
+            if (version && !is_gles)
+                return true;    // Desktop GL has always had it
+            if (version && sscanf(version, "OpenGL ES %d", &major) == 1 && major >= 3)
+                return true;
+            return extensions && strstr(extensions, "GL_EXT_unpack_subimage");
+        }();
+
+    return supported;
+}
+
+/// Uploads the area of pixels (in buffer coordinates) into the bound texture
+void upload_sub_rectangle(
+    unsigned char const* pixels,
+    mir::geometry::Size const& size,
+    mir::geometry::Stride const& stride,
+    int bytes_per_pixel,
+    mir::geometry::Rectangle const& area,
+    GLenum format,
+    GLenum type)
+{
+    auto const x = area.left().as_int();
+    auto const y = area.top().as_int();
+    auto const width = area.size.width.as_int();
+    auto const height = area.size.height.as_int();
+    auto const first_pixel = pixels + y * stride.as_int() + x * bytes_per_pixel;
+
+    if (unpack_row_length_supported())
+    {
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, stride.as_int() / bytes_per_pixel);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, format, type, first_pixel);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    }
+    else if (stride.as_int() == size.width.as_int() * bytes_per_pixel)
+    {
+        // Whole rows are contiguous, so upload the full width of the damaged rows
+        glTexSubImage2D(
+            GL_TEXTURE_2D, 0, 0, y, size.width.as_int(), height, format, type, pixels + y * stride.as_int());
+    }
+    else
+    {
+        for (auto row = 0; row != height; ++row)
+        {
+            glTexSubImage2D(
+                GL_TEXTURE_2D, 0, x, y + row, width, 1, format, type, first_pixel + row * stride.as_int());
+        }
+    }
+}
 }
 
 namespace mf = mir::frontend;
@@ -132,6 +321,10 @@ mf::WlShmBuffer::~WlShmBuffer()
     executor->spawn([wayland = wayland]()
         {
             std::lock_guard <std::mutex> lock{wayland->mutex};
+            if (wayland->pool) {
+                wl_shm_pool_unref(wayland->pool);
+                wayland->pool = nullptr;
+            }
             if (wayland->resource) {
                 wl_resource_queue_event(wayland->resource.value(), WL_BUFFER_RELEASE);
             }
@@ -141,7 +334,8 @@ mf::WlShmBuffer::~WlShmBuffer()
 std::shared_ptr<mg::Buffer> mf::WlShmBuffer::mir_buffer_from_wl_buffer(
     wl_resource *buffer,
     std::shared_ptr<Executor> executor,
-    std::function<void()> &&on_consumed)
+    std::function<void()> &&on_consumed,
+    Access access)
 {
     DestructionShim* shim = nullptr;
 
@@ -177,7 +371,7 @@ std::shared_ptr<mg::Buffer> mf::WlShmBuffer::mir_buffer_from_wl_buffer(
         shim = new DestructionShim{buffer};
     }
 
-    auto mir_buffer = std::make_shared<WlShmBuffer>(buffer, executor, std::move(on_consumed));
+    auto mir_buffer = std::make_shared<WlShmBuffer>(buffer, executor, std::move(on_consumed), access);
     shim->mir_buffer = mir_buffer;
     shim->resources = mir_buffer->wayland;
     return mir_buffer;
@@ -236,6 +430,33 @@ void mf::WlShmBuffer::bind()
     gl_bind_to_texture();
 }
 
+void mf::WlShmBuffer::bind_damaged(Rectangles const& damage)
+{
+    GLenum format, type;
+
+    if (get_gl_pixel_format(
+        format_,
+        format,
+        type)) {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        read(
+            [this, format, type, &damage](unsigned char const *pixels)
+            {
+                Rectangle const buffer_area{{}, size_};
+                for (auto const& rect : damage)
+                {
+                    auto const area = rect.intersection_with(buffer_area);
+                    if (area.size.width.as_int() > 0 && area.size.height.as_int() > 0)
+                    {
+                        upload_sub_rectangle(
+                            pixels, size_, stride_, MIR_BYTES_PER_PIXEL(format_), area, format, type);
+                    }
+                }
+            });
+    }
+}
+
 void mf::WlShmBuffer::secure_for_render()
 {
 }
@@ -248,10 +469,10 @@ void mf::WlShmBuffer::write(unsigned char const *pixels, size_t size)
         return;
     }
 
-    wl_shm_buffer_begin_access(wayland->buffer.value());
-    auto data = wl_shm_buffer_get_data(wayland->buffer.value());
-    ::memcpy(data, pixels, size);
-    wl_shm_buffer_end_access(wayland->buffer.value());
+    PoolAccess const access{wayland->buffer.value()};
+    ::memcpy(access.data, pixels, size);
+    if (access.truncated())
+        report_truncated_pool();
 }
 
 void mf::WlShmBuffer::read(std::function<void(unsigned char const *)> const &do_with_pixels)
@@ -263,7 +484,36 @@ void mf::WlShmBuffer::read(std::function<void(unsigned char const *)> const &do_
         consumed = true;
     }
 
-    do_with_pixels(static_cast<unsigned char const *>(data.get()));
+    if (wayland->copy)
+    {
+        do_with_pixels(static_cast<unsigned char const *>(wayland->copy.get()));
+    }
+    else if (wayland->buffer)
+    {
+        // The client may truncate the pool under us, which we report back on the Wayland thread
+        bool truncated;
+        {
+            PoolAccess const access{wayland->buffer.value()};
+            do_with_pixels(reinterpret_cast<unsigned char const *>(access.data));
+            truncated = access.truncated();
+        }
+        if (truncated)
+            report_truncated_pool();
+    }
+    else
+    {
+        log_warning("Attempt to read from WlShmBuffer after the wl_buffer has been destroyed");
+    }
+}
+
+void mf::WlShmBuffer::report_truncated_pool()
+{
+    executor->spawn([wayland = wayland]()
+        {
+            std::lock_guard <std::mutex> lock{wayland->mutex};
+            if (wayland->resource)
+                post_truncated_pool_error(wayland->resource.value());
+        });
 }
 
 Stride mf::WlShmBuffer::stride() const
@@ -286,7 +536,8 @@ mf::WlShmBuffer::DestructionShim::DestructionShim(wl_resource* buffer_resource)
 mf::WlShmBuffer::WlShmBuffer(
     wl_resource *buffer,
     std::shared_ptr<Executor> executor,
-    std::function<void()> &&on_consumed)
+    std::function<void()> &&on_consumed,
+    Access access)
     :
     wayland{std::make_shared<WaylandResources>(buffer)},
     size_{
@@ -294,7 +545,6 @@ mf::WlShmBuffer::WlShmBuffer(
         wl_shm_buffer_get_height(wayland->buffer.value())},
     stride_{wl_shm_buffer_get_stride(wayland->buffer.value())},
     format_{wl_format_to_mir_format(wl_shm_buffer_get_format(wayland->buffer.value()))},
-    data{std::make_unique<uint8_t[]>(size_.height.as_int() * stride_.as_int())},
     consumed{false},
     on_consumed{std::move(on_consumed)},
     executor{executor}
@@ -311,9 +561,16 @@ mf::WlShmBuffer::WlShmBuffer(
                                   std::runtime_error{"Buffer has invalid stride"}));
     }
 
-    wl_shm_buffer_begin_access(wayland->buffer.value());
-    std::memcpy(data.get(), wl_shm_buffer_get_data(wayland->buffer.value()), size_.height.as_int() * stride_.as_int());
-    wl_shm_buffer_end_access(wayland->buffer.value());
+    switch (access)
+    {
+    case Access::zero_copy:
+        wayland->pool = wl_shm_buffer_ref_pool(wayland->buffer.value());
+        break;
+
+    case Access::copy:
+        wayland->copy = copy_pixels(wayland->buffer.value(), wayland->resource.value());
+        break;
+    }
 }
 
 void mf::WlShmBuffer::on_buffer_destroyed(wl_listener *listener, void *)
@@ -329,6 +586,15 @@ void mf::WlShmBuffer::on_buffer_destroyed(wl_listener *listener, void *)
         if (auto resources = shim->resources.lock())
         {
             std::lock_guard <std::mutex> lock{resources->mutex};
+            if (resources->pool && resources->buffer)
+            {
+                // The client has destroyed a buffer we may still be sampling. Without the
+                // wl_shm_buffer we can't guard against the pool being truncated, so take a copy.
+                // The client is done with the buffer, so there's no-one to report a truncated pool to.
+                resources->copy = copy_pixels(resources->buffer.value(), nullptr);
+                wl_shm_pool_unref(resources->pool);
+                resources->pool = nullptr;
+            }
             resources->buffer = std::experimental::nullopt;
             resources->resource = std::experimental::nullopt;
         }
@@ -22,6 +22,7 @@
 
 #include <mir/graphics/buffer_basic.h>
 #include <mir/renderer/gl/texture_source.h>
+#include <mir/renderer/gl/partial_texture_source.h>
 #include <mir/renderer/sw/pixel_source.h>
 
 #include <wayland-server-core.h>
@@ -42,19 +43,31 @@ class WlShmBuffer :
     public graphics::BufferBasic,
     public graphics::NativeBufferBase,
     public renderer::gl::TextureSource,
+    public renderer::gl::PartialTextureSource,
     public renderer::software::PixelSource
 {
 public:
+    /// How the client's pixels are sampled
+    enum class Access
+    {
+        /// Read the client's shm pool in place, holding the pool until the buffer is released
+        zero_copy,
+        /// Copy the pixels out of the client's shm pool on commit
+        copy
+    };
+
     WlShmBuffer(
         wl_resource *buffer,
         std::shared_ptr<Executor>,
-        std::function<void()> &&on_consumed);
+        std::function<void()> &&on_consumed,
+        Access access);
     ~WlShmBuffer();
 
     static std::shared_ptr <graphics::Buffer> mir_buffer_from_wl_buffer(
         wl_resource *buffer,
         std::shared_ptr<Executor> executor,
-        std::function<void()> &&on_consumed);
+        std::function<void()> &&on_consumed,
+        Access access);
 
     std::shared_ptr <graphics::NativeBuffer> native_buffer_handle() const override;
 
@@ -68,6 +81,8 @@ public:
 
     void bind() override;
 
+    void bind_damaged(geometry::Rectangles const& damage) override;
+
     void secure_for_render() override;
 
     void write(unsigned char const *pixels, size_t size) override;
@@ -82,6 +97,9 @@ private:
 
     static void on_buffer_destroyed(wl_listener *listener, void *);
 
+    /// Posts the client's protocol error for truncating its pool (from any thread)
+    void report_truncated_pool();
+
     struct WaylandResources
     {
         WaylandResources(wl_resource *resource);
@@ -89,6 +107,11 @@ private:
         std::mutex mutex;
         std::experimental::optional<wl_resource* const> resource;
         std::experimental::optional<wl_shm_buffer* const> buffer;
+
+        /// Keeps the client's mapping alive (and defers pool resizes) while we sample it in place
+        wl_shm_pool* pool{nullptr};
+        /// Our own snapshot of the pixels, if we can't (or can no longer) read the client's pool
+        std::unique_ptr<uint8_t[]> copy;
     };
 
     struct DestructionShim
@@ -106,8 +129,6 @@ private:
     geometry::Stride const stride_;
     MirPixelFormat const format_;
 
-    std::unique_ptr<uint8_t[]> const data;
-
     bool consumed;
     std::function<void()> on_consumed;
 
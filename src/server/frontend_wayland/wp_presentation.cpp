@@ -0,0 +1,381 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wp_presentation.h"
+
+#include "wl_surface.h"
+#include "output_manager.h"
+#include "mir_display.h"
+#include "deleted_for_resource.h"
+
+#include "mir/executor.h"
+#include "mir/graphics/display.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/scene/surface.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace ms = mir::scene;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+using namespace std::chrono_literals;
+
+namespace
+{
+using Timestamp = mg::Frame::Timestamp;
+
+// How long to wait for the flip that displays consumed content before assuming it never came
+auto const flip_timeout = 100ms;
+
+// Allowance for the flip to be reported a little after it is due
+auto const flip_slack = 1ms;
+
+auto refresh_period(mg::DisplayConfigurationOutput const& output) -> std::chrono::nanoseconds
+{
+    if (output.current_mode_index >= output.modes.size())
+        return 0ns;
+
+    auto const hz = output.modes[output.current_mode_index].vrefresh_hz;
+    return hz > 0 ? std::chrono::nanoseconds{static_cast<int64_t>(1e9 / hz)} : 0ns;
+}
+
+// Outputs that do not track page flips (offscreen, virtual, nested...) report a default constructed frame
+auto tracks_flips(mg::Frame const& frame) -> bool
+{
+    return frame.msc != 0 && frame.ust.clock_id == CLOCK_MONOTONIC;
+}
+}
+
+namespace mir
+{
+namespace frontend
+{
+class WpPresentation : public wayland::Presentation::Global
+{
+public:
+    WpPresentation(
+        wl_display* display,
+        std::shared_ptr<graphics::Display> const& graphics_display,
+        OutputManager* const output_manager);
+
+private:
+    class Instance : public wayland::Presentation
+    {
+    public:
+        Instance(wl_resource* new_resource, std::weak_ptr<PresentationClock> const& clock);
+
+    private:
+        void destroy() override;
+        void feedback(wl_resource* surface, wl_resource* callback) override;
+
+        std::weak_ptr<PresentationClock> const clock;
+    };
+
+    void bind(wl_resource* new_resource) override;
+
+    std::shared_ptr<PresentationClock> const clock;
+};
+}
+}
+
+auto mf::presentation_flip(
+    mg::Frame const& last_flip,
+    std::chrono::nanoseconds refresh,
+    Timestamp const& consumed_at) -> std::experimental::optional<mg::Frame>
+{
+    if (last_flip.ust <= consumed_at)
+        return std::experimental::nullopt;
+
+    if (refresh <= 0ns)
+        return last_flip;
+
+    // The content was displayed by the first flip after it was consumed, which may be before the last one
+    auto const later_flips = (last_flip.ust - consumed_at - 1ns) / refresh;
+    return mg::Frame{last_flip.msc - later_flips, last_flip.ust - later_flips * refresh};
+}
+
+mf::WpPresentationFeedback::WpPresentationFeedback(
+    wl_resource* new_resource,
+    std::weak_ptr<PresentationClock> const& clock,
+    std::weak_ptr<scene::Surface> const& scene_surface)
+    : mw::PresentationFeedback{new_resource, Version<1>()},
+      destroyed{deleted_flag_for_resource(resource)},
+      clock{clock},
+      scene_surface{scene_surface}
+{
+}
+
+void mf::WpPresentationFeedback::consumed(Timestamp const& consumed_at)
+{
+    if (*destroyed)
+        return;
+
+    auto const clock = this->clock.lock();
+    if (!clock)
+    {
+        discarded();
+        return;
+    }
+
+    std::experimental::optional<geom::Point> surface_position;
+    if (auto const surface = scene_surface.lock())
+        surface_position = surface->top_left();
+
+    clock->present(shared_from_this(), surface_position, consumed_at);
+}
+
+void mf::WpPresentationFeedback::discarded()
+{
+    if (*destroyed)
+        return;
+
+    send_discarded_event();
+    destroy_wayland_object();
+}
+
+void mf::WpPresentationFeedback::presented(mg::Frame const& frame, std::chrono::nanoseconds refresh, uint32_t flags)
+{
+    if (*destroyed)
+        return;
+
+    auto const nanoseconds = frame.ust.nanoseconds.count();
+    uint64_t const seconds = nanoseconds / 1000000000;
+    uint64_t const sequence = frame.msc;
+
+    send_presented_event(
+        seconds >> 32, seconds & 0xffffffff,
+        nanoseconds % 1000000000,
+        refresh.count(),
+        sequence >> 32, sequence & 0xffffffff,
+        flags);
+    destroy_wayland_object();
+}
+
+mf::PresentationFeedbacks::PresentationFeedbacks(
+    std::shared_ptr<Executor> const& executor,
+    std::vector<std::shared_ptr<PresentationListener>> const& listeners)
+    : executor{executor},
+      listeners{listeners}
+{
+}
+
+mf::PresentationFeedbacks::~PresentationFeedbacks()
+{
+    resolve([](PresentationListener& listener) { listener.discarded(); });
+}
+
+void mf::PresentationFeedbacks::consumed()
+{
+    auto const consumed_at = Timestamp::now(CLOCK_MONOTONIC);
+    resolve([consumed_at](PresentationListener& listener) { listener.consumed(consumed_at); });
+}
+
+template<typename Action>
+void mf::PresentationFeedbacks::resolve(Action const& action)
+{
+    std::vector<std::shared_ptr<PresentationListener>> unresolved;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        unresolved.swap(listeners);
+    }
+
+    if (!unresolved.empty())
+    {
+        executor->spawn([unresolved = std::move(unresolved), action]()
+            {
+                for (auto const& listener : unresolved)
+                    action(*listener);
+            });
+    }
+}
+
+mf::PresentationClock::PresentationClock(
+    wl_event_loop* event_loop,
+    std::shared_ptr<mg::Display> const& graphics_display,
+    std::shared_ptr<MirDisplay> const& outputs)
+    : graphics_display{graphics_display},
+      outputs{outputs},
+      timer{wl_event_loop_add_timer(event_loop, &on_timer, this)}
+{
+}
+
+mf::PresentationClock::~PresentationClock()
+{
+    wl_event_source_remove(timer);
+}
+
+void mf::PresentationClock::present(
+    std::shared_ptr<PresentationListener> const& listener,
+    std::experimental::optional<geom::Point> const& surface_position,
+    Timestamp const& consumed_at)
+{
+    // Synchronise to the output containing the top left of the surface, or failing that the first output
+    std::experimental::optional<Waiting> presentation;
+    outputs->for_each_output(
+        [&](mg::DisplayConfigurationOutput const& output)
+        {
+            if (!output.used || !output.connected)
+                return;
+
+            if (!presentation || (surface_position && output.extents().contains(surface_position.value())))
+                presentation = Waiting{listener, output.id, refresh_period(output), consumed_at};
+        });
+
+    if (!presentation)
+    {
+        listener->discarded();
+        return;
+    }
+
+    auto const now = Timestamp::now(CLOCK_MONOTONIC);
+    if (!try_present(presentation.value(), now))
+    {
+        waiting.push_back(presentation.value());
+        schedule(now);
+    }
+}
+
+auto mf::PresentationClock::last_flip_on(mg::DisplayConfigurationOutputId output_id) const -> mg::Frame
+{
+    try
+    {
+        return graphics_display->last_frame_on(output_id.as_value());
+    }
+    catch (std::exception const&)
+    {
+        // The output has gone away since we looked it up
+        return {};
+    }
+}
+
+auto mf::PresentationClock::try_present(Waiting const& waiting, Timestamp const& now) const -> bool
+{
+    auto const last_flip = last_flip_on(waiting.output_id);
+
+    if (!tracks_flips(last_flip))
+    {
+        // Without flips to go on, the content is as presented as it will ever be once composited
+        waiting.listener->presented(mg::Frame{0, waiting.consumed_at}, waiting.refresh, 0);
+        return true;
+    }
+
+    if (auto const flip = presentation_flip(last_flip, waiting.refresh, waiting.consumed_at))
+    {
+        waiting.listener->presented(
+            flip.value(),
+            waiting.refresh,
+            mw::PresentationFeedback::Kind::vsync | mw::PresentationFeedback::Kind::hw_completion);
+        return true;
+    }
+
+    if (now - waiting.consumed_at > flip_timeout)
+    {
+        // The frame was never posted (e.g. the output was turned off)
+        waiting.listener->discarded();
+        return true;
+    }
+
+    return false;
+}
+
+void mf::PresentationClock::schedule(Timestamp const& now)
+{
+    // Wake up just after the earliest flip we're waiting for is due
+    std::chrono::nanoseconds delay = flip_timeout;
+    for (auto const& presentation : waiting)
+    {
+        auto const last_flip = last_flip_on(presentation.output_id);
+
+        if (presentation.refresh > 0ns && last_flip.ust <= now)
+            delay = std::min(delay, presentation.refresh - (now - last_flip.ust) % presentation.refresh + flip_slack);
+        else
+            delay = std::min<std::chrono::nanoseconds>(delay, flip_slack);
+    }
+
+    auto const delay_ms = std::chrono::duration_cast<std::chrono::milliseconds>(delay + 999us);
+    wl_event_source_timer_update(timer, std::max<int>(delay_ms.count(), 1));
+}
+
+int mf::PresentationClock::on_timer(void* data)
+{
+    auto const self = static_cast<PresentationClock*>(data);
+    auto const now = Timestamp::now(CLOCK_MONOTONIC);
+
+    std::vector<Waiting> still_waiting;
+    for (auto const& presentation : self->waiting)
+    {
+        if (!self->try_present(presentation, now))
+            still_waiting.push_back(presentation);
+    }
+    self->waiting = std::move(still_waiting);
+
+    if (!self->waiting.empty())
+        self->schedule(now);
+
+    return 0;
+}
+
+mf::WpPresentation::WpPresentation(
+    wl_display* display,
+    std::shared_ptr<mg::Display> const& graphics_display,
+    OutputManager* const output_manager)
+    : Global{display, Version<1>()},
+      clock{std::make_shared<PresentationClock>(
+          wl_display_get_event_loop(display),
+          graphics_display,
+          output_manager->display_config())}
+{
+}
+
+void mf::WpPresentation::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource, clock};
+}
+
+mf::WpPresentation::Instance::Instance(wl_resource* new_resource, std::weak_ptr<PresentationClock> const& clock)
+    : Presentation{new_resource, Version<1>()},
+      clock{clock}
+{
+    send_clock_id_event(CLOCK_MONOTONIC);
+}
+
+void mf::WpPresentation::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::WpPresentation::Instance::feedback(wl_resource* surface, wl_resource* callback)
+{
+    auto const wl_surface = WlSurface::from(surface);
+
+    std::weak_ptr<ms::Surface> scene_surface;
+    if (auto const mapped = wl_surface->scene_surface())
+        scene_surface = mapped.value();
+
+    wl_surface->add_presentation_feedback(std::make_shared<WpPresentationFeedback>(callback, clock, scene_surface));
+}
+
+auto mf::create_wp_presentation(
+    wl_display* display,
+    std::shared_ptr<mg::Display> const& graphics_display,
+    OutputManager* const output_manager) -> std::shared_ptr<WpPresentation>
+{
+    return std::make_shared<WpPresentation>(display, graphics_display, output_manager);
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_WP_PRESENTATION_H
+#define MIR_FRONTEND_WP_PRESENTATION_H
+
+#include "presentation-time_wrapper.h"
+
+#include "mir/graphics/frame.h"
+#include "mir/graphics/display_configuration.h"
+#include "mir/geometry/point.h"
+
+#include <experimental/optional>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct wl_display;
+struct wl_event_loop;
+struct wl_event_source;
+
+namespace mir
+{
+class Executor;
+
+namespace graphics
+{
+class Display;
+}
+namespace scene
+{
+class Surface;
+}
+namespace frontend
+{
+class WpPresentation;
+class OutputManager;
+class MirDisplay;
+
+/**
+ * The output refresh that first displayed content the compositor consumed at \a consumed_at
+ *
+ * \param [in] last_flip    the most recent page flip completed on the output
+ * \param [in] refresh      the refresh period of the output, or zero if it is unknown
+ * \return                  the flip that displayed the content, or nullopt if it has not happened yet
+ */
+auto presentation_flip(
+    graphics::Frame const& last_flip,
+    std::chrono::nanoseconds refresh,
+    graphics::Frame::Timestamp const& consumed_at) -> std::experimental::optional<graphics::Frame>;
+
+/// Follows a content update from a wl_surface.commit to the display
+class PresentationListener
+{
+public:
+    PresentationListener() = default;
+    virtual ~PresentationListener() = default;
+    PresentationListener(PresentationListener const&) = delete;
+    PresentationListener& operator=(PresentationListener const&) = delete;
+
+    /// The compositor has used the content update for a frame; "presented" follows the next flip
+    virtual void consumed(graphics::Frame::Timestamp const& consumed_at) = 0;
+
+    /// The content update was replaced or removed before the compositor used it
+    virtual void discarded() = 0;
+
+    virtual void presented(graphics::Frame const& frame, std::chrono::nanoseconds refresh, uint32_t flags) = 0;
+};
+
+/// The listeners for a content update: told when the compositor consumes its buffer,
+/// or that it was discarded if the buffer is released without being used
+class PresentationFeedbacks
+{
+public:
+    PresentationFeedbacks(
+        std::shared_ptr<Executor> const& executor,
+        std::vector<std::shared_ptr<PresentationListener>> const& listeners);
+
+    ~PresentationFeedbacks();
+
+    /// Called on the compositor thread, so notes the time before handing over to the Wayland thread
+    void consumed();
+
+private:
+    template<typename Action>
+    void resolve(Action const& action);
+
+    std::shared_ptr<Executor> const executor;
+    std::mutex mutex;
+    std::vector<std::shared_ptr<PresentationListener>> listeners;
+};
+
+/// Waits (on the Wayland event loop) for the flips that display consumed content
+class PresentationClock
+{
+public:
+    PresentationClock(
+        wl_event_loop* event_loop,
+        std::shared_ptr<graphics::Display> const& graphics_display,
+        std::shared_ptr<MirDisplay> const& outputs);
+
+    ~PresentationClock();
+
+    void present(
+        std::shared_ptr<PresentationListener> const& listener,
+        std::experimental::optional<geometry::Point> const& surface_position,
+        graphics::Frame::Timestamp const& consumed_at);
+
+private:
+    struct Waiting
+    {
+        std::shared_ptr<PresentationListener> listener;
+        graphics::DisplayConfigurationOutputId output_id;
+        std::chrono::nanoseconds refresh;
+        graphics::Frame::Timestamp consumed_at;
+    };
+
+    auto last_flip_on(graphics::DisplayConfigurationOutputId output_id) const -> graphics::Frame;
+
+    /// Tells the listener if the outcome is known, returning true if it was told
+    auto try_present(Waiting const& waiting, graphics::Frame::Timestamp const& now) const -> bool;
+
+    void schedule(graphics::Frame::Timestamp const& now);
+
+    static int on_timer(void* data);
+
+    std::shared_ptr<graphics::Display> const graphics_display;
+    std::shared_ptr<MirDisplay> const outputs;
+    wl_event_source* const timer;
+    std::vector<Waiting> waiting;
+};
+
+/// Feedback requested by a client for a single wl_surface.commit
+class WpPresentationFeedback
+    : public wayland::PresentationFeedback,
+      public PresentationListener,
+      public std::enable_shared_from_this<WpPresentationFeedback>
+{
+public:
+    WpPresentationFeedback(
+        wl_resource* new_resource,
+        std::weak_ptr<PresentationClock> const& clock,
+        std::weak_ptr<scene::Surface> const& scene_surface);
+
+    void consumed(graphics::Frame::Timestamp const& consumed_at) override;
+    void discarded() override;
+    void presented(graphics::Frame const& frame, std::chrono::nanoseconds refresh, uint32_t flags) override;
+
+    std::shared_ptr<bool> const destroyed;
+
+private:
+    std::weak_ptr<PresentationClock> const clock;
+    std::weak_ptr<scene::Surface> const scene_surface;
+};
+
+auto create_wp_presentation(
+    wl_display* display,
+    std::shared_ptr<graphics::Display> const& graphics_display,
+    OutputManager* const output_manager) -> std::shared_ptr<WpPresentation>;
+}
+}
+
+#endif // MIR_FRONTEND_WP_PRESENTATION_H
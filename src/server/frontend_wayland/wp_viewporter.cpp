@@ -0,0 +1,179 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "wp_viewporter.h"
+
+#include "wl_surface.h"
+
+namespace mf = mir::frontend;
+namespace mw = mir::wayland;
+namespace geom = mir::geometry;
+
+namespace mir
+{
+namespace frontend
+{
+class WpViewporter : public wayland::Viewporter::Global
+{
+public:
+    WpViewporter(wl_display* display);
+
+private:
+    class Instance : public wayland::Viewporter
+    {
+    public:
+        Instance(wl_resource* new_resource);
+
+    private:
+        void destroy() override;
+        void get_viewport(wl_resource* id, wl_resource* surface) override;
+    };
+
+    void bind(wl_resource* new_resource) override;
+};
+
+/// Crops and scales the content of a WlSurface (the renderer does the work)
+class WpViewport : public wayland::Viewport
+{
+public:
+    WpViewport(wl_resource* new_resource, WlSurface* surface);
+    ~WpViewport();
+
+private:
+    void destroy() override;
+    void set_source(double x, double y, double width, double height) override;
+    void set_destination(int32_t width, int32_t height) override;
+
+    /// Posts no_surface and returns false if the surface has gone
+    auto check_surface() const -> bool;
+
+    WlSurface* surface; // nullptr once the surface is destroyed
+};
+}
+}
+
+mf::WpViewporter::WpViewporter(wl_display* display)
+    : Global{display, Version<1>()}
+{
+}
+
+void mf::WpViewporter::bind(wl_resource* new_resource)
+{
+    new Instance{new_resource};
+}
+
+mf::WpViewporter::Instance::Instance(wl_resource* new_resource)
+    : Viewporter{new_resource, Version<1>()}
+{
+}
+
+void mf::WpViewporter::Instance::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::WpViewporter::Instance::get_viewport(wl_resource* id, wl_resource* surface)
+{
+    auto const wl_surface = WlSurface::from(surface);
+
+    if (wl_surface->viewport())
+    {
+        wl_resource_post_error(resource, Error::viewport_exists, "Surface already has a viewport");
+        return;
+    }
+
+    new WpViewport{id, wl_surface};
+}
+
+mf::WpViewport::WpViewport(wl_resource* new_resource, WlSurface* surface)
+    : Viewport{new_resource, Version<1>()},
+      surface{surface}
+{
+    surface->set_viewport(this);
+    surface->add_destroy_listener(this, [this]() { this->surface = nullptr; });
+}
+
+mf::WpViewport::~WpViewport()
+{
+    if (surface)
+    {
+        // The crop and scale state is removed on the next commit
+        surface->remove_destroy_listener(this);
+        surface->set_viewport(nullptr);
+        surface->set_pending_viewport_source(std::experimental::nullopt);
+        surface->set_pending_viewport_destination(std::experimental::nullopt);
+    }
+}
+
+void mf::WpViewport::destroy()
+{
+    destroy_wayland_object();
+}
+
+void mf::WpViewport::set_source(double x, double y, double width, double height)
+{
+    if (!check_surface())
+        return;
+
+    if (x == -1 && y == -1 && width == -1 && height == -1)
+    {
+        surface->set_pending_viewport_source(std::experimental::nullopt);
+        return;
+    }
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0)
+    {
+        wl_resource_post_error(
+            resource, Error::bad_value, "Invalid viewport source (%f, %f, %f, %f)", x, y, width, height);
+        return;
+    }
+
+    surface->set_pending_viewport_source(WlSurfaceState::Viewport::Source{x, y, width, height});
+}
+
+void mf::WpViewport::set_destination(int32_t width, int32_t height)
+{
+    if (!check_surface())
+        return;
+
+    if (width == -1 && height == -1)
+    {
+        surface->set_pending_viewport_destination(std::experimental::nullopt);
+        return;
+    }
+
+    if (width <= 0 || height <= 0)
+    {
+        wl_resource_post_error(
+            resource, Error::bad_value, "Invalid viewport destination %d×%d", width, height);
+        return;
+    }
+
+    surface->set_pending_viewport_destination(geom::Size{width, height});
+}
+
+auto mf::WpViewport::check_surface() const -> bool
+{
+    if (!surface)
+        wl_resource_post_error(resource, Error::no_surface, "The wl_surface of the viewport was destroyed");
+
+    return surface;
+}
+
+auto mf::create_wp_viewporter(wl_display* display) -> std::shared_ptr<WpViewporter>
+{
+    return std::make_shared<WpViewporter>(display);
+}
@@ -0,0 +1,36 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_FRONTEND_WP_VIEWPORTER_H
+#define MIR_FRONTEND_WP_VIEWPORTER_H
+
+#include "viewporter_wrapper.h"
+
+#include <memory>
+
+struct wl_display;
+
+namespace mir
+{
+namespace frontend
+{
+class WpViewporter;
+
+auto create_wp_viewporter(wl_display* display) -> std::shared_ptr<WpViewporter>;
+}
+}
+
+#endif // MIR_FRONTEND_WP_VIEWPORTER_H
@@ -28,9 +28,11 @@ namespace mf = mir::frontend;
 mf::XWaylandConnector::XWaylandConnector(
     const int xdisplay,
     std::shared_ptr<WaylandConnector> const& wc,
-    std::string const& xwayland_path) :
+    std::string const& xwayland_path,
+    bool eager_start,
+    std::chrono::seconds idle_timeout) :
     start_xwayland{wc->get_extension("x11-support") ?
-        [=]{ return std::make_unique<XWaylandServer>(xdisplay, wc, xwayland_path); } :
+        [=]{ return std::make_unique<XWaylandServer>(xdisplay, wc, xwayland_path, eager_start, idle_timeout); } :
         decltype(start_xwayland){[]{ return std::unique_ptr<XWaylandServer>{}; }}}
 {
 }
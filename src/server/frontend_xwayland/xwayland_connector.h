@@ -21,6 +21,8 @@
 
 #include "mir/frontend/connector.h"
 
+#include <chrono>
+
 namespace mir
 {
 namespace frontend
@@ -30,7 +32,12 @@ class XWaylandServer;
 class XWaylandConnector : public Connector
 {
 public:
-    XWaylandConnector(const int xdisplay, std::shared_ptr<WaylandConnector> const& wc, std::string const& xwayland_path);
+    XWaylandConnector(
+        const int xdisplay,
+        std::shared_ptr<WaylandConnector> const& wc,
+        std::string const& xwayland_path,
+        bool eager_start,
+        std::chrono::seconds idle_timeout);
     ~XWaylandConnector() override;
 
     void start() override;
@@ -16,6 +16,7 @@
  */
 
 #include "mir/default_server_configuration.h"
+#include "mir/abnormal_exit.h"
 #include "mir/log.h"
 #include "wayland_connector.h"
 #include "xwayland_connector.h"
@@ -64,13 +65,21 @@ std::shared_ptr<mf::Connector> mir::DefaultServerConfiguration::the_xwayland_con
         auto options = the_options();
         if (options->is_set(mo::x11_display_opt))
         {
+            auto const idle_timeout =
+                options->is_set("xwayland-idle-timeout") ? options->get<int>("xwayland-idle-timeout") : 0;
+
+            if (idle_timeout < 0)
+                throw mir::AbnormalExit("Invalid xwayland-idle-timeout, must not be negative");
+
             try
             {
                 auto wc = std::static_pointer_cast<mf::WaylandConnector>(the_wayland_connector());
                 return std::make_shared<mf::XWaylandConnector>(
                     options->get<int>(mo::x11_display_opt),
                     wc,
-                    options->get<std::string>("xwayland-path"));
+                    options->get<std::string>("xwayland-path"),
+                    options->is_set("xwayland-eager-start"),
+                    std::chrono::seconds{idle_timeout});
             }
             catch (...)
             {
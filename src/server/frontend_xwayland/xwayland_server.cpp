@@ -36,11 +36,13 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/un.h>
+#include <sys/timerfd.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <chrono>
 #include <thread>
+#include <vector>
 
 namespace mf = mir::frontend;
 namespace md = mir::dispatch;
@@ -48,15 +50,33 @@ namespace md = mir::dispatch;
 mf::XWaylandServer::XWaylandServer(
     const int xdisplay,
     std::shared_ptr<mf::WaylandConnector> wc,
-    std::string const& xwayland_path) :
+    std::string const& xwayland_path,
+    bool eager_start,
+    std::chrono::seconds idle_timeout) :
     wm(std::make_shared<XWaylandWM>(wc)),
     xdisplay(xdisplay),
     wlc(wc),
     dispatcher{std::make_shared<md::MultiplexingDispatchable>()},
-    xwayland_path{xwayland_path}
+    xwayland_path{xwayland_path},
+    idle_timeout{idle_timeout}
 {
     setup_socket();
-    spawn_xserver_on_event_loop();
+
+    if (idle_timeout > std::chrono::seconds::zero())
+    {
+        idle_timer = Fd{timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK)};
+        if (idle_timer < 0)
+            mir::fatal_error("Failed to create Xwayland idle timer");
+
+        idle_timer_dispatcher = std::make_shared<md::ReadableFd>(idle_timer, [this]() { stop_if_idle(); });
+        dispatcher->add_watch(idle_timer_dispatcher);
+    }
+
+    if (eager_start)
+        new_spawn_thread();
+    else
+        spawn_xserver_on_event_loop();
+
     xserver_thread = std::make_unique<dispatch::ThreadedDispatcher>(
         "Mir/X11 Reader", dispatcher, []()
             { terminate_with_current_exception(); });
@@ -66,6 +86,9 @@ mf::XWaylandServer::~XWaylandServer()
 {
     mir::log_info("Deiniting xwayland server");
 
+    if (idle_timer_dispatcher)
+        dispatcher->remove_watch(idle_timer_dispatcher);
+
     // Terminate any running xservers
     if (xserver_status > 0) {
       terminate = true;
@@ -79,9 +102,12 @@ mf::XWaylandServer::~XWaylandServer()
           if (kill(pid, 0) == 0)    // ...if Xwayland is still running...
             kill(pid, SIGKILL);     // ...then kill it!
       }
-      spawn_thread->join();
     }
 
+    // An Xwayland that exited on its own leaves its (finished) thread to be joined
+    if (spawn_thread && spawn_thread->joinable())
+      spawn_thread->join();
+
     char path[256];
     snprintf(path, sizeof path, "/tmp/.X%d-lock", xdisplay);
     unlink(path);
@@ -188,32 +214,42 @@ void mf::XWaylandServer::execl_xwayland(int wl_client_client_fd, int wm_client_f
 
     auto const dsp_str = ":" + std::to_string(xdisplay);
 
-    execl(xwayland_path.c_str(),
-    "Xwayland",
-    dsp_str.c_str(),
-    "-rootless",
-    "-listen", abstract_socket_fd_str.c_str(),
-    "-listen", socket_fd_str.c_str(),
-    "-wm", wm_fd_str.c_str(),
-    "-terminate",
-    NULL);
+    std::vector<char const*> args{
+        "Xwayland",
+        dsp_str.c_str(),
+        "-rootless",
+        "-listen", abstract_socket_fd_str.c_str(),
+        "-listen", socket_fd_str.c_str(),
+        "-wm", wm_fd_str.c_str()};
+
+    // Without an idle timeout Xwayland exits with its last client, otherwise we stop it
+    if (idle_timeout == std::chrono::seconds::zero())
+        args.push_back("-terminate");
+
+    args.push_back(nullptr);
+
+    execv(xwayland_path.c_str(), const_cast<char* const*>(args.data()));
 }
 
 void mf::XWaylandServer::connect_to_xwayland(int wl_client_server_fd, int wm_server_fd, sig_atomic_t& xserver_ready)
 {
     wl_client* client = nullptr;
+    bool client_created = false;
     std::mutex client_mutex;
     std::condition_variable client_ready;
 
-    wlc->run_on_wayland_display([wl_client_server_fd, &client, &client_mutex, &client_ready](wl_display* display)
+    wlc->run_on_wayland_display(
+        [wl_client_server_fd, &client, &client_created, &client_mutex, &client_ready](wl_display* display)
         {
             std::lock_guard<std::mutex> lock{client_mutex};
             client = wl_client_create(display, wl_client_server_fd);
+            client_created = true;
             client_ready.notify_all();
         });
 
+    // The client may be created before we get here, so don't wait for a notification that's been and gone
     std::unique_lock<std::mutex> lock{client_mutex};
-    client_ready.wait(lock);
+    client_ready.wait(lock, [&client_created] { return client_created; });
 
     // More ugliness
     int tries = 0;
@@ -243,9 +279,15 @@ void mf::XWaylandServer::connect_to_xwayland(int wl_client_server_fd, int wm_ser
     // Reset the tries since server is running now
     xserver_spawn_tries = 0;
 
+    start_idle_checks();
+
     int status;
     waitpid(pid, &status, 0);  // Blocking
-    if (WIFEXITED(status)) {
+    stop_idle_checks();
+    if (stopping_idle_xserver.exchange(false)) {
+        mir::log_info("Xserver stopped after being idle for %lld seconds", (long long)idle_timeout.count());
+        xserver_status = STOPPED;
+    } else if (WIFEXITED(status)) {
         mir::log_info("Xserver stopped");
         xserver_status = STOPPED;
     } else {
@@ -426,6 +468,10 @@ void mf::XWaylandServer::new_spawn_thread() {
   if (xserver_status > 0) return;
   xserver_status = STARTING;
 
+  // The thread that ran the previous Xwayland has finished with it, but needs joining
+  if (spawn_thread && spawn_thread->joinable())
+    spawn_thread->join();
+
   spawn_thread = std::make_unique<std::thread>(&mf::XWaylandServer::spawn, this);
 }
 
@@ -446,3 +492,52 @@ void mf::XWaylandServer::spawn_xserver_on_event_loop()
     dispatcher->add_watch(fd_dispatcher);
 }
 
+
+void mf::XWaylandServer::start_idle_checks()
+{
+    if (!idle_timer_dispatcher)
+        return;
+
+    idle_seconds = 0;
+
+    itimerspec every_second{};
+    every_second.it_value.tv_sec = 1;
+    every_second.it_interval.tv_sec = 1;
+    timerfd_settime(idle_timer, 0, &every_second, nullptr);
+}
+
+void mf::XWaylandServer::stop_idle_checks()
+{
+    if (!idle_timer_dispatcher)
+        return;
+
+    itimerspec const disarm{};
+    timerfd_settime(idle_timer, 0, &disarm, nullptr);
+}
+
+void mf::XWaylandServer::stop_if_idle()
+{
+    uint64_t expirations;
+    if (read(idle_timer, &expirations, sizeof expirations) != sizeof expirations)
+        return;
+
+    if (xserver_status != RUNNING)
+        return;
+
+    // If the clients can't be counted, assume Xwayland is in use
+    auto const clients = wm->x11_client_count();
+    if (!clients || clients.value() > 0)
+    {
+        idle_seconds = 0;
+        return;
+    }
+
+    if ((idle_seconds += expirations) < static_cast<uint64_t>(idle_timeout.count()))
+        return;
+
+    mir::log_info("Stopping idle Xserver");
+    stop_idle_checks();
+    stopping_idle_xserver = true;
+    if (kill(pid, SIGTERM) != 0)
+        stopping_idle_xserver = false;
+}
@@ -19,7 +19,13 @@
 #ifndef MIR_FRONTEND_XWAYLAND_SERVER_H
 #define MIR_FRONTEND_XWAYLAND_SERVER_H
 
+#include "mir/fd.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <thread>
 #include <sys/socket.h>
 #include <sys/un.h>
@@ -40,7 +46,17 @@ class XWaylandWM;
 class XWaylandServer
 {
 public:
-    XWaylandServer(const int xdisp, std::shared_ptr<WaylandConnector> wc, std::string const& xwayland_path);
+    /**
+     * Xwayland is launched when the first X11 client connects to the display's sockets,
+     * unless eager_start is set. With a zero idle_timeout it exits with its last client,
+     * otherwise once it has had no X11 clients for that long. idle_timeout must not be negative.
+     */
+    XWaylandServer(
+        const int xdisp,
+        std::shared_ptr<WaylandConnector> wc,
+        std::string const& xwayland_path,
+        bool eager_start,
+        std::chrono::seconds idle_timeout);
     ~XWaylandServer();
 
     enum Status {
@@ -64,12 +80,17 @@ private:
     int create_lockfile();
     int create_socket(struct sockaddr_un *addr, size_t path_size);
     bool set_cloexec(int fd, bool cloexec);
+    /// Checks for X11 clients every second while Xwayland runs (if there's an idle timeout)
+    void start_idle_checks();
+    void stop_idle_checks();
+    void stop_if_idle();
 
     std::unique_ptr<dispatch::ThreadedDispatcher> xserver_thread;
     std::shared_ptr<XWaylandWM> wm;
     int xdisplay;
     std::shared_ptr<WaylandConnector> wlc;
-    pid_t pid;
+    /// Read by the idle timer on the X11 reader thread
+    std::atomic<pid_t> pid{0};
     std::shared_ptr<dispatch::MultiplexingDispatchable> dispatcher;
     std::shared_ptr<dispatch::ReadableFd> afd_dispatcher;
     std::shared_ptr<dispatch::ReadableFd> fd_dispatcher;
@@ -77,9 +98,15 @@ private:
     int socket_fd;
     int abstract_socket_fd;
     bool terminate = false;
-    Status xserver_status = STOPPED;
+    std::atomic<Status> xserver_status{STOPPED};
     int xserver_spawn_tries = 0;
     std::string const xwayland_path;
+    std::chrono::seconds const idle_timeout;
+    /// Reset when an X11 client is seen, and when the checks start
+    std::atomic<std::uint64_t> idle_seconds{0};
+    std::atomic<bool> stopping_idle_xserver{false};
+    Fd idle_timer;
+    std::shared_ptr<dispatch::ReadableFd> idle_timer_dispatcher;
 };
 } /* frontend */
 } /* mir */
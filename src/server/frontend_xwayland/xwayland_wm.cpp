@@ -95,14 +95,22 @@ void mf::XWaylandWM::destroy() {
     event_thread.reset();
   }
 
+  // The windows went with the X server
+  surfaces.clear();
+
   // xcb_cursors == 2 when its empty
   if (xcb_cursors.size() != 2) {
     mir::log_info("Cleaning cursors");
     for (auto xcb_cursor : xcb_cursors)
       xcb_free_cursor(xcb_connection, xcb_cursor);
   }
-  if (xcb_connection != nullptr)
-    xcb_disconnect(xcb_connection);
+  {
+    std::lock_guard<std::mutex> lock{connection_mutex};
+    if (xcb_connection != nullptr)
+      xcb_disconnect(xcb_connection);
+    xcb_connection = nullptr;
+    xres_present = false;
+  }
   close(wm_fd);
 }
 
@@ -114,7 +122,10 @@ void mf::XWaylandWM::start(wl_client *wlc, const int fd)
     wlclient = wlc;
     wm_fd = fd;
 
-    xcb_connection = xcb_connect_to_fd(wm_fd, nullptr);
+    {
+        std::lock_guard<std::mutex> lock{connection_mutex};
+        xcb_connection = xcb_connect_to_fd(wm_fd, nullptr);
+    }
     if (xcb_connection_has_error(xcb_connection))
     {
         mir::log_error("XWAYLAND: xcb_connect_to_fd failed");
@@ -251,6 +262,29 @@ void mf::XWaylandWM::create_window(xcb_window_t id)
     surfaces[id] = std::make_shared<XWaylandWMSurface>(this, id);
 }
 
+auto mf::XWaylandWM::x11_client_count() -> std::experimental::optional<std::size_t>
+{
+    std::lock_guard<std::mutex> lock{connection_mutex};
+    if (!xcb_connection || !xres_present)
+        return std::experimental::nullopt;
+
+    auto const reply = xcb_res_query_clients_reply(xcb_connection, xcb_res_query_clients(xcb_connection), nullptr);
+    if (!reply)
+        return std::experimental::nullopt;
+
+    // The server's own client has no resource base, and the WM is a client too
+    auto const wm_resource_base = xcb_get_setup(xcb_connection)->resource_id_base;
+    std::size_t clients = 0;
+    for (auto i = xcb_res_query_clients_clients_iterator(reply); i.rem; xcb_res_client_next(&i))
+    {
+        if (i.data->resource_base != 0 && i.data->resource_base != wm_resource_base)
+            ++clients;
+    }
+
+    free(reply);
+    return clients;
+}
+
 /* Events */
 void mf::XWaylandWM::handle_events()
 {
@@ -359,6 +393,9 @@ void mf::XWaylandWM::handle_create_notify(xcb_create_notify_event_t *event)
 {
     mir::log_verbose("XCB_CREATE_NOTIFY (window %d, at (%d, %d), width %d, height %d %s)", event->window, event->x,
                      event->y, event->width, event->height, event->override_redirect ? ", override" : "");
+    if (is_ours(event->window))
+        return;
+
     create_window(event->window);
 }
 
@@ -712,6 +749,7 @@ void mf::XWaylandWM::wm_get_resources()
 
     xcb_prefetch_extension_data(xcb_connection, &xcb_xfixes_id);
     xcb_prefetch_extension_data(xcb_connection, &xcb_composite_id);
+    xcb_prefetch_extension_data(xcb_connection, &xcb_res_id);
 
     formats_cookie = xcb_render_query_pict_formats(xcb_connection);
 
@@ -729,6 +767,11 @@ void mf::XWaylandWM::wm_get_resources()
     if (!xfixes || !xfixes->present)
         mir::log_warning("xfixes not available");
 
+    auto const xres = xcb_get_extension_data(xcb_connection, &xcb_res_id);
+    xres_present = xres && xres->present;
+    if (!xres_present)
+        mir::log_warning("XRes not available, so X11 clients can't be counted to stop an idle Xserver");
+
     xfixes_cookie = xcb_xfixes_query_version(xcb_connection, XCB_XFIXES_MAJOR_VERSION, XCB_XFIXES_MINOR_VERSION);
     xfixes_reply = xcb_xfixes_query_version_reply(xcb_connection, xfixes_cookie, NULL);
 
@@ -18,7 +18,9 @@
 #ifndef MIR_FRONTEND_XWAYLAND_WM_H
 #define MIR_FRONTEND_XWAYLAND_WM_H
 
+#include <experimental/optional>
 #include <map>
+#include <mutex>
 #include <thread>
 #include <wayland-server-core.h>
 
@@ -28,6 +30,7 @@
 extern "C" {
 #include <X11/Xcursor/Xcursor.h>
 #include <xcb/composite.h>
+#include <xcb/res.h>
 #include <xcb/xcb.h>
 #include <xcb/xfixes.h>
 struct atom_t
@@ -120,6 +123,10 @@ public:
 
     xcb_connection_t *get_xcb_connection();
 
+    /// The number of X11 clients connected, not counting the WM itself (nullopt if unknown).
+    /// Makes a round trip to the X server, and may be called from any thread.
+    auto x11_client_count() -> std::experimental::optional<std::size_t>;
+
     void dump_property(xcb_atom_t property, xcb_get_property_reply_t *reply);
     void set_net_active_window(xcb_window_t window);
     std::shared_ptr<WaylandConnector> get_wl_connector()
@@ -184,6 +191,8 @@ private:
     std::shared_ptr<WaylandConnector> const wlc;
     std::shared_ptr<dispatch::MultiplexingDispatchable> const dispatcher;
     int wm_fd;
+    /// Held while connecting and disconnecting, as x11_client_count() may be called from another thread
+    std::mutex connection_mutex;
     xcb_connection_t *xcb_connection;
     xcb_screen_t *xcb_screen;
     xcb_window_t xcb_window;
@@ -195,6 +204,7 @@ private:
     xcb_selection_request_event_t xcb_selection_request;
     xcb_render_pictforminfo_t xcb_format_rgb, xcb_format_rgba;
     const xcb_query_extension_reply_t *xfixes;
+    bool xres_present{false};
     std::unique_ptr<dispatch::ThreadedDispatcher> event_thread;
     wl_client *wlclient;
     xcb_visualid_t xcb_visual_id;
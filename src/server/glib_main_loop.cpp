@@ -131,7 +131,8 @@ mir::GLibMainLoop::GLibMainLoop(
       running_{false},
       fd_sources{main_context},
       signal_sources{fd_sources},
-      before_iteration_hook{[]{}}
+      before_iteration_hook{[]{}},
+      spawned_work{main_context, [this] { handle_exception(std::current_exception()); }}
 {
 }
 
@@ -453,16 +454,5 @@ void mir::GLibMainLoop::handle_exception(std::exception_ptr const& e)
 
 void mir::GLibMainLoop::spawn(std::function<void()>&& work)
 {
-    auto const action_with_exception_handling =
-        [this, action = std::move(work)]
-        {
-            try { action(); }
-            catch (...) { handle_exception(std::current_exception()); }
-        };
-
-    detail::add_server_action_gsource(
-        main_context,
-        nullptr,
-        action_with_exception_handling,
-        [](auto) { return true; });
+    spawned_work.spawn(std::move(work));
 }
@@ -20,6 +20,7 @@
 #include "mir/glib_main_loop_sources.h"
 #include "mir/lockable_callback.h"
 #include "mir/raii.h"
+#include "mir/thread/work_queue.h"
 
 #include <algorithm>
 #include <atomic>
@@ -367,6 +368,102 @@ md::GSourceHandle md::add_timer_gsource(
     return gsource;
 }
 
+/**************
+ * WorkSource *
+ **************/
+
+namespace
+{
+struct WorkContext
+{
+    WorkContext(std::function<void()> const& exception_handler)
+        : exception_handler{exception_handler}
+    {
+    }
+    mir::thread::WorkQueue queue;
+    std::function<void()> const exception_handler;
+};
+
+struct WorkGSource
+{
+    GSource gsource;
+    WorkContext ctx;
+    bool ctx_constructed;
+
+    static gboolean dispatch(GSource* source, GSourceFunc, gpointer)
+    {
+        auto& ctx = reinterpret_cast<WorkGSource*>(source)->ctx;
+
+        // Anything spawned from here on needs to make us ready again
+        g_source_set_ready_time(source, -1);
+        ctx.queue.start_draining();
+
+        while (auto const work = ctx.queue.pop())
+        {
+            try
+            {
+                work();
+            }
+            catch(...)
+            {
+                ctx.exception_handler();
+            }
+        }
+
+        return G_SOURCE_CONTINUE;
+    }
+
+    static void finalize(GSource* source)
+    {
+        auto const work_gsource = reinterpret_cast<WorkGSource*>(source);
+
+        // As with server actions, work that never ran may refer to code that
+        // has since been unloaded, so leak it rather than destroy it.
+        if (work_gsource->ctx_constructed && work_gsource->ctx.queue.empty())
+            work_gsource->ctx.~WorkContext();
+    }
+};
+
+GSource* create_work_gsource(GMainContext* main_context, std::function<void()> const& exception_handler)
+{
+    static GSourceFuncs gsource_funcs{
+        nullptr,
+        nullptr,
+        WorkGSource::dispatch,
+        WorkGSource::finalize,
+        nullptr,
+        nullptr
+    };
+
+    auto const gsource = g_source_new(&gsource_funcs, sizeof(WorkGSource));
+    auto const work_gsource = reinterpret_cast<WorkGSource*>(gsource);
+
+    work_gsource->ctx_constructed = false;
+    new (&work_gsource->ctx) WorkContext{exception_handler};
+    work_gsource->ctx_constructed = true;
+
+    g_source_attach(gsource, main_context);
+
+    return gsource;
+}
+}
+
+md::WorkSource::WorkSource(
+    GMainContext* main_context,
+    std::function<void()> const& exception_handler)
+    : gsource{create_work_gsource(main_context, exception_handler), [](GSource*){}}
+{
+}
+
+void md::WorkSource::spawn(std::function<void()>&& work)
+{
+    auto& ctx = reinterpret_cast<WorkGSource*>(static_cast<GSource*>(gsource))->ctx;
+
+    // g_source_set_ready_time() wakes the main context, so only do it when needed
+    if (ctx.queue.push(std::move(work)))
+        g_source_set_ready_time(gsource, 0);
+}
+
 /*************
  * FdSources *
  *************/
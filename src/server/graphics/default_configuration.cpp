@@ -207,7 +207,9 @@ mir::DefaultServerConfiguration::the_display()
                     return std::make_shared<mg::offscreen::Display>(
                         egl_access->egl_native_display(),
                         the_display_configuration_policy(),
-                        the_display_report());
+                        the_display_report(),
+                        the_options()->is_set(options::offscreen_software_opt) ?
+                            mg::offscreen::Rendering::software : mg::offscreen::Rendering::gl);
                 }
                 else
                 {
@@ -127,6 +127,7 @@ bool mgn::detail::DisplayBuffer::overlay(RenderableList const& list)
     auto const topmost = list.back();
 
     if ((topmost->screen_position() != area) ||
+        (topmost->src_bounds() != geom::Rectangle{{}, area.size}) ||
         (topmost->alpha() != 1.0f) ||
         (topmost->shaped()) ||
         (topmost->transformation() != identity))
@@ -18,6 +18,7 @@
 
 #include "display.h"
 #include "display_buffer.h"
+#include "software_display_buffer.h"
 #include "mir/graphics/display_configuration_policy.h"
 #include "mir/graphics/egl_error.h"
 #include "mir/graphics/virtual_output.h"
@@ -97,8 +98,10 @@ mgo::detail::DisplaySyncGroup::recommended_sleep() const
 mgo::Display::Display(
     EGLNativeDisplayType egl_native_display,
     std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
-    std::shared_ptr<DisplayReport> const&)
-    : egl_display{create_and_initialize_display(egl_native_display)},
+    std::shared_ptr<DisplayReport> const&,
+    Rendering rendering)
+    : rendering{rendering},
+      egl_display{create_and_initialize_display(egl_native_display)},
       egl_context_shared{egl_display, EGL_NO_CONTEXT},
       current_display_configuration{geom::Size{1024,768}}
 {
@@ -150,13 +153,23 @@ void mgo::Display::configure(mg::DisplayConfiguration const& conf)
         {
             if (output.connected && output.preferred_mode_index < output.modes.size())
             {
-                eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
-                auto raw_db = new mgo::DisplayBuffer{
-                    SurfacelessEGLContext{egl_display, egl_context_shared},
-                    output.extents()};
-
-                display_sync_groups.emplace_back(
-                    new mgo::detail::DisplaySyncGroup(std::unique_ptr<mg::DisplayBuffer>(raw_db)));
+                std::unique_ptr<mg::DisplayBuffer> db;
+
+                switch (rendering)
+                {
+                case Rendering::gl:
+                    eglBindAPI(MIR_SERVER_EGL_OPENGL_API);
+                    db.reset(new mgo::DisplayBuffer{
+                        SurfacelessEGLContext{egl_display, egl_context_shared},
+                        output.extents()});
+                    break;
+
+                case Rendering::software:
+                    db.reset(new mgo::SoftwareDisplayBuffer{output.extents()});
+                    break;
+                }
+
+                display_sync_groups.emplace_back(new mgo::detail::DisplaySyncGroup(std::move(db)));
             }
         });
 }
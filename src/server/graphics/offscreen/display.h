@@ -72,6 +72,13 @@ private:
 
 }
 
+/// How the offscreen outputs are composited
+enum class Rendering
+{
+    gl,         ///< Into GL framebuffer objects
+    software    ///< Into CPU memory, by the software renderer
+};
+
 class Display : public graphics::Display,
                 public graphics::NativeDisplay,
                 public renderer::gl::ContextSource
@@ -79,7 +86,8 @@ class Display : public graphics::Display,
 public:
     Display(EGLNativeDisplayType egl_native_display,
             std::shared_ptr<DisplayConfigurationPolicy> const& initial_conf_policy,
-            std::shared_ptr<DisplayReport> const& listener);
+            std::shared_ptr<DisplayReport> const& listener,
+            Rendering rendering = Rendering::gl);
     ~Display() noexcept;
 
     void for_each_display_sync_group(std::function<void(DisplaySyncGroup&)> const& f) override;
@@ -108,6 +116,7 @@ public:
     std::unique_ptr<renderer::gl::Context> create_gl_context() const override;
     bool apply_if_configuration_preserves_display_buffers(graphics::DisplayConfiguration const& conf) override;
 private:
+    Rendering const rendering;
     detail::EGLDisplayHandle const egl_display;
     SurfacelessEGLContext const egl_context_shared;
     mutable std::mutex configuration_mutex;
@@ -148,6 +148,13 @@ void mgo::DisplayBuffer::release_current()
 void mgo::DisplayBuffer::swap_buffers()
 {
     glFinish();
+    drawn = true;
+}
+
+unsigned int mgo::DisplayBuffer::buffer_age() const
+{
+    // There's only the one FBO, so once drawn it always holds the last frame
+    return drawn ? 1 : 0;
 }
 
 bool mgo::DisplayBuffer::overlay(RenderableList const&)
@@ -25,6 +25,7 @@
 #include "mir/geometry/size.h"
 #include "mir/geometry/rectangle.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/gl/buffer_age_source.h"
 
 #include <EGL/egl.h>
 
@@ -59,7 +60,8 @@ private:
 
 class DisplayBuffer : public graphics::DisplayBuffer,
                       public graphics::NativeDisplayBuffer,
-                      public renderer::gl::RenderTarget
+                      public renderer::gl::RenderTarget,
+                      public renderer::gl::BufferAgeSource
 {
 public:
     DisplayBuffer(SurfacelessEGLContext egl_context,
@@ -73,10 +75,12 @@ public:
     void bind() override;
     void release_current() override;
     void swap_buffers() override;
+    unsigned int buffer_age() const override;
 private:
     SurfacelessEGLContext const egl_context;
     detail::GLFramebufferObject const fbo;
     geometry::Rectangle const area;
+    bool drawn{false};
 };
 
 }
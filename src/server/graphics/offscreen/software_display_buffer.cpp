@@ -0,0 +1,68 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "software_display_buffer.h"
+
+namespace mg = mir::graphics;
+namespace mgo = mg::offscreen;
+namespace geom = mir::geometry;
+
+mgo::SoftwareDisplayBuffer::SoftwareDisplayBuffer(geom::Rectangle const& area)
+    : area(area),
+      pixels(area.size.width.as_int() * area.size.height.as_int(), 0)
+{
+}
+
+geom::Rectangle mgo::SoftwareDisplayBuffer::view_area() const
+{
+    return area;
+}
+
+bool mgo::SoftwareDisplayBuffer::overlay(RenderableList const&)
+{
+    return false;
+}
+
+glm::mat2 mgo::SoftwareDisplayBuffer::transformation() const
+{
+    return glm::mat2(1);
+}
+
+mg::NativeDisplayBuffer* mgo::SoftwareDisplayBuffer::native_display_buffer()
+{
+    return this;
+}
+
+geom::Size mgo::SoftwareDisplayBuffer::size() const
+{
+    return area.size;
+}
+
+auto mgo::SoftwareDisplayBuffer::back_buffer() -> Pixels
+{
+    return {pixels.data(), geom::Stride{area.size.width.as_int() * static_cast<int>(sizeof(uint32_t))}};
+}
+
+unsigned int mgo::SoftwareDisplayBuffer::buffer_age() const
+{
+    // There's only the one buffer, so once drawn it always holds the last frame
+    return drawn ? 1 : 0;
+}
+
+void mgo::SoftwareDisplayBuffer::swap_buffers()
+{
+    drawn = true;
+}
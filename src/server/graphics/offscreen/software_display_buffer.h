@@ -0,0 +1,61 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_GRAPHICS_OFFSCREEN_SOFTWARE_DISPLAY_BUFFER_H_
+#define MIR_GRAPHICS_OFFSCREEN_SOFTWARE_DISPLAY_BUFFER_H_
+
+#include "mir/graphics/display_buffer.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/renderer/sw/render_target.h"
+
+#include <vector>
+
+namespace mir
+{
+namespace graphics
+{
+namespace offscreen
+{
+
+/// An offscreen output in CPU memory, composited by the software renderer
+class SoftwareDisplayBuffer : public graphics::DisplayBuffer,
+                              public graphics::NativeDisplayBuffer,
+                              public renderer::software::RenderTarget
+{
+public:
+    SoftwareDisplayBuffer(geometry::Rectangle const& area);
+
+    geometry::Rectangle view_area() const override;
+    bool overlay(RenderableList const& renderlist) override;
+    glm::mat2 transformation() const override;
+    NativeDisplayBuffer* native_display_buffer() override;
+
+    geometry::Size size() const override;
+    Pixels back_buffer() override;
+    unsigned int buffer_age() const override;
+    void swap_buffers() override;
+
+private:
+    geometry::Rectangle const area;
+    std::vector<uint32_t> pixels;
+    bool drawn{false};
+};
+
+}
+}
+}
+
+#endif /* MIR_GRAPHICS_OFFSCREEN_SOFTWARE_DISPLAY_BUFFER_H_ */
@@ -24,10 +24,12 @@
 #include "mir/graphics/buffer_properties.h"
 #include "mir/input/scene.h"
 #include "mir/renderer/sw/pixel_source.h"
+#include "mir/renderer/sw/pixel_kernels.h"
 
 #include <boost/throw_exception.hpp>
 #include <stdexcept>
 #include <mutex>
+#include <vector>
 
 namespace mg = mir::graphics;
 namespace mi = mir::input;
@@ -86,11 +88,22 @@ public:
         return {position, buffer_->size()};
     }
 
+    geom::Rectangle src_bounds() const override
+    {
+        return {{}, buffer_->size()};
+    }
+
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
         return std::experimental::optional<geometry::Rectangle>();
     }
 
+    geom::Rectangles damage() const override
+    {
+        // A new image gets a new CursorRenderable, so the content never changes
+        return {};
+    }
+
     float alpha() const override
     {
         return 1.0;
@@ -106,6 +119,11 @@ public:
         return true;
     }
 
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
     void move_to(geom::Point new_position)
     {
         std::lock_guard<std::mutex> lock{position_mutex};
@@ -194,14 +212,24 @@ mg::SoftwareCursor::create_renderable_for(CursorImage const& cursor_image, geom:
         allocator->alloc_software_buffer(cursor_image.size(), format),
         position + hotspot - cursor_image.hotspot());
 
-    // TODO: The buffer pixel format may not be argb_8888, leading to
-    // incorrect cursor colors. We need to transform the data to match
-    // the buffer pixel format.
     auto pixel_source = dynamic_cast<mrs::PixelSource*>(new_renderable->buffer()->native_buffer_base());
-    if (pixel_source)
-        pixel_source->write(static_cast<unsigned char const*>(cursor_image.as_argb_8888()), pixels_size);
-    else
+    if (!pixel_source)
         BOOST_THROW_EXCEPTION(std::logic_error("could not write to buffer for software cursor"));
+
+    if (format == mir_pixel_format_abgr_8888)
+    {
+        // The buffer has red and blue the other way around, so convert the image to match
+        std::vector<uint32_t> pixels(pixels_size / sizeof(uint32_t));
+        mrs::pixel_kernels().swap_red_blue(
+            pixels.data(),
+            static_cast<uint32_t const*>(cursor_image.as_argb_8888()),
+            pixels.size());
+        pixel_source->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels_size);
+    }
+    else
+    {
+        pixel_source->write(static_cast<unsigned char const*>(cursor_image.as_argb_8888()), pixels_size);
+    }
     return new_renderable;
 }
 
@@ -0,0 +1,49 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/input/cookie_token.h"
+#include "mir/cookie/authority.h"
+#include "mir/events/event.h"
+#include "mir/events/input_event.h"
+
+#include <string.h>
+
+namespace mi = mir::input;
+
+auto mi::cookie_token(std::chrono::nanoseconds timestamp) -> std::vector<uint8_t>
+{
+    uint64_t const value = timestamp.count();
+    std::vector<uint8_t> token(sizeof value);
+    memcpy(token.data(), &value, sizeof value);
+    return token;
+}
+
+void mi::seal_cookie(MirEvent& event, cookie::Authority& authority)
+{
+    if (event.type() != mir_event_type_input)
+        return;
+
+    auto const input = event.to_input();
+    auto const token = input->cookie();
+
+    // A full cookie is a good deal larger than a token, and an empty one means there's no cookie
+    uint64_t timestamp;
+    if (token.size() != sizeof timestamp)
+        return;
+
+    memcpy(&timestamp, token.data(), sizeof timestamp);
+    input->set_cookie(authority.make_cookie(timestamp)->serialize());
+}
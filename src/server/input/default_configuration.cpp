@@ -143,7 +143,7 @@ mir::DefaultServerConfiguration::the_input_dispatcher()
                 !options->is_set(options::host_socket_opt);
 
             return std::make_shared<mi::KeyRepeatDispatcher>(
-                the_event_filter_chain_dispatcher(), the_main_loop(), the_cookie_authority(),
+                the_event_filter_chain_dispatcher(), the_main_loop(),
                 enable_repeat, key_repeat_timeout, key_repeat_delay, false);
         });
 }
@@ -273,7 +273,10 @@ mir::DefaultServerConfiguration::the_input_reading_multiplexer()
     return input_reading_multiplexer(
         []() -> std::shared_ptr<mir::dispatch::MultiplexingDispatchable>
         {
-            return std::make_shared<mir::dispatch::MultiplexingDispatchable>();
+            auto const multiplexer = std::make_shared<mir::dispatch::MultiplexingDispatchable>();
+            // Only the input reading thread dispatches this, so let it drain every ready device per wakeup
+            multiplexer->set_max_events_per_dispatch(mir::dispatch::MultiplexingDispatchable::max_batch_size);
+            return multiplexer;
         }
     );
 }
@@ -319,7 +322,6 @@ std::shared_ptr<mi::DefaultInputDeviceHub> mir::DefaultServerConfiguration::the_
            auto hub = std::make_shared<mi::DefaultInputDeviceHub>(
                the_seat(),
                the_input_reading_multiplexer(),
-               the_cookie_authority(),
                the_key_mapper(),
                the_server_status_listener());
 
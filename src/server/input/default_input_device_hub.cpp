@@ -29,7 +29,6 @@
 #include "mir/dispatch/multiplexing_dispatchable.h"
 #include "mir/dispatch/action_queue.h"
 #include "mir/server_action_queue.h"
-#include "mir/cookie/authority.h"
 #define MIR_LOG_COMPONENT "Input"
 #include "mir/log.h"
 
@@ -172,13 +171,11 @@ void mi::ExternalInputDeviceHub::Internal::changes_complete()
 mi::DefaultInputDeviceHub::DefaultInputDeviceHub(
     std::shared_ptr<mi::Seat> const& seat,
     std::shared_ptr<dispatch::MultiplexingDispatchable> const& input_multiplexer,
-    std::shared_ptr<mir::cookie::Authority> const& cookie_authority,
     std::shared_ptr<mi::KeyMapper> const& key_mapper,
     std::shared_ptr<mir::ServerStatusListener> const& server_status_listener)
     : seat{seat},
       input_dispatchable{input_multiplexer},
       device_queue(std::make_shared<dispatch::ActionQueue>()),
-      cookie_authority(cookie_authority),
       key_mapper(key_mapper),
       server_status_listener(server_status_listener),
       device_id_generator{0}
@@ -204,7 +201,7 @@ void mi::DefaultInputDeviceHub::add_device(std::shared_ptr<InputDevice> const& d
         auto handle = restore_or_create_device(*device, queue);
         // send input device info to observer loop..
         devices.push_back(std::make_unique<RegisteredDevice>(
-            device, handle->id(), queue, cookie_authority, handle));
+            device, handle->id(), queue, handle));
 
         auto const& dev = devices.back();
         add_device_handle(handle);
@@ -257,11 +254,9 @@ mi::DefaultInputDeviceHub::RegisteredDevice::RegisteredDevice(
     std::shared_ptr<InputDevice> const& dev,
     MirInputDeviceId device_id,
     std::shared_ptr<dispatch::ActionQueue> const& queue,
-    std::shared_ptr<mir::cookie::Authority> const& cookie_authority,
     std::shared_ptr<mi::DefaultDevice> const& handle)
     : handle(handle),
       device_id(device_id),
-      cookie_authority(cookie_authority),
       device(dev),
       queue(queue)
 {
@@ -301,7 +296,7 @@ void mi::DefaultInputDeviceHub::RegisteredDevice::start(std::shared_ptr<Seat> co
     multiplexer->add_watch(queue);
 
     this->seat = seat;
-    builder = std::make_unique<DefaultEventBuilder>(device_id, cookie_authority, seat);
+    builder = std::make_unique<DefaultEventBuilder>(device_id, seat);
     device->start(this, builder.get());
 }
 
@@ -73,10 +73,21 @@ public:
         return {position, buffer_->size()};
     }
 
+    geom::Rectangle src_bounds() const override
+    {
+        return {{}, buffer_->size()};
+    }
+
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
         return std::experimental::optional<geometry::Rectangle>();
     }
+
+    geom::Rectangles damage() const override
+    {
+        // The touchspot image is drawn once and never changes
+        return {};
+    }
     
     float alpha() const override
     {
@@ -93,6 +104,11 @@ public:
         return true;
     }
 
+    geom::Rectangles opaque_region() const override
+    {
+        return {};
+    }
+
 // TouchspotRenderable    
     void move_center_to(geom::Point pos)
     {
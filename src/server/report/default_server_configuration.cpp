@@ -18,6 +18,7 @@
 
 #include "mir/default_server_configuration.h"
 #include "mir/options/configuration.h"
+#include "mir/compositor/frame_statistics.h"
 
 #include "reports.h"
 #include "lttng_report_factory.h"
@@ -70,6 +71,25 @@ auto mir::DefaultServerConfiguration::the_compositor_report() -> std::shared_ptr
         });
 }
 
+auto mir::DefaultServerConfiguration::the_frame_statistics() -> std::shared_ptr<mc::FrameStatistics>
+{
+    return frame_statistics(
+        [this]()->std::shared_ptr<mc::FrameStatistics>
+        {
+            if (auto const statistics = std::dynamic_pointer_cast<mc::FrameStatistics>(the_compositor_report()))
+                return statistics;
+
+            struct NoFrameStatistics : mc::FrameStatistics
+            {
+                auto per_display() const -> std::vector<mc::DisplayFrameStatistics> override
+                {
+                    return {};
+                }
+            };
+            return std::make_shared<NoFrameStatistics>();
+        });
+}
+
 auto mir::DefaultServerConfiguration::the_connector_report() -> std::shared_ptr<mf::ConnectorReport>
 {
     return connector_report(
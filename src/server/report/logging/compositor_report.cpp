@@ -20,6 +20,7 @@
 #include "mir/logging/logger.h"
 
 using namespace mir::time;
+namespace mc = mir::compositor;
 namespace ml = mir::logging;
 namespace mrl = mir::report::logging;
 
@@ -27,6 +28,38 @@ namespace
 {
     const char * const component = "compositor";
     const auto min_report_interval = std::chrono::seconds(1);
+
+    std::atomic<uint64_t> next_serial{0};
+
+    // Marks an instance being taken over for a new display
+    uint64_t const claiming{~uint64_t{0}};
+
+    // The instance last used by this thread, which is almost always the one wanted next
+    struct CachedInstance
+    {
+        uint64_t report_serial;
+        void* instance;
+    };
+    thread_local CachedInstance cached_instance{claiming, nullptr};
+
+    long usec(std::chrono::nanoseconds duration)
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    }
+
+    void format_percentiles(char* buffer, size_t size, mc::FrameTimePercentiles const& percentiles)
+    {
+        long const p50 = usec(percentiles.p50);
+        long const p90 = usec(percentiles.p90);
+        long const p99 = usec(percentiles.p99);
+        long const max = usec(percentiles.max);
+
+        snprintf(buffer, size, "%ld.%03ld/%ld.%03ld/%ld.%03ld/%ld.%03ld",
+                 p50 / 1000, p50 % 1000,
+                 p90 / 1000, p90 % 1000,
+                 p99 / 1000, p99 % 1000,
+                 max / 1000, max % 1000);
+    }
 }
 
 mrl::CompositorReport::CompositorReport(
@@ -34,8 +67,17 @@ mrl::CompositorReport::CompositorReport(
     std::shared_ptr<Clock> const& clock)
     : logger(logger),
       clock(clock),
-      last_report(now())
+      serial(next_serial++),
+      last_scheduled(now().time_since_epoch().count())
+{
+    for (auto& instance : instances)
+        instance = nullptr;
+}
+
+mrl::CompositorReport::~CompositorReport()
 {
+    for (auto& instance : instances)
+        delete instance.load();
 }
 
 mrl::CompositorReport::TimePoint mrl::CompositorReport::now() const
@@ -43,6 +85,93 @@ mrl::CompositorReport::TimePoint mrl::CompositorReport::now() const
     return clock->now();
 }
 
+mrl::CompositorReport::Instance::Instance(SubCompositorId id, uint64_t serial, TimePoint now)
+    : serial{serial},
+      id{id}
+{
+    reset(now);
+}
+
+void mrl::CompositorReport::Instance::reset(TimePoint now)
+{
+    start_of_frame = end_of_frame = TimePoint{};
+    total_time_sum = render_time_sum = latency_sum = TimePoint{};
+    nframes = nbypassed = 0;
+    damaged_pixels_sum = 0;
+    bypassed = true;
+    prev_bypassed = false;
+
+    render_time.reset();
+    snapshot_to_post.reset();
+    frame_interval.reset();
+
+    last_report = now;
+    last_reported_total_time_sum = last_reported_render_time_sum = last_reported_latency_sum = TimePoint{};
+    last_reported_nframes = last_reported_bypassed = 0;
+    last_reported_damaged_pixels_sum = 0;
+    last_reported_render_time = render_time.snapshot();
+    last_reported_snapshot_to_post = snapshot_to_post.snapshot();
+    last_reported_frame_interval = frame_interval.snapshot();
+}
+
+auto mrl::CompositorReport::instance_for(SubCompositorId id) -> Instance*
+{
+    auto const current = serial.load(std::memory_order_relaxed);
+
+    if (cached_instance.report_serial == current)
+    {
+        auto const cached = static_cast<Instance*>(cached_instance.instance);
+        if (cached->id.load(std::memory_order_relaxed) == id)
+            return cached;
+    }
+
+    auto const use = [current](Instance* instance)
+        {
+            cached_instance = CachedInstance{current, instance};
+            return instance;
+        };
+
+    for (auto const& slot : instances)
+    {
+        auto const instance = slot.load(std::memory_order_acquire);
+        if (!instance)
+            break;
+        if (instance->serial.load(std::memory_order_acquire) == current &&
+            instance->id.load(std::memory_order_relaxed) == id)
+            return use(instance);
+    }
+
+    // A display we've not seen since we were last started: use a free slot while there is one...
+    for (auto& slot : instances)
+    {
+        Instance* instance{nullptr};
+        if (slot.load(std::memory_order_acquire))
+            continue;
+
+        auto const fresh = new Instance{id, current, now()};
+        if (slot.compare_exchange_strong(instance, fresh))
+            return use(fresh);
+        delete fresh;
+    }
+
+    // ...and only then give up the statistics of a display from before we were stopped
+    for (auto const& slot : instances)
+    {
+        auto const instance = slot.load(std::memory_order_acquire);
+        auto claimed = instance->serial.load(std::memory_order_acquire);
+        if (claimed != current && claimed != claiming &&
+            instance->serial.compare_exchange_strong(claimed, claiming))
+        {
+            instance->id = id;
+            instance->reset(now());
+            instance->serial.store(current, std::memory_order_release);
+            return use(instance);
+        }
+    }
+
+    return nullptr;
+}
+
 void mrl::CompositorReport::added_display(int width, int height, int x, int y, SubCompositorId id)
 {
     char msg[128];
@@ -53,25 +182,40 @@ void mrl::CompositorReport::added_display(int width, int height, int x, int y, S
 
 void mrl::CompositorReport::began_frame(SubCompositorId id)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto& inst = instance[id];
+    auto const inst = instance_for(id);
+    if (!inst)
+        return;
 
     auto t = now();
-    inst.start_of_frame = t;
-    inst.latency_sum += t - last_scheduled;
-    inst.bypassed = true;
+    inst->start_of_frame = t;
+    inst->latency_sum += t - TimePoint{TimePoint::duration{last_scheduled.load(std::memory_order_relaxed)}};
+    inst->bypassed = true;
 }
 
 void mrl::CompositorReport::renderables_in_frame(SubCompositorId, mir::graphics::RenderableList const&)
 {
 }
 
+void mrl::CompositorReport::damage_in_frame(SubCompositorId id, mir::geometry::Rectangles const& damage)
+{
+    long long pixels = 0;
+    for (auto const& rect : damage)
+        pixels += static_cast<long long>(rect.size.width.as_int()) * rect.size.height.as_int();
+
+    if (auto const inst = instance_for(id))
+        inst->damaged_pixels_sum += pixels;
+}
+
 void mrl::CompositorReport::rendered_frame(SubCompositorId id)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto& inst = instance[id];
-    inst.render_time_sum += now() - inst.start_of_frame;
-    inst.bypassed = false;
+    auto const inst = instance_for(id);
+    if (!inst)
+        return;
+
+    auto const render_time = now() - inst->start_of_frame;
+    inst->render_time_sum += render_time;
+    inst->render_time.record(render_time);
+    inst->bypassed = false;
 }
 
 void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id)
@@ -95,6 +239,9 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
             ).count();
 
         long bypass_percent = dn ? (nbypassed - last_reported_bypassed) * 100L / dn : 0;
+        long rendered = dn - (nbypassed - last_reported_bypassed);
+        long long avg_damaged_pixels = rendered ?
+            (damaged_pixels_sum - last_reported_damaged_pixels_sum) / rendered : 0;
 
         // Keep everything premultiplied by 1000 to guarantee accuracy
         // and avoid floating point.
@@ -103,12 +250,13 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
         long avg_latency_usec = dn ? dl / dn : 0;
         long dt_msec = dt / 1000L;
 
-        char msg[128];
+        char msg[192];
         snprintf(msg, sizeof msg, "Display %p averaged %ld.%03ld FPS, "
                  "%ld.%03ld ms/frame, "
                  "latency %ld.%03ld ms, "
                  "%ld frames over %ld.%03ld sec, "
-                 "%ld%% bypassed",
+                 "%ld%% bypassed, "
+                 "%lld pixels/frame repainted",
                  id,
                  frames_per_1000sec / 1000,
                  frames_per_1000sec % 1000,
@@ -119,51 +267,88 @@ void mrl::CompositorReport::Instance::log(ml::Logger& logger, SubCompositorId id
                  dn,
                  dt_msec / 1000,
                  dt_msec % 1000,
-                 bypass_percent
+                 bypass_percent,
+                 avg_damaged_pixels
                  );
 
+        auto const render = render_time.snapshot();
+        auto const post = snapshot_to_post.snapshot();
+        auto const interval = frame_interval.snapshot();
+
+        char render_percentiles[64], post_percentiles[64], interval_percentiles[64];
+        format_percentiles(render_percentiles, sizeof render_percentiles,
+                           render.since(last_reported_render_time).percentiles());
+        format_percentiles(post_percentiles, sizeof post_percentiles,
+                           post.since(last_reported_snapshot_to_post).percentiles());
+        format_percentiles(interval_percentiles, sizeof interval_percentiles,
+                           interval.since(last_reported_frame_interval).percentiles());
+
+        char percentiles_msg[256];
+        snprintf(percentiles_msg, sizeof percentiles_msg, "Display %p p50/p90/p99/max ms: "
+                 "render %s, "
+                 "snapshot to post %s, "
+                 "frame interval %s",
+                 id,
+                 render_percentiles,
+                 post_percentiles,
+                 interval_percentiles);
+
+        last_reported_render_time = render;
+        last_reported_snapshot_to_post = post;
+        last_reported_frame_interval = interval;
+
+        logger.log(ml::Severity::informational, percentiles_msg, component);
         logger.log(ml::Severity::informational, msg, component);
     }
+    else
+    {
+        last_reported_render_time = render_time.snapshot();
+        last_reported_snapshot_to_post = snapshot_to_post.snapshot();
+        last_reported_frame_interval = frame_interval.snapshot();
+    }
 
     last_reported_total_time_sum = total_time_sum;
     last_reported_render_time_sum = render_time_sum;
     last_reported_latency_sum = latency_sum;
     last_reported_nframes = nframes;
     last_reported_bypassed = nbypassed;
+    last_reported_damaged_pixels_sum = damaged_pixels_sum;
 }
 
 void mrl::CompositorReport::finished_frame(SubCompositorId id)
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    auto& inst = instance[id];
+    auto const inst = instance_for(id);
+    if (!inst)
+        return;
 
     auto t = now();
-    inst.total_time_sum += t - inst.end_of_frame;
-    inst.end_of_frame = t;
-    inst.nframes++;
-    if (inst.bypassed)
-        ++inst.nbypassed;
+    if (inst->nframes)
+        inst->frame_interval.record(t - inst->end_of_frame);
+    inst->snapshot_to_post.record(t - inst->start_of_frame);
+    inst->total_time_sum += t - inst->end_of_frame;
+    inst->end_of_frame = t;
+    inst->nframes++;
+    if (inst->bypassed)
+        ++inst->nbypassed;
 
     /*
      * The exact reporting interval doesn't matter because we count everything
      * as a Reimann sum. Results will simply be the average over the interval.
      */
-    if ((t - last_report) >= min_report_interval)
+    if ((t - inst->last_report) >= min_report_interval)
     {
-        last_report = t;
-
-        for (auto& i : instance)
-            i.second.log(*logger, i.first);
+        inst->last_report = t;
+        inst->log(*logger, id);
     }
 
-    if (inst.bypassed != inst.prev_bypassed || inst.nframes == 1)
+    if (inst->bypassed != inst->prev_bypassed || inst->nframes == 1)
     {
         char msg[128];
         snprintf(msg, sizeof msg, "Display %p bypass %s",
-                 id, inst.bypassed ? "ON" : "OFF");
+                 id, inst->bypassed ? "ON" : "OFF");
         logger->log(ml::Severity::informational, msg, component);
     }
-    inst.prev_bypassed = inst.bypassed;
+    inst->prev_bypassed = inst->bypassed;
 }
 
 void mrl::CompositorReport::started()
@@ -175,12 +360,36 @@ void mrl::CompositorReport::stopped()
 {
     logger->log(ml::Severity::informational, "Stopped", component);
 
-    std::lock_guard<std::mutex> lock(mutex);
-    instance.clear();
+    // Keep the statistics of the displays we've seen, but the next compositing threads will
+    // have new displays: a new serial makes every thread's cached instance stale.
+    serial = next_serial++;
 }
 
 void mrl::CompositorReport::scheduled()
 {
-    std::lock_guard<std::mutex> lock(mutex);
-    last_scheduled = now();
+    last_scheduled.store(now().time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+auto mrl::CompositorReport::per_display() const -> std::vector<mc::DisplayFrameStatistics>
+{
+    std::vector<mc::DisplayFrameStatistics> result;
+
+    for (auto const& slot : instances)
+    {
+        auto const instance = slot.load(std::memory_order_acquire);
+        if (!instance)
+            break;
+
+        if (instance->serial.load(std::memory_order_acquire) == claiming)
+            continue;
+
+        mc::DisplayFrameStatistics statistics;
+        statistics.id = instance->id.load(std::memory_order_relaxed);
+        statistics.render_time = instance->render_time.snapshot().percentiles();
+        statistics.snapshot_to_post = instance->snapshot_to_post.snapshot().percentiles();
+        statistics.frame_interval = instance->frame_interval.snapshot().percentiles();
+        result.push_back(statistics);
+    }
+
+    return result;
 }
@@ -20,10 +20,12 @@
 #define MIR_REPORT_LOGGING_COMPOSITOR_REPORT_H_
 
 #include "mir/compositor/compositor_report.h"
+#include "mir/compositor/frame_statistics.h"
 #include "mir/time/clock.h"
+#include "frame_time_histogram.h"
+#include <array>
+#include <atomic>
 #include <memory>
-#include <mutex>
-#include <unordered_map>
 #include <chrono>
 
 namespace mir
@@ -37,20 +39,25 @@ namespace report
 namespace logging
 {
 
-class CompositorReport : public mir::compositor::CompositorReport
+class CompositorReport : public mir::compositor::CompositorReport, public mir::compositor::FrameStatistics
 {
 public:
     CompositorReport(std::shared_ptr<mir::logging::Logger> const& logger,
                      std::shared_ptr<time::Clock> const& clock);
+    ~CompositorReport();
+
     void added_display(int width, int height, int x, int y, SubCompositorId id) override;
     void began_frame(SubCompositorId id) override;
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void damage_in_frame(SubCompositorId id, geometry::Rectangles const& damage) override;
     void rendered_frame(SubCompositorId id) override;
     void finished_frame(SubCompositorId id) override;
     void started() override;
     void stopped() override;
     void scheduled() override;
 
+    auto per_display() const -> std::vector<compositor::DisplayFrameStatistics> override;
+
 private:
     std::shared_ptr<mir::logging::Logger> const logger;
     std::shared_ptr<time::Clock> const clock;
@@ -58,8 +65,18 @@ private:
     typedef time::Timestamp TimePoint;
     TimePoint now() const;
 
+    /*
+     * Each display is composited by a single thread, so the per-frame calls for it need no
+     * locking; its Instance is only touched by that thread. Only the histograms are read from
+     * elsewhere. An Instance outlives its display, so that its statistics remain available
+     * after compositing stops, until its slot is needed by a display that came later.
+     */
     struct Instance
     {
+        /// The report serial when the display was added (and so is still current while it is)
+        std::atomic<uint64_t> serial;
+        std::atomic<SubCompositorId> id;
+
         TimePoint start_of_frame;
         TimePoint end_of_frame;
         TimePoint total_time_sum;
@@ -67,22 +84,38 @@ private:
         TimePoint latency_sum;
         long nframes = 0;
         long nbypassed = 0;
+        long long damaged_pixels_sum = 0;
         bool bypassed = true;
         bool prev_bypassed = false;
 
+        FrameTimeHistogram render_time;
+        FrameTimeHistogram snapshot_to_post;
+        FrameTimeHistogram frame_interval;
+
+        TimePoint last_report;
         TimePoint last_reported_total_time_sum;
         TimePoint last_reported_render_time_sum;
         TimePoint last_reported_latency_sum;
         long last_reported_nframes = 0;
         long last_reported_bypassed = 0;
+        long long last_reported_damaged_pixels_sum = 0;
+        FrameTimeHistogram::Snapshot last_reported_render_time;
+        FrameTimeHistogram::Snapshot last_reported_snapshot_to_post;
+        FrameTimeHistogram::Snapshot last_reported_frame_interval;
 
+        Instance(SubCompositorId id, uint64_t serial, TimePoint now);
+        void reset(TimePoint now);
         void log(mir::logging::Logger& logger, SubCompositorId id);
     };
 
-    std::mutex mutex; // Protects the following...
-    std::unordered_map<SubCompositorId, Instance> instance;
-    TimePoint last_scheduled;
-    TimePoint last_report;
+    /// The instance for the display, or nullptr if there are too many displays to track
+    Instance* instance_for(SubCompositorId id);
+
+    static int const max_displays = 32;
+    /// Changed by stopped(), so that the displays of one run can't be confused with those of the next
+    std::atomic<uint64_t> serial;
+    std::array<std::atomic<Instance*>, max_displays> instances;
+    std::atomic<TimePoint::rep> last_scheduled;
 };
 
 } // namespace logging
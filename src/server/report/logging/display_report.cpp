@@ -192,3 +192,22 @@ void mrl::DisplayReport::report_vsync(unsigned int output_id,
     }
     prev_frame[output_id] = frame;
 }
+
+void mrl::DisplayReport::report_framebuffer_cache_hit(unsigned int output_id)
+{
+    std::lock_guard<decltype(framebuffer_cache_mutex)> lk(framebuffer_cache_mutex);
+    ++framebuffer_cache_stats[output_id].hits;
+}
+
+void mrl::DisplayReport::report_framebuffer_cache_miss(unsigned int output_id)
+{
+    std::lock_guard<decltype(framebuffer_cache_mutex)> lk(framebuffer_cache_mutex);
+    auto& stats = framebuffer_cache_stats[output_id];
+    ++stats.misses;
+
+    // Hits are the steady state and are only counted; a miss means a new
+    // framebuffer was registered with KMS, which is worth knowing about.
+    logger->log(component(), ml::Severity::debug,
+        "framebuffer cache miss on %u: %llu hits, %llu misses",
+        output_id, stats.hits, stats.misses);
+}
@@ -60,6 +60,8 @@ class DisplayReport : public graphics::DisplayReport
     virtual void report_vt_switch_away_failure() override;
     virtual void report_vt_switch_back_failure() override;
     virtual void report_egl_configuration(EGLDisplay disp, EGLConfig cfg) override;
+    virtual void report_framebuffer_cache_hit(unsigned int output_id) override;
+    virtual void report_framebuffer_cache_miss(unsigned int output_id) override;
 
   protected:
     DisplayReport(DisplayReport const&) = delete;
@@ -69,6 +71,14 @@ class DisplayReport : public graphics::DisplayReport
     std::shared_ptr<mir::logging::Logger> const logger;
     std::mutex vsync_event_mutex;
     std::unordered_map<unsigned int, mir::graphics::Frame> prev_frame;
+
+    struct FramebufferCacheStats
+    {
+        unsigned long long hits;
+        unsigned long long misses;
+    };
+    std::mutex framebuffer_cache_mutex;
+    std::unordered_map<unsigned int, FramebufferCacheStats> framebuffer_cache_stats;
 };
 }
 }
@@ -0,0 +1,135 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_time_histogram.h"
+
+#include <algorithm>
+
+namespace mc = mir::compositor;
+namespace mrl = mir::report::logging;
+
+namespace
+{
+int const sub_buckets = 1 << mrl::FrameTimeHistogram::sub_bucket_bits;
+uint64_t const largest_value = (uint64_t{1} << mrl::FrameTimeHistogram::max_magnitude) - 1;
+
+int magnitude(uint64_t value)
+{
+    return 63 - __builtin_clzll(value);
+}
+
+// Only the recording thread writes, so plain loads and stores suffice (and avoid locked instructions)
+void increment(std::atomic<uint64_t>& counter)
+{
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+}
+
+mrl::FrameTimeHistogram::FrameTimeHistogram()
+{
+    reset();
+}
+
+int mrl::FrameTimeHistogram::bucket_of(std::chrono::nanoseconds sample)
+{
+    auto const value = std::min(static_cast<uint64_t>(std::max(sample.count(), decltype(sample.count()){0})),
+                                largest_value);
+
+    if (value < static_cast<uint64_t>(sub_buckets))
+        return static_cast<int>(value);
+
+    auto const shift = magnitude(value) - sub_bucket_bits;
+    auto const sub_bucket = static_cast<int>(value >> shift) - sub_buckets;
+    return ((shift + 1) << sub_bucket_bits) + sub_bucket;
+}
+
+auto mrl::FrameTimeHistogram::highest_in_bucket(int bucket) -> std::chrono::nanoseconds
+{
+    if (bucket < sub_buckets)
+        return std::chrono::nanoseconds{bucket};
+
+    auto const shift = (bucket >> sub_bucket_bits) - 1;
+    auto const sub_bucket = bucket & (sub_buckets - 1);
+    auto const lowest = static_cast<uint64_t>(sub_buckets + sub_bucket) << shift;
+    return std::chrono::nanoseconds{lowest + (uint64_t{1} << shift) - 1};
+}
+
+void mrl::FrameTimeHistogram::record(std::chrono::nanoseconds sample)
+{
+    increment(counts[bucket_of(sample)]);
+
+    if (sample.count() > max.load(std::memory_order_relaxed))
+        max.store(sample.count(), std::memory_order_relaxed);
+}
+
+auto mrl::FrameTimeHistogram::snapshot() const -> Snapshot
+{
+    Snapshot result;
+    for (int i = 0; i != bucket_count; ++i)
+        result.counts[i] = counts[i].load(std::memory_order_relaxed);
+
+    // Counting the samples from the buckets keeps the percentiles consistent if we race a record()
+    result.samples = 0;
+    for (auto const count : result.counts)
+        result.samples += count;
+
+    result.max = std::chrono::nanoseconds{max.load(std::memory_order_relaxed)};
+    return result;
+}
+
+void mrl::FrameTimeHistogram::reset()
+{
+    for (auto& count : counts)
+        count.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+auto mrl::FrameTimeHistogram::Snapshot::since(Snapshot const& earlier) const -> Snapshot
+{
+    Snapshot result;
+    for (int i = 0; i != bucket_count; ++i)
+        result.counts[i] = counts[i] - earlier.counts[i];
+    result.samples = samples - earlier.samples;
+    result.max = max;
+    return result;
+}
+
+auto mrl::FrameTimeHistogram::Snapshot::percentiles() const -> mc::FrameTimePercentiles
+{
+    mc::FrameTimePercentiles result;
+    result.samples = samples;
+
+    if (samples == 0)
+        return result;
+
+    struct { int percent; std::chrono::nanoseconds* value; } const targets[] =
+        {{50, &result.p50}, {90, &result.p90}, {99, &result.p99}, {100, &result.max}};
+
+    // Report the highest value each bucket may hold, but never more than the largest actually seen
+    auto const value_of = [this](int bucket) { return std::min(highest_in_bucket(bucket), max); };
+
+    uint64_t seen{0};
+    int bucket{0};
+    for (auto const& target : targets)
+    {
+        auto const rank = (samples * target.percent + 99) / 100;
+        while (seen < rank)
+            seen += counts[bucket++];
+        *target.value = value_of(bucket - 1);
+    }
+
+    return result;
+}
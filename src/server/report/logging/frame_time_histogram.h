@@ -0,0 +1,80 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_REPORT_LOGGING_FRAME_TIME_HISTOGRAM_H_
+#define MIR_REPORT_LOGGING_FRAME_TIME_HISTOGRAM_H_
+
+#include "mir/compositor/frame_statistics.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace mir
+{
+namespace report
+{
+namespace logging
+{
+/**
+ * A fixed-size histogram of durations with bounded relative error.
+ *
+ * Buckets are exact below 16ns and above that each power of two is split into
+ * 16 linear sub-buckets, so any value is known to within 1/16 (~6%). Durations
+ * beyond ~68s are counted as ~68s.
+ *
+ * A single thread may record() while any number of others take snapshot()s.
+ */
+class FrameTimeHistogram
+{
+public:
+    static int const sub_bucket_bits = 4;
+    static int const max_magnitude = 36;
+    static int const bucket_count = (max_magnitude - sub_bucket_bits + 1) << sub_bucket_bits;
+
+    struct Snapshot
+    {
+        std::array<uint64_t, bucket_count> counts;
+        uint64_t samples;
+        std::chrono::nanoseconds max;
+
+        /// The samples recorded since earlier (max is still the overall max)
+        auto since(Snapshot const& earlier) const -> Snapshot;
+        auto percentiles() const -> compositor::FrameTimePercentiles;
+    };
+
+    FrameTimeHistogram();
+
+    void record(std::chrono::nanoseconds sample);
+    auto snapshot() const -> Snapshot;
+
+    /// Not safe to call while another thread is recording
+    void reset();
+
+    static int bucket_of(std::chrono::nanoseconds sample);
+    /// The largest duration counted in the bucket
+    static auto highest_in_bucket(int bucket) -> std::chrono::nanoseconds;
+
+private:
+    std::array<std::atomic<uint64_t>, bucket_count> counts;
+    std::atomic<std::chrono::nanoseconds::rep> max;
+};
+}
+}
+}
+
+#endif // MIR_REPORT_LOGGING_FRAME_TIME_HISTOGRAM_H_
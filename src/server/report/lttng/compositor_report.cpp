@@ -53,6 +53,15 @@ void mir::report::lttng::CompositorReport::renderables_in_frame(
     mir_tracepoint(mir_server_compositor, buffers_in_frame, id, ids.data(), ids.size());
 }
 
+void mir::report::lttng::CompositorReport::damage_in_frame(
+    SubCompositorId id, geometry::Rectangles const& damage)
+{
+    uint64_t pixels = 0;
+    for (auto const& rect : damage)
+        pixels += uint64_t(rect.size.width.as_int()) * rect.size.height.as_int();
+    mir_tracepoint(mir_server_compositor, damage_in_frame, id, damage.size(), pixels);
+}
+
 void mir::report::lttng::CompositorReport::rendered_frame(SubCompositorId id)
 {
     mir_tracepoint(mir_server_compositor, rendered_frame, id);
@@ -90,6 +90,17 @@ TRACEPOINT_EVENT(
     )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_compositor,
+    damage_in_frame,
+    TP_ARGS(void const*, id, size_t, rectangles, uint64_t, pixels),
+    TP_FIELDS(
+        ctf_integer_hex(uintptr_t, id, (uintptr_t)(id))
+        ctf_integer(size_t, rectangles, rectangles)
+        ctf_integer(uint64_t, pixels, pixels)
+    )
+)
+
 #endif /* MIR_LTTNG_COMPOSITOR_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
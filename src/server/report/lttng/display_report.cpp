@@ -52,3 +52,13 @@ void mir::report::lttng::DisplayReport::report_vsync(unsigned int output_id,
 {
     mir_tracepoint(mir_server_display, report_vsync, output_id);
 }
+
+void mir::report::lttng::DisplayReport::report_framebuffer_cache_hit(unsigned int output_id)
+{
+    mir_tracepoint(mir_server_display, report_framebuffer_cache_hit, output_id);
+}
+
+void mir::report::lttng::DisplayReport::report_framebuffer_cache_miss(unsigned int output_id)
+{
+    mir_tracepoint(mir_server_display, report_framebuffer_cache_miss, output_id);
+}
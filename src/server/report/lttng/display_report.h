@@ -46,6 +46,8 @@ public:
     virtual void report_vt_switch_away_failure() override;
     virtual void report_vt_switch_back_failure() override;
     virtual void report_vsync(unsigned int output_id, graphics::Frame const&) override;
+    virtual void report_framebuffer_cache_hit(unsigned int output_id) override;
+    virtual void report_framebuffer_cache_miss(unsigned int output_id) override;
 
 private:
     ServerTracepointProvider tp_provider;
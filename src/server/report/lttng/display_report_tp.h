@@ -71,6 +71,24 @@ TRACEPOINT_EVENT(
      )
 )
 
+TRACEPOINT_EVENT(
+    mir_server_display,
+    report_framebuffer_cache_hit,
+    TP_ARGS(int, id),
+    TP_FIELDS(
+        ctf_integer(int, id, id)
+     )
+)
+
+TRACEPOINT_EVENT(
+    mir_server_display,
+    report_framebuffer_cache_miss,
+    TP_ARGS(int, id),
+    TP_FIELDS(
+        ctf_integer(int, id, id)
+     )
+)
+
 #endif /* MIR_LTTNG_DISPLAY_REPORT_TP_H_ */
 
 #include <lttng/tracepoint-event.h>
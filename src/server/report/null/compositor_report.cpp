@@ -32,6 +32,10 @@ void mrn::CompositorReport::renderables_in_frame(SubCompositorId, mir::graphics:
 {
 }
 
+void mrn::CompositorReport::damage_in_frame(SubCompositorId, mir::geometry::Rectangles const&)
+{
+}
+
 void mrn::CompositorReport::rendered_frame(SubCompositorId)
 {
 }
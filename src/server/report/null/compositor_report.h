@@ -34,6 +34,7 @@ public:
     void added_display(int width, int height, int x, int y, SubCompositorId id) override;
     void began_frame(SubCompositorId id) override;
     void renderables_in_frame(SubCompositorId id, graphics::RenderableList const& renderables) override;
+    void damage_in_frame(SubCompositorId id, geometry::Rectangles const& damage) override;
     void rendered_frame(SubCompositorId id) override;
     void finished_frame(SubCompositorId id) override;
     void started() override;
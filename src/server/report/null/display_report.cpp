@@ -30,3 +30,5 @@ void mrn::DisplayReport::report_vt_switch_away_failure() {}
 void mrn::DisplayReport::report_vt_switch_back_failure() {}
 void mrn::DisplayReport::report_egl_configuration(EGLDisplay, EGLConfig) {}
 void mrn::DisplayReport::report_vsync(unsigned int, mir::graphics::Frame const&) {}
+void mrn::DisplayReport::report_framebuffer_cache_hit(unsigned int) {}
+void mrn::DisplayReport::report_framebuffer_cache_miss(unsigned int) {}
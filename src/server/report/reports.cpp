@@ -24,12 +24,17 @@
 #include "mir/observer_multiplexer.h"
 #include "mir/options/configuration.h"
 #include "mir/abnormal_exit.h"
+#include "mir/main_loop.h"
+#include "mir/log.h"
+#include "mir/report/timeline.h"
 
 #include "report_factory.h"
 #include "lttng_report_factory.h"
 #include "logging_report_factory.h"
 #include "null_report_factory.h"
 
+#include <csignal>
+#include <fstream>
 #include <string>
 
 namespace mo = mir::options;
@@ -122,6 +127,42 @@ std::shared_ptr<mir::frontend::SessionMediatorObserver> create_session_mediator_
         std::throw_with_nested(mir::AbnormalExit("Failed to create report for "s + mo::session_mediator_report_opt));
     }
 }
+
+// Enough for the compositing threads' last ~30 seconds at 60Hz
+size_t const timeline_events_per_thread = 32768;
+
+void write_timeline(std::string const& filename)
+{
+    std::ofstream out{filename};
+    mr::Timeline::write_chrome_trace(out);
+    out.close();
+
+    if (out)
+        mir::log_info("Wrote frame timeline to %s", filename.c_str());
+    else
+        mir::log_warning("Failed to write frame timeline to %s", filename.c_str());
+}
+
+std::shared_ptr<void> start_frame_timeline(
+    mir::DefaultServerConfiguration& config,
+    mo::Option const& options)
+{
+    if (!options.is_set(mo::frame_timeline_opt))
+        return {};
+
+    auto const filename = options.get<std::string>(mo::frame_timeline_opt);
+
+    mr::Timeline::enable(timeline_events_per_thread);
+    config.the_main_loop()->register_signal_handler({SIGUSR2}, [filename](int) { write_timeline(filename); });
+
+    return std::shared_ptr<void>{
+        nullptr,
+        [filename](void*)
+        {
+            write_timeline(filename);
+            mr::Timeline::disable();
+        }};
+}
 }
 
 mir::report::Reports::Reports(
@@ -135,7 +176,8 @@ mir::report::Reports::Reports(
           create_session_mediator_reports(
               server,
               options.get<std::string>(mo::session_mediator_report_opt))},
-      session_mediator_observer_multiplexer{server.the_session_mediator_observer_registrar()}
+      session_mediator_observer_multiplexer{server.the_session_mediator_observer_registrar()},
+      frame_timeline{start_frame_timeline(server, options)}
 {
     display_configuration_multiplexer->register_interest(display_configuration_report);
     seat_observer_multiplexer->register_interest(seat_report);
@@ -0,0 +1,250 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/report/timeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace mr = mir::report;
+
+std::atomic<bool> mr::Timeline::active{false};
+
+namespace
+{
+// Buffers of threads that have exited are kept for the next trace, up to a point
+size_t const max_exited_threads = 16;
+
+struct Event
+{
+    // Every field is atomic so that the buffer can be read while its thread records into it
+    std::atomic<int64_t> timestamp_ns;
+    std::atomic<char const*> name;
+    std::atomic<char> phase;
+};
+
+struct EventCopy
+{
+    int64_t timestamp_ns;
+    char const* name;
+    char phase;
+};
+
+class ThreadEvents
+{
+public:
+    explicit ThreadEvents(size_t capacity)
+        : capacity{std::max<size_t>(capacity, 1)},
+          events{new Event[this->capacity]},
+          tid{static_cast<pid_t>(syscall(SYS_gettid))}
+    {
+        char buffer[64]{};
+        pthread_getname_np(pthread_self(), buffer, sizeof buffer);
+        thread_name = buffer;
+    }
+
+    // Only called on the owning thread
+    void record(char phase, char const* name)
+    {
+        auto const timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+
+        auto const index = head.load(std::memory_order_relaxed);
+        auto& event = events[index % capacity];
+        event.timestamp_ns.store(timestamp, std::memory_order_relaxed);
+        event.name.store(name, std::memory_order_relaxed);
+        event.phase.store(phase, std::memory_order_relaxed);
+        head.store(index + 1, std::memory_order_release);
+    }
+
+    /// The events in the buffer that weren't overwritten while we read them
+    auto read() const -> std::vector<EventCopy>
+    {
+        auto const end = head.load(std::memory_order_acquire);
+        auto const start = end > capacity ? end - capacity : 0;
+
+        std::vector<EventCopy> result;
+        result.reserve(end - start);
+        for (auto i = start; i != end; ++i)
+        {
+            auto const& event = events[i % capacity];
+            result.push_back({
+                event.timestamp_ns.load(std::memory_order_relaxed),
+                event.name.load(std::memory_order_relaxed),
+                event.phase.load(std::memory_order_relaxed)});
+        }
+
+        // Anything the thread has since started overwriting can't be trusted
+        std::atomic_thread_fence(std::memory_order_acquire);
+        auto const now = head.load(std::memory_order_relaxed);
+        auto const first_intact = now >= capacity ? now - capacity + 1 : 0;
+        if (first_intact > start)
+            result.erase(result.begin(), result.begin() + std::min(first_intact - start, result.size()));
+
+        return result;
+    }
+
+    size_t const capacity;
+    std::unique_ptr<Event[]> const events;
+    std::atomic<uint64_t> head{0};
+    pid_t const tid;
+    std::string thread_name;
+};
+
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<ThreadEvents>> live_threads;
+std::deque<std::shared_ptr<ThreadEvents>> exited_threads;
+std::atomic<size_t> events_per_thread{0};
+
+struct ThreadRegistration
+{
+    ~ThreadRegistration()
+    {
+        if (!events)
+            return;
+
+        std::lock_guard<std::mutex> lock{registry_mutex};
+        live_threads.erase(std::remove(live_threads.begin(), live_threads.end(), events), live_threads.end());
+        exited_threads.push_back(std::move(events));
+        if (exited_threads.size() > max_exited_threads)
+            exited_threads.pop_front();
+    }
+
+    ThreadEvents& get()
+    {
+        if (!events)
+        {
+            events = std::make_shared<ThreadEvents>(events_per_thread.load());
+
+            std::lock_guard<std::mutex> lock{registry_mutex};
+            live_threads.push_back(events);
+        }
+        return *events;
+    }
+
+    std::shared_ptr<ThreadEvents> events;
+};
+
+thread_local ThreadRegistration this_thread;
+
+void write_json_string(std::ostream& out, char const* text)
+{
+    out << '"';
+    for (auto p = text; *p; ++p)
+    {
+        auto const c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\')
+        {
+            out << '\\' << *p;
+        }
+        else if (c < 0x20)
+        {
+            char escaped[8];
+            snprintf(escaped, sizeof escaped, "\\u%04x", c);
+            out << escaped;
+        }
+        else
+        {
+            out << *p;
+        }
+    }
+    out << '"';
+}
+}
+
+void mr::Timeline::enable(size_t events_per_thread)
+{
+    ::events_per_thread = events_per_thread;
+    active = true;
+}
+
+void mr::Timeline::disable()
+{
+    active = false;
+}
+
+void mr::Timeline::begin(char const* name)
+{
+    this_thread.get().record('B', name);
+}
+
+void mr::Timeline::end(char const* name)
+{
+    this_thread.get().record('E', name);
+}
+
+void mr::Timeline::write_chrome_trace(std::ostream& out)
+{
+    std::vector<std::shared_ptr<ThreadEvents>> threads;
+    {
+        std::lock_guard<std::mutex> lock{registry_mutex};
+        threads.insert(threads.end(), exited_threads.begin(), exited_threads.end());
+        threads.insert(threads.end(), live_threads.begin(), live_threads.end());
+    }
+
+    auto const pid = getpid();
+    char const* separator = "\n";
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    for (auto const& thread : threads)
+    {
+        out << separator << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid
+            << ",\"tid\":" << thread->tid << ",\"args\":{\"name\":";
+        write_json_string(out, thread->thread_name.c_str());
+        out << "}}";
+        separator = ",\n";
+
+        // The start of a span may have been overwritten, leaving an end that the viewer can't match
+        int depth{0};
+        for (auto const& event : thread->read())
+        {
+            if (event.phase == 'E')
+            {
+                if (depth == 0)
+                    continue;
+                --depth;
+            }
+            else
+            {
+                ++depth;
+            }
+
+            char timestamp[32];
+            snprintf(timestamp, sizeof timestamp, "%lld.%03lld",
+                     static_cast<long long>(event.timestamp_ns / 1000),
+                     static_cast<long long>(event.timestamp_ns % 1000));
+
+            out << separator << "{\"ph\":\"" << event.phase << "\",\"name\":";
+            write_json_string(out, event.name);
+            out << ",\"pid\":" << pid << ",\"tid\":" << thread->tid << ",\"ts\":" << timestamp << "}";
+        }
+    }
+
+    out << "\n]}\n";
+}
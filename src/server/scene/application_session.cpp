@@ -117,7 +117,12 @@ auto ms::ApplicationSession::create_surface(
     else
     {
         for (auto& stream : params.streams.value())
-            streams.push_back({std::dynamic_pointer_cast<mc::BufferStream>(stream.stream.lock()), stream.displacement, stream.size});
+            streams.push_back({
+                std::dynamic_pointer_cast<mc::BufferStream>(stream.stream.lock()),
+                stream.displacement,
+                stream.size,
+                stream.opaque_region,
+                stream.src_bounds});
     }
 
     auto surface = surface_factory->create_surface(session, streams, params);
@@ -338,7 +343,7 @@ void ms::ApplicationSession::configure_streams(
     for (auto& stream : streams)
     {
         if (auto const s = std::dynamic_pointer_cast<mc::BufferStream>(stream.stream.lock()))
-            list.emplace_back(ms::StreamInfo{s, stream.displacement, stream.size});
+            list.emplace_back(ms::StreamInfo{s, stream.displacement, stream.size, stream.opaque_region, stream.src_bounds});
     }
     surface.set_streams(list); 
 }
@@ -19,6 +19,7 @@
  */
 
 #include "basic_surface.h"
+#include "recycling_allocator.h"
 #include "mir/compositor/buffer_stream.h"
 #include "mir/frontend/event_sink.h"
 #include "mir/shell/input_targeter.h"
@@ -278,7 +279,7 @@ ms::BasicSurface::BasicSurface(
     cursor_image_(cursor_image),
     report(report),
     parent_(parent),
-    layers(layers),
+    layers(layers.begin(), layers.end()),
     confine_pointer_state_(state),
     cursor_stream_adapter{std::make_unique<ms::CursorStreamImageAdapter>(*this)},
     session_{session}
@@ -414,11 +415,14 @@ bool ms::BasicSurface::input_area_contains(geom::Point const& point) const
             return false;
     }
 
+    // Input is restricted to the bounding rectangle, and custom input is clipped to it
+    auto const input_rect = geom::Rectangle{content_top_left(lock), content_size(lock)};
+    if (!input_rect.contains(point))
+        return false;
+
     if (custom_input_rectangles.empty())
     {
-        // no custom input, restrict to bounding rectangle
-        auto const input_rect = geom::Rectangle{content_top_left(lock), content_size(lock)};
-        return input_rect.contains(point);
+        return true;
     }
     else
     {
@@ -810,6 +814,21 @@ std::shared_ptr<ms::Surface> ms::BasicSurface::parent() const
 
 namespace
 {
+auto opaque_region_on_screen(std::vector<geom::Rectangle> const& region, geom::Rectangle const& position)
+-> geom::Rectangles
+{
+    geom::Rectangles result;
+    for (auto const& rect : region)
+    {
+        auto const on_screen = geom::Rectangle{rect.top_left + as_displacement(position.top_left), rect.size}
+            .intersection_with(position);
+
+        if (on_screen.size.width > geom::Width{} && on_screen.size.height > geom::Height{})
+            result.add(on_screen);
+    }
+    return result;
+}
+
 //This class avoids locking for long periods of time by copying (or lazy-copying)
 class SurfaceSnapshot : public mg::Renderable
 {
@@ -818,16 +837,20 @@ public:
         std::shared_ptr<mc::BufferStream> const& stream,
         void const* compositor_id,
         geom::Rectangle const& position,
+        geom::Rectangle const& src_bounds,
         std::experimental::optional<geom::Rectangle> const& clip_area,
         glm::mat4 const& transform,
         float alpha,
+        std::shared_ptr<std::vector<geom::Rectangle> const> const& opaque_region,
         mg::Renderable::ID id)
     : underlying_buffer_stream{stream},
       compositor_id{compositor_id},
       alpha_{alpha},
       screen_position_(position),
+      src_bounds_(src_bounds),
       clip_area_(clip_area),
       transformation_(transform),
+      opaque_region_(opaque_region),
       id_(id)
     {
     }
@@ -851,9 +874,25 @@ public:
     geom::Rectangle screen_position() const override
     { return screen_position_; }
 
+    geom::Rectangle src_bounds() const override
+    { return src_bounds_; }
+
     std::experimental::optional<geom::Rectangle> clip_area() const override
     { return clip_area_; }
 
+    geom::Rectangles damage() const override
+    {
+        // The stream tracks damage relative to what each compositor acquired
+        geom::Rectangles result;
+        for (auto const& rect : underlying_buffer_stream->damage_for(compositor_id))
+        {
+            auto const on_screen = buffer_to_screen(rect.intersection_with(src_bounds_));
+            if (on_screen.size.width > geom::Width{} && on_screen.size.height > geom::Height{})
+                result.add(on_screen);
+        }
+        return result;
+    }
+
     float alpha() const override
     { return alpha_; }
 
@@ -863,16 +902,50 @@ public:
     bool shaped() const override
     { return mg::contains_alpha(underlying_buffer_stream->pixel_format()); }
 
+    geom::Rectangles opaque_region() const override
+    { return opaque_region_ ? opaque_region_on_screen(*opaque_region_, screen_position_) : geom::Rectangles{}; }
+
     mg::Renderable::ID id() const override
     { return id_; }
 private:
+    /// Maps part of src_bounds_ onto screen_position_, rounding outwards if it's scaled
+    auto buffer_to_screen(geom::Rectangle const& rect) const -> geom::Rectangle
+    {
+        if (src_bounds_.size.width <= geom::Width{} || src_bounds_.size.height <= geom::Height{})
+            return {};
+
+        auto const scale = [](int offset, int from, int to, bool round_up)
+            {
+                auto const scaled = int64_t{offset} * to;
+                return static_cast<int>(round_up ? (scaled + from - 1) / from : scaled / from);
+            };
+
+        auto const src = src_bounds_;
+        auto const dst = screen_position_;
+        auto const left = scale(
+            (rect.left() - src.left()).as_int(), src.size.width.as_int(), dst.size.width.as_int(), false);
+        auto const top = scale(
+            (rect.top() - src.top()).as_int(), src.size.height.as_int(), dst.size.height.as_int(), false);
+        auto const right = scale(
+            (rect.right() - src.left()).as_int(), src.size.width.as_int(), dst.size.width.as_int(), true);
+        auto const bottom = scale(
+            (rect.bottom() - src.top()).as_int(), src.size.height.as_int(), dst.size.height.as_int(), true);
+
+        return geom::Rectangle{
+            {dst.left().as_int() + left, dst.top().as_int() + top},
+            {right - left, bottom - top}}.intersection_with(dst);
+    }
+
     std::shared_ptr<mc::BufferStream> const underlying_buffer_stream;
     std::shared_ptr<mg::Buffer> mutable compositor_buffer;
     void const*const compositor_id;
     float const alpha_;
     geom::Rectangle const screen_position_;
+    geom::Rectangle const src_bounds_;
     std::experimental::optional<geom::Rectangle> const clip_area_;
     glm::mat4 const transformation_;
+    /// Stream-relative, so that taking the snapshot needn't copy it
+    std::shared_ptr<std::vector<geom::Rectangle> const> const opaque_region_;
     mg::Renderable::ID const id_;
 };
 }
@@ -917,7 +990,7 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
         for(auto& layer : layers)
             layer.stream->set_frame_posted_callback([](auto){});
 
-        layers = s;
+        layers = std::list<Layer>(s.begin(), s.end());
 
         for(auto& layer : layers)
             layer.stream->set_frame_posted_callback(
@@ -935,13 +1008,19 @@ void ms::BasicSurface::set_streams(std::list<scene::StreamInfo> const& s)
 
 mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) const
 {
-    std::lock_guard<std::mutex> lock(guard);
     mg::RenderableList list;
-    
+    append_renderables(id, list);
+    return list;
+}
+
+void ms::BasicSurface::append_renderables(mc::CompositorID id, mg::RenderableList& list) const
+{
+    std::lock_guard<std::mutex> lock(guard);
+
     if (clip_area_)
     {
         if (!surface_rect.overlaps(clip_area_.value()))
-            return list;
+            return;
     }
 
     auto const content_top_left_ = content_top_left(lock);
@@ -956,14 +1035,27 @@ mg::RenderableList ms::BasicSurface::generate_renderables(mc::CompositorID id) c
             else
                 size = info.stream->stream_size();
 
-            list.emplace_back(std::make_shared<SurfaceSnapshot>(
+            geom::Rectangle const position{content_top_left_ + info.displacement, std::move(size)};
+            auto const src_bounds = info.src_bounds.is_set() ?
+                info.src_bounds.value() :
+                geom::Rectangle{{}, position.size};
+            list.emplace_back(make_recycled<SurfaceSnapshot>(
                 info.stream, id,
-                geom::Rectangle{content_top_left_ + info.displacement, std::move(size)},
+                position,
+                src_bounds,
                 clip_area_,
-                transformation_matrix, surface_alpha, info.stream.get()));
+                transformation_matrix, surface_alpha,
+                info.shared_opaque_region,
+                info.stream.get()));
         }
     }
-    return list;
+}
+
+ms::BasicSurface::Layer::Layer(StreamInfo const& info) :
+    StreamInfo(info),
+    shared_opaque_region{
+        info.opaque_region.empty() ? nullptr : std::make_shared<std::vector<geom::Rectangle> const>(info.opaque_region)}
+{
 }
 
 void ms::BasicSurface::set_confine_pointer_state(MirPointerConfinementState state)
@@ -109,6 +109,7 @@ public:
     bool visible() const override;
 
     graphics::RenderableList generate_renderables(compositor::CompositorID id) const override;
+    void append_renderables(compositor::CompositorID id, graphics::RenderableList& list) const override;
     int buffers_ready_for_compositor(void const* compositor_id) const override;
 
     MirWindowType type() const override;
@@ -200,7 +201,16 @@ private:
     std::shared_ptr<SceneReport> const report;
     std::weak_ptr<Surface> const parent_;
 
-    std::list<StreamInfo> layers;
+    /// A StreamInfo whose opaque region can be shared with the snapshots taken of it
+    struct Layer : StreamInfo
+    {
+        Layer(StreamInfo const& info);
+
+        /// Null if the opaque region is empty
+        std::shared_ptr<std::vector<geometry::Rectangle> const> shared_opaque_region;
+    };
+
+    std::list<Layer> layers;
     // Surface attributes:
     MirWindowType type_ = mir_window_type_normal;
     MirWindowState state_ = mir_window_state_restored;
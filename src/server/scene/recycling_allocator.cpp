@@ -0,0 +1,88 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "recycling_allocator.h"
+
+#include <new>
+
+namespace ms = mir::scene;
+
+std::size_t const ms::RecyclingArena::granularity;
+std::size_t const ms::RecyclingArena::max_block_size;
+
+namespace
+{
+auto size_class(std::size_t size) -> std::size_t
+{
+    return (size + ms::RecyclingArena::granularity - 1)/ms::RecyclingArena::granularity - 1;
+}
+}
+
+ms::RecyclingArena::~RecyclingArena()
+{
+    for (auto block : free_lists)
+    {
+        while (block)
+        {
+            auto const next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+}
+
+void* ms::RecyclingArena::allocate(std::size_t size)
+{
+    if (size == 0 || size > max_block_size)
+        return ::operator new(size);
+
+    auto const index = size_class(size);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (auto const block = free_lists[index])
+        {
+            free_lists[index] = block->next;
+            return block;
+        }
+    }
+
+    // Allocate the whole size class so the block can serve any request that maps to it
+    return ::operator new((index + 1)*granularity);
+}
+
+void ms::RecyclingArena::deallocate(void* block, std::size_t size) noexcept
+{
+    if (size == 0 || size > max_block_size)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    auto const index = size_class(size);
+    auto const free_block = static_cast<FreeBlock*>(block);
+
+    std::lock_guard<std::mutex> lock{mutex};
+    free_block->next = free_lists[index];
+    free_lists[index] = free_block;
+}
+
+auto ms::RecyclingArena::for_this_thread() -> std::shared_ptr<RecyclingArena> const&
+{
+    // Outstanding blocks keep the arena alive after the thread has exited
+    static thread_local std::shared_ptr<RecyclingArena> const arena{std::make_shared<RecyclingArena>()};
+    return arena;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef MIR_SCENE_RECYCLING_ALLOCATOR_H_
+#define MIR_SCENE_RECYCLING_ALLOCATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace mir
+{
+namespace scene
+{
+/**
+ * Free lists of fixed size blocks through which the per-frame scene snapshot objects are
+ * recycled.
+ *
+ * Each compositor thread gets an arena of its own, so after the first few frames the
+ * blocks a frame needs are all left over from its predecessor and compositing does not
+ * touch the heap. A block may be returned from any thread. Blocks too large for the size
+ * classes fall through to the heap.
+ */
+class RecyclingArena
+{
+public:
+    RecyclingArena() = default;
+    ~RecyclingArena();
+
+    void* allocate(std::size_t size);
+    void deallocate(void* block, std::size_t size) noexcept;
+
+    /// The arena of the calling thread
+    static auto for_this_thread() -> std::shared_ptr<RecyclingArena> const&;
+
+    static std::size_t const granularity = 64;
+    static std::size_t const max_block_size = 1024;
+
+private:
+    RecyclingArena(RecyclingArena const&) = delete;
+    RecyclingArena& operator=(RecyclingArena const&) = delete;
+
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    std::mutex mutex;
+    std::array<FreeBlock*, max_block_size/granularity> free_lists{};
+};
+
+/// An allocator drawing on a RecyclingArena, which it keeps alive for as long as it is needed
+template<typename T>
+class RecyclingAllocator
+{
+public:
+    using value_type = T;
+
+    explicit RecyclingAllocator(std::shared_ptr<RecyclingArena> const& arena) :
+        arena{arena}
+    {
+    }
+
+    template<typename U>
+    RecyclingAllocator(RecyclingAllocator<U> const& other) :
+        arena{other.arena}
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena->allocate(n*sizeof(T)));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        arena->deallocate(p, n*sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(RecyclingAllocator<U> const& other) const
+    {
+        return arena == other.arena;
+    }
+
+    template<typename U>
+    bool operator!=(RecyclingAllocator<U> const& other) const
+    {
+        return arena != other.arena;
+    }
+
+private:
+    template<typename U>
+    friend class RecyclingAllocator;
+
+    std::shared_ptr<RecyclingArena> arena;
+};
+
+/// Like std::make_shared(), but recycling the storage through the calling thread's arena
+template<typename T, typename... Args>
+auto make_recycled(Args&&... args) -> std::shared_ptr<T>
+{
+    return std::allocate_shared<T>(
+        RecyclingAllocator<T>{RecyclingArena::for_this_thread()},
+        std::forward<Args>(args)...);
+}
+}
+}
+
+#endif /* MIR_SCENE_RECYCLING_ALLOCATOR_H_ */
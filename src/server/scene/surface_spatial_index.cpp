@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "surface_spatial_index.h"
+#include "mir/scene/surface.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace ms = mir::scene;
+namespace geom = mir::geometry;
+
+namespace
+{
+int const cell_shift = 8;                       // 256x256 pixel cells
+int64_t const max_cells_per_surface = 256;      // ...so anything bigger than ~4096x4096 is "oversized"
+
+/// The cell containing coordinate, rounding towards negative infinity
+int cell_of(int coordinate)
+{
+    return coordinate >= 0 ?
+        coordinate >> cell_shift :
+        -((-(coordinate + 1)) >> cell_shift) - 1;
+}
+
+uint64_t key_of(int cell_x, int cell_y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) | static_cast<uint32_t>(cell_y);
+}
+
+bool is_empty(geom::Rectangle const& rect)
+{
+    return rect.size.width.as_int() <= 0 || rect.size.height.as_int() <= 0;
+}
+
+int64_t cell_count(geom::Rectangle const& bounds)
+{
+    if (is_empty(bounds))
+        return 0;
+
+    int64_t const columns = cell_of(bounds.right().as_int() - 1) - cell_of(bounds.left().as_int()) + 1;
+    int64_t const rows = cell_of(bounds.bottom().as_int() - 1) - cell_of(bounds.top().as_int()) + 1;
+    return columns * rows;
+}
+}
+
+template<typename F>
+void ms::SurfaceSpatialIndex::for_each_cell(geom::Rectangle const& bounds, F f)
+{
+    if (is_empty(bounds))
+        return;
+
+    auto const last_x = cell_of(bounds.right().as_int() - 1);
+    auto const last_y = cell_of(bounds.bottom().as_int() - 1);
+
+    for (auto y = cell_of(bounds.top().as_int()); y <= last_y; ++y)
+    {
+        for (auto x = cell_of(bounds.left().as_int()); x <= last_x; ++x)
+        {
+            f(key_of(x, y));
+        }
+    }
+}
+
+void ms::SurfaceSpatialIndex::add_to_cells(Entry* entry)
+{
+    entry->oversized = cell_count(entry->bounds) > max_cells_per_surface;
+
+    if (entry->oversized)
+    {
+        oversized.push_back(entry);
+    }
+    else
+    {
+        for_each_cell(entry->bounds, [&](CellKey key) { cells[key].push_back(entry); });
+    }
+}
+
+void ms::SurfaceSpatialIndex::remove_from_cells(Entry* entry)
+{
+    auto const remove_from = [entry](std::vector<Entry*>& list)
+        {
+            auto const p = std::find(list.begin(), list.end(), entry);
+            if (p != list.end())
+            {
+                // Order within a cell doesn't matter, so avoid shuffling everything down
+                *p = list.back();
+                list.pop_back();
+            }
+        };
+
+    if (entry->oversized)
+    {
+        remove_from(oversized);
+    }
+    else
+    {
+        for_each_cell(entry->bounds, [&](CellKey key)
+            {
+                auto const cell = cells.find(key);
+                if (cell != cells.end())
+                {
+                    remove_from(cell->second);
+                    if (cell->second.empty())
+                        cells.erase(cell);
+                }
+            });
+    }
+}
+
+void ms::SurfaceSpatialIndex::raise_to_top(std::shared_ptr<Surface> const& surface, unsigned int depth_index)
+{
+    StackingOrder const order{depth_index, next_sequence++};
+
+    auto const existing = entries.find(surface.get());
+    if (existing != entries.end())
+    {
+        existing->second.order = order;
+    }
+    else
+    {
+        auto& entry = entries[surface.get()];
+        entry.surface = surface;
+        entry.bounds = surface->input_bounds();
+        entry.order = order;
+        add_to_cells(&entry);
+    }
+}
+
+void ms::SurfaceSpatialIndex::remove(Surface const* surface)
+{
+    auto const entry = entries.find(surface);
+    if (entry != entries.end())
+    {
+        remove_from_cells(&entry->second);
+        entries.erase(entry);
+    }
+}
+
+void ms::SurfaceSpatialIndex::update_bounds(Surface const* surface)
+{
+    auto const p = entries.find(surface);
+    if (p == entries.end())
+        return;
+
+    auto& entry = p->second;
+    auto const bounds = entry.surface->input_bounds();
+    if (bounds != entry.bounds)
+    {
+        remove_from_cells(&entry);
+        entry.bounds = bounds;
+        add_to_cells(&entry);
+    }
+}
+
+auto ms::SurfaceSpatialIndex::surface_at(geom::Point point) const -> std::shared_ptr<Surface>
+{
+    static std::vector<Entry*> const no_entries;
+
+    auto const cell = cells.find(key_of(cell_of(point.x.as_int()), cell_of(point.y.as_int())));
+    auto const& candidates = cell != cells.end() ? cell->second : no_entries;
+
+    // Try the candidates from the top down. There are few enough in a cell that repeatedly
+    // scanning for the next one is cheaper than sorting them, and the first usually accepts.
+    StackingOrder below{std::numeric_limits<unsigned int>::max(), std::numeric_limits<uint64_t>::max()};
+
+    for (;;)
+    {
+        Entry const* next{nullptr};
+        for (auto const* list : {&candidates, &oversized})
+        {
+            for (auto const* entry : *list)
+            {
+                if (entry->order < below &&
+                    (!next || next->order < entry->order) &&
+                    entry->bounds.contains(point))
+                {
+                    next = entry;
+                }
+            }
+        }
+
+        if (!next)
+            return {};
+
+        if (next->surface->input_area_contains(point))
+            return next->surface;
+
+        below = next->order;
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MIR_SCENE_SURFACE_SPATIAL_INDEX_H_
+#define MIR_SCENE_SURFACE_SPATIAL_INDEX_H_
+
+#include "mir/geometry/rectangle.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace mir
+{
+namespace scene
+{
+class Surface;
+
+/**
+ * Finds the topmost surface accepting input at a point without visiting every surface.
+ *
+ * Surfaces are bucketed by their input bounds into a uniform grid, and each carries
+ * its position in the stacking order so that only the surfaces sharing the point's
+ * cell need be considered. Surfaces covering very many cells are kept in a separate
+ * list that is always searched.
+ *
+ * The index relies on a surface accepting input only within its input_bounds(), and
+ * must be told (via update_bounds()) whenever those change. It is not thread safe.
+ */
+class SurfaceSpatialIndex
+{
+public:
+    /// Adds the surface above all others in the depth layer, or moves it there if already present
+    void raise_to_top(std::shared_ptr<Surface> const& surface, unsigned int depth_index);
+    void remove(Surface const* surface);
+
+    /// Re-reads the input bounds of the surface
+    void update_bounds(Surface const* surface);
+
+    auto surface_at(geometry::Point point) const -> std::shared_ptr<Surface>;
+
+private:
+    using StackingOrder = std::pair<unsigned int, uint64_t>;
+    using CellKey = uint64_t;
+
+    struct Entry
+    {
+        std::shared_ptr<Surface> surface;
+        geometry::Rectangle bounds;
+        StackingOrder order;
+        bool oversized;
+    };
+
+    void add_to_cells(Entry* entry);
+    void remove_from_cells(Entry* entry);
+
+    template<typename F>
+    void for_each_cell(geometry::Rectangle const& bounds, F f);
+
+    std::unordered_map<Surface const*, Entry> entries;
+    std::unordered_map<CellKey, std::vector<Entry*>> cells;
+    std::vector<Entry*> oversized;
+    uint64_t next_sequence{0};
+};
+}
+}
+
+#endif /* MIR_SCENE_SURFACE_SPATIAL_INDEX_H_ */
@@ -20,12 +20,14 @@
 
 #include "surface_stack.h"
 #include "rendering_tracker.h"
+#include "recycling_allocator.h"
 #include "mir/scene/surface.h"
 #include "mir/scene/null_surface_observer.h"
 #include "mir/scene/scene_report.h"
 #include "mir/compositor/scene_element.h"
 #include "mir/graphics/renderable.h"
 #include "mir/depth_layer.h"
+#include "mir/raii.h"
 
 #include <boost/throw_exception.hpp>
 
@@ -48,14 +50,12 @@ class SurfaceSceneElement : public mc::SceneElement
 {
 public:
     SurfaceSceneElement(
-        std::string name,
         std::shared_ptr<mg::Renderable> const& renderable,
         std::shared_ptr<ms::RenderingTracker> const& tracker,
         mc::CompositorID id)
         : renderable_{renderable},
           tracker{tracker},
-          cid{id},
-          surface_name(name)
+          cid{id}
     {
     }
 
@@ -78,7 +78,6 @@ private:
     std::shared_ptr<mg::Renderable> const renderable_;
     std::shared_ptr<ms::RenderingTracker> const tracker;
     mc::CompositorID cid;
-    std::string const surface_name;
 };
 
 //note: something different than a 2D/HWC overlay
@@ -86,7 +85,7 @@ class OverlaySceneElement : public mc::SceneElement
 {
 public:
     OverlaySceneElement(
-        std::shared_ptr<mg::Renderable> renderable)
+        std::shared_ptr<mg::Renderable> const& renderable)
         : renderable_{renderable}
     {
     }
@@ -124,6 +123,16 @@ struct SurfaceDepthLayerObserver : ms::NullSurfaceObserver
         stack->raise(surface);
     }
 
+    void moved_to(ms::Surface const* surface, geom::Point const& /*top_left*/) override
+    {
+        stack->input_bounds_changed(surface);
+    }
+
+    void content_resized_to(ms::Surface const* surface, geom::Size const& /*content_size*/) override
+    {
+        stack->input_bounds_changed(surface);
+    }
+
 private:
     ms::SurfaceStack* stack;
 };
@@ -152,33 +161,45 @@ ms::SurfaceStack::~SurfaceStack() noexcept(true)
 
 mc::SceneElementSequence ms::SurfaceStack::scene_elements_for(mc::CompositorID id)
 {
+    mc::SceneElementSequence elements;
+    fill_scene_elements(id, elements);
+    return elements;
+}
+
+void ms::SurfaceStack::fill_scene_elements(mc::CompositorID id, mc::SceneElementSequence& elements)
+{
+    // Kept between frames so that, like the elements, it only grows with the scene
+    static thread_local mg::RenderableList renderables;
+    // ...but not the renderables themselves, even if a surface throws
+    auto const clear_renderables = raii::paired_calls([]{}, []{ renderables.clear(); });
+
     RecursiveReadLock lg(guard);
 
     scene_changed = false;
-    mc::SceneElementSequence elements;
+    elements.clear();
     for (auto const& layer : surface_layers)
     {
         for (auto const& surface : layer)
         {
             if (surface->visible())
             {
-                for (auto& renderable : surface->generate_renderables(id))
+                surface->append_renderables(id, renderables);
+                for (auto const& renderable : renderables)
                 {
                     elements.emplace_back(
-                        std::make_shared<SurfaceSceneElement>(
-                            surface->name(),
+                        make_recycled<SurfaceSceneElement>(
                             renderable,
                             rendering_trackers[surface.get()],
                             id));
                 }
+                renderables.clear();
             }
         }
     }
     for (auto const& renderable : overlays)
     {
-        elements.emplace_back(std::make_shared<OverlaySceneElement>(renderable));
+        elements.emplace_back(make_recycled<OverlaySceneElement>(renderable));
     }
-    return elements;
 }
 
 int ms::SurfaceStack::frames_pending(mc::CompositorID id) const
@@ -293,6 +314,7 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
             if (surface != layer.end())
             {
                 layer.erase(surface);
+                spatial_index.remove(keep_alive.get());
                 rendering_trackers.erase(keep_alive.get());
                 keep_alive->remove_observer(surface_observer);
                 found_surface = true;
@@ -309,37 +331,27 @@ void ms::SurfaceStack::remove_surface(std::weak_ptr<Surface> const& surface)
     // TODO: error logging when surface not found
 }
 
-namespace
+auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
+-> std::shared_ptr<Surface>
 {
-template <typename Container>
-struct InReverse {
-    Container& container;
-    auto begin() -> decltype(container.rbegin()) { return container.rbegin(); }
-    auto end() -> decltype(container.rend()) { return container.rend(); }
-};
+    RecursiveReadLock lg(guard);
 
-template <typename Container>
-InReverse<Container> in_reverse(Container& container) { return InReverse<Container>{container}; }
+    // TODO There's a lack of clarity about how the input area will
+    // TODO be maintained and whether this test will detect clicks on
+    // TODO decorations (it should) as these may be outside the area
+    // TODO known to the client.  But it works for now.
+    return spatial_index.surface_at(cursor);
 }
 
-auto ms::SurfaceStack::surface_at(geometry::Point cursor) const
--> std::shared_ptr<Surface>
+auto ms::SurfaceStack::input_surface_at(geometry::Point point) -> std::shared_ptr<mi::Surface>
 {
-    RecursiveReadLock lg(guard);
-    for (auto const& layer : in_reverse(surface_layers))
-    {
-        for (auto const& surface : in_reverse(layer))
-        {
-            // TODO There's a lack of clarity about how the input area will
-            // TODO be maintained and whether this test will detect clicks on
-            // TODO decorations (it should) as these may be outside the area
-            // TODO known to the client.  But it works for now.
-            if (surface->input_area_contains(cursor))
-                    return surface;
-        }
-    }
+    return surface_at(point);
+}
 
-    return {};
+void ms::SurfaceStack::input_bounds_changed(Surface const* surface)
+{
+    RecursiveWriteLock lg(guard);
+    spatial_index.update_bounds(surface);
 }
 
 void ms::SurfaceStack::for_each(std::function<void(std::shared_ptr<mi::Surface> const&)> const& callback)
@@ -450,6 +462,7 @@ void ms::SurfaceStack::insert_surface_at_top_of_depth_layer(std::shared_ptr<Surf
     if (surface_layers.size() <= depth_index)
         surface_layers.resize(depth_index + 1);
     surface_layers[depth_index].push_back(surface);
+    spatial_index.raise_to_top(surface, depth_index);
 }
 
 void ms::SurfaceStack::add_observer(std::shared_ptr<ms::Observer> const& observer)
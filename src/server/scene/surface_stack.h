@@ -30,6 +30,8 @@
 #include "mir/basic_observers.h"
 #include "mir/scene/surface_observer.h"
 
+#include "surface_spatial_index.h"
+
 #include <atomic>
 #include <map>
 #include <memory>
@@ -79,16 +81,20 @@ public:
 
     // From Scene
     compositor::SceneElementSequence scene_elements_for(compositor::CompositorID id) override;
+    void fill_scene_elements(compositor::CompositorID id, compositor::SceneElementSequence& elements) override;
     int frames_pending(compositor::CompositorID) const override;
     void register_compositor(compositor::CompositorID id) override;
     void unregister_compositor(compositor::CompositorID id) override;
 
     // From Scene
     void for_each(std::function<void(std::shared_ptr<input::Surface> const&)> const& callback) override;
+    auto input_surface_at(geometry::Point point) -> std::shared_ptr<input::Surface> override;
 
     virtual void remove_surface(std::weak_ptr<Surface> const& surface) override;
 
     void raise(Surface const* surface);
+    /// Notifies the stack that the input bounds of surface may have changed
+    void input_bounds_changed(Surface const* surface);
     virtual void raise(std::weak_ptr<Surface> const& surface) override;
     void raise(SurfaceSet const& surfaces) override;
 
@@ -126,6 +132,8 @@ private:
      * The inner vectors contain the list of surfaces on each layer (bottom to top)
      */
     std::vector<std::vector<std::shared_ptr<Surface>>> surface_layers;
+    /// The surfaces of surface_layers, indexed by input bounds for hit-testing
+    SurfaceSpatialIndex spatial_index;
     std::map<Surface*,std::shared_ptr<RenderingTracker>> rendering_trackers;
     std::set<compositor::CompositorID> registered_compositors;
     
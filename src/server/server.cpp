@@ -117,6 +117,7 @@ struct TemporaryCompositeEventFilter : public mi::CompositeEventFilter
     MACRO(the_display)\
     MACRO(the_display_configuration_controller)\
     MACRO(the_focus_controller)\
+    MACRO(the_frame_statistics)\
     MACRO(the_gl_config)\
     MACRO(the_graphics_platform)\
     MACRO(the_input_targeter)\
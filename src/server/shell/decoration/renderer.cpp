@@ -23,6 +23,7 @@
 
 #include "mir/graphics/graphic_buffer_allocator.h"
 #include "mir/renderer/sw/pixel_source.h"
+#include "mir/renderer/sw/pixel_kernels.h"
 #include "mir/geometry/displacement.h"
 #include "mir/log.h"
 
@@ -31,8 +32,12 @@
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
+#include <list>
 #include <locale>
 #include <codecvt>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace ms = mir::scene;
 namespace mg = mir::graphics;
@@ -106,10 +111,10 @@ inline void render_row(
         return;
     geom::X const right = std::min(left.x + as_delta(length), as_x(buf_size.width));
     left.x = std::max(left.x, geom::X{});
+    if (right <= left.x)
+        return;
     uint32_t* const start = data + (left.y.as_int() * buf_size.width.as_int()) + left.x.as_int();
-    uint32_t* const end = start + right.as_int() - left.x.as_int();
-    for (uint32_t* i = start; i < end; i++)
-        *i = color;
+    mrs::pixel_kernels().fill(start, color, right.as_int() - left.x.as_int());
 }
 
 inline void render_close_icon(
@@ -169,6 +174,60 @@ inline void render_minimize_icon(
 }
 }
 
+namespace
+{
+/// Keeps the most recently used values, evicting the least recently used once their total cost exceeds capacity
+template<typename Key, typename Value>
+class LruCache
+{
+public:
+    explicit LruCache(size_t capacity)
+        : capacity{capacity}
+    {
+    }
+
+    auto find(Key const& key) -> Value const*
+    {
+        auto const found = index.find(key);
+        if (found == index.end())
+            return nullptr;
+
+        entries.splice(entries.begin(), entries, found->second);
+        return &found->second->value;
+    }
+
+    auto insert(Key const& key, Value value, size_t cost) -> Value const&
+    {
+        entries.push_front({key, std::move(value), cost});
+        index[key] = entries.begin();
+        total_cost += cost;
+
+        // Never evict what was just inserted, even if it is over capacity by itself
+        while (total_cost > capacity && entries.size() > 1)
+        {
+            total_cost -= entries.back().cost;
+            index.erase(entries.back().key);
+            entries.pop_back();
+        }
+
+        return entries.front().value;
+    }
+
+private:
+    struct Entry
+    {
+        Key key;
+        Value value;
+        size_t cost;
+    };
+
+    size_t const capacity;
+    size_t total_cost{0};
+    std::list<Entry> entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator> index;
+};
+}
+
 class msd::Renderer::Text::Impl
     : public Text
 {
@@ -185,19 +244,52 @@ public:
         Pixel color) override;
 
 private:
+    /// A rendered glyph's coverage, copied out of FreeType's glyph slot
+    struct Glyph
+    {
+        geom::Displacement bitmap_offset;   ///< From the pen position to the top left of the bitmap
+        geom::Displacement advance;
+        geom::Size size;
+        std::vector<unsigned char> alpha;   ///< Rows of size.width bytes
+    };
+
+    struct PositionedGlyph
+    {
+        std::shared_ptr<Glyph const> glyph;
+        geom::Displacement top_left;        ///< Relative to the top left of the run
+    };
+
+    /// The glyphs of a title, laid out for drawing
+    using Run = std::vector<PositionedGlyph>;
+
+    /// Between them, the caches hold at most 1MiB. A laid out title is charged for the glyphs it
+    /// holds, as these stay alive after the glyph cache evicts them.
+    static size_t const glyph_cache_bytes = 512 * 1024;
+    /// Decorations redraw the same title on focus changes and resizes
+    static size_t const run_cache_bytes = 512 * 1024;
+
     std::mutex mutex;
     FT_Library library;
     FT_Face face;
-
+    geom::Height face_size;
+    /// Keyed by character and pixel size
+    LruCache<uint64_t, std::shared_ptr<Glyph const>> glyph_cache{glyph_cache_bytes};
+    /// Keyed by pixel size and title
+    LruCache<std::string, std::shared_ptr<Run const>> run_cache{run_cache_bytes};
+
+    auto layout_run(std::string const& text, geom::Height height) -> std::shared_ptr<Run const>;
+    auto cached_glyph(char32_t glyph, geom::Height height) -> std::shared_ptr<Glyph const>;
     void set_char_size(geom::Height height);
     void rasterize_glyph(char32_t glyph);
     void render_glyph(
         Pixel* buf,
         geom::Size buf_size,
-        FT_Bitmap const* glyph,
+        Glyph const& glyph,
         geom::Point top_left,
         Pixel color);
 
+    static auto glyph_bytes(Glyph const& glyph) -> size_t;
+    static auto run_bytes(std::string const& key, Run const& run) -> size_t;
     static auto font_path() -> std::string;
     static auto utf8_to_utf32(std::string const& text) -> std::u32string;
 };
@@ -290,40 +382,71 @@ void msd::Renderer::Text::Impl::render(
         return;
     }
 
-    try
-    {
-        set_char_size(height_pixels);
-    }
-    catch (std::runtime_error const& error)
-    {
-        log_warning(error.what());
-        return;
-    }
+    for (auto const& glyph : *layout_run(text, height_pixels))
+        render_glyph(buf, buf_size, *glyph.glyph, top_left + glyph.top_left, color);
+}
 
-    auto const utf32 = utf8_to_utf32(text);
+auto msd::Renderer::Text::Impl::layout_run(std::string const& text, geom::Height height) -> std::shared_ptr<Run const>
+{
+    auto const key = std::to_string(height.as_int()) + ':' + text;
+    if (auto const cached = run_cache.find(key))
+        return *cached;
 
-    for (char32_t const glyph : utf32)
+    auto run = std::make_shared<Run>();
+    geom::Displacement pen;
+    bool complete{true};
+
+    for (char32_t const glyph : utf8_to_utf32(text))
     {
         try
         {
-            rasterize_glyph(glyph);
-
-            geom::Point glyph_top_left =
-                top_left +
-                geom::Displacement{
-                    face->glyph->bitmap_left,
-                    height_pixels.as_int() - face->glyph->bitmap_top};
-            render_glyph(buf, buf_size, &face->glyph->bitmap, glyph_top_left, color);
-
-            top_left += geom::Displacement{
-                face->glyph->advance.x / 64,
-                face->glyph->advance.y / 64};
+            auto const rendered = cached_glyph(glyph, height);
+            run->push_back({rendered, pen + rendered->bitmap_offset + geom::Displacement{0, height.as_int()}});
+            pen = pen + rendered->advance;
         }
         catch (std::runtime_error const& error)
         {
             log_warning(error.what());
+            complete = false;
         }
     }
+
+    // Try again next time, rather than keep a title with glyphs missing (e.g. because the font
+    // couldn't be set to this size)
+    if (!complete)
+        return run;
+
+    return run_cache.insert(key, run, run_bytes(key, *run));
+}
+
+auto msd::Renderer::Text::Impl::cached_glyph(char32_t glyph, geom::Height height) -> std::shared_ptr<Glyph const>
+{
+    auto const key = (uint64_t{static_cast<uint32_t>(height.as_int())} << 32) | glyph;
+    if (auto const cached = glyph_cache.find(key))
+        return *cached;
+
+    if (face_size != height)
+    {
+        set_char_size(height);
+        face_size = height;
+    }
+
+    rasterize_glyph(glyph);
+
+    auto const slot = face->glyph;
+    auto const& bitmap = slot->bitmap;
+    auto rendered = std::make_shared<Glyph>();
+    rendered->bitmap_offset = {slot->bitmap_left, -slot->bitmap_top};
+    rendered->advance = {slot->advance.x / 64, slot->advance.y / 64};
+    rendered->size = {static_cast<int>(bitmap.width), static_cast<int>(bitmap.rows)};
+    rendered->alpha.resize(bitmap.width * bitmap.rows);
+    for (unsigned row = 0; row < bitmap.rows; row++)
+    {
+        std::copy_n(bitmap.buffer + row * bitmap.pitch, bitmap.width, rendered->alpha.data() + row * bitmap.width);
+    }
+
+    auto const cost = glyph_bytes(*rendered);
+    return glyph_cache.insert(key, std::move(rendered), cost);
 }
 
 void msd::Renderer::Text::Impl::set_char_size(geom::Height height)
@@ -349,43 +472,58 @@ void msd::Renderer::Text::Impl::rasterize_glyph(char32_t glyph)
 void msd::Renderer::Text::Impl::render_glyph(
     Pixel* buf,
     geom::Size buf_size,
-    FT_Bitmap const* glyph,
+    Glyph const& glyph,
     geom::Point top_left,
     Pixel color)
 {
     geom::X const buffer_left = std::max(top_left.x, geom::X{});
-    geom::X const buffer_right = std::min(top_left.x + geom::DeltaX{glyph->width}, as_x(buf_size.width));
+    geom::X const buffer_right = std::min(top_left.x + as_delta(glyph.size.width), as_x(buf_size.width));
 
     geom::Y const buffer_top = std::max(top_left.y, geom::Y{});
-    geom::Y const buffer_bottom = std::min(top_left.y + geom::DeltaY{glyph->rows}, as_y(buf_size.height));
+    geom::Y const buffer_bottom = std::min(top_left.y + as_delta(glyph.size.height), as_y(buf_size.height));
 
-    geom::Displacement const glyph_offset = as_displacement(top_left);
+    if (buffer_right <= buffer_left)
+        return;
 
-    unsigned char* const color_pixels = (unsigned char *)&color;
-    unsigned char const color_alpha = color_pixels[3];
+    geom::Displacement const glyph_offset = as_displacement(top_left);
+    geom::X const glyph_left = buffer_left - glyph_offset.dx;
+    auto const& kernels = mrs::pixel_kernels();
 
     for (geom::Y buffer_y = buffer_top; buffer_y < buffer_bottom; buffer_y += geom::DeltaY{1})
     {
         geom::Y const glyph_y = buffer_y - glyph_offset.dy;
-        unsigned char* const glyph_row = glyph->buffer + glyph_y.as_int() * glyph->pitch;
+        unsigned char const* const glyph_row = glyph.alpha.data() + glyph_y.as_int() * glyph.size.width.as_int();
         Pixel* const buffer_row = buf + buffer_y.as_int() * buf_size.width.as_int();
 
-        for (geom::X buffer_x = buffer_left; buffer_x < buffer_right; buffer_x += geom::DeltaX{1})
-        {
-            geom::X const glyph_x = buffer_x - glyph_offset.dx;
-            unsigned char const glyph_alpha = ((int)glyph_row[glyph_x.as_int()] * color_alpha) / 255;
-            unsigned char* const buffer_pixels = (unsigned char *)(buffer_row + buffer_x.as_int());
-            for (int i = 0; i < 3; i++)
-            {
-                // Blend color with the previous buffer color based on the glyph's alpha
-                buffer_pixels[i] =
-                    ((int)buffer_pixels[i] * (255 - glyph_alpha)) / 255 +
-                    ((int)color_pixels[i] * glyph_alpha) / 255;
-            }
-        }
+        // Blend color with the previous buffer color based on the glyph's alpha
+        kernels.blend_a8(
+            buffer_row + buffer_left.as_int(),
+            glyph_row + glyph_left.as_int(),
+            color,
+            buffer_right.as_int() - buffer_left.as_int());
     }
 }
 
+auto msd::Renderer::Text::Impl::glyph_bytes(Glyph const& glyph) -> size_t
+{
+    return sizeof(Glyph) + glyph.alpha.capacity();
+}
+
+auto msd::Renderer::Text::Impl::run_bytes(std::string const& key, Run const& run) -> size_t
+{
+    auto bytes = sizeof(Run) + key.capacity() + run.capacity() * sizeof(PositionedGlyph);
+
+    // A title is likely to repeat glyphs, but each is only held once
+    std::unordered_set<Glyph const*> held;
+    for (auto const& glyph : run)
+    {
+        if (held.insert(glyph.glyph.get()).second)
+            bytes += glyph_bytes(*glyph.glyph);
+    }
+
+    return bytes;
+}
+
 auto msd::Renderer::Text::Impl::font_path() -> std::string
 {
     // Similar to default_font() in examples/example-server-lib/wallpaper_config.cpp
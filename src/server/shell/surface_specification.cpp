@@ -32,7 +32,9 @@ auto msh::operator==(StreamSpecification const& lhs, StreamSpecification const&
     return
         lhs.stream.lock() == rhs.stream.lock() &&
         lhs.displacement == rhs.displacement &&
-        lhs.size == rhs.size;
+        lhs.size == rhs.size &&
+        lhs.opaque_region == rhs.opaque_region &&
+        lhs.src_bounds == rhs.src_bounds;
 }
 
 bool msh::SurfaceSpecification::is_empty() const
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/thread/work_queue.h"
+
+namespace mt = mir::thread;
+
+/*
+ * This is Dmitry Vyukov's intrusive MPSC queue: producers swing head to
+ * their node and then link the previous head to it. The consumer follows
+ * the links from tail, using a stub node so the queue is never truly empty.
+ *
+ * A producer that has swung head but not yet linked its node hides it (and
+ * anything pushed after it) from the consumer for a moment. pop() returns
+ * nothing then, and that's fine: the producer's wakeup_pending exchange
+ * comes after it links, so it sees the consumer's start_draining() and asks
+ * for another wakeup.
+ */
+
+mt::WorkQueue::WorkQueue()
+    : head{&stub},
+      tail{&stub}
+{
+}
+
+mt::WorkQueue::~WorkQueue()
+{
+    while (pop())
+    {
+    }
+}
+
+bool mt::WorkQueue::push(std::function<void()>&& work)
+{
+    // An empty function would look like the end of the queue to pop()
+    if (!work)
+        return false;
+
+    auto const node = new Node;
+    node->work = std::move(work);
+    push_node(node);
+
+    return !wakeup_pending.exchange(true);
+}
+
+void mt::WorkQueue::start_draining()
+{
+    wakeup_pending.exchange(false);
+}
+
+std::function<void()> mt::WorkQueue::pop()
+{
+    auto first = tail;
+    auto next = first->next.load(std::memory_order_acquire);
+
+    if (first == &stub)
+    {
+        if (!next)
+            return {};
+
+        tail = next;
+        first = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (!next)
+    {
+        // first is the last linked node; it's only safe to take once
+        // something is linked after it, so put the stub back behind it.
+        if (first != head.load())
+            return {};
+
+        push_node(&stub);
+
+        next = first->next.load(std::memory_order_acquire);
+        if (!next)
+            return {};
+    }
+
+    tail = next;
+    auto work = std::move(first->work);
+    delete first;
+    return work;
+}
+
+bool mt::WorkQueue::empty() const
+{
+    return tail == &stub && !stub.next.load(std::memory_order_acquire);
+}
+
+void mt::WorkQueue::push_node(Node* node)
+{
+    node->next.store(nullptr, std::memory_order_relaxed);
+    auto const previous = head.exchange(node);
+    previous->next.store(node, std::memory_order_release);
+}
@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir_test_framework/headless_in_process_server.h"
+#include "mir/options/configuration.h"
+#include "mir/server.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mo = mir::options;
+namespace mtf = mir_test_framework;
+
+using namespace std::chrono;
+using namespace testing;
+
+namespace
+{
+/// Stands in for Xwayland: it records each launch, but never becomes ready
+class FakeXwayland
+{
+public:
+    FakeXwayland()
+    {
+        std::ofstream{path} <<
+            "#!/bin/sh\n"
+            "echo launched >> " << launch_log << "\n"
+            "exec sleep 1\n";
+        chmod(path.c_str(), 0700);
+    }
+
+    ~FakeXwayland()
+    {
+        unlink(launch_log.c_str());
+        unlink(path.c_str());
+        rmdir(dir.c_str());
+    }
+
+    auto launches() const -> int
+    {
+        std::ifstream log{launch_log};
+        int count = 0;
+        for (std::string line; std::getline(log, line);)
+            ++count;
+        return count;
+    }
+
+    /// Waits up to timeout for Xwayland to be launched
+    void wait_for_launch(milliseconds timeout) const
+    {
+        auto const start = steady_clock::now();
+        while (launches() == 0 && steady_clock::now() - start < timeout)
+            std::this_thread::sleep_for(milliseconds{1});
+    }
+
+    std::string const dir{make_temp_dir()};
+    std::string const path{dir + "/Xwayland"};
+    std::string const launch_log{dir + "/launches"};
+
+private:
+    static auto make_temp_dir() -> std::string
+    {
+        char dir[] = "/tmp/fake_xwayland_XXXXXX";
+        if (!mkdtemp(dir))
+            throw std::system_error(errno, std::system_category(), "Failed to create temp dir");
+        return dir;
+    }
+};
+
+/// An X11 display number not in use on this machine
+auto unused_x11_display() -> int
+{
+    for (int display = 100; display != 200; ++display)
+    {
+        auto const lock = "/tmp/.X" + std::to_string(display) + "-lock";
+        auto const socket = "/tmp/.X11-unix/X" + std::to_string(display);
+        if (access(lock.c_str(), F_OK) != 0 && access(socket.c_str(), F_OK) != 0)
+            return display;
+    }
+    throw std::runtime_error{"No free X11 display"};
+}
+
+struct XWaylandServer : mtf::HeadlessInProcessServer
+{
+    XWaylandServer(FakeXwayland const& xwayland, int x11_display, bool eager_start)
+    {
+        // Normally added by miral::X11Support
+        server.add_configuration_option(mo::x11_display_opt, "", mir::OptionType::integer);
+        server.add_configuration_option("xwayland-path", "", xwayland.path);
+        server.add_configuration_option("xwayland-eager-start", "", mir::OptionType::null);
+        server.add_configuration_option("xwayland-idle-timeout", "", 0);
+
+        add_to_environment("MIR_SERVER_X11_DISPLAY_EXPERIMENTAL", std::to_string(x11_display).c_str());
+        if (eager_start)
+            add_to_environment("MIR_SERVER_XWAYLAND_EAGER_START", "");
+    }
+
+    void TestBody() override {}
+};
+
+struct XWaylandStartup : Test
+{
+    void SetUp() override
+    {
+        mkdir("/tmp/.X11-unix", 01777);
+        ASSERT_THAT(access("/tmp/.X11-unix", W_OK), Eq(0));
+    }
+
+    void connect_x11_client() const
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof addr.sun_path, "/tmp/.X11-unix/X%d", x11_display);
+
+        auto const fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        ASSERT_THAT(fd, Ge(0));
+        EXPECT_THAT(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr), Eq(0));
+        close(fd);
+    }
+
+    FakeXwayland const xwayland;
+    int const x11_display{unused_x11_display()};
+};
+}
+
+TEST_F(XWaylandStartup, xwayland_is_not_launched_until_an_x11_client_connects)
+{
+    XWaylandServer server{xwayland, x11_display, false};
+    server.SetUp();
+
+    std::this_thread::sleep_for(milliseconds{200});
+    EXPECT_THAT(xwayland.launches(), Eq(0));
+
+    connect_x11_client();
+    xwayland.wait_for_launch(seconds{10});
+    EXPECT_THAT(xwayland.launches(), Ge(1));
+
+    server.TearDown();
+}
+
+TEST_F(XWaylandStartup, eager_start_launches_xwayland_with_the_server)
+{
+    XWaylandServer server{xwayland, x11_display, true};
+    server.SetUp();
+
+    xwayland.wait_for_launch(seconds{10});
+    EXPECT_THAT(xwayland.launches(), Ge(1));
+
+    server.TearDown();
+}
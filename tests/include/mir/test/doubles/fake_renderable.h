@@ -70,9 +70,14 @@ public:
         return opacity;
     }
 
+    void set_transformation(glm::mat4 const& new_transformation)
+    {
+        transformation_ = new_transformation;
+    }
+
     glm::mat4 transformation() const override
     {
-        return glm::mat4(1);
+        return transformation_;
     }
 
     bool shaped() const override
@@ -80,6 +85,16 @@ public:
         return !rectangular;
     }
 
+    void set_opaque_region(geometry::Rectangles const& region)
+    {
+        opaque_region_ = region;
+    }
+
+    geometry::Rectangles opaque_region() const override
+    {
+        return opaque_region_;
+    }
+
     void set_buffer(std::shared_ptr<graphics::Buffer> b)
     {
         buf = b;
@@ -90,14 +105,44 @@ public:
         return buf;
     }
 
+    void set_screen_position(geometry::Rectangle const& new_rect)
+    {
+        rect = new_rect;
+    }
+
     geometry::Rectangle screen_position() const override
     {
         return rect;
     }
+
+    void set_src_bounds(geometry::Rectangle const& bounds)
+    {
+        src_bounds_ = bounds;
+    }
+
+    geometry::Rectangle src_bounds() const override
+    {
+        return src_bounds_ ? src_bounds_.value() : geometry::Rectangle{{}, rect.size};
+    }
     
+    void set_clip_area(geometry::Rectangle const& area)
+    {
+        clip_area_ = area;
+    }
+
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
-        return std::experimental::optional<geometry::Rectangle>();
+        return clip_area_;
+    }
+
+    void set_damage(geometry::Rectangles const& new_damage)
+    {
+        damage_ = new_damage;
+    }
+
+    geometry::Rectangles damage() const override
+    {
+        return damage_ ? damage_.value() : geometry::Rectangles{rect};
     }
 
     unsigned int swap_interval() const override
@@ -110,6 +155,11 @@ private:
     mir::geometry::Rectangle rect;
     float opacity;
     bool rectangular;
+    glm::mat4 transformation_ = glm::mat4(1);
+    std::experimental::optional<geometry::Rectangles> damage_;
+    geometry::Rectangles opaque_region_;
+    std::experimental::optional<geometry::Rectangle> src_bounds_;
+    std::experimental::optional<geometry::Rectangle> clip_area_;
 };
 
 } // namespace doubles
@@ -39,6 +39,8 @@ public:
                  void(compositor::CompositorReport::SubCompositorId));
     MOCK_METHOD2(renderables_in_frame,
                  void(compositor::CompositorReport::SubCompositorId, graphics::RenderableList const&));
+    MOCK_METHOD2(damage_in_frame,
+                 void(compositor::CompositorReport::SubCompositorId, geometry::Rectangles const&));
     MOCK_METHOD1(rendered_frame,
                  void(compositor::CompositorReport::SubCompositorId));
     MOCK_METHOD1(finished_frame,
@@ -35,8 +35,14 @@ struct MockRenderable : public graphics::Renderable
     {
         ON_CALL(*this, screen_position())
             .WillByDefault(testing::Return(geometry::Rectangle{{},{}}));
+        ON_CALL(*this, src_bounds())
+            .WillByDefault(testing::Invoke([this] { return geometry::Rectangle{{}, screen_position().size}; }));
         ON_CALL(*this, clip_area())
             .WillByDefault(testing::Return(std::experimental::optional<geometry::Rectangle>()));
+        ON_CALL(*this, damage())
+            .WillByDefault(testing::Return(geometry::Rectangles{}));
+        ON_CALL(*this, opaque_region())
+            .WillByDefault(testing::Return(geometry::Rectangles{}));
         ON_CALL(*this, buffer())
             .WillByDefault(testing::Return(std::make_shared<StubBuffer>()));
         ON_CALL(*this, alpha())
@@ -50,11 +56,14 @@ struct MockRenderable : public graphics::Renderable
     MOCK_CONST_METHOD0(id, ID());
     MOCK_CONST_METHOD0(buffer, std::shared_ptr<graphics::Buffer>());
     MOCK_CONST_METHOD0(screen_position, geometry::Rectangle());
+    MOCK_CONST_METHOD0(src_bounds, geometry::Rectangle());
     MOCK_CONST_METHOD0(clip_area, std::experimental::optional<geometry::Rectangle>());
+    MOCK_CONST_METHOD0(damage, geometry::Rectangles());
     MOCK_CONST_METHOD0(alpha, float());
     MOCK_CONST_METHOD0(transformation, glm::mat4());
     MOCK_CONST_METHOD0(visible, bool());
     MOCK_CONST_METHOD0(shaped, bool());
+    MOCK_CONST_METHOD0(opaque_region, geometry::Rectangles());
     MOCK_CONST_METHOD0(swap_interval, unsigned int());
 };
 }
@@ -65,6 +65,14 @@ public:
     {
         if (b) ++nready;
     }
+    void submit_buffer(std::shared_ptr<graphics::Buffer> const& b, geometry::Rectangles const&) override
+    {
+        submit_buffer(b);
+    }
+    geometry::Rectangles damage_for(void const*) const override
+    {
+        return {geometry::Rectangle{{}, stub_compositor_buffer->size()}};
+    }
     void with_most_recent_buffer_do(std::function<void(graphics::Buffer&)> const& fn) override
     {
         fn(*stub_compositor_buffer);
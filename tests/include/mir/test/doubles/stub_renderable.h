@@ -74,10 +74,18 @@ public:
     {
         return rect;
     }
+    geometry::Rectangle src_bounds() const override
+    {
+        return {{}, rect.size};
+    }
     std::experimental::optional<geometry::Rectangle> clip_area() const override
     {
         return std::experimental::optional<geometry::Rectangle>();
     }
+    geometry::Rectangles damage() const override
+    {
+        return {rect};
+    }
     float alpha() const override
     {
         return 1.0f;
@@ -90,6 +98,10 @@ public:
     {
         return false;
     }
+    geometry::Rectangles opaque_region() const override
+    {
+        return {};
+    }
     unsigned int swap_interval() const override
     {
         return 1;
@@ -0,0 +1,95 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef MIR_TEST_DOUBLES_STUB_SW_DISPLAY_BUFFER_H_
+#define MIR_TEST_DOUBLES_STUB_SW_DISPLAY_BUFFER_H_
+
+#include "mir/test/doubles/stub_display_buffer.h"
+#include "mir/renderer/sw/render_target.h"
+
+#include <vector>
+
+namespace mir
+{
+namespace test
+{
+namespace doubles
+{
+
+/// A DisplayBuffer with a chain of buffers in memory for software rendering
+class StubSWDisplayBuffer : public StubDisplayBuffer,
+                            public renderer::software::RenderTarget
+{
+public:
+    StubSWDisplayBuffer(geometry::Rectangle const& view_area, size_t buffer_count = 2)
+        : StubDisplayBuffer{view_area},
+          width{view_area.size.width.as_int()},
+          // Rows are padded, to catch anything that ignores the stride
+          row_pixels{width + 3},
+          buffers(buffer_count, std::vector<uint32_t>(row_pixels * view_area.size.height.as_int(), 0)),
+          ages(buffer_count, 0)
+    {
+    }
+
+    geometry::Size size() const override { return view_area().size; }
+
+    Pixels back_buffer() override
+    {
+        return {buffers[back].data(), geometry::Stride{row_pixels * static_cast<int>(sizeof(uint32_t))}};
+    }
+
+    unsigned int buffer_age() const override { return ages[back]; }
+
+    void swap_buffers() override
+    {
+        for (auto& age : ages)
+        {
+            if (age)
+                ++age;
+        }
+        ages[back] = 1;
+        front = back;
+        back = (back + 1) % buffers.size();
+    }
+
+    /// The pixel last presented at \a position (relative to the view area)
+    uint32_t presented_pixel(geometry::Point position) const
+    {
+        return buffers[front][position.y.as_int() * row_pixels + position.x.as_int()];
+    }
+
+    /// The rows last presented, without padding
+    std::vector<uint32_t> presented() const
+    {
+        std::vector<uint32_t> pixels;
+        for (auto row = buffers[front].begin(); row != buffers[front].end(); row += row_pixels)
+            pixels.insert(pixels.end(), row, row + width);
+        return pixels;
+    }
+
+private:
+    int const width;
+    int const row_pixels;
+    std::vector<std::vector<uint32_t>> buffers;
+    std::vector<unsigned int> ages;
+    size_t front{0};
+    size_t back{0};
+};
+
+}
+}
+}
+
+#endif /* MIR_TEST_DOUBLES_STUB_SW_DISPLAY_BUFFER_H_ */
@@ -24,13 +24,20 @@
 #include "mir/test/doubles/null_display_changer.h"
 
 #include "mir_toolkit/mir_connection.h"
+#include "mir_toolkit/mir_display_configuration.h"
 
 #include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
 
 namespace mtd = mir::test::doubles;
 namespace mt = mir::test;
 namespace mg = mir::graphics;
 namespace mf = mir::frontend;
+namespace ms = mir::scene;
 
 namespace
 {
@@ -43,8 +50,27 @@ public:
         return mt::fake_shared(stub_display_config);
     }
 
+    void configure(
+        std::shared_ptr<ms::Session> const&,
+        std::shared_ptr<mg::DisplayConfiguration> const&) override
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        ++configurations;
+        configured.notify_all();
+    }
+
+    bool wait_for_configurations(int count, std::chrono::seconds timeout)
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        return configured.wait_for(lock, timeout, [&] { return configurations >= count; });
+    }
+
 private:
     mtd::StubDisplayConfig stub_display_config{20};
+
+    std::mutex mutex;
+    std::condition_variable configured;
+    int configurations{0};
 };
 
 
@@ -101,3 +127,41 @@ TEST_F(LargeMessages, connection_to_server_with_large_display_configuration_succ
 
     mir_connection_release(connection_context.connection);
 }
+
+// Each round trip sends the display configuration to the server and gets the
+// (large) base configuration back, exercising both directions of the transport
+TEST_F(LargeMessages, large_message_round_trip_throughput)
+{
+    using namespace testing;
+
+    int const round_trips{2000};
+    // Stay well within the socket buffers, so the server never has to wait for the client
+    int const max_in_flight{8};
+
+    ConnectionContext connection_context;
+
+    mir_connect(new_connection().c_str(), __PRETTY_FUNCTION__,
+                connection_callback, &connection_context);
+
+    connection_context.connected.wait_until_ready(std::chrono::seconds{3});
+    ASSERT_THAT(connection_context.connection, NotNull());
+
+    auto const config = mir_connection_create_display_configuration(connection_context.connection);
+    auto& changer = large_messages_server_config.large_display_config_changer;
+
+    auto const start = std::chrono::steady_clock::now();
+    for (int i = 0; i != round_trips; ++i)
+    {
+        ASSERT_TRUE(changer.wait_for_configurations(i - max_in_flight, std::chrono::seconds{10}));
+        mir_connection_apply_session_display_config(connection_context.connection, config);
+    }
+    ASSERT_TRUE(changer.wait_for_configurations(round_trips, std::chrono::seconds{10}));
+    auto const duration = std::chrono::steady_clock::now() - start;
+
+    auto const round_trips_per_second = static_cast<int>(
+        round_trips / std::chrono::duration<double>(duration).count());
+    RecordProperty("round_trips_per_second", round_trips_per_second);
+
+    mir_display_config_release(config);
+    mir_connection_release(connection_context.connection);
+}
@@ -18,8 +18,71 @@
 
 #include "system_performance_test.h"
 
+#include "src/server/scene/surface_stack.h"
+#include "src/server/scene/basic_surface.h"
+#include "src/server/report/null_report_factory.h"
+#include "mir/compositor/scene_element.h"
+#include "mir/graphics/renderable.h"
+
+#include "mir/test/doubles/stub_buffer_stream.h"
+
+#include <gmock/gmock.h>
+
+#include <cstdlib>
+#include <new>
+
 using namespace std::literals::chrono_literals;
 using namespace mir::test;
+using namespace testing;
+
+namespace mc = mir::compositor;
+namespace ms = mir::scene;
+namespace mi = mir::input;
+namespace geom = mir::geometry;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+thread_local bool counting_allocations{false};
+thread_local long allocations{0};
+
+/// Counts the heap allocations made by this thread while in scope
+class AllocationCounter
+{
+public:
+    AllocationCounter()
+    {
+        allocations = 0;
+        counting_allocations = true;
+    }
+
+    ~AllocationCounter()
+    {
+        counting_allocations = false;
+    }
+
+    long count() const
+    {
+        return allocations;
+    }
+};
+}
+
+void* operator new(std::size_t size)
+{
+    if (counting_allocations)
+        ++allocations;
+
+    if (auto const block = std::malloc(size ? size : 1))
+        return block;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* block) noexcept
+{
+    std::free(block);
+}
 
 namespace
 {
@@ -46,10 +109,29 @@ struct CompositorPerformance : SystemPerformanceTest
                     compositor_render_time = render_time;
                 }
             }
+            if (char const* repaint = strstr(line, "bypassed, "))
+            {
+                long long pixels;
+                if (1 == sscanf(repaint, "bypassed, %lld pixels/frame repainted",
+                                &pixels))
+                {
+                    repainted_pixels = pixels;
+                }
+            }
         }
     }
 
     float compositor_fps, compositor_render_time;
+    long long repainted_pixels = -1;
+};
+
+struct HeadlessCompositorPerformance : CompositorPerformance
+{
+    void SetUp() override
+    {
+        compositor_fps = compositor_render_time = -1.0f;
+        SystemPerformanceTest::set_up_with("--compositor-report=log --offscreen");
+    }
 };
 } // anonymous namespace
 
@@ -67,3 +149,96 @@ TEST_F(CompositorPerformance, regression_test_1563287)
     EXPECT_GE(compositor_fps, 58.0f);
     EXPECT_LT(compositor_render_time, 17.0f);
 }
+
+TEST_F(HeadlessCompositorPerformance, repaints_only_what_clients_change)
+{
+    // A single 500x500 window animating on an otherwise idle desktop
+    int const client_window_pixels = 500 * 500;
+
+    spawn_clients({"mir_demo_client_progressbar"});
+    run_server_for(10s);
+
+    read_compositor_report();
+    ASSERT_GE(repainted_pixels, 0);
+    EXPECT_LE(repainted_pixels, client_window_pixels);
+}
+
+namespace
+{
+struct SceneSnapshotPerformance : Test
+{
+    SceneSnapshotPerformance()
+    {
+        for (int i = 0; i != surfaces; ++i)
+        {
+            ms::StreamInfo layer{std::make_shared<mtd::StubBufferStream>(), {}, {}};
+            if (i % 2)
+                layer.opaque_region = {{{0, 0}, {100, 50}}, {{0, 50}, {20, 50}}};
+
+            auto const surface = std::make_shared<ms::BasicSurface>(
+                nullptr,
+                "a surface with a name too long for the small string optimisation",
+                geom::Rectangle{{(i % 10) * 100, (i / 10) * 100}, {200, 200}},
+                mir_pointer_unconfined,
+                std::list<ms::StreamInfo>{layer},
+                nullptr,
+                mir::report::null_scene_report());
+
+            stack.add_surface(surface, mi::InputReceptionMode::normal);
+        }
+
+        for (auto const id : compositors)
+            stack.register_compositor(id);
+    }
+
+    ~SceneSnapshotPerformance()
+    {
+        for (auto const id : compositors)
+            stack.unregister_compositor(id);
+    }
+
+    /// Snapshots the scene for each compositor and uses it the way compositing does
+    void composite_frame()
+    {
+        for (int i = 0; i != compositor_count; ++i)
+        {
+            stack.fill_scene_elements(compositors[i], scene_elements[i]);
+
+            for (auto const& element : scene_elements[i])
+            {
+                auto const renderable = element->renderable();
+                renderable->buffer();
+                renderable->screen_position();
+                element->rendered();
+            }
+
+            scene_elements[i].clear();
+        }
+    }
+
+    static int const surfaces = 80;
+    static int const compositor_count = 2;
+
+    ms::SurfaceStack stack{mir::report::null_scene_report()};
+    int compositor_ids[compositor_count];
+    mc::CompositorID const compositors[compositor_count]{&compositor_ids[0], &compositor_ids[1]};
+    mc::SceneElementSequence scene_elements[compositor_count];
+};
+}
+
+TEST_F(SceneSnapshotPerformance, steady_state_compositing_does_not_allocate)
+{
+    // The first frames size the element sequences and fill the snapshot arena
+    for (int frame = 0; frame != 10; ++frame)
+        composite_frame();
+
+    long allocations_made;
+    {
+        AllocationCounter const counter;
+        for (int frame = 0; frame != 1000; ++frame)
+            composite_frame();
+        allocations_made = counter.count();
+    }
+
+    EXPECT_THAT(allocations_made, Eq(0));
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir_test_framework/headless_in_process_server.h"
+#include "mir/options/configuration.h"
+#include "mir/server.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace mo = mir::options;
+namespace mtf = mir_test_framework;
+
+using namespace std::chrono;
+using namespace testing;
+
+namespace
+{
+/// Runs the real Xwayland (from $XWAYLAND, or /usr/bin/Xwayland), recording the pid of each launch
+class XwaylandLauncher
+{
+public:
+    XwaylandLauncher()
+    {
+        auto const xwayland = getenv("XWAYLAND") ? getenv("XWAYLAND") : "/usr/bin/Xwayland";
+        if (access(xwayland, X_OK) != 0)
+            throw std::runtime_error{std::string{"These tests need Xwayland, not found at "} + xwayland};
+
+        std::ofstream{path} <<
+            "#!/bin/sh\n"
+            "echo $$ >> " << launch_log << "\n"
+            "exec " << xwayland << " \"$@\"\n";
+        chmod(path.c_str(), 0700);
+    }
+
+    ~XwaylandLauncher()
+    {
+        unlink(launch_log.c_str());
+        unlink(path.c_str());
+        rmdir(dir.c_str());
+    }
+
+    auto launches() const -> std::vector<pid_t>
+    {
+        std::ifstream log{launch_log};
+        std::vector<pid_t> pids;
+        for (pid_t pid; log >> pid;)
+            pids.push_back(pid);
+        return pids;
+    }
+
+    std::string const dir{make_temp_dir()};
+    std::string const path{dir + "/Xwayland"};
+    std::string const launch_log{dir + "/launches"};
+
+private:
+    static auto make_temp_dir() -> std::string
+    {
+        char dir[] = "/tmp/xwayland_startup_XXXXXX";
+        if (!mkdtemp(dir))
+            throw std::system_error(errno, std::system_category(), "Failed to create temp dir");
+        return dir;
+    }
+};
+
+/// An X11 display number not in use on this machine
+auto unused_x11_display() -> int
+{
+    for (int display = 100; display != 200; ++display)
+    {
+        auto const lock = "/tmp/.X" + std::to_string(display) + "-lock";
+        auto const socket = "/tmp/.X11-unix/X" + std::to_string(display);
+        if (access(lock.c_str(), F_OK) != 0 && access(socket.c_str(), F_OK) != 0)
+            return display;
+    }
+    throw std::runtime_error{"No free X11 display"};
+}
+
+/// Resident set size of a process, in kB (0 if it's gone)
+auto rss_kb(std::string const& pid) -> long
+{
+    std::ifstream status{"/proc/" + pid + "/status"};
+    for (std::string line; std::getline(status, line);)
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+            return std::stol(line.substr(6));
+    }
+    return 0;
+}
+
+/// Just enough of an X11 client to know when the X server has accepted it
+class X11Client
+{
+public:
+    explicit X11Client(int x11_display)
+        : fd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)}
+    {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        snprintf(addr.sun_path, sizeof addr.sun_path, "/tmp/.X11-unix/X%d", x11_display);
+
+        if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0)
+            throw std::system_error(errno, std::system_category(), "Failed to connect to X11 socket");
+
+        // Connection setup: little endian, protocol 11.0, no authorization
+        char const setup[12] = {'l', 0, 11, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        if (write(fd, setup, sizeof setup) != sizeof setup)
+            throw std::system_error(errno, std::system_category(), "Failed to send X11 connection setup");
+    }
+
+    ~X11Client()
+    {
+        close(fd);
+    }
+
+    /// Waits up to timeout for the server's reply, returning whether the connection was accepted
+    auto accepted(milliseconds timeout) -> bool
+    {
+        pollfd readable{fd, POLLIN, 0};
+        if (poll(&readable, 1, timeout.count()) != 1)
+            return false;
+
+        char status{0};
+        return read(fd, &status, 1) == 1 && status == 1;    // 1 is Success
+    }
+
+    X11Client(X11Client const&) = delete;
+    X11Client& operator=(X11Client const&) = delete;
+
+private:
+    int const fd;
+};
+
+struct XwaylandServer : mtf::HeadlessInProcessServer
+{
+    XwaylandServer(XwaylandLauncher const& xwayland, int x11_display, bool eager_start, seconds idle_timeout)
+    {
+        // Normally added by miral::X11Support
+        server.add_configuration_option(mo::x11_display_opt, "", mir::OptionType::integer);
+        server.add_configuration_option("xwayland-path", "", xwayland.path);
+        server.add_configuration_option("xwayland-eager-start", "", mir::OptionType::null);
+        server.add_configuration_option("xwayland-idle-timeout", "", 0);
+
+        add_to_environment("MIR_SERVER_X11_DISPLAY_EXPERIMENTAL", std::to_string(x11_display).c_str());
+        add_to_environment("MIR_SERVER_XWAYLAND_IDLE_TIMEOUT", std::to_string(idle_timeout.count()).c_str());
+        if (eager_start)
+            add_to_environment("MIR_SERVER_XWAYLAND_EAGER_START", "");
+    }
+
+    void TestBody() override {}
+};
+
+struct XwaylandStartup : Test
+{
+    void SetUp() override
+    {
+        mkdir("/tmp/.X11-unix", 01777);
+        ASSERT_THAT(access("/tmp/.X11-unix", W_OK), Eq(0));
+    }
+
+    /// Records how long it takes from starting the server until the first X11 client is accepted
+    void record_time_to_first_client(bool eager_start, std::string const& mode)
+    {
+        XwaylandServer server{xwayland, x11_display, eager_start, seconds{0}};
+
+        auto const start = steady_clock::now();
+        server.SetUp();
+        auto const server_started = steady_clock::now();
+        auto const server_rss = rss_kb("self");
+
+        {
+            X11Client client{x11_display};
+            EXPECT_TRUE(client.accepted(seconds{30}));
+            auto const client_accepted = steady_clock::now();
+
+            ASSERT_THAT(xwayland.launches().size(), Eq(1u));
+            auto const xwayland_rss = rss_kb(std::to_string(xwayland.launches().front()));
+
+            RecordProperty(mode + "_server_start_ms",
+                duration_cast<milliseconds>(server_started - start).count());
+            RecordProperty(mode + "_first_x11_client_ms",
+                duration_cast<milliseconds>(client_accepted - start).count());
+            RecordProperty(mode + "_server_rss_kb", server_rss);
+            RecordProperty(mode + "_xwayland_rss_kb", xwayland_rss);
+        }
+
+        server.TearDown();
+    }
+
+    XwaylandLauncher const xwayland;
+    int const x11_display{unused_x11_display()};
+};
+}
+
+TEST_F(XwaylandStartup, lazy_start_time_to_first_x11_client)
+{
+    record_time_to_first_client(false, "lazy");
+}
+
+TEST_F(XwaylandStartup, eager_start_time_to_first_x11_client)
+{
+    record_time_to_first_client(true, "eager");
+}
+
+TEST_F(XwaylandStartup, idle_xwayland_is_stopped_and_the_next_x11_client_starts_it_again)
+{
+    seconds const idle_timeout{1};
+    XwaylandServer server{xwayland, x11_display, false, idle_timeout};
+    server.SetUp();
+
+    {
+        X11Client client{x11_display};
+        ASSERT_TRUE(client.accepted(seconds{30}));
+
+        // A connected client keeps Xwayland running, even without windows
+        std::this_thread::sleep_for(3 * idle_timeout);
+        ASSERT_THAT(xwayland.launches().size(), Eq(1u));
+        EXPECT_THAT(kill(xwayland.launches().front(), 0), Eq(0));
+    }
+
+    auto const first_xwayland = xwayland.launches().front();
+    auto const deadline = steady_clock::now() + 10 * idle_timeout;
+    while (kill(first_xwayland, 0) == 0 && steady_clock::now() < deadline)
+        std::this_thread::sleep_for(milliseconds{10});
+    EXPECT_THAT(kill(first_xwayland, 0), Ne(0)) << "Idle Xwayland was not stopped";
+
+    {
+        X11Client client{x11_display};
+        EXPECT_TRUE(client.accepted(seconds{30}));
+        EXPECT_THAT(xwayland.launches().size(), Eq(2u));
+    }
+
+    server.TearDown();
+}
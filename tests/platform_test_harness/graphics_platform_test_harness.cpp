@@ -481,6 +481,11 @@ void basic_software_buffer_drawing(
             return mir::geometry::Rectangle{top_left, buffer()->size()};
         }
 
+        auto src_bounds() const -> mir::geometry::Rectangle override
+        {
+            return mir::geometry::Rectangle{{}, buffer()->size()};
+        }
+
         auto alpha() const -> float override
         {
             return 1.0f;
@@ -496,11 +501,21 @@ void basic_software_buffer_drawing(
             return mg::contains_alpha(buffer_->pixel_format());
         }
 
+        auto opaque_region() const -> mir::geometry::Rectangles override
+        {
+            return {};
+        }
+
         auto clip_area() const -> std::experimental::optional<mir::geometry::Rectangle> override
         {
             return std::experimental::optional<mir::geometry::Rectangle>{};
         }
 
+        auto damage() const -> mir::geometry::Rectangles override
+        {
+            return {screen_position()};
+        }
+
         unsigned int swap_interval() const override
         {
             return 0;
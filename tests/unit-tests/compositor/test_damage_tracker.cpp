@@ -0,0 +1,163 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/compositor/damage_tracker.h"
+#include "mir/geometry/rectangle.h"
+#include "mir/test/doubles/fake_renderable.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <memory>
+
+using namespace testing;
+using namespace mir::geometry;
+namespace mc = mir::compositor;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+
+namespace
+{
+std::vector<Rectangle> contents_of(Rectangles const& rectangles)
+{
+    return {rectangles.begin(), rectangles.end()};
+}
+
+struct DamageTracker : Test
+{
+    std::vector<Rectangle> damage_for(mg::RenderableList const& renderables)
+    {
+        return contents_of(tracker.damage_for(renderables, view_area, identity));
+    }
+
+    Rectangle const view_area{{0, 0}, {1920, 1080}};
+    glm::mat2 const identity{1};
+    mc::DamageTracker tracker;
+
+    std::shared_ptr<mtd::FakeRenderable> const window =
+        std::make_shared<mtd::FakeRenderable>(Rectangle{{100, 100}, {400, 300}});
+    std::shared_ptr<mtd::FakeRenderable> const other_window =
+        std::make_shared<mtd::FakeRenderable>(Rectangle{{300, 200}, {400, 300}});
+};
+}
+
+TEST_F(DamageTracker, first_frame_is_entirely_damaged)
+{
+    EXPECT_THAT(damage_for({window}), ElementsAre(view_area));
+}
+
+TEST_F(DamageTracker, unchanged_frame_has_no_damage)
+{
+    window->set_damage({});
+    damage_for({window});
+
+    EXPECT_THAT(damage_for({window}), IsEmpty());
+}
+
+TEST_F(DamageTracker, reports_content_damage_of_renderables)
+{
+    damage_for({window});
+
+    Rectangle const cursor_blink{{120, 130}, {2, 16}};
+    window->set_damage({cursor_blink});
+
+    EXPECT_THAT(damage_for({window}), ElementsAre(cursor_blink));
+}
+
+TEST_F(DamageTracker, clips_content_damage_to_renderable)
+{
+    damage_for({window});
+
+    window->set_damage({{{0, 0}, {200, 200}}});
+
+    EXPECT_THAT(damage_for({window}), ElementsAre(Rectangle{{100, 100}, {100, 100}}));
+}
+
+TEST_F(DamageTracker, new_renderable_damages_its_area)
+{
+    window->set_damage({});
+    damage_for({window});
+
+    EXPECT_THAT(damage_for({window, other_window}), ElementsAre(other_window->screen_position()));
+}
+
+TEST_F(DamageTracker, removed_renderable_damages_its_old_area)
+{
+    window->set_damage({});
+    damage_for({window, other_window});
+
+    EXPECT_THAT(damage_for({window}), ElementsAre(other_window->screen_position()));
+}
+
+TEST_F(DamageTracker, moved_renderable_damages_old_and_new_areas)
+{
+    window->set_damage({});
+    damage_for({window});
+
+    auto const old_position = window->screen_position();
+    Rectangle const new_position{{150, 100}, {400, 300}};
+    window->set_screen_position(new_position);
+
+    EXPECT_THAT(damage_for({window}), UnorderedElementsAre(old_position, new_position));
+}
+
+TEST_F(DamageTracker, restacked_renderables_are_damaged)
+{
+    window->set_damage({});
+    other_window->set_damage({});
+    damage_for({window, other_window});
+
+    EXPECT_THAT(damage_for({other_window, window}), Not(IsEmpty()));
+}
+
+TEST_F(DamageTracker, damage_is_clipped_to_view_area)
+{
+    damage_for({});
+
+    auto const partly_offscreen = std::make_shared<mtd::FakeRenderable>(Rectangle{{1800, 1000}, {400, 300}});
+
+    EXPECT_THAT(damage_for({partly_offscreen}), ElementsAre(Rectangle{{1800, 1000}, {120, 80}}));
+}
+
+TEST_F(DamageTracker, changed_view_area_damages_everything)
+{
+    window->set_damage({});
+    damage_for({window});
+
+    Rectangle const new_view_area{{0, 0}, {1280, 1024}};
+
+    EXPECT_THAT(contents_of(tracker.damage_for({window}, new_view_area, identity)), ElementsAre(new_view_area));
+}
+
+TEST_F(DamageTracker, changed_output_transform_damages_everything)
+{
+    window->set_damage({});
+    damage_for({window});
+
+    glm::mat2 const rotated{0, -1,
+                            1,  0};
+
+    EXPECT_THAT(contents_of(tracker.damage_for({window}, view_area, rotated)), ElementsAre(view_area));
+}
+
+TEST_F(DamageTracker, invalidate_damages_everything)
+{
+    window->set_damage({});
+    damage_for({window});
+
+    tracker.invalidate();
+
+    EXPECT_THAT(damage_for({window}), ElementsAre(view_area));
+}
@@ -388,3 +388,73 @@ TEST_F(DefaultDisplayBufferCompositor, marks_occluded_scene_elements)
     compositor.composite({element0_occluded, element1_rendered, element2_occluded});
 }
 
+
+TEST_F(DefaultDisplayBufferCompositor, first_frame_damages_whole_screen)
+{
+    using namespace testing;
+    EXPECT_CALL(mock_renderer, set_frame_damage(geom::Rectangles{screen}));
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, only_damaged_content_is_repainted)
+{
+    using namespace testing;
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({big, small}));
+
+    // e.g. a blinking text cursor
+    geom::Rectangle const cursor{{20, 30}, {2, 12}};
+    big->set_damage({});
+    small->set_damage({cursor});
+
+    Sequence render_seq;
+    EXPECT_CALL(mock_renderer, set_frame_damage(geom::Rectangles{cursor}))
+        .InSequence(render_seq);
+    EXPECT_CALL(mock_renderer, render(ContainerEq(mg::RenderableList{big, small})))
+        .InSequence(render_seq);
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, reports_damage_in_frame)
+{
+    using namespace testing;
+    auto report = std::make_shared<NiceMock<mtd::MockCompositorReport>>();
+
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        report);
+
+    EXPECT_CALL(*report, damage_in_frame(&compositor, geom::Rectangles{screen}));
+
+    compositor.composite(make_scene_elements({big, small}));
+}
+
+TEST_F(DefaultDisplayBufferCompositor, overlay_invalidates_damage_history)
+{
+    using namespace testing;
+    mc::DefaultDisplayBufferCompositor compositor(
+        display_buffer,
+        mt::fake_shared(mock_renderer),
+        mr::null_compositor_report());
+    compositor.composite(make_scene_elements({fullscreen}));
+
+    EXPECT_CALL(display_buffer, overlay(_))
+        .WillOnce(Return(true))
+        .WillOnce(Return(false));
+    compositor.composite(make_scene_elements({fullscreen}));
+
+    fullscreen->set_damage({});
+    EXPECT_CALL(mock_renderer, set_frame_damage(geom::Rectangles{screen}));
+
+    compositor.composite(make_scene_elements({fullscreen}));
+}
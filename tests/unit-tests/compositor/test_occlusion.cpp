@@ -125,6 +125,120 @@ TEST_F(OcclusionFilterTest, shaped_window_occludes_nothing)
     EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
 }
 
+TEST_F(OcclusionFilterTest, shaped_window_occludes_what_is_behind_its_opaque_region)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {10, 10}}, 1.0f, false);
+    top->set_opaque_region({Rectangle{{11, 11}, {8, 8}}});
+    auto bottom = std::make_shared<mtd::FakeRenderable>(12, 12, 5, 5);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(top));
+}
+
+TEST_F(OcclusionFilterTest, shaped_window_does_not_occlude_what_is_outside_its_opaque_region)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {10, 10}}, 1.0f, false);
+    top->set_opaque_region({Rectangle{{10, 10}, {10, 4}}});
+    auto bottom = std::make_shared<mtd::FakeRenderable>(12, 12, 5, 5);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    ASSERT_THAT(elements.size(), Eq(2u));
+    EXPECT_THAT(elements[0]->renderable()->id(), Eq(bottom->id()));
+    EXPECT_THAT(elements[1]->renderable(), Eq(top));
+}
+
+TEST_F(OcclusionFilterTest, translucent_window_with_opaque_region_occludes_nothing)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(Rectangle{{10, 10}, {10, 10}}, 0.5f, false);
+    top->set_opaque_region({Rectangle{{10, 10}, {10, 10}}});
+    auto bottom = std::make_shared<mtd::FakeRenderable>(12, 12, 5, 5);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    EXPECT_THAT(renderables_from(elements), ElementsAre(bottom, top));
+}
+
+TEST_F(OcclusionFilterTest, clipped_window_does_not_occlude_what_is_outside_its_clip_area)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(10, 10, 10, 10);
+    top->set_clip_area({{10, 10}, {10, 4}});
+    auto bottom = std::make_shared<mtd::FakeRenderable>(12, 12, 5, 5);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    ASSERT_THAT(elements.size(), Eq(2u));
+    EXPECT_THAT(elements[0]->renderable()->id(), Eq(bottom->id()));
+    EXPECT_THAT(elements[1]->renderable(), Eq(top));
+}
+
+TEST_F(OcclusionFilterTest, clipped_window_occludes_what_is_behind_its_clip_area)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(10, 10, 10, 10);
+    top->set_clip_area({{11, 11}, {8, 8}});
+    auto bottom = std::make_shared<mtd::FakeRenderable>(12, 12, 5, 5);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(top));
+}
+
+TEST_F(OcclusionFilterTest, window_covered_by_two_tiled_windows_occluded)
+{
+    auto left = std::make_shared<mtd::FakeRenderable>(0, 0, 500, 500);
+    auto right = std::make_shared<mtd::FakeRenderable>(500, 0, 500, 500);
+    auto bottom = std::make_shared<mtd::FakeRenderable>(250, 100, 500, 300);
+    auto elements = scene_elements_from({bottom, left, right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), ElementsAre(bottom));
+    EXPECT_THAT(renderables_from(elements), ElementsAre(left, right));
+}
+
+TEST_F(OcclusionFilterTest, partially_covered_window_clipped_to_visible_part)
+{
+    auto top = std::make_shared<mtd::FakeRenderable>(0, 0, 500, 100);
+    auto bottom = std::make_shared<mtd::FakeRenderable>(100, 50, 200, 200);
+    auto elements = scene_elements_from({bottom, top});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    ASSERT_THAT(elements.size(), Eq(2u));
+
+    auto const clipped = elements[0]->renderable();
+    EXPECT_THAT(clipped->id(), Eq(bottom->id()));
+    EXPECT_THAT(clipped->screen_position(), Eq(bottom->screen_position()));
+    EXPECT_THAT(clipped->clip_area(), Eq(std::experimental::make_optional(Rectangle{{100, 100}, {200, 150}})));
+    EXPECT_THAT(elements[1]->renderable(), Eq(top));
+}
+
+TEST_F(OcclusionFilterTest, window_visible_through_a_gap_clipped_to_the_gap)
+{
+    auto top_left = std::make_shared<mtd::FakeRenderable>(0, 0, 100, 300);
+    auto top_right = std::make_shared<mtd::FakeRenderable>(200, 0, 100, 300);
+    auto bottom = std::make_shared<mtd::FakeRenderable>(0, 0, 300, 300);
+    auto elements = scene_elements_from({bottom, top_left, top_right});
+
+    auto const& occlusions = filter_occlusions_from(elements, monitor_rect);
+
+    EXPECT_THAT(renderables_from(occlusions), IsEmpty());
+    ASSERT_THAT(elements.size(), Eq(3u));
+    EXPECT_THAT(elements[0]->renderable()->clip_area(), Eq(std::experimental::make_optional(Rectangle{{100, 0}, {100, 300}})));
+}
+
 TEST_F(OcclusionFilterTest, identical_window_occluded)
 {
     auto top = std::make_shared<mtd::FakeRenderable>(10, 10, 10, 10);
@@ -35,6 +35,11 @@ namespace mg = mir::graphics;
 namespace geom = mir::geometry;
 namespace
 {
+std::vector<geom::Rectangle> contents_of(geom::Rectangles const& rects)
+{
+    return {rects.begin(), rects.end()};
+}
+
 struct Stream : Test
 {
     Stream() :
@@ -227,3 +232,95 @@ TEST_F(Stream, returns_buffers_to_client_when_told_to_bring_queue_up_to_date)
     EXPECT_THAT(buffers[1].use_count(), Eq(1));
     EXPECT_THAT(buffers[2].use_count(), Eq(2));
 }
+
+TEST_F(Stream, damage_for_unknown_user_is_everything)
+{
+    stream.submit_buffer(buffers[0], {{{1, 0}, {2, 1}}});
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), ElementsAre(geom::Rectangle{{}, initial_size}));
+}
+
+TEST_F(Stream, first_buffer_locked_is_entirely_damaged)
+{
+    stream.submit_buffer(buffers[0], {{{1, 0}, {2, 1}}});
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), ElementsAre(geom::Rectangle{{}, initial_size}));
+}
+
+TEST_F(Stream, reports_submitted_damage_to_compositor)
+{
+    geom::Rectangle const damage{{1, 0}, {2, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.submit_buffer(buffers[1], {damage});
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), ElementsAre(damage));
+}
+
+TEST_F(Stream, clips_submitted_damage_to_buffer)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.submit_buffer(buffers[1], {{{40, 0}, {100, 100}}});
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), ElementsAre(geom::Rectangle{{40, 0}, {4, 2}}));
+}
+
+TEST_F(Stream, accumulates_damage_of_dropped_buffers)
+{
+    geom::Rectangle const first_damage{{1, 0}, {2, 1}};
+    geom::Rectangle const second_damage{{10, 1}, {3, 1}};
+
+    stream.allow_framedropping(true);
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.submit_buffer(buffers[1], {first_damage});
+    stream.submit_buffer(buffers[2], {second_damage});
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), UnorderedElementsAre(first_damage, second_damage));
+}
+
+TEST_F(Stream, relocking_the_same_buffer_has_no_damage)
+{
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), IsEmpty());
+}
+
+TEST_F(Stream, tracks_damage_separately_per_compositor)
+{
+    int const other_compositor{0};
+    geom::Rectangle const damage{{1, 0}, {2, 1}};
+
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.lock_compositor_buffer(&other_compositor);
+    stream.submit_buffer(buffers[1], {damage});
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), ElementsAre(damage));
+    EXPECT_THAT(contents_of(stream.damage_for(&other_compositor)), ElementsAre(geom::Rectangle{{}, initial_size}));
+
+    stream.lock_compositor_buffer(&other_compositor);
+    EXPECT_THAT(contents_of(stream.damage_for(&other_compositor)), ElementsAre(damage));
+}
+
+TEST_F(Stream, resized_buffer_is_entirely_damaged)
+{
+    geom::Size const new_size{10, 10};
+    auto const resized = std::make_shared<mtd::StubBuffer>(new_size);
+
+    stream.submit_buffer(buffers[0]);
+    stream.lock_compositor_buffer(this);
+    stream.submit_buffer(resized, {{{1, 0}, {2, 1}}});
+    stream.lock_compositor_buffer(this);
+
+    EXPECT_THAT(contents_of(stream.damage_for(this)), ElementsAre(geom::Rectangle{{}, new_size}));
+}
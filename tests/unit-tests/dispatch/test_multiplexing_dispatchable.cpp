@@ -28,7 +28,9 @@
 #include <fcntl.h>
 
 #include <atomic>
+#include <stdexcept>
 #include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -490,3 +492,111 @@ TEST(MultiplexingDispatchableTest, automatic_removals_are_threadsafe)
     
     dispatchee->trigger();
 }
+
+TEST(MultiplexingDispatchableTest, dispatches_one_ready_dispatchee_per_dispatch_by_default)
+{
+    int dispatch_count{0};
+    auto first = std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; });
+    auto second = std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; });
+    md::MultiplexingDispatchable dispatcher{first, second};
+
+    first->trigger();
+    second->trigger();
+
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatch_count, testing::Eq(1));
+}
+
+TEST(MultiplexingDispatchableTest, batched_dispatch_handles_all_ready_dispatchees)
+{
+    int const dispatchee_count{5};
+    int dispatch_count{0};
+
+    md::MultiplexingDispatchable dispatcher;
+    dispatcher.set_max_events_per_dispatch(8);
+
+    std::vector<std::shared_ptr<mt::TestDispatchable>> dispatchees;
+    for (int i = 0; i != dispatchee_count; ++i)
+    {
+        dispatchees.push_back(std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; }));
+        dispatcher.add_watch(dispatchees.back());
+        dispatchees.back()->trigger();
+    }
+
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatch_count, testing::Eq(dispatchee_count));
+    EXPECT_FALSE(mt::fd_is_readable(dispatcher.watch_fd()));
+}
+
+TEST(MultiplexingDispatchableTest, batched_dispatch_rearms_sequential_dispatchees)
+{
+    int dispatch_count{0};
+    auto first = std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; });
+    auto second = std::make_shared<mt::TestDispatchable>([&dispatch_count]() { ++dispatch_count; });
+    md::MultiplexingDispatchable dispatcher{first, second};
+    dispatcher.set_max_events_per_dispatch(2);
+
+    first->trigger();
+    second->trigger();
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    first->trigger();
+    second->trigger();
+    ASSERT_TRUE(mt::fd_is_readable(dispatcher.watch_fd()));
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatch_count, testing::Eq(4));
+}
+
+TEST(MultiplexingDispatchableTest, dispatchee_removed_earlier_in_batch_is_not_dispatched)
+{
+    md::MultiplexingDispatchable dispatcher;
+    dispatcher.set_max_events_per_dispatch(2);
+
+    int dispatch_count{0};
+    std::shared_ptr<mt::TestDispatchable> first, second;
+    first = std::make_shared<mt::TestDispatchable>(
+        [&]() { ++dispatch_count; dispatcher.remove_watch(second); });
+    second = std::make_shared<mt::TestDispatchable>(
+        [&]() { ++dispatch_count; dispatcher.remove_watch(first); });
+    dispatcher.add_watch(first);
+    dispatcher.add_watch(second);
+
+    first->trigger();
+    second->trigger();
+    dispatcher.dispatch(md::FdEvent::readable);
+
+    EXPECT_THAT(dispatch_count, testing::Eq(1));
+}
+
+TEST(MultiplexingDispatchableTest, dispatchees_after_a_throwing_dispatchee_remain_ready)
+{
+    bool thrown{false};
+    int dispatch_count{0};
+    auto const handler = [&]()
+        {
+            if (!thrown)
+            {
+                thrown = true;
+                throw std::runtime_error{"Dispatch failed"};
+            }
+            ++dispatch_count;
+        };
+    auto first = std::make_shared<mt::TestDispatchable>(handler);
+    auto second = std::make_shared<mt::TestDispatchable>(handler);
+    md::MultiplexingDispatchable dispatcher{first, second};
+    dispatcher.set_max_events_per_dispatch(2);
+
+    first->trigger();
+    second->trigger();
+    EXPECT_THROW(dispatcher.dispatch(md::FdEvent::readable), std::runtime_error);
+
+    while (mt::fd_is_readable(dispatcher.watch_fd()))
+    {
+        dispatcher.dispatch(md::FdEvent::readable);
+    }
+
+    EXPECT_THAT(dispatch_count, testing::Eq(1));
+}
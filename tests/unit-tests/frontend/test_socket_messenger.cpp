@@ -0,0 +1,240 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend/socket_messenger.h"
+#include "mir/fd_socket_transmission.h"
+
+#include <boost/asio.hpp>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace mfd = mir::frontend::detail;
+namespace ba = boost::asio;
+
+using namespace testing;
+
+namespace
+{
+// Comfortably more than the socket buffer, but within the default queue limit
+std::string const filler(60000, 'x');
+int const filler_messages{40};
+
+struct ClientConnection
+{
+    ClientConnection(ba::io_service& io_service, size_t max_queued_bytes) :
+        server_end{std::make_shared<ba::local::stream_protocol::socket>(io_service)},
+        client_end{io_service}
+    {
+        ba::local::connect_pair(*server_end, client_end);
+        messenger = std::make_shared<mfd::SocketMessenger>(server_end, max_queued_bytes);
+    }
+
+    void send(std::string const& message, mf::FdSets const& fds = {})
+    {
+        messenger->send(message.data(), message.size(), fds);
+    }
+
+    void send_superseding(std::string const& message, uint64_t key)
+    {
+        messenger->send_superseding(message.data(), message.size(), key);
+    }
+
+    // Returns an empty string once the server has closed the connection
+    std::string read_message()
+    {
+        unsigned char header[2];
+        if (recv(client_end.native_handle(), header, sizeof header, MSG_WAITALL) != sizeof header)
+            return {};
+
+        std::string message((header[0] << 8) | header[1], '\0');
+        EXPECT_THAT(
+            recv(client_end.native_handle(), &message[0], message.size(), MSG_WAITALL),
+            Eq(static_cast<ssize_t>(message.size())));
+        return message;
+    }
+
+    // The bytes that have reached the client's socket, but that it hasn't read
+    size_t bytes_readable()
+    {
+        int bytes{0};
+        EXPECT_THAT(ioctl(client_end.native_handle(), FIONREAD, &bytes), Eq(0));
+        return bytes;
+    }
+
+    std::shared_ptr<ba::local::stream_protocol::socket> const server_end;
+    ba::local::stream_protocol::socket client_end;
+    std::shared_ptr<mfd::SocketMessenger> messenger;
+};
+
+struct SocketMessenger : Test
+{
+    SocketMessenger()
+        : io_thread{[this] { io_service.run(); }}
+    {
+    }
+
+    ~SocketMessenger()
+    {
+        io_service.stop();
+        io_thread.join();
+    }
+
+    std::unique_ptr<ClientConnection> connect_client(
+        size_t max_queued_bytes = mfd::SocketMessenger::default_max_queued_bytes)
+    {
+        return std::make_unique<ClientConnection>(io_service, max_queued_bytes);
+    }
+
+    ba::io_service io_service;
+    ba::io_service::work work{io_service};
+    std::thread io_thread;
+};
+}
+
+TEST_F(SocketMessenger, sends_message_prefixed_with_its_length)
+{
+    auto const client = connect_client();
+
+    client->send("hello");
+
+    EXPECT_THAT(client->read_message(), Eq("hello"));
+}
+
+TEST_F(SocketMessenger, queues_messages_for_client_that_is_not_reading)
+{
+    auto const client = connect_client();
+
+    for (int i = 0; i != filler_messages; ++i)
+        client->send(filler + std::to_string(i));
+
+    for (int i = 0; i != filler_messages; ++i)
+        EXPECT_THAT(client->read_message(), Eq(filler + std::to_string(i)));
+}
+
+TEST_F(SocketMessenger, stalled_client_does_not_delay_other_clients)
+{
+    auto const stalled_client = connect_client();
+    auto const other_client = connect_client();
+
+    for (int i = 0; i != filler_messages; ++i)
+    {
+        // Sending to the stalled client returns without it reading anything...
+        stalled_client->send(filler);
+        // ...and the other client is sent its message in the meantime
+        other_client->send("ping");
+        ASSERT_THAT(other_client->read_message(), Eq("ping"));
+    }
+
+    // Most of what was sent to the stalled client is still queued, not in its socket
+    EXPECT_THAT(stalled_client->bytes_readable(), Lt(filler_messages * (filler.size() + 2)));
+
+    for (int i = 0; i != filler_messages; ++i)
+        ASSERT_THAT(stalled_client->read_message(), Eq(filler));
+}
+
+TEST_F(SocketMessenger, superseded_messages_are_dropped_while_queued)
+{
+    auto const client = connect_client();
+
+    for (int i = 0; i != filler_messages; ++i)
+        client->send(filler);
+
+    client->send_superseding("resize 1", 1);
+    client->send_superseding("resize 2", 1);
+    client->send_superseding("motion 1", 2);
+    client->send_superseding("resize 3", 1);
+    client->send("ping");
+
+    for (int i = 0; i != filler_messages; ++i)
+        ASSERT_THAT(client->read_message(), Eq(filler));
+
+    EXPECT_THAT(client->read_message(), Eq("motion 1"));
+    EXPECT_THAT(client->read_message(), Eq("resize 3"));
+    EXPECT_THAT(client->read_message(), Eq("ping"));
+}
+
+TEST_F(SocketMessenger, superseding_messages_are_all_sent_to_client_that_is_keeping_up)
+{
+    auto const client = connect_client();
+
+    client->send_superseding("resize 1", 1);
+    EXPECT_THAT(client->read_message(), Eq("resize 1"));
+    client->send_superseding("resize 2", 1);
+    EXPECT_THAT(client->read_message(), Eq("resize 2"));
+}
+
+TEST_F(SocketMessenger, queued_fds_follow_their_message)
+{
+    auto const client = connect_client();
+
+    for (int i = 0; i != filler_messages; ++i)
+        client->send(filler);
+
+    int pipe_fds[2];
+    ASSERT_THAT(pipe(pipe_fds), Eq(0));
+    mir::Fd const read_end{pipe_fds[0]};
+    {
+        mir::Fd const write_end{pipe_fds[1]};
+        client->send("buffer", {{write_end}});
+    }
+
+    for (int i = 0; i != filler_messages; ++i)
+        ASSERT_THAT(client->read_message(), Eq(filler));
+    EXPECT_THAT(client->read_message(), Eq("buffer"));
+
+    // The messenger has to hold on to the fds it queues, as the caller's are already closed
+    std::vector<mir::Fd> fds(1);
+    char marker;
+    mir::receive_data(mir::Fd{mir::IntOwnedFd{client->client_end.native_handle()}}, &marker, 1, fds);
+    ASSERT_THAT(write(fds[0], "x", 1), Eq(1));
+
+    char received;
+    EXPECT_THAT(read(read_end, &received, 1), Eq(1));
+    EXPECT_THAT(received, Eq('x'));
+}
+
+TEST_F(SocketMessenger, disconnects_client_that_lets_too_much_queue_up)
+{
+    auto const client = connect_client(4 * filler.size());
+
+    EXPECT_THROW(
+        {
+            for (int i = 0; i != filler_messages; ++i)
+                client->send(filler);
+        },
+        std::runtime_error);
+
+    timeval const timeout{5, 0};
+    setsockopt(client->client_end.native_handle(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+
+    // The client gets whatever made it into the socket, and then the connection is closed
+    char buffer[4096];
+    ssize_t received;
+    while ((received = recv(client->client_end.native_handle(), buffer, sizeof buffer, 0)) > 0)
+        ;
+    EXPECT_THAT(received, Eq(0));
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/geometry/region.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <random>
+
+using namespace mir::geometry;
+using namespace testing;
+
+namespace
+{
+auto contents_of(Region const& region) -> std::vector<Rectangle>
+{
+    return {std::begin(region), std::end(region)};
+}
+
+/// Brute force membership test of a single pixel
+bool contains_pixel(Region const& region, int x, int y)
+{
+    for (auto const& rect : region)
+    {
+        if (rect.contains(Point{x, y}))
+            return true;
+    }
+    return false;
+}
+}
+
+TEST(Region, default_is_empty)
+{
+    Region const region;
+
+    EXPECT_TRUE(region.is_empty());
+    EXPECT_THAT(contents_of(region), IsEmpty());
+}
+
+TEST(Region, empty_rectangle_gives_empty_region)
+{
+    Region const region{Rectangle{{3, 4}, {0, 10}}};
+
+    EXPECT_TRUE(region.is_empty());
+}
+
+TEST(Region, union_of_side_by_side_rectangles_is_merged)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{10, 0}, {10, 10}}};
+
+    EXPECT_THAT(contents_of(region), ElementsAre(Rectangle{{0, 0}, {20, 10}}));
+}
+
+TEST(Region, union_of_stacked_rectangles_is_merged)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{0, 10}, {10, 10}}};
+
+    EXPECT_THAT(contents_of(region), ElementsAre(Rectangle{{0, 0}, {10, 20}}));
+}
+
+TEST(Region, union_of_overlapping_rectangles_is_banded)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{5, 5}, {10, 10}}};
+
+    EXPECT_THAT(contents_of(region), ElementsAre(
+        Rectangle{{0, 0}, {10, 5}},
+        Rectangle{{0, 5}, {15, 5}},
+        Rectangle{{5, 10}, {10, 5}}));
+}
+
+TEST(Region, subtracting_a_hole_leaves_a_frame)
+{
+    Region region{Rectangle{{0, 0}, {30, 30}}};
+    region.subtract(Rectangle{{10, 10}, {10, 10}});
+
+    EXPECT_THAT(contents_of(region), ElementsAre(
+        Rectangle{{0, 0}, {30, 10}},
+        Rectangle{{0, 10}, {10, 10}},
+        Rectangle{{20, 10}, {10, 10}},
+        Rectangle{{0, 20}, {30, 10}}));
+}
+
+TEST(Region, subtracting_everything_leaves_nothing)
+{
+    Region region{Rectangle{{5, 5}, {30, 30}}};
+    region.subtract(Region{{{0, 0}, {40, 20}}, {{0, 20}, {40, 20}}});
+
+    EXPECT_TRUE(region.is_empty());
+}
+
+TEST(Region, intersection_is_common_area)
+{
+    Region region{{{0, 0}, {10, 10}}, {{20, 0}, {10, 10}}};
+    region.intersect(Rectangle{{5, 5}, {20, 20}});
+
+    EXPECT_THAT(contents_of(region), ElementsAre(
+        Rectangle{{5, 5}, {5, 5}},
+        Rectangle{{20, 5}, {5, 5}}));
+}
+
+TEST(Region, contains_rectangle_covered_by_several)
+{
+    Region const tiled{{{0, 0}, {50, 100}}, {{50, 0}, {50, 100}}};
+    Region const stacked{{{0, 0}, {100, 50}}, {{0, 50}, {100, 50}}};
+
+    EXPECT_TRUE(tiled.contains({{25, 25}, {50, 50}}));
+    EXPECT_TRUE(stacked.contains({{25, 25}, {50, 50}}));
+}
+
+TEST(Region, does_not_contain_rectangle_over_a_gap)
+{
+    Region const vertical_gap{{{0, 0}, {49, 100}}, {{50, 0}, {50, 100}}};
+    Region const horizontal_gap{{{0, 0}, {100, 49}}, {{0, 50}, {100, 50}}};
+
+    EXPECT_FALSE(vertical_gap.contains({{25, 25}, {50, 50}}));
+    EXPECT_FALSE(horizontal_gap.contains({{25, 25}, {50, 50}}));
+    EXPECT_FALSE(Region{}.contains({{0, 0}, {1, 1}}));
+}
+
+TEST(Region, overlaps)
+{
+    Region const region{{{0, 0}, {10, 10}}, {{20, 20}, {10, 10}}};
+
+    EXPECT_TRUE(region.overlaps({{5, 5}, {10, 10}}));
+    EXPECT_TRUE(region.overlaps({{25, 15}, {1, 10}}));
+    EXPECT_FALSE(region.overlaps({{10, 10}, {10, 10}}));
+}
+
+TEST(Region, bounding_rectangle)
+{
+    Region const region{{{10, 0}, {10, 10}}, {{0, 20}, {5, 5}}, {{30, 5}, {5, 5}}};
+
+    EXPECT_THAT(region.bounding_rectangle(), Eq(Rectangle{{0, 0}, {35, 25}}));
+}
+
+TEST(Region, equal_point_sets_have_equal_representations)
+{
+    Region const a{{{0, 0}, {10, 20}}, {{10, 0}, {10, 20}}};
+    Region const b{{{0, 0}, {20, 10}}, {{0, 10}, {20, 10}}};
+
+    EXPECT_THAT(a, Eq(b));
+}
+
+TEST(Region, operations_agree_with_pixel_sets)
+{
+    std::mt19937 random{1234};
+    std::uniform_int_distribution<int> position{0, 30};
+    std::uniform_int_distribution<int> extent{1, 15};
+
+    auto const random_rect = [&]()
+        { return Rectangle{{position(random), position(random)}, {extent(random), extent(random)}}; };
+
+    for (int trial = 0; trial != 50; ++trial)
+    {
+        Region a, b;
+        for (int i = 0; i != 4; ++i)
+        {
+            a.add(random_rect());
+            b.add(random_rect());
+        }
+
+        auto united = a;
+        united.add(b);
+        auto subtracted = a;
+        subtracted.subtract(b);
+        auto intersected = a;
+        intersected.intersect(b);
+
+        for (int y = 0; y != 50; ++y)
+        {
+            for (int x = 0; x != 50; ++x)
+            {
+                auto const in_a = contains_pixel(a, x, y);
+                auto const in_b = contains_pixel(b, x, y);
+                ASSERT_THAT(contains_pixel(united, x, y), Eq(in_a || in_b));
+                ASSERT_THAT(contains_pixel(subtracted, x, y), Eq(in_a && !in_b));
+                ASSERT_THAT(contains_pixel(intersected, x, y), Eq(in_a && in_b));
+            }
+        }
+    }
+}
@@ -21,14 +21,26 @@
 #include "mir/test/doubles/mock_gl_buffer.h"
 #include "mir/test/doubles/mock_renderable.h"
 #include "mir/test/doubles/mock_gl.h"
+#include "mir/renderer/gl/partial_texture_source.h"
 #include <gtest/gtest.h>
 
 namespace mtd=mir::test::doubles;
 namespace mgl=mir::gl;
 namespace mg=mir::graphics;
+namespace geom=mir::geometry;
 
 namespace
 {
+struct MockPartialGLBuffer : mtd::MockGLBuffer,
+                             mir::renderer::gl::PartialTextureSource
+{
+    MockPartialGLBuffer(geom::Size size)
+        : MockGLBuffer{size, geom::Stride{size.width.as_int() * 4}, mir_pixel_format_argb_8888}
+    {
+    }
+
+    MOCK_METHOD1(bind_damaged, void(geom::Rectangles const&));
+};
 
 class RecentlyUsedCache : public testing::Test
 {
@@ -140,3 +152,91 @@ TEST_F(RecentlyUsedCache, invalidated_buffers_are_reloaded)
     cache.invalidate();
     cache.load(*renderable);
 }
+
+TEST_F(RecentlyUsedCache, uploads_only_damage_of_same_sized_buffers)
+{
+    using namespace testing;
+    geom::Rectangle const position{{10, 20}, {100, 50}};
+    auto const first = std::make_shared<NiceMock<MockPartialGLBuffer>>(position.size);
+    auto const second = std::make_shared<NiceMock<MockPartialGLBuffer>>(position.size);
+    ON_CALL(*first, id()).WillByDefault(Return(mg::BufferID(1)));
+    ON_CALL(*second, id()).WillByDefault(Return(mg::BufferID(2)));
+    ON_CALL(*renderable, screen_position()).WillByDefault(Return(position));
+
+    mgl::RecentlyUsedCache cache;
+
+    EXPECT_CALL(*first, bind());
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(first));
+    cache.load(*renderable);
+    cache.drop_unused();
+
+    EXPECT_CALL(*second, bind()).Times(0);
+    EXPECT_CALL(*second, bind_damaged(geom::Rectangles{{{5, 5}, {20, 10}}}));
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(second));
+    ON_CALL(*renderable, damage()).WillByDefault(Return(geom::Rectangles{{{15, 25}, {20, 10}}}));
+    cache.load(*renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_buffer_when_size_changes)
+{
+    using namespace testing;
+    auto const first = std::make_shared<NiceMock<MockPartialGLBuffer>>(geom::Size{100, 50});
+    auto const second = std::make_shared<NiceMock<MockPartialGLBuffer>>(geom::Size{200, 50});
+    ON_CALL(*first, id()).WillByDefault(Return(mg::BufferID(1)));
+    ON_CALL(*second, id()).WillByDefault(Return(mg::BufferID(2)));
+
+    mgl::RecentlyUsedCache cache;
+
+    ON_CALL(*renderable, screen_position()).WillByDefault(Return(geom::Rectangle{{}, {100, 50}}));
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(first));
+    cache.load(*renderable);
+
+    EXPECT_CALL(*second, bind());
+    EXPECT_CALL(*second, bind_damaged(_)).Times(0);
+    ON_CALL(*renderable, screen_position()).WillByDefault(Return(geom::Rectangle{{}, {200, 50}}));
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(second));
+    cache.load(*renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_buffer_after_invalidation)
+{
+    using namespace testing;
+    geom::Rectangle const position{{}, {100, 50}};
+    auto const first = std::make_shared<NiceMock<MockPartialGLBuffer>>(position.size);
+    auto const second = std::make_shared<NiceMock<MockPartialGLBuffer>>(position.size);
+    ON_CALL(*first, id()).WillByDefault(Return(mg::BufferID(1)));
+    ON_CALL(*second, id()).WillByDefault(Return(mg::BufferID(2)));
+    ON_CALL(*renderable, screen_position()).WillByDefault(Return(position));
+
+    mgl::RecentlyUsedCache cache;
+
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(first));
+    cache.load(*renderable);
+    cache.invalidate();
+
+    EXPECT_CALL(*second, bind());
+    EXPECT_CALL(*second, bind_damaged(_)).Times(0);
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(second));
+    cache.load(*renderable);
+}
+
+TEST_F(RecentlyUsedCache, uploads_whole_buffer_when_scaled)
+{
+    using namespace testing;
+    geom::Size const buffer_size{100, 50};
+    auto const first = std::make_shared<NiceMock<MockPartialGLBuffer>>(buffer_size);
+    auto const second = std::make_shared<NiceMock<MockPartialGLBuffer>>(buffer_size);
+    ON_CALL(*first, id()).WillByDefault(Return(mg::BufferID(1)));
+    ON_CALL(*second, id()).WillByDefault(Return(mg::BufferID(2)));
+    ON_CALL(*renderable, screen_position()).WillByDefault(Return(geom::Rectangle{{}, {200, 100}}));
+
+    mgl::RecentlyUsedCache cache;
+
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(first));
+    cache.load(*renderable);
+
+    EXPECT_CALL(*second, bind());
+    EXPECT_CALL(*second, bind_damaged(_)).Times(0);
+    ON_CALL(*renderable, buffer()).WillByDefault(Return(second));
+    cache.load(*renderable);
+}
@@ -3,6 +3,7 @@
 #include "src/server/graphics/offscreen/display.h"
 #include "mir/graphics/default_display_configuration_policy.h"
 #include "mir/renderer/gl/render_target.h"
+#include "mir/renderer/sw/render_target.h"
 #include "src/server/report/null_report_factory.h"
 
 #include "mir/test/doubles/mock_egl.h"
@@ -147,6 +148,42 @@ TEST_F(OffscreenDisplayTest, makes_fbo_current_rendering_target)
     });
 }
 
+TEST_F(OffscreenDisplayTest, software_rendering_provides_cpu_render_targets)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(mock_gl, glGenFramebuffers(_,_)).Times(0);
+
+    mgo::Display display{
+        native_display,
+        std::make_shared<mg::CloneDisplayConfigurationPolicy>(),
+        mr::null_display_report(),
+        mgo::Rendering::software};
+
+    int count = 0;
+    display.for_each_display_sync_group([&](mg::DisplaySyncGroup& group) {
+        group.for_each_display_buffer([&](mg::DisplayBuffer& db) {
+            ++count;
+            auto const native = db.native_display_buffer();
+            EXPECT_THAT(dynamic_cast<mir::renderer::gl::RenderTarget*>(native), IsNull());
+
+            auto const render_target = dynamic_cast<mir::renderer::software::RenderTarget*>(native);
+            ASSERT_THAT(render_target, NotNull());
+            EXPECT_THAT(render_target->size(), Eq(db.view_area().size));
+            EXPECT_THAT(render_target->buffer_age(), Eq(0u));
+
+            auto const pixels = render_target->back_buffer();
+            EXPECT_THAT(pixels.data, NotNull());
+            EXPECT_THAT(pixels.stride.as_int(), Ge(db.view_area().size.width.as_int() * 4));
+
+            render_target->swap_buffers();
+            EXPECT_THAT(render_target->buffer_age(), Eq(1u));
+        });
+    });
+
+    EXPECT_TRUE(count);
+}
+
 TEST_F(OffscreenDisplayTest, restores_previous_state_on_fbo_setup_failure)
 {
     using namespace ::testing;
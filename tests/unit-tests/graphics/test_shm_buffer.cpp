@@ -29,6 +29,7 @@
 #include <GLES2/gl2ext.h>
 #include <EGL/egl.h>
 #include <endian.h>
+#include <vector>
 #include <boost/throw_exception.hpp>
 
 namespace mg = mir::graphics;
@@ -244,6 +245,26 @@ TEST_F(ShmBufferTest, uploads_abgr_8888_correctly)
     buf.bind();
 }
 
+TEST_F(ShmBufferTest, does_not_reupload_unchanged_pixels)
+{
+    PlatformlessShmBuffer buf(size, mir_pixel_format_abgr_8888, egl_delegate);
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_,_,_,_,_,_,_,_,_)).Times(1);
+    buf.bind();
+    buf.bind();
+}
+
+TEST_F(ShmBufferTest, reuploads_after_write)
+{
+    PlatformlessShmBuffer buf(size, mir_pixel_format_abgr_8888, egl_delegate);
+    std::vector<unsigned char> const pixels(size.width.as_int() * size.height.as_int() * 4, 0xaa);
+
+    EXPECT_CALL(mock_gl, glTexImage2D(_,_,_,_,_,_,_,_,_)).Times(2);
+    buf.bind();
+    buf.write(pixels.data(), pixels.size());
+    buf.bind();
+}
+
 namespace
 {
 void wait_for_egl_thread(mgc::EGLContextExecutor& egl_delegate)
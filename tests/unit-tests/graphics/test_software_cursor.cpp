@@ -19,6 +19,7 @@
 #include "src/server/graphics/software_cursor.h"
 #include "mir/graphics/cursor_image.h"
 #include "mir/graphics/renderable.h"
+#include "mir/renderer/sw/pixel_source.h"
 
 #include "mir/test/doubles/stub_buffer_allocator.h"
 #include "mir/test/doubles/stub_input_scene.h"
@@ -333,3 +334,46 @@ TEST_F(SoftwareCursor, doesnt_try_to_remove_after_hiding)
     cursor.show(stub_cursor_image); //should add, but not remove a second time
     Mock::VerifyAndClearExpectations(&mock_input_scene);
 }
+
+TEST_F(SoftwareCursor, converts_image_to_abgr_buffer)
+{
+    using namespace testing;
+
+    struct AbgrBufferAllocator : mtd::StubBufferAllocator
+    {
+        std::vector<MirPixelFormat> supported_pixel_formats() override { return {mir_pixel_format_abgr_8888}; }
+    } abgr_allocator;
+
+    struct ArgbCursorImage : StubCursorImage
+    {
+        using StubCursorImage::StubCursorImage;
+
+        void const* as_argb_8888() const override
+        {
+            return argb_pixels.data();
+        }
+
+        std::vector<uint32_t> argb_pixels = std::vector<uint32_t>(64 * 64, 0x80112233);
+    } argb_cursor_image{{0, 0}};
+
+    std::shared_ptr<mg::Renderable> renderable;
+    EXPECT_CALL(mock_input_scene, add_input_visualization(_))
+        .WillOnce(SaveArg<0>(&renderable));
+
+    mg::SoftwareCursor cursor{
+        mt::fake_shared(abgr_allocator),
+        mt::fake_shared(mock_input_scene)};
+    cursor.show(argb_cursor_image);
+
+    ASSERT_THAT(renderable, NotNull());
+    auto const pixel_source =
+        dynamic_cast<mir::renderer::software::PixelSource*>(renderable->buffer()->native_buffer_base());
+    ASSERT_THAT(pixel_source, NotNull());
+
+    pixel_source->read([](unsigned char const* pixels)
+        {
+            auto const abgr_pixels = reinterpret_cast<uint32_t const*>(pixels);
+            EXPECT_THAT(abgr_pixels[0], Eq(0x80332211u));
+            EXPECT_THAT(abgr_pixels[64 * 64 - 1], Eq(0x80332211u));
+        });
+}
@@ -35,7 +35,6 @@
 #include "mir/test/gmock_fixes.h"
 #include "mir/test/fake_shared.h"
 #include "mir/udev/wrapper.h"
-#include "mir/cookie/authority.h"
 #include "mir_test_framework/libinput_environment.h"
 
 #include <gmock/gmock.h>
@@ -68,9 +67,8 @@ using Matrix = mi::OutputInfo::Matrix;
 
 struct MockEventBuilder : mi::EventBuilder
 {
-    std::shared_ptr<mir::cookie::Authority> const cookie_authority = mir::cookie::Authority::create();
     mtd::MockInputSeat seat;
-    mi::DefaultEventBuilder builder{MirInputDeviceId{3}, cookie_authority, mt::fake_shared(seat)};
+    mi::DefaultEventBuilder builder{MirInputDeviceId{3}, mt::fake_shared(seat)};
     MockEventBuilder()
     {
         ON_CALL(*this, key_event(_,_,_,_))
@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "src/server/input/default_event_builder.h"
+#include "mir/input/cookie_token.h"
+#include "mir/cookie/authority.h"
+#include "mir/cookie/blob.h"
+#include "mir/events/event.h"
+#include "mir/events/input_event.h"
+#include "mir/events/event_builders.h"
+
+#include "mir/test/doubles/mock_input_seat.h"
+#include "mir/test/fake_shared.h"
+
+#include <linux/input-event-codes.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mi = mir::input;
+namespace mev = mir::events;
+namespace mt = mir::test;
+namespace mtd = mir::test::doubles;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+struct CookieToken : Test
+{
+    std::shared_ptr<mir::cookie::Authority> const authority = mir::cookie::Authority::create();
+    NiceMock<mtd::MockInputSeat> seat;
+    mi::DefaultEventBuilder builder{MirInputDeviceId{3}, mt::fake_shared(seat)};
+    std::chrono::nanoseconds const timestamp{1234567890ns};
+};
+}
+
+TEST_F(CookieToken, key_events_carry_a_token_rather_than_a_cookie)
+{
+    auto const event = builder.key_event(timestamp, mir_keyboard_action_down, 0, KEY_A);
+
+    EXPECT_THAT(event->to_input()->cookie(), Eq(mi::cookie_token(timestamp)));
+    EXPECT_THAT(event->to_input()->cookie().size(), Lt(mir::cookie::default_blob_size));
+}
+
+TEST_F(CookieToken, sealing_a_token_gives_a_cookie_the_authority_accepts)
+{
+    auto const event = builder.pointer_event(timestamp, mir_pointer_action_button_down, mir_pointer_button_primary,
+        0.0f, 0.0f, 0.0f, 0.0f);
+
+    mi::seal_cookie(*event, *authority);
+
+    auto const cookie = event->to_input()->cookie();
+    ASSERT_THAT(cookie.size(), Eq(mir::cookie::default_blob_size));
+    EXPECT_THAT(authority->make_cookie(cookie)->timestamp(), Eq(static_cast<uint64_t>(timestamp.count())));
+}
+
+TEST_F(CookieToken, sealing_leaves_events_without_a_cookie_alone)
+{
+    auto const event = builder.pointer_event(timestamp, mir_pointer_action_motion, 0, 0.0f, 0.0f, 1.0f, 1.0f);
+
+    mi::seal_cookie(*event, *authority);
+
+    EXPECT_THAT(event->to_input()->cookie(), IsEmpty());
+}
+
+TEST_F(CookieToken, sealing_leaves_a_full_cookie_alone)
+{
+    auto const cookie = authority->make_cookie(timestamp.count())->serialize();
+    auto const event = mev::make_event(MirInputDeviceId{3}, timestamp, cookie, mir_keyboard_action_down, 0, KEY_A,
+        mir_input_event_modifier_none);
+
+    mi::seal_cookie(*event, *authority);
+
+    EXPECT_THAT(event->to_input()->cookie(), Eq(cookie));
+}
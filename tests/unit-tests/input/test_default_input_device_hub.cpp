@@ -39,7 +39,6 @@
 #include "mir/input/cursor_listener.h"
 #include "mir/input/mir_pointer_config.h"
 #include "mir/input/mir_touchpad_config.h"
-#include "mir/cookie/authority.h"
 #include "mir/graphics/buffer.h"
 #include "mir/input/device.h"
 #include "mir/input/input_device.h"
@@ -78,13 +77,12 @@ MATCHER_P(WithName, name,
 
 struct InputDeviceHubTest : ::testing::Test
 {
-    std::shared_ptr<mir::cookie::Authority> cookie_authority = mir::cookie::Authority::create();
     mir::dispatch::MultiplexingDispatchable multiplexer;
     NiceMock<mtd::MockInputSeat> mock_seat;
     NiceMock<mtd::MockKeyMapper> mock_key_mapper;
     NiceMock<mtd::MockServerStatusListener> mock_server_status_listener;
     mi::DefaultInputDeviceHub hub{mt::fake_shared(mock_seat), mt::fake_shared(multiplexer),
-                                  cookie_authority, mt::fake_shared(mock_key_mapper),
+                                  mt::fake_shared(mock_key_mapper),
                                   mt::fake_shared(mock_server_status_listener)};
     NiceMock<mtd::MockInputDeviceObserver> mock_observer;
     NiceMock<mtd::MockInputDevice> device{"device","dev-1", mi::DeviceCapability::unknown};
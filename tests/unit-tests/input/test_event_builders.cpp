@@ -18,6 +18,7 @@
 
 #include "mir/events/event_builders.h"
 #include "mir/events/event_private.h" // only needed to validate motion_up/down mapping
+#include "mir_toolkit/mir_blob.h"
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -283,3 +284,36 @@ TEST_F(InputEventBuilder, when_deserialized_input_device_state_event_has_supplie
         EXPECT_THAT(mir_input_device_state_event_device_pressed_keys_for_index(ids_event, 2, i), Eq(pressed_keys[i]));
     }
 }
+
+TEST_F(InputEventBuilder, storage_of_destroyed_event_is_reused)
+{
+    auto make_motion = [this]
+        {
+            return mev::make_event(device_id, timestamp, cookie, modifiers, mir_pointer_action_motion, 0,
+                                   0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+        };
+
+    void const* const first = make_motion().get();
+    auto const second = make_motion();
+
+    EXPECT_THAT(second.get(), Eq(first));
+}
+
+TEST_F(InputEventBuilder, clone_of_large_event_is_faithful)
+{
+    // Bigger than fits in an event without allocating more message space
+    std::vector<uint8_t> const handle(4096, 0xa5);
+
+    auto ev = mev::make_event(device_id, timestamp, cookie, modifiers, mir_pointer_action_motion, 0,
+                              0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f);
+    mev::set_drag_and_drop_handle(*ev, handle);
+
+    auto const clone = mev::clone_event(*ev);
+    auto const blob = clone->to_input()->to_pointer()->dnd_handle();
+
+    ASSERT_THAT(mir_blob_size(blob), Eq(handle.size()));
+    EXPECT_THAT(std::vector<uint8_t>(
+        static_cast<uint8_t const*>(mir_blob_data(blob)),
+        static_cast<uint8_t const*>(mir_blob_data(blob)) + mir_blob_size(blob)), Eq(handle));
+    mir_blob_release(blob);
+}
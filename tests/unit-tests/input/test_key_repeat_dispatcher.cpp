@@ -22,7 +22,6 @@
 #include "mir/events/event_builders.h"
 #include "mir/time/alarm.h"
 #include "mir/time/alarm_factory.h"
-#include "mir/cookie/authority.h"
 #include "mir/input/input_device_observer.h"
 #include "mir/input/mir_pointer_config.h"
 #include "mir/input/mir_touchpad_config.h"
@@ -105,7 +104,7 @@ struct StubDevice : public mi::Device
 struct KeyRepeatDispatcher : public testing::Test
 {
     KeyRepeatDispatcher(bool on_arale = false)
-        : dispatcher(mock_next_dispatcher, mock_alarm_factory, cookie_authority, true, repeat_time, repeat_delay, on_arale)
+        : dispatcher(mock_next_dispatcher, mock_alarm_factory, true, repeat_time, repeat_delay, on_arale)
     {
         ON_CALL(hub,add_observer(_)).WillByDefault(SaveArg<0>(&observer));
         dispatcher.set_input_device_hub(mt::fake_shared(hub));
@@ -120,7 +119,6 @@ struct KeyRepeatDispatcher : public testing::Test
     const MirInputDeviceId test_device = 123;
     std::shared_ptr<mtd::MockInputDispatcher> mock_next_dispatcher = std::make_shared<mtd::MockInputDispatcher>();
     std::shared_ptr<MockAlarmFactory> mock_alarm_factory = std::make_shared<MockAlarmFactory>();
-    std::shared_ptr<mir::cookie::Authority> cookie_authority = mir::cookie::Authority::create();
     std::chrono::milliseconds const repeat_time{2};
     std::chrono::milliseconds const repeat_delay{1};
     std::shared_ptr<mi::InputDeviceObserver> observer;
@@ -21,7 +21,6 @@
 #include "src/include/client/mir/input/input_devices.h"
 #include "src/server/input/default_event_builder.h"
 
-#include "mir/cookie/authority.h"
 #include "mir/input/device_capability.h"
 #include "mir/input/input_device.h"
 #include "mir/input/input_device_info.h"
@@ -136,7 +135,7 @@ TEST_F(TestNestedInputPlatform, devices_forward_input_events)
 {
     auto nested_input_device = capture_input_device(a_mouse);
     NiceMock<mtd::MockInputSink> event_sink;
-    mi::DefaultEventBuilder builder(MirInputDeviceId{12}, mir::cookie::Authority::create(), mt::fake_shared(mock_seat));
+    mi::DefaultEventBuilder builder(MirInputDeviceId{12}, mt::fake_shared(mock_seat));
 
     ASSERT_THAT(nested_input_device, Ne(nullptr));
     nested_input_device->start(&event_sink, &builder);
@@ -162,7 +161,7 @@ TEST_F(TestNestedInputPlatform, devices_forward_key_events)
     auto nested_input_device = capture_input_device(a_keyboard);
     auto const scan_code = 45;
     NiceMock<mtd::MockInputSink> event_sink;
-    mi::DefaultEventBuilder builder(MirInputDeviceId{18}, mir::cookie::Authority::create(), mt::fake_shared(mock_seat));
+    mi::DefaultEventBuilder builder(MirInputDeviceId{18}, mt::fake_shared(mock_seat));
 
     ASSERT_THAT(nested_input_device, Ne(nullptr));
     nested_input_device->start(&event_sink, &builder);
@@ -181,7 +180,7 @@ TEST_F(TestNestedInputPlatform, replaces_enter_events_as_motion_event)
 {
     auto nested_input_device = capture_input_device(a_mouse);
     NiceMock<mtd::MockInputSink> event_sink;
-    mi::DefaultEventBuilder builder(MirInputDeviceId{18}, mir::cookie::Authority::create(), mt::fake_shared(mock_seat));
+    mi::DefaultEventBuilder builder(MirInputDeviceId{18}, mt::fake_shared(mock_seat));
 
     ASSERT_THAT(nested_input_device, Ne(nullptr));
     nested_input_device->start(&event_sink, &builder);
@@ -209,7 +208,7 @@ TEST_F(TestNestedInputPlatform, device_configurations_are_forwarded_to_host_conn
 {
     auto nested_input_device = capture_input_device(a_mouse);
     NiceMock<mtd::MockInputSink> event_sink;
-    mi::DefaultEventBuilder builder(MirInputDeviceId{18}, mir::cookie::Authority::create(), mt::fake_shared(mock_seat));
+    mi::DefaultEventBuilder builder(MirInputDeviceId{18}, mt::fake_shared(mock_seat));
 
     ASSERT_THAT(nested_input_device, Ne(nullptr));
     nested_input_device->start(&event_sink, &builder);
@@ -23,6 +23,9 @@
 #include <gtest/gtest.h>
 #include <string>
 #include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <vector>
 
 using namespace std;
 
@@ -39,6 +42,7 @@ public:
     void log(ml::Severity, string const& message, string const&)
     {
         last = message;
+        messages.push_back(message);
     }
     string const& last_message() const
     {
@@ -48,6 +52,15 @@ public:
     {
         return last.find(substr) != string::npos;
     }
+    bool any_message_contains(char const* substr) const
+    {
+        for (auto const& message : messages)
+        {
+            if (message.find(substr) != string::npos)
+                return true;
+        }
+        return false;
+    }
     bool scrape(float& fps, float& frame_time) const
     {
         return sscanf(last.c_str(), "Display %*s averaged %f FPS, %f ms/frame",
@@ -55,6 +68,7 @@ public:
     }
 private:
     string last;
+    vector<string> messages;
 };
 
 struct LoggingCompositorReport : ::testing::Test
@@ -189,3 +203,157 @@ TEST_F(LoggingCompositorReport, bypass_has_no_render_time)
 
     report.stopped();
 }
+
+TEST_F(LoggingCompositorReport, reports_repainted_pixels_per_frame)
+{
+    const void* const display_id = nullptr;
+    mir::geometry::Rectangles const damage{{{0, 0}, {10, 10}}, {{100, 100}, {20, 5}}};
+
+    int const target_fps = 60;
+    for (int frame = 0; frame < target_fps*3; frame++)
+    {
+        report.began_frame(display_id);
+        clock->advance_by(chrono::microseconds(1000000 / target_fps));
+        report.damage_in_frame(display_id, damage);
+        report.rendered_frame(display_id);
+        report.finished_frame(display_id);
+    }
+
+    long long pixels_per_frame = 0;
+    char const* const repainted = strstr(recorder->last_message().c_str(), "bypassed, ");
+    ASSERT_TRUE(repainted) << recorder->last_message();
+    ASSERT_EQ(1, sscanf(repainted, "bypassed, %lld pixels/frame repainted", &pixels_per_frame))
+        << recorder->last_message();
+    EXPECT_EQ(200, pixels_per_frame);
+}
+
+TEST_F(LoggingCompositorReport, gathers_frame_time_percentiles_per_display)
+{
+    const void* const id = "My Screen";
+
+    report.started();
+    for (int frame = 1; frame <= 100; frame++)
+    {
+        report.began_frame(id);
+        clock->advance_by(chrono::milliseconds(frame));
+        report.rendered_frame(id);
+        clock->advance_by(chrono::milliseconds(1));
+        report.finished_frame(id);
+        clock->advance_by(chrono::milliseconds(2));
+    }
+
+    auto const statistics = report.per_display();
+    ASSERT_EQ(1u, statistics.size());
+    EXPECT_EQ(id, statistics[0].id);
+
+    // Percentiles are accurate to within 1/16
+    auto const render_time = statistics[0].render_time;
+    EXPECT_EQ(100u, render_time.samples);
+    EXPECT_GE(render_time.p50, chrono::milliseconds(50));
+    EXPECT_LE(render_time.p50, chrono::microseconds(50 * 17000 / 16));
+    EXPECT_GE(render_time.p90, chrono::milliseconds(90));
+    EXPECT_LE(render_time.p90, chrono::microseconds(90 * 17000 / 16));
+    EXPECT_GE(render_time.p99, chrono::milliseconds(99));
+    EXPECT_EQ(chrono::nanoseconds{chrono::milliseconds(100)}, render_time.max);
+
+    EXPECT_EQ(chrono::nanoseconds{chrono::milliseconds(101)}, statistics[0].snapshot_to_post.max);
+    EXPECT_EQ(99u, statistics[0].frame_interval.samples);
+    EXPECT_EQ(chrono::nanoseconds{chrono::milliseconds(103)}, statistics[0].frame_interval.max);
+
+    EXPECT_TRUE(recorder->any_message_contains("p50/p90/p99/max ms: render "));
+
+    report.stopped();
+    EXPECT_EQ(1u, report.per_display().size());
+}
+
+TEST_F(LoggingCompositorReport, keeps_displays_separate)
+{
+    const void* const left = "left";
+    const void* const right = "right";
+
+    report.started();
+    for (int frame = 0; frame < 10; frame++)
+    {
+        report.began_frame(left);
+        clock->advance_by(chrono::milliseconds(4));
+        report.rendered_frame(left);
+        report.finished_frame(left);
+
+        report.began_frame(right);
+        clock->advance_by(chrono::milliseconds(8));
+        report.rendered_frame(right);
+        report.finished_frame(right);
+    }
+
+    auto const statistics = report.per_display();
+    ASSERT_EQ(2u, statistics.size());
+    for (auto const& display : statistics)
+    {
+        auto const expected = display.id == left ? chrono::milliseconds(4) : chrono::milliseconds(8);
+        EXPECT_EQ(10u, display.render_time.samples);
+        EXPECT_EQ(chrono::nanoseconds{expected}, display.render_time.max);
+    }
+
+    report.stopped();
+}
+
+TEST_F(LoggingCompositorReport, keeps_display_statistics_across_pause_resume)
+{
+    const void* const before = "before";
+    const void* const after = "after";
+
+    report.started();
+    for (int frame = 0; frame < 10; frame++)
+    {
+        report.began_frame(before);
+        clock->advance_by(chrono::milliseconds(4));
+        report.rendered_frame(before);
+        report.finished_frame(before);
+    }
+    report.stopped();
+
+    report.started();
+    for (int frame = 0; frame < 5; frame++)
+    {
+        report.began_frame(after);
+        clock->advance_by(chrono::milliseconds(8));
+        report.rendered_frame(after);
+        report.finished_frame(after);
+    }
+    report.stopped();
+
+    auto const statistics = report.per_display();
+    ASSERT_EQ(2u, statistics.size());
+    for (auto const& display : statistics)
+    {
+        if (display.id == before)
+            EXPECT_EQ(10u, display.render_time.samples);
+        else
+            EXPECT_EQ(5u, display.render_time.samples);
+    }
+}
+
+TEST_F(LoggingCompositorReport, reuses_the_statistics_of_old_displays_when_out_of_room)
+{
+    int const displays = 100;
+    char ids[displays];
+
+    for (auto& id : ids)
+    {
+        report.started();
+        report.began_frame(&id);
+        clock->advance_by(chrono::milliseconds(1));
+        report.rendered_frame(&id);
+        report.finished_frame(&id);
+        report.stopped();
+    }
+
+    auto const statistics = report.per_display();
+    ASSERT_FALSE(statistics.empty());
+    EXPECT_LT(statistics.size(), static_cast<size_t>(displays));
+    EXPECT_TRUE(std::any_of(statistics.begin(), statistics.end(),
+        [&](mir::compositor::DisplayFrameStatistics const& display)
+        {
+            return display.id == &ids[displays - 1] && display.render_time.samples == 1;
+        }));
+}
@@ -197,3 +197,26 @@ TEST_F(DisplayReport, reports_vsync_steady_interval_despite_missed_frames)
     frame.ust.nanoseconds += d2 * nanos_per_frame;
     report.report_vsync(id, frame);
 }
+
+TEST_F(DisplayReport, reports_framebuffer_cache_misses_with_running_totals)
+{
+    unsigned int const id = 30;
+
+    InSequence seq;
+
+    EXPECT_CALL(*logger, log(
+        ml::Severity::debug,
+        "framebuffer cache miss on 30: 0 hits, 1 misses",
+        component));
+    EXPECT_CALL(*logger, log(
+        ml::Severity::debug,
+        "framebuffer cache miss on 30: 2 hits, 2 misses",
+        component));
+
+    mrl::DisplayReport report(logger);
+
+    report.report_framebuffer_cache_miss(id);
+    report.report_framebuffer_cache_hit(id);
+    report.report_framebuffer_cache_hit(id);
+    report.report_framebuffer_cache_miss(id);
+}
@@ -0,0 +1,123 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 or 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mir/report/timeline.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace mr = mir::report;
+using namespace testing;
+
+namespace
+{
+struct Timeline : Test
+{
+    ~Timeline()
+    {
+        mr::Timeline::disable();
+    }
+
+    // Each thread gets its own buffer, so record on a new one to start afresh
+    template<typename Action>
+    void on_new_thread(Action action)
+    {
+        std::thread{action}.join();
+    }
+
+    std::string trace()
+    {
+        std::stringstream out;
+        mr::Timeline::write_chrome_trace(out);
+        return out.str();
+    }
+};
+}
+
+TEST_F(Timeline, records_nothing_while_disabled)
+{
+    mr::Timeline::disable();
+
+    on_new_thread([] { mr::Timeline::Span const span{"disabled span"}; });
+
+    EXPECT_THAT(trace(), Not(HasSubstr("disabled span")));
+}
+
+TEST_F(Timeline, writes_spans_as_chrome_trace_events)
+{
+    mr::Timeline::enable(16);
+
+    on_new_thread(
+        []
+        {
+            mr::Timeline::Span const outer{"outer span"};
+            mr::Timeline::Span const inner{"inner span"};
+        });
+
+    auto const json = trace();
+    EXPECT_THAT(json, StartsWith("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["));
+    EXPECT_THAT(json, HasSubstr("{\"ph\":\"B\",\"name\":\"outer span\""));
+    EXPECT_THAT(json, HasSubstr("{\"ph\":\"B\",\"name\":\"inner span\""));
+    EXPECT_THAT(json, HasSubstr("{\"ph\":\"E\",\"name\":\"inner span\""));
+    EXPECT_THAT(json, HasSubstr("{\"ph\":\"E\",\"name\":\"outer span\""));
+    EXPECT_THAT(json, HasSubstr("\"name\":\"thread_name\""));
+    EXPECT_THAT(json, EndsWith("]}\n"));
+}
+
+TEST_F(Timeline, keeps_only_the_latest_events)
+{
+    mr::Timeline::enable(4);
+
+    on_new_thread(
+        []
+        {
+            { mr::Timeline::Span const span{"overwritten span"}; }
+            { mr::Timeline::Span const span{"retained span"}; }
+            { mr::Timeline::Span const span{"retained span"}; }
+        });
+
+    auto const json = trace();
+    EXPECT_THAT(json, Not(HasSubstr("overwritten span")));
+    EXPECT_THAT(json, HasSubstr("retained span"));
+}
+
+TEST_F(Timeline, does_not_write_ends_of_overwritten_spans)
+{
+    mr::Timeline::enable(4);
+
+    on_new_thread(
+        []
+        {
+            mr::Timeline::Span const outer{"truncated span"};
+            { mr::Timeline::Span const span{"short span"}; }
+            { mr::Timeline::Span const span{"short span"}; }
+        });
+
+    EXPECT_THAT(trace(), Not(HasSubstr("truncated span")));
+}
+
+TEST_F(Timeline, escapes_names)
+{
+    mr::Timeline::enable(16);
+
+    on_new_thread([] { mr::Timeline::Span const span{"a \"quoted\\\" span"}; });
+
+    EXPECT_THAT(trace(), HasSubstr("\"name\":\"a \\\"quoted\\\\\\\" span\""));
+}
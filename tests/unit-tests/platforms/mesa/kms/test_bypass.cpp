@@ -84,6 +84,30 @@ TEST_F(BypassMatchTest, shaped_fullscreen_window_not_bypassed)
     EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
 }
 
+TEST_F(BypassMatchTest, shaped_fullscreen_window_declared_opaque_is_bypassed)
+{
+    mgm::BypassMatch matcher(primary_monitor);
+
+    auto const window = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {1920, 1200}}, 1.0f, false);
+    window->set_opaque_region({geom::Rectangle{{0, 0}, {1920, 1200}}});
+    mg::RenderableList list{window};
+
+    auto it = std::find_if(list.rbegin(), list.rend(), matcher);
+    EXPECT_NE(list.rend(), it);
+    EXPECT_EQ(window, *it);
+}
+
+TEST_F(BypassMatchTest, shaped_fullscreen_window_partly_opaque_not_bypassed)
+{
+    mgm::BypassMatch matcher(primary_monitor);
+
+    auto const window = std::make_shared<mtd::FakeRenderable>(geom::Rectangle{{0, 0}, {1920, 1200}}, 1.0f, false);
+    window->set_opaque_region({geom::Rectangle{{0, 30}, {1920, 1170}}});
+    mg::RenderableList list{window};
+
+    EXPECT_EQ(list.rend(), std::find_if(list.rbegin(), list.rend(), matcher));
+}
+
 TEST_F(BypassMatchTest, offset_fullscreen_window_not_bypassed)
 {
     mgm::BypassMatch matcher(primary_monitor);
@@ -20,6 +20,7 @@
 #include "mir/test/doubles/null_console_services.h"
 #include "src/platforms/mesa/server/kms/platform.h"
 #include "src/platforms/mesa/server/kms/display_buffer.h"
+#include "src/platforms/mesa/server/wayland_scanout_buffer.h"
 #include "src/platforms/mesa/include/native_buffer.h"
 #include "src/server/report/null_report_factory.h"
 #include "mir/test/doubles/mock_egl.h"
@@ -503,3 +504,75 @@ TEST_F(MesaDisplayBufferTest, buffer_requiring_migration_is_ineligable_for_bypas
 
     EXPECT_FALSE(db.overlay(bypassable_list));
 }
+
+TEST_F(MesaDisplayBufferTest, wayland_buffer_is_scanned_out_of_its_imported_bo)
+{
+    auto const imported_bo = reinterpret_cast<gbm_bo*>(0x5ca7);
+    auto composited = std::make_unique<NiceMock<MockBuffer>>();
+    ON_CALL(*composited, size())
+        .WillByDefault(Return(display_area.size));
+    int scanouts{0};
+    auto const wayland_buffer = std::make_shared<WaylandScanoutBuffer>(
+        std::move(composited),
+        std::shared_ptr<gbm_bo>{imported_bo, [](gbm_bo*){}},
+        [&scanouts] { ++scanouts; });
+    auto const renderable = std::make_shared<FakeRenderable>(display_area);
+    renderable->set_buffer(wayland_buffer);
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_CALL(*mock_kms_output, fb_for(imported_bo));
+
+    EXPECT_TRUE(db.overlay({renderable}));
+    EXPECT_THAT(scanouts, Eq(1));
+}
+
+TEST_F(MesaDisplayBufferTest, wayland_buffer_is_not_consumed_when_it_cannot_be_scanned_out)
+{
+    auto const imported_bo = reinterpret_cast<gbm_bo*>(0x5ca7);
+    ON_CALL(*mock_kms_output, buffer_requires_migration(imported_bo))
+        .WillByDefault(Return(true));
+    auto composited = std::make_unique<NiceMock<MockBuffer>>();
+    ON_CALL(*composited, size())
+        .WillByDefault(Return(display_area.size));
+    int scanouts{0};
+    auto const wayland_buffer = std::make_shared<WaylandScanoutBuffer>(
+        std::move(composited),
+        std::shared_ptr<gbm_bo>{imported_bo, [](gbm_bo*){}},
+        [&scanouts] { ++scanouts; });
+    auto const renderable = std::make_shared<FakeRenderable>(display_area);
+    renderable->set_buffer(wayland_buffer);
+
+    graphics::mesa::DisplayBuffer db(
+        graphics::mesa::BypassOption::allowed,
+        null_display_report(),
+        {mock_kms_output},
+        make_output_surface(),
+        display_area,
+        identity);
+
+    EXPECT_FALSE(db.overlay({renderable}));
+    EXPECT_THAT(scanouts, Eq(0));
+}
+
+TEST_F(MesaDisplayBufferTest, wayland_buffer_is_composited_from_the_client_buffer)
+{
+    auto composited = std::make_unique<NiceMock<MockBuffer>>();
+    auto const composited_base = composited->native_buffer_base();
+    ON_CALL(*composited, pixel_format())
+        .WillByDefault(Return(mir_pixel_format_xrgb_8888));
+
+    WaylandScanoutBuffer wayland_buffer{
+        std::move(composited),
+        std::shared_ptr<gbm_bo>{fake_bo, [](gbm_bo*){}},
+        []{}};
+
+    EXPECT_THAT(wayland_buffer.native_buffer_base(), Eq(composited_base));
+    EXPECT_THAT(wayland_buffer.pixel_format(), Eq(mir_pixel_format_xrgb_8888));
+}
@@ -24,8 +24,10 @@
 
 #include "mir/test/doubles/mock_drm.h"
 #include "mir/test/doubles/mock_gbm.h"
+#include "mir/test/doubles/mock_display_report.h"
 
 #include <stdexcept>
+#include <unordered_map>
 
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
@@ -148,6 +150,35 @@ public:
         mock_drm.prepare(drm_device);
     }
 
+    /* Keep gbm_bo user data like libgbm does, so the output can find its FBHandle again */
+    void store_bo_user_data()
+    {
+        ON_CALL(mock_gbm, gbm_bo_set_user_data(_,_,_))
+            .WillByDefault(Invoke(
+                [this](gbm_bo* bo, void* data, void (*destroy)(gbm_bo*, void*))
+                {
+                    bo_user_data[bo] = BoUserData{data, destroy};
+                }));
+        ON_CALL(mock_gbm, gbm_bo_get_user_data(_))
+            .WillByDefault(Invoke(
+                [this](gbm_bo* bo) -> void*
+                {
+                    auto const data = bo_user_data.find(bo);
+                    return data != bo_user_data.end() ? data->second.data : nullptr;
+                }));
+    }
+
+    void destroy_bo(gbm_bo* bo)
+    {
+        auto const data = bo_user_data.find(bo);
+        if (data != bo_user_data.end())
+        {
+            auto const user_data = data->second;
+            bo_user_data.erase(data);
+            user_data.destroy(bo, user_data.data);
+        }
+    }
+
     void append_fb_id(uint32_t fb_id)
     {
         EXPECT_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
@@ -161,6 +192,7 @@ public:
     testing::NiceMock<mtd::MockGBM> mock_gbm;
     MockPageFlipper mock_page_flipper;
     NullPageFlipper null_page_flipper;
+    testing::NiceMock<mtd::MockDisplayReport> report;
     std::vector<drmModeModeInfo> modes_empty;
 
     char const* const drm_device = "/dev/dri/card0";
@@ -173,6 +205,13 @@ public:
     std::vector<uint32_t> const connector_ids;
     std::vector<uint32_t> possible_encoder_ids1;
     std::vector<uint32_t> possible_encoder_ids2;
+
+    struct BoUserData
+    {
+        void* data;
+        void (*destroy)(gbm_bo*, void*);
+    };
+    std::unordered_map<gbm_bo*, BoUserData> bo_user_data;
 };
 
 }
@@ -209,7 +248,8 @@ TEST_F(RealKMSOutputTest, operations_use_existing_crtc)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     auto fb = output.fb_for(fake_bo);
 
@@ -251,7 +291,8 @@ TEST_F(RealKMSOutputTest, operations_use_possible_crtc)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     auto fb = output.fb_for(fake_bo);
 
@@ -291,7 +332,8 @@ TEST_F(RealKMSOutputTest, set_crtc_failure_is_handled_gracefully)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     auto fb = output.fb_for(fake_bo);
 
@@ -314,7 +356,8 @@ TEST_F(RealKMSOutputTest, clear_crtc_gets_crtc_if_none_is_current)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_ids[0], 0, 0, 0, nullptr, 0, nullptr))
         .Times(1)
@@ -351,7 +394,8 @@ TEST_F(RealKMSOutputTest, clear_crtc_does_not_throw_if_no_crtc_is_found)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     EXPECT_CALL(mock_drm, drmModeSetCrtc(_, _, 0, 0, 0, nullptr, 0, nullptr))
         .Times(0);
@@ -372,7 +416,8 @@ TEST_F(RealKMSOutputTest, cursor_move_permission_failure_is_non_fatal)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     auto fb = output.fb_for(fake_bo);
 
@@ -400,7 +445,8 @@ TEST_F(RealKMSOutputTest, cursor_set_permission_failure_is_non_fatal)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     auto fb = output.fb_for(fake_bo);
 
@@ -429,7 +475,8 @@ TEST_F(RealKMSOutputTest, has_no_cursor_if_no_hardware_support)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     auto fb = output.fb_for(fake_bo);
 
@@ -450,7 +497,8 @@ TEST_F(RealKMSOutputTest, clear_crtc_is_non_fatal_on_permission_error)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_ids[0], 0, 0, 0, nullptr, 0, nullptr))
         .Times(2)
@@ -476,7 +524,8 @@ TEST_F(RealKMSOutputTest, clear_crtc_throws_if_drm_call_fails_for_non_permission
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     EXPECT_CALL(mock_drm, drmModeSetCrtc(_, crtc_ids[0], 0, 0, 0, nullptr, 0, nullptr))
         .Times(1)
@@ -498,7 +547,8 @@ TEST_F(RealKMSOutputTest, drm_set_gamma)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     mg::GammaCurves gamma{{1}, {2}, {3}};
 
@@ -529,7 +579,8 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
     mgm::RealKMSOutput output{
         drm_fd,
         mg::kms::get_connector(drm_fd, connector_ids[0]),
-        mt::fake_shared(mock_page_flipper)};
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
 
     mg::GammaCurves gamma{{1}, {2}, {3}};
 
@@ -548,3 +599,96 @@ TEST_F(RealKMSOutputTest, drm_set_gamma_failure_does_not_throw)
 
     EXPECT_NO_THROW(output.set_gamma(gamma););
 }
+
+TEST_F(RealKMSOutputTest, fb_for_reuses_framebuffer_of_known_buffer)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+    store_bo_user_data();
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
+
+    append_fb_id(fb_id);
+    EXPECT_CALL(report, report_framebuffer_cache_miss(connector_ids[0])).Times(1);
+    EXPECT_CALL(report, report_framebuffer_cache_hit(connector_ids[0])).Times(2);
+
+    auto const fb = output.fb_for(fake_bo);
+    ASSERT_THAT(fb, NotNull());
+    EXPECT_THAT(output.fb_for(fake_bo), Eq(fb));
+    EXPECT_THAT(output.fb_for(fake_bo), Eq(fb));
+
+    destroy_bo(fake_bo);
+}
+
+TEST_F(RealKMSOutputTest, fb_for_adds_framebuffer_for_each_new_buffer)
+{
+    using namespace testing;
+
+    setup_outputs_connected_crtc();
+    store_bo_user_data();
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
+
+    std::vector<gbm_bo*> const bos{
+        reinterpret_cast<gbm_bo*>(0x123ba),
+        reinterpret_cast<gbm_bo*>(0x123bb),
+        reinterpret_cast<gbm_bo*>(0x123bc)};
+
+    EXPECT_CALL(mock_drm, drmModeAddFB2(_,_,_,_,_,_,_,_,_))
+        .WillOnce(DoAll(SetArgPointee<7>(67), Return(0)))
+        .WillOnce(DoAll(SetArgPointee<7>(68), Return(0)))
+        .WillOnce(DoAll(SetArgPointee<7>(69), Return(0)));
+    EXPECT_CALL(report, report_framebuffer_cache_miss(connector_ids[0])).Times(3);
+    EXPECT_CALL(report, report_framebuffer_cache_hit(connector_ids[0])).Times(6);
+
+    // Cycling through a swapchain only registers each buffer once
+    for (int frame = 0; frame != 3; ++frame)
+    {
+        for (auto const bo : bos)
+            EXPECT_THAT(output.fb_for(bo), NotNull());
+    }
+
+    for (auto const bo : bos)
+        destroy_bo(bo);
+}
+
+TEST_F(RealKMSOutputTest, framebuffer_is_removed_when_buffer_is_destroyed)
+{
+    using namespace testing;
+
+    uint32_t const fb_id{67};
+
+    setup_outputs_connected_crtc();
+    store_bo_user_data();
+
+    mgm::RealKMSOutput output{
+        drm_fd,
+        mg::kms::get_connector(drm_fd, connector_ids[0]),
+        mt::fake_shared(mock_page_flipper),
+        mt::fake_shared(report)};
+
+    append_fb_id(fb_id);
+    ASSERT_THAT(output.fb_for(fake_bo), NotNull());
+
+    EXPECT_CALL(mock_drm, drmModeRmFB(_, fb_id)).Times(1);
+    destroy_bo(fake_bo);
+    Mock::VerifyAndClearExpectations(&mock_drm);
+
+    // A new buffer at the same address needs a new framebuffer
+    append_fb_id(fb_id + 1);
+    EXPECT_CALL(report, report_framebuffer_cache_miss(connector_ids[0])).Times(1);
+    ASSERT_THAT(output.fb_for(fake_bo), NotNull());
+
+    destroy_bo(fake_bo);
+}
@@ -31,6 +31,7 @@
 #include <src/renderers/gl/renderer.h>
 #include <mir/test/doubles/stub_gl_display_buffer.h>
 #include <mir/test/doubles/mock_gl_display_buffer.h>
+#include <mir/renderer/gl/buffer_age_source.h>
 
 using testing::SetArgPointee;
 using testing::InSequence;
@@ -88,6 +89,17 @@ void SetUpMockProgramData(mtd::MockGL &mock_gl)
         .WillByDefault(Return(alpha_uniform_location));
 }
 
+class AgedGLDisplayBuffer : public mtd::StubGLDisplayBuffer,
+                            public mrg::BufferAgeSource
+{
+public:
+    using StubGLDisplayBuffer::StubGLDisplayBuffer;
+
+    unsigned int buffer_age() const override { return age; }
+
+    unsigned int age = 0;
+};
+
 class GLRenderer :
     public testing::Test
 {
@@ -183,6 +195,30 @@ TEST_F(GLRenderer, enables_blending_for_rgba_surfaces)
     renderer.render(renderable_list);
 }
 
+TEST_F(GLRenderer, disables_blending_for_rgba_surfaces_declared_opaque)
+{
+    EXPECT_CALL(*renderable, shaped()).WillOnce(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{0, 0}, {10, 10}}}));
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRenderer, enables_blending_for_rgba_surfaces_partly_declared_opaque)
+{
+    EXPECT_CALL(*renderable, shaped()).WillOnce(Return(true));
+    EXPECT_CALL(*renderable, opaque_region())
+        .WillRepeatedly(Return(mir::geometry::Rectangles{{{1, 2}, {3, 1}}}));
+    EXPECT_CALL(mock_gl, glDisable(GL_BLEND)).Times(0);
+    EXPECT_CALL(mock_gl, glEnable(GL_BLEND));
+
+    mrg::Renderer renderer(display_buffer);
+    renderer.render(renderable_list);
+}
+
 TEST_F(GLRenderer, enables_blending_for_rgbx_translucent_surfaces)
 {
     EXPECT_CALL(*renderable, alpha()).WillRepeatedly(Return(0.5f));
@@ -466,3 +502,98 @@ TEST_F(GLRenderer, sets_viewport_downscaled_wide)
 
     mrg::Renderer renderer(mock_display_buffer);
 }
+
+struct GLRendererPartialRepaint : GLRenderer
+{
+    GLRendererPartialRepaint()
+    {
+        ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_WIDTH,_))
+            .WillByDefault(DoAll(SetArgPointee<3>(view_area.size.width.as_int()),
+                                 Return(EGL_TRUE)));
+        ON_CALL(mock_egl, eglQuerySurface(_,_,EGL_HEIGHT,_))
+            .WillByDefault(DoAll(SetArgPointee<3>(view_area.size.height.as_int()),
+                                 Return(EGL_TRUE)));
+        EXPECT_CALL(*renderable, transformation()).WillRepeatedly(Return(glm::mat4(1)));
+    }
+
+    mir::geometry::Rectangle const view_area{{0,0}, {1920,1080}};
+    AgedGLDisplayBuffer aged_display_buffer{view_area};
+};
+
+TEST_F(GLRendererPartialRepaint, repaints_everything_when_buffer_age_is_unknown)
+{
+    mrg::Renderer renderer(aged_display_buffer);
+
+    EXPECT_CALL(mock_gl, glScissor(_, _, _, _)).Times(0);
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(AtLeast(1));
+
+    renderer.set_frame_damage({{{100, 100}, {10, 10}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRendererPartialRepaint, repaints_only_damage_when_buffer_holds_previous_frame)
+{
+    mrg::Renderer renderer(aged_display_buffer);
+    renderer.render(renderable_list);
+    testing::Mock::VerifyAndClearExpectations(&mock_gl);
+
+    aged_display_buffer.age = 1;
+
+    EXPECT_CALL(mock_gl, glScissor(100, 970, 10, 10));
+    EXPECT_CALL(mock_gl, glClear(_));
+    // The renderable is nowhere near the damage
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(0);
+
+    renderer.set_frame_damage({{{100, 100}, {10, 10}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRendererPartialRepaint, repaints_damage_of_intervening_frames_for_older_buffers)
+{
+    mrg::Renderer renderer(aged_display_buffer);
+    renderer.render(renderable_list);
+
+    aged_display_buffer.age = 1;
+    renderer.set_frame_damage({{{200, 200}, {20, 20}}});
+    renderer.render(renderable_list);
+    testing::Mock::VerifyAndClearExpectations(&mock_gl);
+
+    aged_display_buffer.age = 2;
+
+    EXPECT_CALL(mock_gl, glScissor(100, 970, 10, 10));
+    EXPECT_CALL(mock_gl, glScissor(200, 860, 20, 20));
+
+    renderer.set_frame_damage({{{100, 100}, {10, 10}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRendererPartialRepaint, redraws_renderables_overlapping_damage)
+{
+    mrg::Renderer renderer(aged_display_buffer);
+    renderer.render(renderable_list);
+    testing::Mock::VerifyAndClearExpectations(&mock_gl);
+
+    aged_display_buffer.age = 1;
+
+    EXPECT_CALL(mock_gl, glScissor(0, 1076, 2, 4));
+    EXPECT_CALL(mock_gl, glDrawArrays(_, _, _)).Times(AtLeast(1));
+
+    renderer.set_frame_damage({{{0, 0}, {2, 4}}});
+    renderer.render(renderable_list);
+}
+
+TEST_F(GLRendererPartialRepaint, repaints_everything_after_output_transform_changes)
+{
+    mrg::Renderer renderer(aged_display_buffer);
+    renderer.render(renderable_list);
+    aged_display_buffer.age = 1;
+
+    glm::mat2 const rotated{0,-1,
+                            1, 0};
+    renderer.set_output_transform(rotated);
+
+    EXPECT_CALL(mock_gl, glScissor(_, _, _, _)).Times(0);
+
+    renderer.set_frame_damage({{{100, 100}, {10, 10}}});
+    renderer.render(renderable_list);
+}
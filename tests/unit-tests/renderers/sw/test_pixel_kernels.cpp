@@ -0,0 +1,298 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/renderer/sw/pixel_kernels.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace mrs = mir::renderer::software;
+using namespace testing;
+
+namespace
+{
+auto reference() -> mrs::PixelKernels const&
+{
+    return *mrs::available_pixel_kernels().front();
+}
+
+auto random_pixels(size_t count) -> std::vector<uint32_t>
+{
+    std::mt19937 random{count};
+    std::uniform_int_distribution<uint32_t> pixel;
+    std::vector<uint32_t> pixels(count);
+    for (auto& p : pixels)
+        p = pixel(random);
+    return pixels;
+}
+
+// Colors with alphas at and around the edges of the range
+uint32_t const colors[]{0xff000000, 0xffffffff, 0xff3060a0, 0x80ffffff, 0x7f102030, 0x01ff80ff, 0x00ffffff, 0xfe7f8081};
+
+struct PixelKernels : TestWithParam<mrs::PixelKernels const*>
+{
+    mrs::PixelKernels const& kernels = *GetParam();
+};
+}
+
+TEST(PixelKernelsReference, is_scalar)
+{
+    EXPECT_THAT(reference().name, StrEq("scalar"));
+}
+
+TEST(PixelKernelsReference, fully_covered_opaque_color_replaces_color_channels)
+{
+    uint32_t pixel = 0x12345678;
+    uint8_t const mask = 255;
+
+    reference().blend_a8(&pixel, &mask, 0xffa0b0c0, 1);
+
+    EXPECT_THAT(pixel, Eq(0x12a0b0c0u));
+}
+
+TEST(PixelKernelsReference, uncovered_pixel_is_unchanged)
+{
+    uint32_t pixel = 0x12345678;
+    uint8_t const mask = 0;
+
+    reference().blend_a8(&pixel, &mask, 0xffa0b0c0, 1);
+
+    EXPECT_THAT(pixel, Eq(0x12345678u));
+}
+
+TEST(PixelKernelsReference, blend_truncates_like_decoration_text)
+{
+    uint32_t pixel = 0xff000000;
+    uint8_t const mask = 128;
+
+    reference().blend_a8(&pixel, &mask, 0xffffffff, 1);
+
+    // 255 * 128 / 255 = 128 coverage, then 255 * 128 / 255 = 128 per channel
+    EXPECT_THAT(pixel, Eq(0xff808080u));
+}
+
+TEST(PixelKernelsReference, premultiply_rounds_to_nearest)
+{
+    uint32_t const pixels[]{0x80ff0000, 0x00ffffff, 0xffabcdef, 0x40010203};
+    uint32_t result[4];
+
+    reference().premultiply(result, pixels, 4);
+
+    EXPECT_THAT(result, ElementsAre(0x80800000u, 0x00000000u, 0xffabcdefu, 0x40000101u));
+}
+
+TEST(PixelKernelsReference, swap_red_blue_swaps_red_and_blue)
+{
+    uint32_t pixel = 0x11223344;
+
+    reference().swap_red_blue(&pixel, &pixel, 1);
+
+    EXPECT_THAT(pixel, Eq(0x11443322u));
+}
+
+TEST(PixelKernelsReference, over_composites_premultiplied_pixels)
+{
+    uint32_t dest[]{0xff204060, 0xff204060, 0xff204060, 0x00000000};
+    uint32_t const src[]{0xffa0b0c0, 0x00000000, 0x80400000, 0x80400000};
+
+    reference().over(dest, src, 255, 4);
+
+    // Opaque replaces, transparent keeps, translucent is added to what shows through
+    EXPECT_THAT(dest, ElementsAre(0xffa0b0c0u, 0xff204060u, 0xff502030u, 0x80400000u));
+}
+
+TEST(PixelKernelsReference, over_scales_source_by_plane_alpha)
+{
+    uint32_t dest = 0xff000000;
+    uint32_t const src = 0xffffffff;
+
+    reference().over(&dest, &src, 128, 1);
+
+    EXPECT_THAT(dest, Eq(0xff808080u));
+}
+
+TEST(PixelKernelsReference, over_saturates_invalid_premultiplied_pixels)
+{
+    uint32_t dest = 0xffffffff;
+    uint32_t const src = 0x00ff0000;
+
+    reference().over(&dest, &src, 255, 1);
+
+    EXPECT_THAT(dest, Eq(0xffffffffu));
+}
+
+TEST(PixelKernelsReference, scale_nearest_samples_fixed_point_positions)
+{
+    uint32_t const src[]{10, 11, 12, 13};
+    uint32_t dest[8];
+
+    reference().scale_nearest(dest, src, 0, 0x8000, 8);
+
+    EXPECT_THAT(dest, ElementsAre(10u, 10u, 11u, 11u, 12u, 12u, 13u, 13u));
+}
+
+TEST(PixelKernelsReference, best_kernels_are_available)
+{
+    EXPECT_THAT(mrs::available_pixel_kernels(), Contains(&mrs::pixel_kernels()));
+}
+
+TEST_P(PixelKernels, fill_matches_reference)
+{
+    // Every length and alignment around the vector widths, so the tails are covered too
+    for (size_t offset = 0; offset != 4; ++offset)
+    {
+        for (size_t count = 0; count != 40; ++count)
+        {
+            auto expected = random_pixels(offset + count + 1);
+            auto result = expected;
+
+            reference().fill(expected.data() + offset, 0x80a0b0c0, count);
+            kernels.fill(result.data() + offset, 0x80a0b0c0, count);
+
+            ASSERT_THAT(result, ContainerEq(expected)) << "offset " << offset << ", count " << count;
+        }
+    }
+}
+
+TEST_P(PixelKernels, blend_a8_matches_reference_for_every_coverage_and_channel_value)
+{
+    // Pair every channel value with every coverage value, starting unaligned and with a ragged tail
+    size_t const count = 256 * 256 + 5;
+    std::vector<uint32_t> pixels(count + 1);
+    std::vector<uint8_t> mask(count + 1);
+    auto const noise = random_pixels(count + 1);
+    for (size_t i = 0; i != pixels.size(); ++i)
+    {
+        uint32_t const channel = i & 0xff;
+        pixels[i] = (noise[i] & 0xff000000) | channel << 16 | (255 - channel) << 8 | (noise[i] & 0xff);
+        mask[i] = (i >> 8) & 0xff;
+    }
+
+    for (auto const color : colors)
+    {
+        auto expected = pixels;
+        auto result = pixels;
+
+        reference().blend_a8(expected.data() + 1, mask.data() + 1, color, count);
+        kernels.blend_a8(result.data() + 1, mask.data() + 1, color, count);
+
+        ASSERT_THAT(result, ContainerEq(expected)) << "color " << std::hex << color;
+    }
+}
+
+TEST_P(PixelKernels, premultiply_matches_reference_for_every_channel_and_alpha_value)
+{
+    size_t const count = 256 * 256 + 5;
+    std::vector<uint32_t> pixels(count + 1);
+    for (size_t i = 0; i != pixels.size(); ++i)
+    {
+        uint32_t const channel = i & 0xff;
+        uint32_t const alpha = (i >> 8) & 0xff;
+        pixels[i] = alpha << 24 | channel << 16 | (255 - channel) << 8 | (channel ^ 0x5a);
+    }
+    std::vector<uint32_t> expected(pixels.size());
+    std::vector<uint32_t> result(pixels.size());
+
+    reference().premultiply(expected.data() + 1, pixels.data() + 1, count);
+    kernels.premultiply(result.data() + 1, pixels.data() + 1, count);
+
+    EXPECT_THAT(result, ContainerEq(expected));
+}
+
+TEST_P(PixelKernels, premultiply_works_in_place)
+{
+    auto const pixels = random_pixels(67);
+    std::vector<uint32_t> expected(pixels.size());
+    auto result = pixels;
+
+    reference().premultiply(expected.data(), pixels.data(), pixels.size());
+    kernels.premultiply(result.data(), result.data(), result.size());
+
+    EXPECT_THAT(result, ContainerEq(expected));
+}
+
+TEST_P(PixelKernels, swap_red_blue_matches_reference)
+{
+    for (size_t count = 0; count != 40; ++count)
+    {
+        auto const pixels = random_pixels(count + 1);
+        std::vector<uint32_t> expected(pixels.size());
+        std::vector<uint32_t> result(pixels.size());
+
+        reference().swap_red_blue(expected.data() + 1, pixels.data() + 1, count);
+        kernels.swap_red_blue(result.data() + 1, pixels.data() + 1, count);
+
+        ASSERT_THAT(result, ContainerEq(expected)) << "count " << count;
+    }
+}
+
+TEST_P(PixelKernels, over_matches_reference_for_every_channel_and_alpha_value)
+{
+    // Pair every source channel with every source alpha, starting unaligned and with a ragged tail
+    size_t const count = 256 * 256 + 5;
+    std::vector<uint32_t> pixels(count + 1);
+    auto const noise = random_pixels(count + 1);
+    for (size_t i = 0; i != pixels.size(); ++i)
+    {
+        uint32_t const channel = i & 0xff;
+        uint32_t const alpha = (i >> 8) & 0xff;
+        pixels[i] = alpha << 24 | channel << 16 | (255 - channel) << 8 | (noise[i] & 0xff);
+    }
+    // Runs of transparent and opaque pixels to catch the shortcuts
+    std::fill(pixels.begin() + 1000, pixels.begin() + 1040, 0u);
+    std::fill(pixels.begin() + 2000, pixels.begin() + 2040, 0xff8090a0u);
+
+    for (uint8_t const alpha : {255, 254, 128, 1, 0})
+    {
+        auto expected = noise;
+        auto result = noise;
+
+        reference().over(expected.data() + 1, pixels.data() + 1, alpha, count);
+        kernels.over(result.data() + 1, pixels.data() + 1, alpha, count);
+
+        ASSERT_THAT(result, ContainerEq(expected)) << "alpha " << int{alpha};
+    }
+}
+
+TEST_P(PixelKernels, scale_nearest_matches_reference)
+{
+    auto const pixels = random_pixels(101);
+
+    // Shrinking, stretching and one to one, with lengths around the vector widths
+    for (uint32_t const step : {0x10000u, 0x8000u, 0x1c000u, 0x3fffu, 0x10001u})
+    {
+        for (size_t count = 0; count != 40; ++count)
+        {
+            std::vector<uint32_t> expected(count + 1);
+            std::vector<uint32_t> result(count + 1);
+
+            reference().scale_nearest(expected.data() + 1, pixels.data(), 0x1234, step, count);
+            kernels.scale_nearest(result.data() + 1, pixels.data(), 0x1234, step, count);
+
+            ASSERT_THAT(result, ContainerEq(expected)) << "step " << std::hex << step << ", count " << std::dec << count;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(
+    AvailableImplementations,
+    PixelKernels,
+    ValuesIn(mrs::available_pixel_kernels()));
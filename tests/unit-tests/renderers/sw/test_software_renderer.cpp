@@ -0,0 +1,331 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "src/renderers/sw/renderer.h"
+#include "src/renderers/sw/renderer_factory.h"
+
+#include "mir/test/doubles/stub_sw_display_buffer.h"
+#include "mir/test/doubles/stub_gl_display_buffer.h"
+#include "mir/test/doubles/stub_buffer.h"
+#include "mir/test/doubles/mock_buffer.h"
+#include "mir/test/doubles/fake_renderable.h"
+#include "mir/test/fake_shared.h"
+#include "mir/graphics/buffer_properties.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <stdexcept>
+
+namespace mg = mir::graphics;
+namespace mr = mir::renderer;
+namespace mrs = mir::renderer::software;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+using namespace testing;
+
+namespace
+{
+uint32_t const black{0xff000000};
+
+auto buffer_of(geom::Size size, MirPixelFormat format, std::vector<uint32_t> const& pixels)
+    -> std::shared_ptr<mtd::StubBuffer>
+{
+    auto const buffer = std::make_shared<mtd::StubBuffer>(
+        mg::BufferProperties{size, format, mg::BufferUsage::software});
+    buffer->write(reinterpret_cast<unsigned char const*>(pixels.data()), pixels.size() * sizeof pixels[0]);
+    return buffer;
+}
+
+auto solid_buffer(geom::Size size, MirPixelFormat format, uint32_t color) -> std::shared_ptr<mtd::StubBuffer>
+{
+    return buffer_of(size, format, std::vector<uint32_t>(size.width.as_int() * size.height.as_int(), color));
+}
+
+auto renderable_of(
+    geom::Rectangle position,
+    std::shared_ptr<mg::Buffer> const& buffer,
+    float alpha = 1.0f) -> std::shared_ptr<mtd::FakeRenderable>
+{
+    auto const shaped = buffer->pixel_format() == mir_pixel_format_argb_8888 ||
+                        buffer->pixel_format() == mir_pixel_format_abgr_8888;
+    auto const renderable = std::make_shared<mtd::FakeRenderable>(position, alpha, !shaped);
+    renderable->set_buffer(buffer);
+    return renderable;
+}
+
+class NullRendererFactory : public mr::RendererFactory
+{
+public:
+    std::unique_ptr<mr::Renderer> create_renderer_for(mg::DisplayBuffer&) override
+    {
+        return nullptr;
+    }
+};
+
+struct SoftwareRenderer : Test
+{
+    geom::Rectangle const view_area{{0, 0}, {8, 6}};
+    mtd::StubSWDisplayBuffer display_buffer{view_area};
+    mrs::Renderer renderer{display_buffer};
+};
+}
+
+TEST_F(SoftwareRenderer, needs_a_software_render_target)
+{
+    mtd::StubGLDisplayBuffer gl_display_buffer{view_area};
+
+    EXPECT_THROW(mrs::Renderer{gl_display_buffer}, std::logic_error);
+}
+
+TEST_F(SoftwareRenderer, factory_only_handles_display_buffers_without_gl)
+{
+    mrs::RendererFactory factory{std::make_shared<NullRendererFactory>()};
+    mtd::StubGLDisplayBuffer gl_display_buffer{view_area};
+
+    EXPECT_THAT(factory.create_renderer_for(display_buffer), NotNull());
+    EXPECT_THAT(factory.create_renderer_for(gl_display_buffer), IsNull());
+}
+
+TEST_F(SoftwareRenderer, clears_to_black)
+{
+    renderer.render({});
+
+    EXPECT_THAT(display_buffer.presented(), Each(black));
+}
+
+TEST_F(SoftwareRenderer, draws_buffer_at_its_screen_position)
+{
+    uint32_t const color{0xff102030};
+    geom::Rectangle const position{{2, 1}, {3, 2}};
+
+    renderer.render({renderable_of(position, solid_buffer(position.size, mir_pixel_format_xrgb_8888, color))});
+
+    for (int y = 0; y != view_area.size.height.as_int(); ++y)
+    {
+        for (int x = 0; x != view_area.size.width.as_int(); ++x)
+        {
+            geom::Point const p{x, y};
+            EXPECT_THAT(display_buffer.presented_pixel(p), Eq(position.contains(p) ? color : black)) << p;
+        }
+    }
+}
+
+TEST_F(SoftwareRenderer, draws_relative_to_the_viewport)
+{
+    renderer.set_viewport({{100, 200}, view_area.size});
+
+    renderer.render({renderable_of({{101, 202}, {1, 1}}, solid_buffer({1, 1}, mir_pixel_format_xrgb_8888, 0xff405060))});
+
+    EXPECT_THAT(display_buffer.presented_pixel({1, 2}), Eq(0xff405060u));
+    EXPECT_THAT(display_buffer.presented_pixel({0, 0}), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, converts_abgr_buffers)
+{
+    renderer.render({renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xbgr_8888, 0xff302010))});
+
+    EXPECT_THAT(display_buffer.presented(), Each(0xff102030u));
+}
+
+TEST_F(SoftwareRenderer, ignores_alpha_channel_of_opaque_formats)
+{
+    uint32_t const color_channels{0x00ffffff};
+
+    renderer.render({
+        renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xffffffff)),
+        renderable_of({{0, 0}, {4, 6}}, solid_buffer({4, 6}, mir_pixel_format_xrgb_8888, 0x00102030)),
+        renderable_of({{4, 0}, {4, 6}}, solid_buffer({4, 6}, mir_pixel_format_xrgb_8888, 0x00000000), 0.5f)});
+
+    // Had the alpha of zero been used, the white beneath would show through
+    EXPECT_THAT(display_buffer.presented_pixel({0, 0}) & color_channels, Eq(0x102030u));
+    EXPECT_THAT(display_buffer.presented_pixel({4, 0}) & color_channels, Eq(0x7f7f7fu));
+}
+
+TEST_F(SoftwareRenderer, blends_translucent_pixels_over_what_is_beneath)
+{
+    renderer.render({
+        renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff204060)),
+        renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_argb_8888, 0x80400000))});
+
+    EXPECT_THAT(display_buffer.presented(), Each(0xff502030u));
+}
+
+TEST_F(SoftwareRenderer, applies_renderable_alpha)
+{
+    renderer.render({renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xffffffff), 0.5f)});
+
+    EXPECT_THAT(display_buffer.presented(), Each(0xff808080u));
+}
+
+TEST_F(SoftwareRenderer, scales_buffer_to_its_screen_position)
+{
+    // Two pixels wide, stretched to four
+    auto const buffer = buffer_of({2, 1}, mir_pixel_format_xrgb_8888, {0xff000001, 0xff000002});
+
+    renderer.render({renderable_of({{0, 0}, {4, 2}}, buffer)});
+
+    EXPECT_THAT(display_buffer.presented_pixel({0, 0}), Eq(0xff000001u));
+    EXPECT_THAT(display_buffer.presented_pixel({1, 1}), Eq(0xff000001u));
+    EXPECT_THAT(display_buffer.presented_pixel({2, 0}), Eq(0xff000002u));
+    EXPECT_THAT(display_buffer.presented_pixel({3, 1}), Eq(0xff000002u));
+    EXPECT_THAT(display_buffer.presented_pixel({4, 0}), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, crops_and_scales_src_bounds_to_its_screen_position)
+{
+    // The right column of a 3×2 buffer, stretched to 2×2
+    auto const buffer = buffer_of({3, 2}, mir_pixel_format_xrgb_8888,
+        {0xff000001, 0xff000002, 0xff000003,
+         0xff000004, 0xff000005, 0xff000006});
+    auto const renderable = renderable_of({{0, 0}, {2, 2}}, buffer);
+    renderable->set_src_bounds({{2, 0}, {1, 2}});
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.presented_pixel({0, 0}), Eq(0xff000003u));
+    EXPECT_THAT(display_buffer.presented_pixel({1, 0}), Eq(0xff000003u));
+    EXPECT_THAT(display_buffer.presented_pixel({0, 1}), Eq(0xff000006u));
+    EXPECT_THAT(display_buffer.presented_pixel({1, 1}), Eq(0xff000006u));
+}
+
+TEST_F(SoftwareRenderer, crops_src_bounds_without_scaling)
+{
+    auto const buffer = buffer_of({3, 2}, mir_pixel_format_xrgb_8888,
+        {0xff000001, 0xff000002, 0xff000003,
+         0xff000004, 0xff000005, 0xff000006});
+    auto const renderable = renderable_of({{1, 1}, {2, 1}}, buffer);
+    renderable->set_src_bounds({{1, 1}, {2, 1}});
+
+    renderer.render({renderable});
+
+    EXPECT_THAT(display_buffer.presented_pixel({1, 1}), Eq(0xff000005u));
+    EXPECT_THAT(display_buffer.presented_pixel({2, 1}), Eq(0xff000006u));
+    EXPECT_THAT(display_buffer.presented_pixel({1, 0}), Eq(black));
+}
+
+TEST_F(SoftwareRenderer, rotates_transformed_renderables_about_their_centre)
+{
+    // Two pixels wide, stretched to 4×2, then turned a quarter clockwise to 2×4
+    auto const buffer = buffer_of({2, 1}, mir_pixel_format_xrgb_8888, {0xff000001, 0xff000002});
+    auto const renderable = renderable_of({{2, 1}, {4, 2}}, buffer);
+    renderable->set_transformation(glm::mat4{
+         0, 1, 0, 0,
+        -1, 0, 0, 0,
+         0, 0, 1, 0,
+         0, 0, 0, 1});
+
+    renderer.render({renderable});
+
+    for (int y = 0; y != view_area.size.height.as_int(); ++y)
+    {
+        for (int x = 0; x != view_area.size.width.as_int(); ++x)
+        {
+            geom::Point const p{x, y};
+            auto const expected =
+                !geom::Rectangle{{3, 0}, {2, 4}}.contains(p) ? black :
+                y < 2 ? 0xff000001u : 0xff000002u;
+            EXPECT_THAT(display_buffer.presented_pixel(p), Eq(expected)) << p;
+        }
+    }
+}
+
+TEST_F(SoftwareRenderer, draws_beneath_where_a_transformed_renderable_no_longer_covers)
+{
+    uint32_t const beneath{0xff405060};
+    auto const renderable = renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff000001));
+    // Half size
+    renderable->set_transformation(glm::mat4{
+        0.5f, 0,    0, 0,
+        0,    0.5f, 0, 0,
+        0,    0,    1, 0,
+        0,    0,    0, 1});
+
+    renderer.render({
+        renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, beneath)),
+        renderable});
+
+    EXPECT_THAT(display_buffer.presented_pixel({0, 0}), Eq(beneath));
+    EXPECT_THAT(display_buffer.presented_pixel({2, 1}), Eq(0xff000001u));
+    EXPECT_THAT(display_buffer.presented_pixel({5, 3}), Eq(0xff000001u));
+    EXPECT_THAT(display_buffer.presented_pixel({2, 4}), Eq(beneath));
+}
+
+TEST_F(SoftwareRenderer, does_not_read_buffers_hidden_beneath_opaque_renderables)
+{
+    NiceMock<mtd::MockBuffer> hidden{view_area.size, geom::Stride{32}, mir_pixel_format_xrgb_8888};
+    EXPECT_CALL(hidden, read(_)).Times(0);
+
+    renderer.render({
+        renderable_of(view_area, mir::test::fake_shared(hidden)),
+        renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff405060))});
+
+    EXPECT_THAT(display_buffer.presented(), Each(0xff405060u));
+}
+
+TEST_F(SoftwareRenderer, repaints_only_damage_when_buffer_age_allows)
+{
+    auto const window = renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff000001));
+
+    // Fill both buffers of the chain
+    renderer.render({window});
+    renderer.set_frame_damage(geom::Rectangles{});
+    renderer.render({window});
+
+    geom::Rectangle const damage{{1, 1}, {2, 2}};
+    window->set_buffer(solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff000002));
+    renderer.set_frame_damage(geom::Rectangles{damage});
+    renderer.render({window});
+
+    for (int y = 0; y != view_area.size.height.as_int(); ++y)
+    {
+        for (int x = 0; x != view_area.size.width.as_int(); ++x)
+        {
+            geom::Point const p{x, y};
+            EXPECT_THAT(display_buffer.presented_pixel(p), Eq(damage.contains(p) ? 0xff000002u : 0xff000001u)) << p;
+        }
+    }
+}
+
+TEST_F(SoftwareRenderer, repaints_everything_without_buffer_age)
+{
+    renderer.render({renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff000001))});
+
+    // The back buffer has never been drawn, so damage alone isn't enough
+    renderer.set_frame_damage(geom::Rectangles{geom::Rectangle{{1, 1}, {1, 1}}});
+    renderer.render({renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff000002))});
+
+    EXPECT_THAT(display_buffer.presented(), Each(0xff000002u));
+}
+
+TEST_F(SoftwareRenderer, repairs_damage_of_previous_frames)
+{
+    auto const window = renderable_of(view_area, solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff000001));
+    renderer.render({window});
+    renderer.set_frame_damage(geom::Rectangles{});
+    renderer.render({window});
+
+    // The back buffer missed this frame's update...
+    window->set_buffer(solid_buffer(view_area.size, mir_pixel_format_xrgb_8888, 0xff000002));
+    renderer.set_frame_damage(geom::Rectangles{geom::Rectangle{{0, 0}, {2, 2}}});
+    renderer.render({window});
+
+    // ...so it has to be repaired along with this one's
+    renderer.set_frame_damage(geom::Rectangles{});
+    renderer.render({window});
+
+    EXPECT_THAT(display_buffer.presented_pixel({1, 1}), Eq(0xff000002u));
+    EXPECT_THAT(display_buffer.presented_pixel({3, 3}), Eq(0xff000001u));
+}
@@ -735,6 +735,15 @@ TEST_F(BasicSurfaceTest, adjusts_explicit_input_region_for_frame_geometry)
     }
 }
 
+TEST_F(BasicSurfaceTest, explicit_input_region_is_clipped_to_surface)
+{
+    surface.set_input_region({{{-5, -5}, {100, 100}}});
+
+    EXPECT_TRUE(surface.input_area_contains(rect.top_left));
+    EXPECT_FALSE(surface.input_area_contains(rect.top_left - geom::Displacement{1, 1}));
+    EXPECT_FALSE(surface.input_area_contains(rect.bottom_right()));
+}
+
 TEST_F(BasicSurfaceTest, reception_mode_is_normal_by_default)
 {
     EXPECT_EQ(mi::InputReceptionMode::normal, surface.reception_mode());
@@ -1541,6 +1550,116 @@ TEST_F(BasicSurfaceTest, renderables_of_transparent_buffer_streams_are_shaped)
     EXPECT_THAT(renderables[1]->shaped(), true);
 }
 
+TEST_F(BasicSurfaceTest, renderables_carry_opaque_region_in_screen_coordinates)
+{
+    using namespace testing;
+    auto buffer_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    geom::Displacement const displacement{19, 99};
+    geom::Size const size{50, 40};
+
+    std::list<ms::StreamInfo> streams = {
+        { buffer_stream, displacement, size, {{{5, 5}, {10, 10}}, {{40, 30}, {100, 100}}} },
+    };
+    surface.set_streams(streams);
+
+    auto renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(1));
+
+    auto const top_left = renderables[0]->screen_position().top_left;
+    EXPECT_THAT(renderables[0]->opaque_region(), Eq(geom::Rectangles{
+        {top_left + geom::Displacement{5, 5}, {10, 10}},
+        {top_left + geom::Displacement{40, 30}, {10, 10}}}));
+}
+
+TEST_F(BasicSurfaceTest, renderables_carry_src_bounds_of_cropped_and_scaled_streams)
+{
+    using namespace testing;
+    auto buffer_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    geom::Size const size{50, 40};
+    geom::Rectangle const src_bounds{{10, 20}, {25, 20}};
+
+    std::list<ms::StreamInfo> streams = {
+        { mock_buffer_stream, {0, 0}, {} },
+        { buffer_stream, {0, 0}, size, {}, src_bounds },
+    };
+    surface.set_streams(streams);
+
+    auto renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(2));
+    EXPECT_THAT(renderables[0]->src_bounds(), Eq(geom::Rectangle{{}, renderables[0]->screen_position().size}));
+    EXPECT_THAT(renderables[1]->src_bounds(), Eq(src_bounds));
+    EXPECT_THAT(renderables[1]->screen_position().size, Eq(size));
+}
+
+TEST_F(BasicSurfaceTest, damage_to_a_cropped_stream_is_placed_relative_to_the_crop)
+{
+    using namespace testing;
+    auto buffer_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    geom::Rectangle const src_bounds{{20, 30}, {40, 30}};
+    ON_CALL(*buffer_stream, lock_compositor_buffer(_))
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>(geom::Size{100, 80})));
+    ON_CALL(*buffer_stream, damage_for(_))
+        .WillByDefault(Return(geom::Rectangles{{{25, 35}, {5, 5}}, {{0, 0}, {20, 30}}}));
+
+    std::list<ms::StreamInfo> streams = {
+        { buffer_stream, {0, 0}, src_bounds.size, {}, src_bounds },
+    };
+    surface.set_streams(streams);
+
+    auto renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(1));
+
+    // Damage outside the crop is not shown
+    auto const top_left = renderables[0]->screen_position().top_left;
+    EXPECT_THAT(renderables[0]->damage(), Eq(geom::Rectangles{
+        {top_left + geom::Displacement{5, 5}, {5, 5}}}));
+}
+
+TEST_F(BasicSurfaceTest, damage_to_a_scaled_stream_is_scaled_and_rounded_outwards)
+{
+    using namespace testing;
+    auto buffer_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    geom::Rectangle const src_bounds{{20, 30}, {40, 30}};
+    ON_CALL(*buffer_stream, lock_compositor_buffer(_))
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>(geom::Size{100, 80})));
+    ON_CALL(*buffer_stream, damage_for(_))
+        .WillByDefault(Return(geom::Rectangles{{{25, 35}, {5, 5}}}));
+
+    std::list<ms::StreamInfo> streams = {
+        { buffer_stream, {0, 0}, geom::Size{60, 45}, {}, src_bounds },
+    };
+    surface.set_streams(streams);
+
+    auto renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(1));
+
+    // Scaled by 1.5: {7.5, 7.5, 7.5x7.5} covers {7, 7, 8x8}
+    auto const top_left = renderables[0]->screen_position().top_left;
+    EXPECT_THAT(renderables[0]->damage(), Eq(geom::Rectangles{
+        {top_left + geom::Displacement{7, 7}, {8, 8}}}));
+}
+
+TEST_F(BasicSurfaceTest, undamaged_scaled_stream_has_no_damage)
+{
+    using namespace testing;
+    auto buffer_stream = std::make_shared<NiceMock<mtd::MockBufferStream>>();
+    geom::Rectangle const src_bounds{{20, 30}, {40, 30}};
+    ON_CALL(*buffer_stream, lock_compositor_buffer(_))
+        .WillByDefault(Return(std::make_shared<mtd::StubBuffer>(geom::Size{100, 80})));
+    ON_CALL(*buffer_stream, damage_for(_))
+        .WillByDefault(Return(geom::Rectangles{}));
+
+    std::list<ms::StreamInfo> streams = {
+        { buffer_stream, {0, 0}, geom::Size{80, 60}, {}, src_bounds },
+    };
+    surface.set_streams(streams);
+
+    auto renderables = surface.generate_renderables(this);
+    ASSERT_THAT(renderables.size(), Eq(1));
+
+    EXPECT_THAT(renderables[0]->damage(), Eq(geom::Rectangles{}));
+}
+
 namespace
 {
 struct VisibilityObserver : ms::NullSurfaceObserver
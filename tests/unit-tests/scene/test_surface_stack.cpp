@@ -29,8 +29,11 @@
 #include "mir/test/doubles/stub_buffer_stream.h"
 #include "mir/test/doubles/stub_buffer_stream_factory.h"
 #include "mir/test/doubles/stub_renderable.h"
+#include "mir/test/doubles/stub_surface.h"
 #include "mir/test/doubles/mock_buffer_stream.h"
 
+#include <boost/throw_exception.hpp>
+
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
@@ -84,6 +87,22 @@ struct MockSceneObserver : public ms::Observer
     MOCK_METHOD0(end_observation, void());
 };
 
+/// A visible surface that fails part way through appending its renderables
+struct ThrowingSurface : mtd::StubSurface
+{
+    bool visible() const override { return true; }
+
+    void append_renderables(mc::CompositorID, mg::RenderableList& renderables) const override
+    {
+        auto const renderable = std::make_shared<mtd::StubRenderable>();
+        appended = renderable;
+        renderables.push_back(renderable);
+        BOOST_THROW_EXCEPTION(std::runtime_error{"Failed to append renderables"});
+    }
+
+    std::weak_ptr<mg::Renderable> mutable appended;
+};
+
 struct SurfaceStack : public ::testing::Test
 {
     void SetUp()
@@ -444,6 +463,24 @@ TEST_F(SurfaceStack, generate_elementelements)
         stack.remove_surface(surface);
 }
 
+TEST_F(SurfaceStack, renderables_appended_by_a_surface_that_throws_are_released)
+{
+    using namespace testing;
+
+    auto const throwing_surface = std::make_shared<ThrowingSurface>();
+    stack.add_surface(throwing_surface, default_params.input_mode);
+
+    EXPECT_THROW(stack.scene_elements_for(compositor_id), std::runtime_error);
+    EXPECT_TRUE(throwing_surface->appended.expired());
+
+    stack.remove_surface(throwing_surface);
+    stack.add_surface(stub_surface1, default_params.input_mode);
+
+    EXPECT_THAT(
+        stack.scene_elements_for(compositor_id),
+        ElementsAre(SceneElementForStream(stub_buffer_stream1)));
+}
+
 TEST_F(SurfaceStack, scene_observer_notified_of_add_and_remove)
 {
     using namespace ::testing;
@@ -998,6 +1035,76 @@ TEST_F(SurfaceStack, returns_top_visible_surface_under_cursor)
     EXPECT_THAT(stack.surface_at(cursor_over_none).get(), IsNull());
 }
 
+TEST_F(SurfaceStack, surface_under_cursor_follows_moved_and_resized_surfaces)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({100, 100});
+    stub_surface2->move_to({1000, 1000});
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface2));
+
+    stub_surface2->move_to({0, 0});
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at({1050, 1050}).get(), IsNull());
+
+    stub_surface1->resize({2000, 2000});
+    EXPECT_THAT(stack.surface_at({1050, 1050}), Eq(stub_surface1));
+}
+
+TEST_F(SurfaceStack, surface_under_cursor_respects_raise_and_depth_layer)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->resize({100, 100});
+    stub_surface2->resize({100, 100});
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+
+    stack.raise(stub_surface1);
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface1));
+
+    stub_surface2->set_depth_layer(mir_depth_layer_above);
+    stack.raise(stub_surface1);
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+}
+
+TEST_F(SurfaceStack, removed_surface_is_not_under_cursor)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stub_surface1->resize({100, 100});
+
+    stack.remove_surface(stub_surface1);
+
+    EXPECT_THAT(stack.surface_at({50, 50}).get(), IsNull());
+}
+
+TEST_F(SurfaceStack, finds_very_large_surfaces_under_cursor)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stack.add_surface(stub_surface2, default_params.input_mode);
+
+    stub_surface1->move_to({-20000, -20000});
+    stub_surface1->resize({40000, 40000});
+    stub_surface2->resize({100, 100});
+
+    EXPECT_THAT(stack.surface_at({50, 50}), Eq(stub_surface2));
+    EXPECT_THAT(stack.surface_at({-15000, 15000}), Eq(stub_surface1));
+}
+
+TEST_F(SurfaceStack, input_surface_at_is_surface_under_cursor)
+{
+    stack.add_surface(stub_surface1, default_params.input_mode);
+    stub_surface1->resize({100, 100});
+
+    EXPECT_THAT(stack.input_surface_at({50, 50}), Eq(stub_surface1));
+    EXPECT_THAT(stack.input_surface_at({150, 50}).get(), IsNull());
+}
+
 TEST_F(SurfaceStack, raise_surfaces_to_top)
 {
     stack.add_surface(stub_surface1, default_params.input_mode);
@@ -0,0 +1,165 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mir/thread/work_queue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace mth = mir::thread;
+
+using namespace testing;
+
+namespace
+{
+int drain(mth::WorkQueue& queue)
+{
+    int ran{0};
+    while (auto work = queue.pop())
+    {
+        work();
+        ++ran;
+    }
+    return ran;
+}
+}
+
+TEST(WorkQueue, runs_work_in_the_order_it_was_pushed)
+{
+    mth::WorkQueue queue;
+    std::vector<int> order;
+
+    for (int i = 0; i != 5; ++i)
+        queue.push([&order, i] { order.push_back(i); });
+
+    queue.start_draining();
+    drain(queue);
+
+    EXPECT_THAT(order, ElementsAre(0, 1, 2, 3, 4));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(WorkQueue, only_asks_for_one_wakeup_until_consumer_starts_draining)
+{
+    mth::WorkQueue queue;
+
+    EXPECT_TRUE(queue.push([]{}));
+    EXPECT_FALSE(queue.push([]{}));
+    EXPECT_FALSE(queue.push([]{}));
+
+    queue.start_draining();
+    EXPECT_THAT(drain(queue), Eq(3));
+
+    EXPECT_TRUE(queue.push([]{}));
+    EXPECT_FALSE(queue.push([]{}));
+}
+
+TEST(WorkQueue, work_pushed_while_draining_asks_for_wakeup)
+{
+    mth::WorkQueue queue;
+    bool asked_for_wakeup{false};
+
+    queue.push([&] { asked_for_wakeup = queue.push([]{}); });
+
+    queue.start_draining();
+    queue.pop()();
+
+    EXPECT_TRUE(asked_for_wakeup);
+    EXPECT_FALSE(queue.empty());
+}
+
+TEST(WorkQueue, ignores_empty_work)
+{
+    mth::WorkQueue queue;
+
+    EXPECT_FALSE(queue.push({}));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.pop());
+}
+
+TEST(WorkQueue, destroys_work_left_on_queue)
+{
+    auto const resource = std::make_shared<int>();
+
+    {
+        mth::WorkQueue queue;
+        queue.push([resource] {});
+        queue.push([resource] {});
+        EXPECT_THAT(resource.use_count(), Eq(3));
+    }
+
+    EXPECT_THAT(resource.use_count(), Eq(1));
+}
+
+TEST(WorkQueue, consumer_runs_all_work_from_many_producers)
+{
+    int const producers{4};
+    int const items_per_producer{20000};
+
+    mth::WorkQueue queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    int wakeups_pending{0};
+    int wakeups{0};
+    std::atomic<int> ran{0};
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i != producers; ++i)
+    {
+        threads.emplace_back(
+            [&]
+            {
+                for (int j = 0; j != items_per_producer; ++j)
+                {
+                    if (queue.push([&ran] { ran.fetch_add(1, std::memory_order_relaxed); }))
+                    {
+                        std::lock_guard<std::mutex> lock{mutex};
+                        ++wakeups_pending;
+                        cv.notify_one();
+                    }
+                }
+            });
+    }
+
+    // The consumer only looks at the queue when woken, so a lost wakeup hangs here
+    while (ran != producers * items_per_producer)
+    {
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds{30}, [&] { return wakeups_pending > 0; }));
+            wakeups_pending = 0;
+            ++wakeups;
+        }
+
+        queue.start_draining();
+        drain(queue);
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_THAT(ran, Eq(producers * items_per_producer));
+    EXPECT_TRUE(queue.empty());
+    EXPECT_THAT(wakeups, Le(producers * items_per_producer));
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/client_motion_coalescer.h"
+
+#include <wayland-server-core.h>
+#include <wayland-server-protocol.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstring>
+#include <system_error>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+
+using namespace testing;
+using namespace std::chrono;
+using namespace std::chrono_literals;
+
+namespace
+{
+uint32_t const pointer_id{2};
+
+/// A real Wayland client connection, with the test reading the client's end of the socket
+struct ClientMotionCoalescerTest : Test
+{
+    ClientMotionCoalescerTest()
+    {
+        int fds[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+            throw std::system_error(errno, std::system_category(), "Failed to create socket pair");
+
+        client = wl_client_create(display, fds[0]);
+        client_end = fds[1];
+        pointer = wl_resource_create(client, &wl_pointer_interface, 1, pointer_id);
+        coalescer = std::make_unique<mf::ClientMotionCoalescer>(client,
+            [this](mf::ClientMotionCoalescer::Motion const& motion)
+            {
+                sent.push_back(motion);
+                if (motion.position)
+                {
+                    wl_pointer_send_motion(
+                        pointer,
+                        motion.time.count(),
+                        wl_fixed_from_int(motion.position.value().x.as_int()),
+                        wl_fixed_from_int(motion.position.value().y.as_int()));
+                }
+            });
+    }
+
+    ~ClientMotionCoalescerTest()
+    {
+        coalescer.reset();
+        wl_client_destroy(client);
+        wl_display_destroy(display);
+        close(client_end);
+    }
+
+    auto motion_to(int x, mf::WlSurface* surface = nullptr) -> mf::ClientMotionCoalescer::Motion
+    {
+        return {milliseconds{x}, surface, surface_destroyed, geom::Point{x, 0}, {}};
+    }
+
+    /// Runs the Wayland thread until the deadline: flushing the clients, then dispatching
+    void run_until(steady_clock::time_point deadline)
+    {
+        for (auto now = steady_clock::now(); now < deadline; now = steady_clock::now())
+        {
+            wl_display_flush_clients(display);
+            wl_event_loop_dispatch(
+                wl_display_get_event_loop(display),
+                duration_cast<milliseconds>(deadline - now + 999us).count());
+        }
+        wl_display_flush_clients(display);
+    }
+
+    /// Reads whatever is waiting in the client's socket, returning the x of each motion
+    auto client_reads() -> std::vector<int>
+    {
+        char buffer[4096];
+        for (ssize_t size; (size = recv(client_end, buffer, sizeof buffer, MSG_DONTWAIT)) > 0;)
+            unread.insert(unread.end(), buffer, buffer + size);
+
+        std::vector<int> motions;
+        size_t offset{0};
+        while (unread.size() - offset >= 8)
+        {
+            uint32_t header[2];
+            memcpy(header, unread.data() + offset, sizeof header);
+            auto const size = header[1] >> 16;
+            auto const opcode = header[1] & 0xffff;
+            if (unread.size() - offset < size)
+                break;
+
+            if (header[0] == pointer_id && opcode == WL_POINTER_MOTION)
+            {
+                int32_t x;
+                memcpy(&x, unread.data() + offset + 12, sizeof x);
+                motions.push_back(wl_fixed_to_int(x));
+            }
+            offset += size;
+        }
+        unread.erase(unread.begin(), unread.begin() + offset);
+
+        return motions;
+    }
+
+    wl_display* const display{wl_display_create()};
+    wl_client* client;
+    int client_end;
+    wl_resource* pointer;
+    std::vector<char> unread;
+
+    std::shared_ptr<bool> const surface_destroyed{std::make_shared<bool>(false)};
+    std::vector<mf::ClientMotionCoalescer::Motion> sent;
+    std::unique_ptr<mf::ClientMotionCoalescer> coalescer;
+};
+}
+
+TEST_F(ClientMotionCoalescerTest, a_client_that_has_read_everything_is_sent_motion_straight_away)
+{
+    coalescer->motion(motion_to(1));
+
+    ASSERT_THAT(sent.size(), Eq(1u));
+    EXPECT_THAT(sent[0].position, Eq(geom::Point{1, 0}));
+}
+
+TEST_F(ClientMotionCoalescerTest, motion_is_held_and_merged_until_the_client_reads)
+{
+    coalescer->motion(motion_to(1));
+    run_until(steady_clock::now() + 3 * mf::ClientMotionCoalescer::recheck_interval);
+
+    auto scroll = motion_to(2);
+    scroll.position = std::experimental::nullopt;
+    scroll.scroll = {0, 5};
+    coalescer->motion(scroll);
+    scroll.scroll = {0, 7};
+    coalescer->motion(scroll);
+    coalescer->motion(motion_to(3));
+
+    run_until(steady_clock::now() + 3 * mf::ClientMotionCoalescer::recheck_interval);
+    EXPECT_THAT(sent.size(), Eq(1u));
+
+    EXPECT_THAT(client_reads(), ElementsAre(1));
+    run_until(steady_clock::now() + 3 * mf::ClientMotionCoalescer::recheck_interval);
+
+    ASSERT_THAT(sent.size(), Eq(2u));
+    EXPECT_THAT(sent[1].time, Eq(milliseconds{3}));
+    EXPECT_THAT(sent[1].position, Eq(geom::Point{3, 0}));
+    EXPECT_THAT(sent[1].scroll, Eq(geom::Displacement{0, 12}));
+    EXPECT_THAT(client_reads(), ElementsAre(3));
+}
+
+TEST_F(ClientMotionCoalescerTest, flush_sends_held_motion_without_waiting_for_the_client)
+{
+    coalescer->motion(motion_to(1));
+    coalescer->motion(motion_to(2));
+    EXPECT_THAT(sent.size(), Eq(1u));
+
+    coalescer->flush();
+
+    ASSERT_THAT(sent.size(), Eq(2u));
+    EXPECT_THAT(sent[1].position, Eq(geom::Point{2, 0}));
+}
+
+TEST_F(ClientMotionCoalescerTest, motion_over_another_surface_is_not_merged)
+{
+    auto const first = reinterpret_cast<mf::WlSurface*>(&sent);
+    auto const second = reinterpret_cast<mf::WlSurface*>(&unread);
+
+    coalescer->motion(motion_to(1, first));
+    coalescer->motion(motion_to(2, first));
+    coalescer->motion(motion_to(3, second));
+
+    ASSERT_THAT(sent.size(), Eq(2u));
+    EXPECT_THAT(sent[1].surface, Eq(first));
+    EXPECT_THAT(sent[1].position, Eq(geom::Point{2, 0}));
+}
+
+TEST_F(ClientMotionCoalescerTest, motion_held_for_a_destroyed_surface_is_dropped)
+{
+    coalescer->motion(motion_to(1));
+    coalescer->motion(motion_to(2));
+
+    *surface_destroyed = true;
+    coalescer->flush();
+
+    EXPECT_THAT(sent.size(), Eq(1u));
+}
+
+TEST_F(ClientMotionCoalescerTest, a_client_reading_at_60hz_gets_about_one_motion_per_read)
+{
+    // A 1000Hz mouse, with a client that only reads its socket at 60Hz
+    auto const input_period = 1ms;
+    auto const read_period = duration_cast<steady_clock::duration>(1s) / 60;
+
+    auto const start = steady_clock::now();
+    auto next_read = start + read_period;
+    int moves{0};
+    int reads{0};
+    std::vector<int> received;
+
+    auto const read = [&]
+        {
+            auto const motions = client_reads();
+            received.insert(received.end(), motions.begin(), motions.end());
+            ++reads;
+            next_read += read_period;
+        };
+
+    for (auto next_input = start; next_input < start + 500ms; next_input += input_period)
+    {
+        coalescer->motion(motion_to(++moves));
+        run_until(next_input + input_period);
+
+        if (steady_clock::now() >= next_read)
+            read();
+    }
+
+    // Once the mouse stops, the client still catches up with where it ended up
+    while (reads < 40)
+    {
+        run_until(next_read);
+        read();
+    }
+
+    // Without merging the client would get every one of the motions
+    EXPECT_THAT(received.size(), Le(static_cast<size_t>(reads + 1)));
+    ASSERT_THAT(received, Not(IsEmpty()));
+    EXPECT_THAT(received.back(), Eq(moves));
+    EXPECT_TRUE(std::is_sorted(received.begin(), received.end()));
+}
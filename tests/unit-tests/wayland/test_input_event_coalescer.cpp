@@ -0,0 +1,204 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "src/server/frontend_wayland/input_event_coalescer.h"
+
+#include "mir/events/event_builders.h"
+#include "mir_toolkit/events/input/input_event.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace mf = mir::frontend;
+namespace mev = mir::events;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+/// Stands in for the Wayland thread, which only gets round to queued work when dispatched
+struct InputEventCoalescerTest : Test
+{
+    void consume(mir::EventUPtr const& event)
+    {
+        if (auto const owned_event = coalescer.enqueue(*event))
+        {
+            queue.push_back([this, owned_event]
+                {
+                    coalescer.dequeue(owned_event);
+                    handled.push_back(owned_event);
+                });
+        }
+    }
+
+    void dispatch()
+    {
+        while (!queue.empty())
+        {
+            queue.front()();
+            queue.pop_front();
+        }
+    }
+
+    auto motion(std::chrono::nanoseconds time, float x, float y, float dx = 0, float dy = 0,
+        float hscroll = 0, float vscroll = 0, MirPointerButtons buttons = 0) -> mir::EventUPtr
+    {
+        return mev::make_event(device_id, time, cookie, mir_input_event_modifier_none, mir_pointer_action_motion,
+            buttons, x, y, hscroll, vscroll, dx, dy);
+    }
+
+    auto button(std::chrono::nanoseconds time, float x, float y, MirPointerButtons buttons) -> mir::EventUPtr
+    {
+        return mev::make_event(device_id, time, cookie, mir_input_event_modifier_none,
+            buttons ? mir_pointer_action_button_down : mir_pointer_action_button_up,
+            buttons, x, y, 0, 0, 0, 0);
+    }
+
+    static auto pointer(std::shared_ptr<MirEvent> const& event) -> MirPointerEvent const*
+    {
+        return mir_input_event_get_pointer_event(mir_event_get_input_event(event.get()));
+    }
+
+    static auto axis(std::shared_ptr<MirEvent> const& event, MirPointerAxis axis) -> float
+    {
+        return mir_pointer_event_axis_value(pointer(event), axis);
+    }
+
+    MirInputDeviceId const device_id{7};
+    std::vector<uint8_t> const cookie;
+    mf::InputEventCoalescer coalescer;
+    std::deque<std::function<void()>> queue;
+    std::vector<std::shared_ptr<MirEvent>> handled;
+};
+}
+
+TEST_F(InputEventCoalescerTest, motion_queued_before_dispatch_is_merged_into_latest_position)
+{
+    consume(motion(1ms, 10, 10));
+    consume(motion(2ms, 11, 12));
+    consume(motion(3ms, 13, 15));
+
+    EXPECT_THAT(queue.size(), Eq(1u));
+
+    dispatch();
+
+    ASSERT_THAT(handled.size(), Eq(1u));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_x), Eq(13));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_y), Eq(15));
+    EXPECT_THAT(mir_input_event_get_event_time(mir_event_get_input_event(handled[0].get())), Eq(std::chrono::nanoseconds{3ms}.count()));
+}
+
+TEST_F(InputEventCoalescerTest, merged_motion_sums_relative_motion_and_scrolling)
+{
+    consume(motion(1ms, 10, 10, 1, 2, 0.5f, 1));
+    consume(motion(2ms, 11, 12, 1, 2, 0.5f, -3));
+
+    dispatch();
+
+    ASSERT_THAT(handled.size(), Eq(1u));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_relative_x), Eq(2));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_relative_y), Eq(4));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_hscroll), Eq(1));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_vscroll), Eq(-2));
+}
+
+TEST_F(InputEventCoalescerTest, motion_is_not_merged_across_other_events)
+{
+    consume(motion(1ms, 10, 10));
+    consume(button(2ms, 10, 10, mir_pointer_button_primary));
+    consume(motion(3ms, 20, 20, 0, 0, 0, 0, mir_pointer_button_primary));
+    consume(motion(4ms, 30, 30, 0, 0, 0, 0, mir_pointer_button_primary));
+
+    dispatch();
+
+    ASSERT_THAT(handled.size(), Eq(3u));
+    EXPECT_THAT(mir_pointer_event_action(pointer(handled[0])), Eq(mir_pointer_action_motion));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_x), Eq(10));
+    EXPECT_THAT(mir_pointer_event_action(pointer(handled[1])), Eq(mir_pointer_action_button_down));
+    EXPECT_THAT(mir_pointer_event_action(pointer(handled[2])), Eq(mir_pointer_action_motion));
+    EXPECT_THAT(axis(handled[2], mir_pointer_axis_x), Eq(30));
+}
+
+TEST_F(InputEventCoalescerTest, motion_is_not_merged_into_motion_already_handled)
+{
+    consume(motion(1ms, 10, 10));
+    dispatch();
+    consume(motion(2ms, 20, 20));
+    dispatch();
+
+    ASSERT_THAT(handled.size(), Eq(2u));
+    EXPECT_THAT(axis(handled[0], mir_pointer_axis_x), Eq(10));
+    EXPECT_THAT(axis(handled[1], mir_pointer_axis_x), Eq(20));
+}
+
+TEST_F(InputEventCoalescerTest, motion_with_different_buttons_is_not_merged)
+{
+    consume(motion(1ms, 10, 10));
+    consume(motion(2ms, 20, 20, 0, 0, 0, 0, mir_pointer_button_secondary));
+
+    EXPECT_THAT(queue.size(), Eq(2u));
+}
+
+TEST_F(InputEventCoalescerTest, high_frequency_motion_to_a_slow_dispatcher_does_not_grow_the_queue)
+{
+    // A 1000Hz mouse, with the Wayland thread only getting round to this surface's events at 60Hz
+    auto const input_period = 1ms;
+    auto const dispatch_period = std::chrono::nanoseconds{1s} / 60;
+
+    size_t longest_queue{0};
+    auto next_dispatch = dispatch_period;
+    int clicks{0};
+
+    for (auto time = 0ns; time < 1s; time += input_period)
+    {
+        float const x = std::chrono::duration_cast<std::chrono::milliseconds>(time).count();
+
+        // Clicks in amongst the motion still have to arrive in order
+        if (time.count() % (100 * 1000 * 1000) == 0)
+        {
+            consume(button(time, x, x, mir_pointer_button_primary));
+            consume(button(time, x, x, 0));
+            ++clicks;
+        }
+        else
+        {
+            consume(motion(time, x, x, 1, 0));
+        }
+
+        if (time >= next_dispatch)
+        {
+            longest_queue = std::max(longest_queue, queue.size());
+            dispatch();
+            next_dispatch += dispatch_period;
+        }
+    }
+    dispatch();
+
+    // Without merging the queue would hold 16 or 17 motion events by each dispatch
+    EXPECT_THAT(longest_queue, Le(4u));
+    // ...and the Wayland thread handles about one motion per dispatch, plus the clicks
+    EXPECT_THAT(handled.size(), Lt(100u));
+
+    float total_relative_motion{0};
+    for (auto const& event : handled)
+        total_relative_motion += axis(event, mir_pointer_axis_relative_x);
+    EXPECT_THAT(total_relative_motion, Eq(1000 - clicks));
+}
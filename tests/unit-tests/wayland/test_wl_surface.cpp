@@ -0,0 +1,75 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "src/server/frontend_wayland/wl_surface.h"
+
+#include "mir/geometry/rectangle.h"
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+namespace mf = mir::frontend;
+namespace geom = mir::geometry;
+
+using namespace testing;
+
+TEST(WlSurfaceDamage, without_a_viewport_surface_damage_is_buffer_damage)
+{
+    geom::Rectangle const buffer{{}, {100, 80}};
+
+    EXPECT_THAT(mf::surface_to_buffer({{10, 20}, {30, 40}}, buffer, buffer.size), Eq(geom::Rectangle{{10, 20}, {30, 40}}));
+}
+
+TEST(WlSurfaceDamage, damage_to_a_cropped_surface_is_offset_into_the_buffer)
+{
+    geom::Rectangle const source{{20, 30}, {40, 30}};
+
+    EXPECT_THAT(mf::surface_to_buffer({{5, 5}, {5, 5}}, source, source.size), Eq(geom::Rectangle{{25, 35}, {5, 5}}));
+}
+
+TEST(WlSurfaceDamage, damage_to_a_scaled_surface_covers_every_buffer_pixel_it_touches)
+{
+    geom::Rectangle const source{{0, 0}, {10, 10}};
+
+    // Each buffer pixel covers three surface pixels
+    EXPECT_THAT(mf::surface_to_buffer({{4, 4}, {1, 1}}, source, {30, 30}), Eq(geom::Rectangle{{1, 1}, {1, 1}}));
+    EXPECT_THAT(mf::surface_to_buffer({{5, 5}, {2, 2}}, source, {30, 30}), Eq(geom::Rectangle{{1, 1}, {2, 2}}));
+
+    // Each surface pixel covers two buffer pixels
+    EXPECT_THAT(mf::surface_to_buffer({{1, 1}, {1, 1}}, source, {5, 5}), Eq(geom::Rectangle{{2, 2}, {2, 2}}));
+}
+
+TEST(WlSurfaceDamage, damage_is_clipped_to_the_source)
+{
+    geom::Rectangle const source{{20, 30}, {40, 30}};
+    auto const everything = geom::Rectangle{{-100, -100}, {100000, 100000}};
+
+    EXPECT_THAT(mf::surface_to_buffer(everything, source, {80, 60}), Eq(source));
+}
+
+TEST(WlSurfaceViewport, fractional_source_covers_every_buffer_pixel_it_touches)
+{
+    mf::WlSurfaceState::Viewport::Source const source{10.5, 20.25, 30.0, 40.5};
+
+    EXPECT_THAT(source.covering(), Eq(geom::Rectangle{{10, 20}, {31, 41}}));
+}
+
+TEST(WlSurfaceViewport, integer_source_covers_itself)
+{
+    mf::WlSurfaceState::Viewport::Source const source{10, 20, 30, 40};
+
+    EXPECT_THAT(source.covering(), Eq(geom::Rectangle{{10, 20}, {30, 40}}));
+}
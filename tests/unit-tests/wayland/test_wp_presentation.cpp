@@ -0,0 +1,262 @@
+/*
+ * Copyright © 2019 Canonical Ltd.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 or 3 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "src/server/frontend_wayland/wp_presentation.h"
+#include "src/server/frontend_wayland/mir_display.h"
+
+#include "mir/graphics/display_configuration_observer.h"
+
+#include "mir/test/doubles/null_display.h"
+#include "mir/test/doubles/null_display_changer.h"
+#include "mir/test/doubles/stub_display_configuration.h"
+#include "mir/test/doubles/stub_observer_registrar.h"
+#include "mir/test/doubles/explicit_executor.h"
+
+#include <wayland-server-core.h>
+
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+
+#include <map>
+
+namespace mf = mir::frontend;
+namespace mg = mir::graphics;
+namespace mtd = mir::test::doubles;
+namespace geom = mir::geometry;
+
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace
+{
+auto const refresh = std::chrono::nanoseconds{16666667};
+
+auto at(std::chrono::nanoseconds time) -> mg::Frame::Timestamp
+{
+    return {CLOCK_MONOTONIC, time};
+}
+
+auto flip(int64_t msc, std::chrono::nanoseconds time) -> mg::Frame
+{
+    return {msc, at(time)};
+}
+
+auto now() -> mg::Frame::Timestamp
+{
+    return mg::Frame::Timestamp::now(CLOCK_MONOTONIC);
+}
+
+struct StubGraphicsDisplay : mtd::NullDisplay
+{
+    mg::Frame last_frame_on(unsigned output_id) const override
+    {
+        auto const flip = flips.find(output_id);
+        return flip != flips.end() ? flip->second : mg::Frame{};
+    }
+
+    std::map<unsigned, mg::Frame> flips;
+};
+
+struct StubDisplayChanger : mtd::NullDisplayChanger
+{
+    std::shared_ptr<mg::DisplayConfiguration> base_configuration() override
+    {
+        return std::make_shared<mtd::StubDisplayConfig>(outputs);
+    }
+
+    std::vector<geom::Rectangle> outputs{{{0, 0}, {640, 480}}};
+};
+
+struct MockPresentationListener : mf::PresentationListener
+{
+    MOCK_METHOD1(consumed, void(mg::Frame::Timestamp const&));
+    MOCK_METHOD0(discarded, void());
+    MOCK_METHOD3(presented, void(mg::Frame const&, std::chrono::nanoseconds, uint32_t));
+};
+
+MATCHER_P(IsFrame, msc, "")
+{
+    return arg.msc == msc;
+}
+
+struct PresentationClock : Test
+{
+    ~PresentationClock()
+    {
+        clock.reset();
+        wl_event_loop_destroy(event_loop);
+    }
+
+    /// Runs the event loop until the listener hears the outcome, or gives up after a second
+    void dispatch_until_resolved()
+    {
+        auto const give_up = now() + 1s;
+        while (!resolved && now() < give_up)
+            wl_event_loop_dispatch(event_loop, 100);
+    }
+
+    wl_event_loop* const event_loop{wl_event_loop_create()};
+    std::shared_ptr<StubGraphicsDisplay> const graphics_display{std::make_shared<StubGraphicsDisplay>()};
+    std::shared_ptr<StubDisplayChanger> const changer{std::make_shared<StubDisplayChanger>()};
+    std::shared_ptr<mf::MirDisplay> const outputs{std::make_shared<mf::MirDisplay>(
+        changer,
+        std::make_shared<mtd::StubObserverRegistrar<mg::DisplayConfigurationObserver>>())};
+    std::unique_ptr<mf::PresentationClock> clock{
+        std::make_unique<mf::PresentationClock>(event_loop, graphics_display, outputs)};
+
+    bool resolved{false};
+    std::shared_ptr<NiceMock<MockPresentationListener>> const listener{
+        std::make_shared<NiceMock<MockPresentationListener>>()};
+};
+
+struct PresentationFeedbacks : Test
+{
+    std::shared_ptr<mtd::ExplicitExectutor> const executor{std::make_shared<mtd::ExplicitExectutor>()};
+    std::shared_ptr<NiceMock<MockPresentationListener>> const listener{
+        std::make_shared<NiceMock<MockPresentationListener>>()};
+};
+}
+
+TEST(WpPresentation, content_is_not_presented_before_the_next_flip)
+{
+    auto const last_flip = flip(100, 1s);
+
+    EXPECT_FALSE(mf::presentation_flip(last_flip, refresh, at(1s + 5ms)));
+    EXPECT_FALSE(mf::presentation_flip(last_flip, refresh, at(1s)));
+}
+
+TEST(WpPresentation, content_is_presented_by_the_first_flip_after_it_is_consumed)
+{
+    auto const presented = mf::presentation_flip(flip(101, 1s + refresh), refresh, at(1s + 5ms));
+
+    ASSERT_TRUE(presented);
+    EXPECT_THAT(presented.value().msc, Eq(101));
+    EXPECT_THAT(presented.value().ust.nanoseconds, Eq(1s + refresh));
+}
+
+TEST(WpPresentation, later_flips_are_wound_back_to_the_one_that_presented_the_content)
+{
+    auto const presented = mf::presentation_flip(flip(104, 1s + 4*refresh), refresh, at(1s + 5ms));
+
+    ASSERT_TRUE(presented);
+    EXPECT_THAT(presented.value().msc, Eq(101));
+    EXPECT_THAT(presented.value().ust.nanoseconds, Eq(1s + refresh));
+}
+
+TEST(WpPresentation, without_a_refresh_period_the_last_flip_is_used)
+{
+    auto const last_flip = flip(104, 1s + 4*refresh);
+    auto const presented = mf::presentation_flip(last_flip, 0ns, at(1s + 5ms));
+
+    ASSERT_TRUE(presented);
+    EXPECT_THAT(presented.value().msc, Eq(last_flip.msc));
+    EXPECT_THAT(presented.value().ust.nanoseconds, Eq(last_flip.ust.nanoseconds));
+}
+
+TEST_F(PresentationClock, without_flip_tracking_content_is_presented_when_consumed)
+{
+    auto const consumed_at = now();
+
+    EXPECT_CALL(*listener, presented(IsFrame(0), Gt(0ns), 0u));
+    EXPECT_CALL(*listener, discarded()).Times(0);
+
+    clock->present(listener, geom::Point{10, 10}, consumed_at);
+}
+
+TEST_F(PresentationClock, content_is_presented_by_the_flip_after_it_is_consumed)
+{
+    auto const consumed_at = now();
+    graphics_display->flips[1] = {100, consumed_at - 5ms};
+
+    EXPECT_CALL(*listener, presented(IsFrame(101), Gt(0ns), Ne(0u)))
+        .WillOnce(InvokeWithoutArgs([this] { resolved = true; }));
+
+    clock->present(listener, geom::Point{10, 10}, consumed_at);
+
+    graphics_display->flips[1] = {101, consumed_at + 1ms};
+    dispatch_until_resolved();
+}
+
+TEST_F(PresentationClock, content_that_no_flip_displays_is_discarded_after_a_timeout)
+{
+    auto const consumed_at = now();
+    graphics_display->flips[1] = {100, consumed_at - 5ms};
+
+    EXPECT_CALL(*listener, presented(_, _, _)).Times(0);
+    EXPECT_CALL(*listener, discarded())
+        .WillOnce(InvokeWithoutArgs([this] { resolved = true; }));
+
+    clock->present(listener, geom::Point{10, 10}, consumed_at);
+
+    dispatch_until_resolved();
+}
+
+TEST_F(PresentationClock, content_is_discarded_without_an_output)
+{
+    changer->outputs.clear();
+
+    EXPECT_CALL(*listener, discarded());
+
+    clock->present(listener, geom::Point{10, 10}, now());
+}
+
+TEST_F(PresentationClock, content_is_synchronised_to_the_output_containing_the_surface)
+{
+    changer->outputs.push_back({{640, 0}, {640, 480}});
+    auto const consumed_at = now();
+    graphics_display->flips[2] = {100, consumed_at + 1ms};
+
+    EXPECT_CALL(*listener, presented(IsFrame(100), _, _));
+
+    clock->present(listener, geom::Point{700, 10}, consumed_at);
+}
+
+TEST_F(PresentationClock, content_of_a_destroyed_surface_is_synchronised_to_the_first_output)
+{
+    changer->outputs.push_back({{640, 0}, {640, 480}});
+    auto const consumed_at = now();
+    graphics_display->flips[2] = {100, consumed_at + 1ms};
+
+    EXPECT_CALL(*listener, presented(IsFrame(0), _, _));
+
+    clock->present(listener, std::experimental::nullopt, consumed_at);
+}
+
+TEST_F(PresentationFeedbacks, consumed_content_is_reported_once_on_the_executor)
+{
+    EXPECT_CALL(*listener, consumed(_)).Times(0);
+    {
+        mf::PresentationFeedbacks feedbacks{executor, {listener}};
+        feedbacks.consumed();
+        feedbacks.consumed();
+    }
+
+    Mock::VerifyAndClearExpectations(listener.get());
+
+    EXPECT_CALL(*listener, consumed(_)).Times(1);
+    EXPECT_CALL(*listener, discarded()).Times(0);
+    executor->execute();
+}
+
+TEST_F(PresentationFeedbacks, content_released_without_being_consumed_is_discarded)
+{
+    // As when the buffer is replaced before it is composited, or a null buffer is attached
+    {
+        mf::PresentationFeedbacks feedbacks{executor, {listener}};
+    }
+
+    EXPECT_CALL(*listener, discarded());
+    executor->execute();
+}